@@ -72,7 +72,7 @@ include "dependencies/glad"
 include "dependencies/imgui"
 include "dependencies/stbs"
 include "dependencies/spdlog"
-include "dependencies/tinyGLTF"
+include "dependencies/tinygltf"
 
 -- Add all the core dependencies to the project includes
 -- We will reserve the first include directory for the project's source
@@ -86,10 +86,10 @@ ProjIncludes = {
 	"dependencies/stbs",
 	"dependencies/fmod/include",
 	"dependencies/spdlog/include",
-	"dependencies/entt",
+	"dependencies/ENTT",
 	"dependencies/cereal",
 	"dependencies/gzip",
-	"dependencies/tinyGLTF",
+	"dependencies/tinygltf",
 	"dependencies/json",
 	"dependencies/bullet3/include",
 }
@@ -98,12 +98,32 @@ ProjIncludes = {
 Dependencies = {
 	"GLFW",
 	"Glad",
-	"stbs",
+	"Stbs",
 	"ImGui",
+	"TinyGLTF",
+}
+
+-- System libraries for windows builds, we ship our own zlib
+DependenciesWindows = {
 	"opengl32.lib",
 	"imagehlp.lib",
 	"dependencies/gzip/zlib.lib",
-	"tinyGLTF",
+}
+
+-- System libraries for linux builds, the bullet and fmod libs we ship are MSVC only, so we link against
+-- the system's bullet instead (fmod is not used by any of the projects)
+DependenciesLinux = {
+	"GL",
+	"EGL",
+	"X11",
+	"dl",
+	"pthread",
+	"z",
+	"BulletSoftBody",
+	"BulletDynamics",
+	"BulletCollision",
+	"Bullet3Common",
+	"LinearMath",
 }
 
 DependenciesDebug = {
@@ -201,6 +221,10 @@ function CreateDefaultModule(folderName)
 		-- Defines what directories we want to include
 		includedirs(ProjIncludes)
 
+		defines {
+			"GLFW_INCLUDE_NONE",
+		}
+
 		configuration "vs"
 	    	buildoptions { "/bigobj" }
 
@@ -210,24 +234,35 @@ function CreateDefaultModule(folderName)
 	        defines {
 	            "WINDOWS",
 	        }
+
+	    	links(DependenciesWindows)
+
+	    filter "system:linux"
+	    	links(DependenciesLinux)
 	        
 	    filter "configurations:Debug"
 	        runtime "Debug"
 	        symbols "on"
 
-	    	links(linkListDebug)
-
 	    filter "configurations:Release"
 	        runtime "Release"
 	        optimize "on"
 
+	    filter { "system:windows", "configurations:Debug" }
+	    	links(linkListDebug)
+
+	    filter { "system:windows", "configurations:Release" }
 	    	links(linkListRelease)
         
 end
 
--- Executes an xcopy command to copy all newer files from one folder to another
+-- Copies all newer files from one folder to another, with xcopy on windows and cp everywhere else
 function CopyFolder(sourcePath, destPath)
-	os.execute("xcopy /Q /E /Y /I /C \"" .. sourcePath .. "\" \"" .. destPath .. "\"")
+	if os.ishost("windows") then
+		os.execute("xcopy /Q /E /Y /I /C \"" .. sourcePath .. "\" \"" .. destPath .. "\"")
+	else
+		os.execute("mkdir -p \"" .. destPath .. "\" && cp -ru \"" .. sourcePath .. "\"/. \"" .. destPath .. "\"")
+	end
 end
 
 if not os.isdir(path.join(rootDir, "shared_assets")) then
@@ -333,7 +368,9 @@ function AddProjects(groupName, folders)
 			-- Gets the location of the project's source code
 			local srcdir = path.join(relpath, "src")
 
-			-- These are the commands that get executed after build, but before debugging
+			-- These are the commands that get executed after build, but before debugging (see the
+			-- system filters below)
+			filter "system:windows"
 			postbuildcommands {
 				-- This step copies over anything in the dll folder to the output directory
 		  		"(xcopy /Q /E /Y /I /C \"%{wks.location}shared_assets\\dll\" \"%{absdir}\")",
@@ -345,6 +382,15 @@ function AddProjects(groupName, folders)
 		  		"(xcopy /Q /E /Y /I /C \"%{resdir}\" \"%{absdir}\")"
 			} 
 
+			-- The same as above, for linux builds
+			filter "system:linux"
+			postbuildcommands {
+				"mkdir -p \"%{absdir}\" \"%{resdir}\"",
+				"cp -ru \"%{wks.location}shared_assets/res/.\" \"%{absdir}\"",
+				"cp -ru \"%{resdir}/.\" \"%{absdir}\""
+			}
+			filter {}
+
 			-- Our source files are everything in the src folder
 			files {
 				"%{prj.location}\\src\\**.h",
@@ -353,9 +399,10 @@ function AddProjects(groupName, folders)
 	            "%{prj.location}\\src\\**.hpp"
 			}
 
-			-- Disable CRT secure warnings
+			-- Disable CRT secure warnings, and stop GLFW from including the GL headers (we use glad)
 			defines {
-				"_CRT_SECURE_NO_WARNINGS"
+				"_CRT_SECURE_NO_WARNINGS",
+				"GLFW_INCLUDE_NONE"
 			}
 
 			-- We update the reserved include directory to be the project's source directory
@@ -366,18 +413,33 @@ function AddProjects(groupName, folders)
 			-- Link to the dependencies and modules
 			links(ProjLinks)
 
-		    buildoptions { "/bigobj" }
-
 			-- This filters for our windows builds
 			filter "system:windows"
 				systemversion "latest"
 
+				buildoptions { "/bigobj" }
+
 				-- Set some defines for the windows builds
 				defines {
-					"GLFW_INCLUDE_NONE", 
 					"WINDOWS"
 				}
 
+				links(DependenciesWindows)
+
+				-- The linux file dialogs go through zenity instead
+				removefiles { "%{prj.location}/src/Utils/Linux/**" }
+
+			-- Linux builds also need EGL for headless benchmark runs (see GLAppLayer). The GNU linker
+			-- only looks backwards for symbols, so the static libs are grouped to resolve them in any order
+			filter "system:linux"
+				pic "On"
+				linkgroups "On"
+
+				links(DependenciesLinux)
+
+				-- The file dialogs use the win32 API
+				removefiles { "%{prj.location}/src/Utils/Windows/**.cpp" }
+
 			-- Filters for our debug configurations
 			filter "configurations:Debug"
 				runtime "Debug"
@@ -9,6 +9,7 @@ Simple utility class for managing basic keyboard input.
 #include "NOU/Input.h"
 
 #include <string>
+#include <cstring>
 
 namespace nou
 {
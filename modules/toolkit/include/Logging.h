@@ -3,6 +3,14 @@
 #include "spdlog/fmt/ostr.h"
 #include "spdlog/logger.h"
 
+// __debugbreak is MSVC only, everywhere else we raise SIGTRAP, which stops in an attached debugger
+#ifdef _MSC_VER
+#define LOG_DEBUG_BREAK() __debugbreak()
+#else
+#include <csignal>
+#define LOG_DEBUG_BREAK() std::raise(SIGTRAP)
+#endif
+
 class Logger {
 public:
 	struct LoggerSettings
@@ -44,4 +52,4 @@ private:
 #define LOG_ERROR(...) { ::Logger::GetLogger()->error(__VA_ARGS__); ::Logger::GetLogger()->error("Location: \n{}", ::Logger::DumpStackTrace()); }
 
 // Allows us to assert if a value is true, and automagically debug break if it is false
-#define LOG_ASSERT(x, ...) { if (!(x)) { ::Logger::GetLogger()->error(__VA_ARGS__); __debugbreak(); } }
\ No newline at end of file
+#define LOG_ASSERT(x, ...) { if (!(x)) { ::Logger::GetLogger()->error(__VA_ARGS__); LOG_DEBUG_BREAK(); } }
\ No newline at end of file
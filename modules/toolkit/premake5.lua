@@ -17,9 +17,8 @@ project "toolkit"
     links {
         "Glad",
         "GLFW",
-        "stbs",
-        "spdlog",
-        "opengl32.lib"
+        "Stbs",
+        "spdlog"
     }
 
     includedirs {
@@ -32,6 +31,10 @@ project "toolkit"
         "%{wks.location}\\dependencies\\stbs"
     }
 
+    defines {
+        "GLFW_INCLUDE_NONE"
+    }
+
     disablewarnings {
         "26495",
         "26812",
@@ -46,6 +49,15 @@ project "toolkit"
             "TTK_GLFW"
         }
 
+        links { "opengl32.lib" }
+
+    filter "system:linux"
+        defines {
+            "TTK_GLFW"
+        }
+
+        links { "GL" }
+
         
     filter "configurations:Debug"
         runtime "Debug"
@@ -36,7 +36,11 @@ void Logger::Init(const LoggerSettings& settings) {
 		// The default color for trace is the same as info, so we get our color output
 		auto console_sink = dynamic_cast<spdlog::sinks::stdout_color_sink_mt*>(myLogger->sinks().back().get());
 		// and make trace cyan instead
+		#ifdef WINDOWS
 		console_sink->set_color(spdlog::level::trace, console_sink->CYAN);
+		#else
+		console_sink->set_color(spdlog::level::trace, console_sink->cyan);
+		#endif
 
 		#ifdef WINDOWS 
 		// Get the process handle
@@ -3,6 +3,11 @@
 #ifdef WINDOWS
 #include "windows.h"
 #include "psapi.h"
+#else
+#include <cstdio>
+#include <ctime>
+#include <sys/resource.h>
+#include <unistd.h>
 #endif
 
 size_t System::GetMemoryUsageBytes() {
@@ -10,6 +15,15 @@ size_t System::GetMemoryUsageBytes() {
 	static PROCESS_MEMORY_COUNTERS pmc;
 	GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc));
 	return pmc.WorkingSetSize;
+	#else
+	// The second value in statm is the resident set size, in pages
+	size_t pages = 0;
+	FILE* file = fopen("/proc/self/statm", "r");
+	if (file != nullptr) {
+		if (fscanf(file, "%*s %zu", &pages) != 1) pages = 0;
+		fclose(file);
+	}
+	return pages * static_cast<size_t>(sysconf(_SC_PAGESIZE));
 	#endif
 }
 
@@ -19,6 +33,9 @@ size_t System::GetPageUsageBytes()
 	static PROCESS_MEMORY_COUNTERS pmc;
 	GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc));
 	return pmc.QuotaPagedPoolUsage;
+	#else
+	// There's no paged pool outside of windows
+	return 0;
 	#endif
 }
 
@@ -27,6 +44,11 @@ size_t System::GetPeakMemoryUsageBytes() {
 	static PROCESS_MEMORY_COUNTERS pmc;
 	GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc));
 	return pmc.PeakWorkingSetSize;
+	#else
+	// ru_maxrss is in kilobytes on linux
+	rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return static_cast<size_t>(usage.ru_maxrss) * 1024;
 	#endif
 }
 
@@ -51,6 +73,25 @@ double System::GetCpuUsage()
 	lastUserCPU = user;
 	lastSysCPU = sys;
 
+	return percent * 100.0;
+	#else
+	// Same as above, with all times in microseconds
+	timespec ftime;
+	clock_gettime(CLOCK_MONOTONIC, &ftime);
+	unsigned long long now = static_cast<unsigned long long>(ftime.tv_sec) * 1000000 + ftime.tv_nsec / 1000;
+
+	rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	unsigned long long sys  = static_cast<unsigned long long>(usage.ru_stime.tv_sec) * 1000000 + usage.ru_stime.tv_usec;
+	unsigned long long user = static_cast<unsigned long long>(usage.ru_utime.tv_sec) * 1000000 + usage.ru_utime.tv_usec;
+
+	double percent = static_cast<double>(sys - lastSysCPU) + (user - lastUserCPU);
+	percent /= (now - lastCPU) > 0 ? (now - lastCPU) : 1;
+	percent /= numProcessors;
+	lastCPU = now;
+	lastUserCPU = user;
+	lastSysCPU = sys;
+
 	return percent * 100.0;
 	#endif
 }
@@ -58,6 +99,7 @@ double System::GetCpuUsage()
 void System::__Init() {
 	static bool isInit = false;
 	if (!isInit) {
+		#ifdef WINDOWS
 		SYSTEM_INFO sysInfo;
 		FILETIME ftime, fsys, fuser;
 
@@ -71,6 +113,19 @@ void System::__Init() {
 		GetProcessTimes(self, &ftime, &ftime, &fsys, &fuser);
 		memcpy(&lastSysCPU, &fsys, sizeof(FILETIME));
 		memcpy(&lastUserCPU, &fuser, sizeof(FILETIME));
+		#else
+		numProcessors = static_cast<int>(sysconf(_SC_NPROCESSORS_ONLN));
+		self = nullptr;
+
+		timespec ftime;
+		clock_gettime(CLOCK_MONOTONIC, &ftime);
+		lastCPU = static_cast<unsigned long long>(ftime.tv_sec) * 1000000 + ftime.tv_nsec / 1000;
+
+		rusage usage;
+		getrusage(RUSAGE_SELF, &usage);
+		lastSysCPU  = static_cast<unsigned long long>(usage.ru_stime.tv_sec) * 1000000 + usage.ru_stime.tv_usec;
+		lastUserCPU = static_cast<unsigned long long>(usage.ru_utime.tv_sec) * 1000000 + usage.ru_utime.tv_usec;
+		#endif
 
 		isInit = true;
 	}
@@ -13,7 +13,7 @@
 
 #include "TTK/GraphicsUtils.h"
 #include "TTK/TTKContext.h"
-#include <GLM/gtc/matrix_transform.inl>
+#include <GLM/gtc/matrix_transform.hpp>
 
 #include "imgui.h"
 #include "imgui_impl_glfw.h"
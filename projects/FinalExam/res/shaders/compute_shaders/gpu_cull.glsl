@@ -0,0 +1,107 @@
+#version 430
+
+layout (local_size_x = 64) in;
+
+// Matches GpuCuller::CullObject
+struct CullObject {
+    vec4  Center;
+    vec4  Extents;
+    // x is the object's batch, y is the batch's first slot in the visible list, z is 1 to never cull,
+    // w is 1 if the slot is free
+    uvec4 Batch;
+};
+
+layout (std430, binding = 10) readonly buffer b_CullObjects {
+    CullObject Objects[];
+};
+layout (std430, binding = 11) writeonly buffer b_VisibleObjects {
+    uint VisibleObjects[];
+};
+// GpuCuller::DrawCommand, 5 values per command with the instance count second
+layout (std430, binding = 12) buffer b_DrawCommands {
+    uint Commands[];
+};
+
+// The previous frame's depth, see hiz_downsample.glsl
+layout (binding = 0) uniform sampler2D s_HiZ;
+
+uniform mat4  u_ViewProjection;
+// The view projection that the Hi-Z pyramid was rendered with
+uniform mat4  u_HiZViewProjection;
+// The size of the first level of the pyramid
+uniform ivec2 u_HiZSize;
+uniform int   u_HiZLevels;
+uniform int   u_UseHiZ;
+uniform uint  u_ObjectCount;
+
+// Same plane extraction as the render layer (Gribb & Hartmann)
+bool IsInFrustum(vec3 center, vec3 extents) {
+    mat4 m = transpose(u_ViewProjection);
+    vec4 planes[6] = vec4[6](m[3] + m[0], m[3] - m[0], m[3] + m[1], m[3] - m[1], m[3] + m[2], m[3] - m[2]);
+    for (int ix = 0; ix < 6; ix++) {
+        float radius = dot(abs(planes[ix].xyz), extents);
+        if (dot(planes[ix].xyz, center) + planes[ix].w < -radius) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Projects the box into the previous frame, and checks whether it is behind everything in the
+// region of the pyramid that it covers
+bool IsOccluded(vec3 center, vec3 extents) {
+    vec3 minUVZ = vec3(1.0);
+    vec3 maxUVZ = vec3(0.0);
+    for (int ix = 0; ix < 8; ix++) {
+        vec3 corner = center + extents * vec3((ix & 1) != 0 ? 1 : -1, (ix & 2) != 0 ? 1 : -1, (ix & 4) != 0 ? 1 : -1);
+        vec4 clip = u_HiZViewProjection * vec4(corner, 1.0);
+        // Boxes crossing the near plane are always visible
+        if (clip.w <= 0.0001) {
+            return false;
+        }
+        vec3 uvz = (clip.xyz / clip.w) * 0.5 + 0.5;
+        minUVZ = min(minUVZ, uvz);
+        maxUVZ = max(maxUVZ, uvz);
+    }
+    minUVZ.xy = clamp(minUVZ.xy, 0.0, 1.0);
+    maxUVZ.xy = clamp(maxUVZ.xy, 0.0, 1.0);
+
+    // Pick the level where the box covers at most 2x2 texels
+    vec2 size = (maxUVZ.xy - minUVZ.xy) * vec2(u_HiZSize);
+    int level = clamp(int(ceil(log2(max(max(size.x, size.y), 1.0)))), 0, u_HiZLevels - 1);
+    ivec2 levelSize = max(u_HiZSize >> level, ivec2(1));
+    ivec2 start = clamp(ivec2(minUVZ.xy * vec2(levelSize)), ivec2(0), levelSize - 1);
+    ivec2 end   = clamp(ivec2(maxUVZ.xy * vec2(levelSize)), ivec2(0), levelSize - 1);
+
+    float farthest = 0.0;
+    for (int y = start.y; y <= end.y; y++) {
+        for (int x = start.x; x <= end.x; x++) {
+            farthest = max(farthest, texelFetch(s_HiZ, ivec2(x, y), level).r);
+        }
+    }
+    return minUVZ.z > farthest;
+}
+
+// Appends every object that passes to its batch's range of the visible list
+void main() {
+    uint ix = gl_GlobalInvocationID.x;
+    if (ix >= u_ObjectCount) {
+        return;
+    }
+
+    CullObject object = Objects[ix];
+    if (object.Batch.w != 0) {
+        return;
+    }
+    if (object.Batch.z == 0) {
+        if (!IsInFrustum(object.Center.xyz, object.Extents.xyz)) {
+            return;
+        }
+        if (u_UseHiZ != 0 && IsOccluded(object.Center.xyz, object.Extents.xyz)) {
+            return;
+        }
+    }
+
+    uint slot = atomicAdd(Commands[object.Batch.x * 5 + 1], 1);
+    VisibleObjects[object.Batch.y + slot] = ix;
+}
@@ -0,0 +1,34 @@
+#version 430
+
+layout (local_size_x = 8, local_size_y = 8) in;
+
+// The depth buffer when building the first level, otherwise the pyramid itself
+layout (binding = 0) uniform sampler2D s_Source;
+layout (binding = 0, r32f) uniform writeonly image2D u_Destination;
+
+uniform int   u_SourceLevel;
+uniform ivec2 u_SourceSize;
+uniform ivec2 u_DestSize;
+
+// Builds one level of the Hi-Z pyramid, where each texel holds the farthest depth of the texels it covers.
+// When the source has an odd size, the last texel along that edge also takes the extra row or column,
+// otherwise we'd lose it and could cull objects behind it
+void main() {
+    ivec2 dest = ivec2(gl_GlobalInvocationID.xy);
+    if (any(greaterThanEqual(dest, u_DestSize))) {
+        return;
+    }
+
+    ivec2 start = dest * 2;
+    ivec2 end = min(start + 1, u_SourceSize - 1);
+    if (dest.x == u_DestSize.x - 1) { end.x = u_SourceSize.x - 1; }
+    if (dest.y == u_DestSize.y - 1) { end.y = u_SourceSize.y - 1; }
+
+    float depth = 0.0;
+    for (int y = start.y; y <= end.y; y++) {
+        for (int x = start.x; x <= end.x; x++) {
+            depth = max(depth, texelFetch(s_Source, ivec2(x, y), u_SourceLevel).r);
+        }
+    }
+    imageStore(u_Destination, dest, vec4(depth));
+}
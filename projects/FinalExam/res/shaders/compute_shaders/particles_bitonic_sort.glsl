@@ -0,0 +1,78 @@
+#version 450
+
+// Each work group handles a block of BLOCK_SIZE elements, with each thread owning one pair
+#define BLOCK_SIZE 1024
+layout (local_size_x = BLOCK_SIZE / 2) in;
+
+layout (std430, binding = 6) buffer SortKeyBuffer {
+    float SortKeys[];
+};
+layout (std430, binding = 7) buffer SortValueBuffer {
+    uint SortValues[];
+};
+
+#define STAGE_LOCAL_SORT  0 // Fully sorts each block in shared memory
+#define STAGE_GLOBAL_STEP 1 // A single compare and swap pass for pairs too far apart to fit in a block
+#define STAGE_LOCAL_MERGE 2 // Finishes a merge once the pairs fit inside a block
+
+uniform uint u_Stage;
+uniform uint u_K;
+uniform uint u_J;
+
+shared float s_Keys[BLOCK_SIZE];
+shared uint  s_Values[BLOCK_SIZE];
+
+// The index of the first element of the given pair, when pairs are j elements apart
+uint pair_start(uint pair, uint j) {
+    return 2 * pair - (pair & (j - 1));
+}
+
+void main() {
+    uint thread = gl_LocalInvocationID.x;
+
+    if (u_Stage == STAGE_GLOBAL_STEP) {
+        uint a = pair_start(gl_GlobalInvocationID.x, u_J);
+        uint b = a + u_J;
+        bool ascending = (a & u_K) == 0;
+        if ((SortKeys[a] > SortKeys[b]) == ascending) {
+            float key = SortKeys[a];
+            SortKeys[a] = SortKeys[b];
+            SortKeys[b] = key;
+            uint value = SortValues[a];
+            SortValues[a] = SortValues[b];
+            SortValues[b] = value;
+        }
+        return;
+    }
+
+    uint base = gl_WorkGroupID.x * BLOCK_SIZE;
+    s_Keys[thread]                    = SortKeys[base + thread];
+    s_Keys[thread + BLOCK_SIZE / 2]   = SortKeys[base + thread + BLOCK_SIZE / 2];
+    s_Values[thread]                  = SortValues[base + thread];
+    s_Values[thread + BLOCK_SIZE / 2] = SortValues[base + thread + BLOCK_SIZE / 2];
+    barrier();
+
+    uint firstK = u_Stage == STAGE_LOCAL_SORT ? 2 : u_K;
+    uint lastK  = u_Stage == STAGE_LOCAL_SORT ? BLOCK_SIZE : u_K;
+    for (uint k = firstK; k <= lastK; k <<= 1) {
+        for (uint j = min(k >> 1, BLOCK_SIZE / 2); j > 0; j >>= 1) {
+            uint a = pair_start(thread, j);
+            uint b = a + j;
+            bool ascending = ((base + a) & k) == 0;
+            if ((s_Keys[a] > s_Keys[b]) == ascending) {
+                float key = s_Keys[a];
+                s_Keys[a] = s_Keys[b];
+                s_Keys[b] = key;
+                uint value = s_Values[a];
+                s_Values[a] = s_Values[b];
+                s_Values[b] = value;
+            }
+            barrier();
+        }
+    }
+
+    SortKeys[base + thread]                    = s_Keys[thread];
+    SortKeys[base + thread + BLOCK_SIZE / 2]   = s_Keys[thread + BLOCK_SIZE / 2];
+    SortValues[base + thread]                  = s_Values[thread];
+    SortValues[base + thread + BLOCK_SIZE / 2] = s_Values[thread + BLOCK_SIZE / 2];
+}
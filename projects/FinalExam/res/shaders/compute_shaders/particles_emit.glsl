@@ -0,0 +1,141 @@
+#version 450
+
+// One thread per new particle, across every emitter that is spawning this step
+layout (local_size_x = 64) in;
+
+#include "../fragments/particle_pool.glsl"
+#include "../fragments/random.glsl"
+
+// Emitter state for this step, the CPU works out how many particles are due (see prep_emitter in particle_sim_gs.glsl)
+struct EmitRequest {
+    uvec4 Info;      // x is type, y is texture index, z is the number of particles to emit, w is the first thread for this emitter
+    vec4  Position;  // xyz is position, w is the emitter's timer before spawning
+    vec4  Velocity;
+    vec4  Color;
+    vec4  Metadata;
+    vec4  Metadata2;
+};
+
+layout (std430, binding = 4) buffer EmitterBuffer {
+    EmitRequest Emitters[];
+};
+
+uniform mat4 u_ModelMatrix;
+uniform uint u_Seed;
+uniform uint u_EmitterCount;
+// The number of particles that all of the emitters are spawning
+uniform uint u_TotalEmit;
+
+uint rngState;
+
+float next_random() {
+    rngState = hash(rngState);
+    return floatConstruct(rngState);
+}
+
+// Finds the emitter that a thread belongs to, the emitters' first threads are in ascending order
+uint find_emitter(uint thread) {
+    uint low  = 0;
+    uint high = u_EmitterCount - 1;
+    while (low < high) {
+        uint mid = (low + high + 1) / 2;
+        if (Emitters[mid].Info.w <= thread) {
+            low = mid;
+        } else {
+            high = mid - 1;
+        }
+    }
+    return low;
+}
+
+void main() {
+    uint thread = gl_GlobalInvocationID.x;
+    if (thread >= u_TotalEmit) {
+        return;
+    }
+    uint emitterIx = find_emitter(thread);
+    EmitRequest emitter = Emitters[emitterIx];
+    uint ix = thread - emitter.Info.w;
+
+    // Grab a free particle, if the pool is full we put the count back and give up
+    int dead = atomicAdd(DeadCount, -1);
+    if (dead <= 0) {
+        atomicAdd(DeadCount, 1);
+        return;
+    }
+    uint particleIx = DeadList[dead - 1];
+
+    rngState = hash(uvec3(u_Seed, emitterIx, ix));
+
+    vec4 meta  = emitter.Metadata;
+    vec4 meta2 = emitter.Metadata2;
+    // Back-date each particle to when it should have spawned during this step
+    float timeAdjust = -emitter.Position.w + (ix * meta.x);
+
+    vec3 offset    = vec3(0);
+    vec3 velocity  = vec3(0);
+    vec2 lifeRange = meta.zw;
+    vec2 sizeRange = meta2.xy;
+
+    switch (emitter.Info.x) {
+        case TYPE_EMITTER_STREAM:
+            velocity = emitter.Velocity.xyz;
+            break;
+
+        case TYPE_EMITTER_SPHERE:
+        {
+            float z   = next_random() * 2 - 1;
+            float rxy = sqrt(1 - z * z);
+            float phi = next_random() * 6.28318530718;
+            vec3 direction = vec3(rxy * cos(phi), rxy * sin(phi), z);
+            offset   = direction * next_random() * emitter.Velocity.y;
+            velocity = direction * emitter.Velocity.x;
+            break;
+        }
+
+        case TYPE_EMITTER_BOX:
+        {
+            vec3 halfExtents = meta2.yzw;
+            offset = vec3(
+                (next_random() * 2 - 1) * halfExtents.x,
+                (next_random() * 2 - 1) * halfExtents.y,
+                (next_random() * 2 - 1) * halfExtents.z
+            );
+            velocity  = length(offset) > 0 ? normalize(offset) * emitter.Velocity.xyz : vec3(0);
+            sizeRange = meta.yz;
+            lifeRange = vec2(meta.w, meta2.x);
+            break;
+        }
+
+        case TYPE_EMITTER_CONE:
+        {
+            vec3 axis   = normalize(emitter.Velocity.xyz);
+            vec3 crossX = vec3(-axis.z, axis.x, axis.y);
+            if (dot(crossX, axis) > 0.001) {
+                crossX = vec3(-axis.y, axis.x, axis.z);
+            }
+            vec3 crossY = cross(axis, crossX);
+
+            float theta = acos(mix(cos(meta.y), 1, next_random()));
+            float phi   = next_random() * 6.28318530718;
+            velocity = sin(theta) * (cos(phi) * crossX + sin(phi) * crossY) + cos(theta) * axis;
+            velocity *= length(emitter.Velocity.xyz);
+            break;
+        }
+    }
+
+    float lifetime = lifeRange.x + (lifeRange.y - lifeRange.x) * next_random();
+
+    Particle p;
+    p.PositionLife  = vec4((u_ModelMatrix * vec4(emitter.Position.xyz + offset + velocity * timeAdjust, 1)).xyz, lifetime);
+    p.VelocityStart = vec4(mat3(u_ModelMatrix) * velocity, lifetime);
+    p.Color         = emitter.Color;
+    p.Size          = sizeRange.x + (sizeRange.y - sizeRange.x) * next_random();
+    p.TexID         = emitter.Info.y;
+    p.Padding       = vec2(0);
+    Particles[particleIx] = p;
+
+    // New particles go into the list that the simulation just filled
+    uint next = 1 - u_Current;
+    AliveList[next * u_Capacity + atomicAdd(AliveCount[next], 1)] = particleIx;
+}
@@ -0,0 +1,36 @@
+#version 450
+
+layout (local_size_x = 1) in;
+
+#include "../fragments/particle_pool.glsl"
+
+// Matches DrawArraysIndirectCommand followed by DispatchIndirectCommand
+layout (std430, binding = 5) buffer IndirectArgs {
+    uint DrawCount;
+    uint DrawInstanceCount;
+    uint DrawFirst;
+    uint DrawBaseInstance;
+    uint SimulateGroupsX;
+    uint SimulateGroupsY;
+    uint SimulateGroupsZ;
+};
+
+// Each particle is drawn as two triangles, see particles_compute_render_vs.glsl
+const uint VERTICES_PER_PARTICLE = 6;
+
+// Sets up the indirect arguments for drawing this frame's particles and simulating them next update
+void main() {
+    uint next = 1 - u_Current;
+
+    DrawCount         = AliveCount[next] * VERTICES_PER_PARTICLE;
+    DrawInstanceCount = 1;
+    DrawFirst         = 0;
+    DrawBaseInstance  = 0;
+
+    SimulateGroupsX = (AliveCount[next] + 255) / 256;
+    SimulateGroupsY = 1;
+    SimulateGroupsZ = 1;
+
+    // The list we just read from will be written to next update
+    AliveCount[u_Current] = 0;
+}
@@ -0,0 +1,33 @@
+#version 450
+
+layout (local_size_x = 256) in;
+
+#include "../fragments/particle_pool.glsl"
+
+uniform float u_DeltaTime;
+uniform vec3  u_Gravity;
+
+// Matches the TYPE_PARTICLE case in particle_sim_gs.glsl
+void main() {
+    uint ix = gl_GlobalInvocationID.x;
+    if (ix >= AliveCount[u_Current]) {
+        return;
+    }
+
+    uint next = 1 - u_Current;
+    uint particleIx = AliveList[u_Current * u_Capacity + ix];
+    Particle p = Particles[particleIx];
+
+    p.PositionLife.w -= u_DeltaTime;
+    if (p.PositionLife.w > 0) {
+        // Update position and apply forces
+        p.PositionLife.xyz  += p.VelocityStart.xyz * u_DeltaTime;
+        p.VelocityStart.xyz += u_Gravity * u_DeltaTime;
+        p.Color.a = p.PositionLife.w / p.VelocityStart.w;
+        Particles[particleIx] = p;
+
+        AliveList[next * u_Capacity + atomicAdd(AliveCount[next], 1)] = particleIx;
+    } else {
+        DeadList[atomicAdd(DeadCount, 1)] = particleIx;
+    }
+}
@@ -0,0 +1,28 @@
+#version 450
+
+layout (local_size_x = 256) in;
+
+#include "../fragments/frame_uniforms.glsl"
+#include "../fragments/particle_pool.glsl"
+
+layout (std430, binding = 6) buffer SortKeyBuffer {
+    float SortKeys[];
+};
+layout (std430, binding = 7) buffer SortValueBuffer {
+    uint SortValues[];
+};
+
+// Fills the sort buffers with the view depth of each live particle, so that after sorting the
+// farthest particles come first. Unused slots are pushed to the very end
+void main() {
+    uint ix = gl_GlobalInvocationID.x;
+
+    if (ix < AliveCount[u_Current]) {
+        uint particleIx = AliveList[u_Current * u_Capacity + ix];
+        SortKeys[ix]   = (u_View * vec4(Particles[particleIx].PositionLife.xyz, 1)).z;
+        SortValues[ix] = particleIx;
+    } else {
+        SortKeys[ix]   = 3.402823466e+38;
+        SortValues[ix] = 0;
+    }
+}
@@ -8,6 +8,7 @@ uniform layout(binding = 1) sampler2D s_NormalsMetallic;
 uniform layout(binding = 2) sampler2D s_DiffuseAccumulation;
 uniform layout(binding = 3) sampler2D s_SpecularAccumulation;
 uniform layout(binding = 4) sampler2D s_Emissive;
+uniform layout(binding = 5) sampler2D s_Depth;
 
 //testing
 uniform layout(binding = 11) sampler2D testChoice;
@@ -16,29 +17,66 @@ uniform layout(binding = 11) sampler2D testChoice;
 #include "../fragments/color_correction.glsl"
 #include "../fragments/multiple_point_lights.glsl"
 
-void main() {
-    vec3 albedo = texture(s_Albedo, inUV).rgb;
-    vec3 diffuse = texture(s_DiffuseAccumulation, inUV).rgb;
-    vec3 specular = texture(s_SpecularAccumulation, inUV).rgb;
-    vec4 emissive = texture(s_Emissive, inUV);
+// How much to sharpen the image when it has been rendered below full resolution, 0 to disable
+uniform float u_Sharpness;
 
-    vec3 choiceSelection = texture(testChoice, inUV).rgb;
+// Composites a single G-buffer sample, uv should already be scaled into the rendered region
+vec3 Shade(vec2 uv, vec3 choiceSelection) {
+    vec3 albedo = texture(s_Albedo, uv).rgb;
+    vec3 diffuse = texture(s_DiffuseAccumulation, uv).rgb;
+    vec3 specular = texture(s_SpecularAccumulation, uv).rgb;
+    vec4 emissive = texture(s_Emissive, uv);
 
     if(choiceSelection.x > 0) //r value // ambient
     {
-        outColor = vec4(albedo * (diffuse + specular + (emissive.rgb * emissive.a)), 1.0); //to be changed
+        return albedo * (diffuse + specular + (emissive.rgb * emissive.a)); //to be changed
     }
     else if(choiceSelection.y > 0) //g value //diffuse 
     {
-        outColor = vec4(albedo * (diffuse + (emissive.rgb * emissive.a)), 1.0); 
+        return albedo * (diffuse + (emissive.rgb * emissive.a)); 
     }
     else if(choiceSelection.z > 0) //b value //specular
     {
-        outColor = vec4(albedo * (specular + (emissive.rgb * emissive.a)), 1.0);
+        return albedo * (specular + (emissive.rgb * emissive.a));
     }
     else
     {
-        outColor = vec4(albedo * (diffuse + specular + (emissive.rgb * emissive.a)), 1.0);
+        return albedo * (diffuse + specular + (emissive.rgb * emissive.a));
+    }
+}
+
+void main() {
+    // Nothing was drawn on the far plane, the skybox fills those pixels in after we're done
+    if (texelFetch(s_Depth, ivec2(gl_FragCoord.xy * u_RenderScale.xy), 0).r >= 1.0) {
+        discard;
+    }
+
+    vec3 choiceSelection = texture(testChoice, inUV).rgb;
+
+    // The scene may only cover part of the G-buffer, clamp so that bilinear filtering doesn't pull in
+    // anything left outside of that region by previous frames
+    vec2 texelSize = 1.0 / textureSize(s_Albedo, 0);
+    vec2 uvMin = texelSize * 0.5;
+    vec2 uvMax = u_RenderScale.xy - texelSize * 0.5;
+    vec2 uv = clamp(inUV * u_RenderScale.xy, uvMin, uvMax);
+
+    vec3 color = Shade(uv, choiceSelection);
+
+    // Contrast adaptive sharpening, to win back some of the detail lost by upscaling. Sharpening is
+    // reduced where the neighbourhood is already high contrast to avoid ringing
+    if (u_Sharpness > 0) {
+        vec3 n = Shade(clamp(uv + vec2(0, texelSize.y), uvMin, uvMax), choiceSelection);
+        vec3 s = Shade(clamp(uv - vec2(0, texelSize.y), uvMin, uvMax), choiceSelection);
+        vec3 e = Shade(clamp(uv + vec2(texelSize.x, 0), uvMin, uvMax), choiceSelection);
+        vec3 w = Shade(clamp(uv - vec2(texelSize.x, 0), uvMin, uvMax), choiceSelection);
+
+        vec3 minColor = min(color, min(min(n, s), min(e, w)));
+        vec3 maxColor = max(color, max(max(n, s), max(e, w)));
+        vec3 amount = sqrt(clamp(min(minColor, 1.0 - maxColor) / max(maxColor, 0.0001), 0.0, 1.0));
+        vec3 weight = amount * (-1.0 / mix(8.0, 5.0, clamp(u_Sharpness, 0.0, 1.0)));
+
+        color = clamp((color + (n + s + e + w) * weight) / (1.0 + 4.0 * weight), 0.0, 1.0);
     }
-	
-}
\ No newline at end of file
+
+    outColor = vec4(color, 1.0);
+}
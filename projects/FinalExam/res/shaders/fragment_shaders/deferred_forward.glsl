@@ -24,6 +24,7 @@ struct Material {
 uniform Material u_Material;
 
 #include "../fragments/frame_uniforms.glsl"
+#include "../fragments/lod_fade.glsl"
 
 // https://learnopengl.com/Advanced-Lighting/Advanced-Lighting
 void main() {
@@ -33,8 +34,8 @@ void main() {
 	// We can use another texture to store things like our lighting settings
 	vec4 lightingParams = texture(u_Material.MetallicShininessMap, inUV);
 
-	// Discarding fragments who's alpha is below the material's threshold
-	if (albedoColor.a < u_Material.DiscardThreshold) {
+	// Discarding fragments who's alpha is below the material's threshold, or that our impostor is covering
+	if (albedoColor.a < u_Material.DiscardThreshold || IsMeshFadedOut(u_LodFade.x)) {
 		discard;
 	}
 
@@ -0,0 +1,59 @@
+#version 430
+
+#include "../fragments/fs_common_inputs.glsl"
+
+layout(location = 7) flat in ivec4 inLayers;
+layout(location = 8) flat in vec4  inParams;
+
+// We output a single color to the color buffer
+layout(location = 0) out vec4 albedo_specPower;
+layout(location = 1) out vec4 normal_metallic;
+layout(location = 2) out vec4 emissive;
+layout(location = 3) out vec3 view_pos;
+
+// The texture array pages for this batch, each instance picks its layer with inLayers
+// See Material::BATCHED_TEXTURE_NAMES for the order
+uniform layout(binding = 0) sampler2DArray s_AlbedoPage;
+uniform layout(binding = 1) sampler2DArray s_EmissivePage;
+uniform layout(binding = 2) sampler2DArray s_NormalPage;
+uniform layout(binding = 3) sampler2DArray s_MetallicShininessPage;
+
+#include "../fragments/frame_uniforms.glsl"
+#include "../fragments/lod_fade.glsl"
+
+// Materials without a texture behave as if the texture was unbound
+vec4 SampleLayer(sampler2DArray page, int layer, vec2 uv) {
+	return layer < 0 ? vec4(0, 0, 0, 1) : texture(page, vec3(uv, layer));
+}
+
+// Same as deferred_forward.glsl, but reading the material from texture arrays
+void main() {
+	// Get albedo from the material
+	vec4 albedoColor = SampleLayer(s_AlbedoPage, inLayers.x, inUV);
+
+	// We can use another texture to store things like our lighting settings
+	vec4 lightingParams = SampleLayer(s_MetallicShininessPage, inLayers.w, inUV);
+
+	// Discarding fragments who's alpha is below the material's threshold, or that our impostor is covering
+	if (albedoColor.a < inParams.x || IsMeshFadedOut(inParams.y)) {
+		discard;
+	}
+
+	albedo_specPower = vec4(albedoColor.rgb, 1.0f);
+
+    // Read our tangent from the map, and convert from the [0,1] range to [-1,1] range
+    vec3 normal = SampleLayer(s_NormalPage, inLayers.z, inUV).rgb;
+    normal = normal * 2.0 - 1.0;
+
+    // Here we apply the TBN matrix to transform the normal from tangent space to view space
+    normal = normalize(inTBN * normal);
+
+	// Map [-1, 1] to [0, 1]
+	normal = clamp((normal + 1) / 2.0, 0, 1);
+	normal_metallic = vec4(normal, lightingParams.y);
+
+	// Extract emissive from the material
+	emissive = SampleLayer(s_EmissivePage, inLayers.y, inUV);
+
+	view_pos = inViewPos;
+}
@@ -0,0 +1,41 @@
+#version 430
+
+layout(location = 0) in vec3 inViewPos;
+layout(location = 1) in vec2 inUV;
+layout(location = 2) flat in float inFade;
+layout(location = 3) flat in mat3 inFrameToView;
+
+// Same outputs as deferred_forward.glsl
+layout(location = 0) out vec4 albedo_specPower;
+layout(location = 1) out vec4 normal_metallic;
+layout(location = 2) out vec4 emissive;
+layout(location = 3) out vec3 view_pos;
+
+// The impostor atlas, see ImpostorAtlas for what is stored in each
+uniform layout(binding = 0) sampler2D s_Albedo;
+uniform layout(binding = 1) sampler2D s_Normal;
+uniform layout(binding = 2) sampler2D s_Emissive;
+
+#include "../fragments/frame_uniforms.glsl"
+#include "../fragments/lod_fade.glsl"
+
+void main() {
+	vec4 albedoColor = texture(s_Albedo, inUV);
+
+	// Alpha holds the baked coverage
+	if (albedoColor.a < 0.5 || IsImpostorFadedOut(inFade)) {
+		discard;
+	}
+
+	albedo_specPower = vec4(albedoColor.rgb, 1.0f);
+
+	// Normals were baked in the frame's view space, so move them into ours
+	vec4 normalParams = texture(s_Normal, inUV);
+	vec3 normal = normalize(inFrameToView * (normalParams.rgb * 2.0 - 1.0));
+	normal = clamp((normal + 1) / 2.0, 0, 1);
+	normal_metallic = vec4(normal, normalParams.a);
+
+	emissive = texture(s_Emissive, inUV);
+
+	view_pos = inViewPos;
+}
@@ -29,9 +29,9 @@ layout (std140, binding = 2) uniform b_LightBlock {
 	mat3  EnvironmentRotation;
 };
 
+#include "../fragments/frame_uniforms.glsl"
 #include "../fragments/deferred_post_common.glsl"
 
-#include "../fragments/frame_uniforms.glsl"
 
 // Calculates the contribution the given point light has 
 // for the current fragment
@@ -72,7 +72,7 @@ void main() {
     vec3 albedo = GetAlbedo(inUV);
     vec3 viewPos = GetViewPosition(inUV);
     
-    float specularPow = texture(s_AlbedoSpec, inUV).a;
+    float specularPow = texture(s_AlbedoSpec, inUV * u_RenderScale.xy).a;
 
     vec3 diffuse = vec3(0);
     vec3 specular = vec3(0);
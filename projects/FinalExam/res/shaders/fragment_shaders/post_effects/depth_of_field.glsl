@@ -55,7 +55,7 @@ vec3 depthOfField(vec2 texCoord, float focusPoint, float focusLength) {
     vec2 texelSize = 1.0 / textureSize(a_Depth, 0);
 
     // Get our depth into view space, and use that to calculate our circle of confusion
-    float centerDepth = DepthToDist(texCoord, texelFetch(a_Depth, ivec2(texCoord / texelSize), 0).r);
+    float centerDepth = DepthToDist(texCoord, texelFetch(a_Depth, ivec2(texCoord * u_RenderScale.xy / texelSize), 0).r);
     float centerCOC = getBlurSize(centerDepth, focusPoint, focusLength);
 
     // Initialize out color and total number of samples
@@ -71,7 +71,7 @@ vec3 depthOfField(vec2 texCoord, float focusPoint, float focusLength) {
 
         // Collect the color, depth, circle of confusion for that sample
         vec3 sampleColor = texture(a_Sampler, tc).rgb;
-        float sampleDepth = DepthToDist(tc, texelFetch(a_Depth, ivec2(tc / texelSize), 0).r);
+        float sampleDepth = DepthToDist(tc, texelFetch(a_Depth, ivec2(tc * u_RenderScale.xy / texelSize), 0).r);
         float sampleCOC = getBlurSize(sampleDepth, focusPoint, focusLength);
 
         if (sampleDepth > centerDepth)
@@ -93,6 +93,7 @@ void main() {
     float focalLength = 1.0f / (1.0 / u_FocalDepth + 1.0 / u_LensDepth);
     // Perform our DOF blurring
     vec3 dof = depthOfField(inUV, u_FocalDepth, focalLength);
-    // Return the result
-    outColor = vec4(dof, 1.0);
+    // Return the result, we store the distance in alpha for the half resolution upsample
+    float dist = DepthToDist(inUV, texelFetch(a_Depth, ivec2(inUV * u_RenderScale.xy * textureSize(a_Depth, 0)), 0).r);
+    outColor = vec4(dof, dist);
 }
\ No newline at end of file
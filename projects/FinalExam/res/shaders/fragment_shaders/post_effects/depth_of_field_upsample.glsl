@@ -0,0 +1,73 @@
+#version 440
+
+// Upsamples a half resolution depth of field blur, using a bilateral filter so that blurred
+// colors do not bleed across depth discontinuities
+
+layout(location = 0) in vec2 inUV;
+
+layout(location = 0) out vec4 outColor;
+
+// The full resolution color buffer, used for pixels that are in focus
+layout(binding = 0) uniform sampler2D a_Sampler;
+// The depth buffer to use (non-linearized)
+layout(binding = 1) uniform sampler2D a_Depth;
+// The half resolution blur, with the distance to the camera in the alpha channel
+layout(binding = 2) uniform sampler2D a_Blurred;
+
+#include "../../fragments/frame_uniforms.glsl"
+
+// Avoids dividing by zero when depths match exactly
+const float DEPTH_EPSILON = 0.001;
+
+// Converts a screen space coord and a raw depth value into a world-space distance
+// @param screen The screen-space coordinate to convert
+// @param rawValue The raw, non-linear depth value to convert
+// @returns A distance to the camera in world units
+float DepthToDist(vec2 screen, float rawValue) {
+	vec4 screenPos = vec4(screen.x, screen.y, rawValue, 1.0) * 2.0 - 1.0;
+	vec4 viewPosition = u_InvProjection * screenPos;
+
+	return -(viewPosition.z / viewPosition.w);
+}
+
+// Calculates the blur radius in pixels for a given depth, should match depth_of_field.glsl
+float getBlurSize(float depth, float focalPlane, float focalLength) {
+	float coc = clamp(
+        (focalLength * (focalPlane - depth)) / 
+        (depth * (focalPlane - focalLength)), 
+        -1.0, 1.0);
+	return abs(coc) * u_Aperture;
+}
+
+void main() {
+    float focalLength = 1.0f / (1.0 / u_FocalDepth + 1.0 / u_LensDepth);
+    float dist = DepthToDist(inUV, texture(a_Depth, inUV * u_RenderScale.xy).r);
+
+    // Find the 4 half resolution texels around us, and our bilinear weights between them
+    ivec2 lowSize = textureSize(a_Blurred, 0);
+    vec2  coord   = inUV * lowSize - 0.5;
+    ivec2 base    = ivec2(floor(coord));
+    vec2  f       = fract(coord);
+
+    vec3  color  = vec3(0);
+    float weight = 0.0;
+    for (int iy = 0; iy <= 1; iy++) {
+        for (int ix = 0; ix <= 1; ix++) {
+            vec4 texel = texelFetch(a_Blurred, clamp(base + ivec2(ix, iy), ivec2(0), lowSize - 1), 0);
+
+            // Texels at a similar depth to us contribute the most
+            float bilinear = (ix == 0 ? 1.0 - f.x : f.x) * (iy == 0 ? 1.0 - f.y : f.y);
+            float w = bilinear / (DEPTH_EPSILON + abs(dist - texel.a) / dist);
+
+            color  += texel.rgb * w;
+            weight += w;
+        }
+    }
+    vec3 blurred = color / max(weight, 1e-5);
+
+    // Pixels with a blur radius under a pixel stay at full resolution so in-focus areas stay sharp
+    float blurSize = getBlurSize(dist, u_FocalDepth, focalLength);
+    vec3 sharp = texture(a_Sampler, inUV).rgb;
+
+    outColor = vec4(mix(sharp, blurred, smoothstep(0.5, 1.5, blurSize)), 1.0);
+}
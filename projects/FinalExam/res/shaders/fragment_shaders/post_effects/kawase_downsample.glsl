@@ -0,0 +1,26 @@
+#version 430
+
+// Downsampling half of a dual Kawase blur
+// See "Bandwidth-Efficient Rendering" (Marius Bjorge, SIGGRAPH 2015)
+
+layout(location = 0) in vec2 inUV;
+layout(location = 0) out vec3 outColor;
+
+uniform layout(binding = 0) sampler2D s_Image;
+
+// Half the size of a pixel in the input image
+uniform vec2  u_HalfPixel;
+uniform float u_Offset;
+
+void main() {
+    vec2 offset = u_HalfPixel * u_Offset;
+
+    // Each corner sample lands between 4 pixels, so bilinear filtering does most of the work for us
+    vec3 accumulator = texture(s_Image, inUV).rgb * 4.0;
+    accumulator += texture(s_Image, inUV - offset).rgb;
+    accumulator += texture(s_Image, inUV + offset).rgb;
+    accumulator += texture(s_Image, inUV + vec2(offset.x, -offset.y)).rgb;
+    accumulator += texture(s_Image, inUV - vec2(offset.x, -offset.y)).rgb;
+
+    outColor = accumulator / 8.0;
+}
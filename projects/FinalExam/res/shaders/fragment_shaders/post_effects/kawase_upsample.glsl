@@ -0,0 +1,28 @@
+#version 430
+
+// Upsampling half of a dual Kawase blur
+// See "Bandwidth-Efficient Rendering" (Marius Bjorge, SIGGRAPH 2015)
+
+layout(location = 0) in vec2 inUV;
+layout(location = 0) out vec3 outColor;
+
+uniform layout(binding = 0) sampler2D s_Image;
+
+// Half the size of a pixel in the input image
+uniform vec2  u_HalfPixel;
+uniform float u_Offset;
+
+void main() {
+    vec2 offset = u_HalfPixel * u_Offset;
+
+    vec3 accumulator = texture(s_Image, inUV + vec2(-offset.x * 2.0, 0.0)).rgb;
+    accumulator += texture(s_Image, inUV + vec2(-offset.x, offset.y)).rgb * 2.0;
+    accumulator += texture(s_Image, inUV + vec2(0.0, offset.y * 2.0)).rgb;
+    accumulator += texture(s_Image, inUV + vec2(offset.x, offset.y)).rgb * 2.0;
+    accumulator += texture(s_Image, inUV + vec2(offset.x * 2.0, 0.0)).rgb;
+    accumulator += texture(s_Image, inUV + vec2(offset.x, -offset.y)).rgb * 2.0;
+    accumulator += texture(s_Image, inUV + vec2(0.0, -offset.y * 2.0)).rgb;
+    accumulator += texture(s_Image, inUV + vec2(-offset.x, -offset.y)).rgb * 2.0;
+
+    outColor = accumulator / 12.0;
+}
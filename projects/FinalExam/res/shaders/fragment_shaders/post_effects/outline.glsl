@@ -22,14 +22,19 @@ uniform vec2  u_PixelSize;
 
 #include "../../fragments/frame_uniforms.glsl"
 
+// The G-buffer may only be partially filled when dynamic resolution is on
 float GetDepth(vec2 uv) {
-    return texelFetch(s_Depth, ivec2(uv * textureSize(s_Depth, 0)), 0).r;
+    return texelFetch(s_Depth, ivec2(uv * u_RenderScale.xy * textureSize(s_Depth, 0)), 0).r;
+}
+
+vec3 GetNormal(vec2 uv) {
+    return texture(s_Normals, uv * u_RenderScale.xy).rgb * 2 - 1;
 }
 
 void main() {
 
     float depth = GetDepth(inUV);
-    vec3 norm = texture(s_Normals, inUV).rgb * 2 - 1;
+    vec3 norm = GetNormal(inUV);
 
     float halfScale = u_Scale * 0.5f;
 
@@ -46,10 +51,10 @@ void main() {
     float d3 = GetDepth(inUV);
 
     // Grab normals
-    vec3 n0 = texture(s_Normals, u0).rgb * 2 - 1;
-    vec3 n1 = texture(s_Normals, u1).rgb * 2 - 1;
-    vec3 n2 = texture(s_Normals, u2).rgb * 2 - 1;
-    vec3 n3 = texture(s_Normals, u3).rgb * 2 - 1;
+    vec3 n0 = GetNormal(u0);
+    vec3 n1 = GetNormal(u1);
+    vec3 n2 = GetNormal(u2);
+    vec3 n3 = GetNormal(u3);
 
     // Compute a threshold term based on the dot product between the camera and the normal
     float nDotV = 1 - dot(norm, -inViewDir);
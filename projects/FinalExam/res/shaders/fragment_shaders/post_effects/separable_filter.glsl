@@ -0,0 +1,25 @@
+#version 430
+
+layout(location = 0) in vec2 inUV;
+layout(location = 0) out vec3 outColor;
+
+uniform layout(binding = 0) sampler2D s_Image;
+
+// Should match SeparableFilter::MAX_TAPS
+const int MAX_TAPS = 15;
+
+uniform float u_Kernel[MAX_TAPS];
+uniform int   u_TapCount;
+// The distance between taps in UV space (ex: one pixel to the right for a horizontal pass)
+uniform vec2  u_Direction;
+
+void main() {
+    int radius = u_TapCount / 2;
+
+    vec3 accumulator = vec3(0);
+    for(int ix = 0; ix < u_TapCount; ix++) {
+        vec2 uv = inUV + u_Direction * (ix - radius);
+        accumulator += texture(s_Image, uv).rgb * u_Kernel[ix];
+    }
+    outColor = accumulator;
+}
@@ -50,8 +50,8 @@ struct Light {
 	vec4  ColorAttenuation;
 };
 
-#include "../fragments/deferred_post_common.glsl"
 #include "../fragments/frame_uniforms.glsl"
+#include "../fragments/deferred_post_common.glsl"
 
 // Showing off another way to extract view pos from depth
 vec4 GetViewPos(vec2 uv) {
@@ -224,7 +224,7 @@ void main() {
         }
 
         // We'll also grab specular power from the G-Buffer
-        float specularPow = texture(s_AlbedoSpec, inUV).a;
+        float specularPow = texture(s_AlbedoSpec, inUV * u_RenderScale.xy).a;
 
         // Use the structure to calculate a directional light's contribution
         CalcDirectionalLightContribution(viewPos, normal, l, specularPow, diffuse, specular);
@@ -0,0 +1,18 @@
+// Per instance data for batched draws, matches RenderLayer::BatchedInstance
+struct BatchedInstance {
+    // The model's world transform
+    mat4  Model;
+    // The model's normal matrix, padded to a mat4
+    mat4  NormalMatrix;
+    // The layer of each material texture in its page (albedo, emissive, normal, metallic/shininess), or -1 if unused
+    ivec4 Layers;
+    // x is the material's discard threshold, y is how far the object has crossfaded to its impostor
+    vec4  Params;
+};
+
+layout (std430, binding = 8) readonly buffer b_BatchedInstances {
+    BatchedInstance Instances[];
+};
+
+// The index of this draw's first instance in the buffer
+uniform int u_BaseInstance;
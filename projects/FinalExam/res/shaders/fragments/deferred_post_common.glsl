@@ -6,18 +6,20 @@ uniform layout(binding=3) sampler2D s_Emissive;
 uniform layout(binding=4) sampler2D s_Position;
 
 
+// Screen space UVs are scaled down to the region of the G-buffer that was rendered into this frame,
+// see u_RenderScale in frame_uniforms.glsl. Requires frame_uniforms.glsl to be included first
 vec3 GetNormal(vec2 uv) {
-    return ((texture(s_NormalsMetallic, uv).xyz) * 2) - 1;
+    return ((texture(s_NormalsMetallic, uv * u_RenderScale.xy).xyz) * 2) - 1;
 }
 
 vec3 GetAlbedo(vec2 uv) {
-    return texture(s_AlbedoSpec, uv).rgb;
+    return texture(s_AlbedoSpec, uv * u_RenderScale.xy).rgb;
 }
 
 vec3 GetViewPosition(vec2 uv) {
-    return texture(s_Position, uv).rgb;
+    return texture(s_Position, uv * u_RenderScale.xy).rgb;
 }
 
 float GetDepth(vec2 uv) {
-    return texelFetch(s_Depth, ivec2(uv * textureSize(s_Depth, 0)), 0).r;
+    return texelFetch(s_Depth, ivec2(uv * u_RenderScale.xy * textureSize(s_Depth, 0)), 0).r;
 }
\ No newline at end of file
@@ -33,6 +33,10 @@ layout (std140, binding = 0) uniform b_FrameLevelUniforms {
     // New for fun, the viewport rectangle on the output (x, y, w, h)
     uniform vec4 u_Viewport;
 
+    // The fraction of the G-buffer that the scene was rendered into this frame (xy), and the size of
+    // that region in pixels (zw). Less than one when dynamic resolution is scaling the scene down
+    uniform vec4 u_RenderScale;
+
 };
 
 // Stores uniforms that change every object/instance
@@ -45,6 +49,8 @@ layout (std140, binding = 1) uniform b_InstanceLevelUniforms {
     uniform mat4 u_ModelView;
     // Normal Matrix for transforming normals
     uniform mat4 u_NormalMatrix;
+    // x is how far the object has crossfaded to its impostor, see fragments/lod_fade.glsl
+    uniform vec4 u_LodFade;
 };
 
 #define FLAG_ENABLE_COLOR_CORRECTION (1 << 0)
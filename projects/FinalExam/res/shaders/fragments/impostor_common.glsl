@@ -0,0 +1,46 @@
+// Per instance data for impostor draws, matches RenderLayer::ImpostorInstance
+struct ImpostorInstance {
+    // The model's world transform
+    mat4 Model;
+    // The center (xyz) and radius (w) of the mesh's bounding sphere, in model space
+    vec4 Bounds;
+    // The direction from the center towards the camera, in model space
+    vec4 ViewDir;
+    // x is how far the impostor has faded in, y is the impostor's slot in the atlas
+    vec4 Params;
+};
+
+layout (std430, binding = 9) readonly buffer b_ImpostorInstances {
+    ImpostorInstance Impostors[];
+};
+
+// The index of this draw's first instance in the buffer
+uniform int u_BaseInstance;
+// The layout of the atlas, see ImpostorAtlas
+uniform int u_FramesPerSide;
+uniform int u_SlotsPerSide;
+
+// Maps a unit direction to [0, 1] texture coordinates on an octahedron, matches ImpostorAtlas::OctahedralEncode
+vec2 OctahedralEncode(vec3 dir) {
+    vec3 n = dir / (abs(dir.x) + abs(dir.y) + abs(dir.z));
+    vec2 result = n.z >= 0.0 ? n.xy : (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    return result * 0.5 + 0.5;
+}
+
+// Inverse of OctahedralEncode, matches ImpostorAtlas::OctahedralDecode
+vec3 OctahedralDecode(vec2 uv) {
+    vec2 f = uv * 2.0 - 1.0;
+    vec3 n = vec3(f.x, f.y, 1.0 - abs(f.x) - abs(f.y));
+    float t = clamp(-n.z, 0.0, 1.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
+
+// The right and up axes of the camera that baked the frame facing the given direction,
+// matches the glm::lookAt call in ImpostorAtlas::GetFrameView
+void GetFrameBasis(vec3 dir, out vec3 right, out vec3 up) {
+    vec3 worldUp = abs(dir.y) > 0.999 ? vec3(0, 0, 1) : vec3(0, 1, 0);
+    right = normalize(cross(-dir, worldUp));
+    up = cross(right, -dir);
+}
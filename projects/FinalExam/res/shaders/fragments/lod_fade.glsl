@@ -0,0 +1,24 @@
+// Screen door crossfading between a mesh and its impostor, see RenderLayer::ImpostorSettings
+// The mesh keeps exactly the pixels that the impostor drops, so the two never overlap
+
+// A 4x4 ordered dither threshold for the current pixel, in (0, 1)
+float LodDitherThreshold() {
+    const float bayer[16] = float[16](
+         0.0,  8.0,  2.0, 10.0,
+        12.0,  4.0, 14.0,  6.0,
+         3.0, 11.0,  1.0,  9.0,
+        15.0,  7.0, 13.0,  5.0
+    );
+    ivec2 pixel = ivec2(gl_FragCoord.xy) & 3;
+    return (bayer[pixel.y * 4 + pixel.x] + 0.5) / 16.0;
+}
+
+// True if a mesh that has faded this far towards its impostor should drop the current pixel
+bool IsMeshFadedOut(float fade) {
+    return fade > 0.0 && LodDitherThreshold() < fade;
+}
+
+// True if an impostor that has faded this far in should drop the current pixel
+bool IsImpostorFadedOut(float fade) {
+    return LodDitherThreshold() >= fade;
+}
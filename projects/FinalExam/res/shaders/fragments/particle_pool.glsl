@@ -0,0 +1,41 @@
+// Shared layouts for the compute particle pipeline, see ComputeParticlePipeline.h
+
+#define TYPE_EMITTER_STREAM 0
+#define TYPE_EMITTER_SPHERE 1
+#define TYPE_EMITTER_BOX 2
+#define TYPE_EMITTER_CONE 3
+#define TYPE_PARTICLE (1 << 17)
+
+struct Particle {
+    vec4  PositionLife;  // xyz is position, w is remaining lifetime
+    vec4  VelocityStart; // xyz is velocity, w is the lifetime the particle started with
+    vec4  Color;
+    float Size;
+    uint  TexID;
+    vec2  Padding;
+};
+
+layout (std430, binding = 0) buffer ParticlePool {
+    Particle Particles[];
+};
+
+// Indices of particles that are free to be spawned
+layout (std430, binding = 1) buffer DeadListBuffer {
+    uint DeadList[];
+};
+
+// Two lists of live particle indices back to back, we read from one and write survivors to the other
+layout (std430, binding = 2) buffer AliveListBuffer {
+    uint AliveList[];
+};
+
+layout (std430, binding = 3) buffer CounterBuffer {
+    int  DeadCount;
+    uint AliveCount[2];
+    uint CounterPadding;
+};
+
+// The number of particles that the pool can hold
+uniform uint u_Capacity;
+// The alive list that holds the particles from the last update
+uniform uint u_Current;
@@ -31,6 +31,10 @@ out vec4 out_Metadata2;
 
 // Uniforms
 uniform vec3  u_Gravity;
+// The time to simulate, this can differ from u_DeltaTime when the system has been skipped for a few frames
+uniform float u_StepTime;
+// Multiplier for emitter spawn rates, see ParticleLayer
+uniform float u_EmissionScale;
 
 uniform mat4 u_ModelMatrix;
 
@@ -57,7 +61,7 @@ vec3 point_on_sphere() {
 }
 
 void prep_emitter(out float startLife, out int toEmit) {
-    float lifetime = inLifetime[0] - u_DeltaTime;
+    float lifetime = inLifetime[0] - u_StepTime * u_EmissionScale;
     int emitted = 1;
     vec4 meta = inMetadata[0];
     startLife = lifetime;
@@ -247,7 +251,7 @@ void emit_cone() {
 }
 
 void main() {
-    float lifetime = inLifetime[0] - u_DeltaTime;
+    float lifetime = inLifetime[0] - u_StepTime;
     vec4 meta = inMetadata[0];
 
 
@@ -276,8 +280,8 @@ void main() {
                 out_TexID = inTexID[0];
 
                 // Update position and apply forces
-                out_Position = inPosition[0] + inVelocity[0] * u_DeltaTime;
-                out_Velocity = inVelocity[0] + (u_Gravity * u_DeltaTime);
+                out_Position = inPosition[0] + inVelocity[0] * u_StepTime;
+                out_Velocity = inVelocity[0] + (u_Gravity * u_StepTime);
                                 
                 // Update lifetime
                 out_Lifetime = lifetime;
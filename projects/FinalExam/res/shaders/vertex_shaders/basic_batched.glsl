@@ -0,0 +1,37 @@
+#version 440
+
+// Include our common vertex shader attributes and uniforms
+#include "../fragments/vs_common.glsl"
+#include "../fragments/batched_instances.glsl"
+
+// Our material data goes straight through to the fragment shader, skipping the 3 slots used by outTBN
+layout(location = 7) flat out ivec4 outLayers;
+layout(location = 8) flat out vec4  outParams;
+
+// Same as basic.glsl, but with our transforms coming from the instance buffer instead of the instance UBO
+void main() {
+	BatchedInstance instance = Instances[u_BaseInstance + gl_InstanceID];
+	mat3 normalMatrix = mat3(instance.NormalMatrix);
+
+	vec4 worldPos = instance.Model * vec4(inPosition, 1.0);
+	gl_Position = u_ViewProjection * worldPos;
+
+	// Pass vertex pos in view space to frag shader
+	outViewPos = (u_View * worldPos).xyz;
+
+	// Normals
+	outNormal = (u_View * vec4(normalMatrix * inNormal, 0)).xyz;
+
+    // We use a TBN matrix for tangent space normal mapping
+    vec3 T = normalize((u_View * vec4(normalMatrix * inTangent, 0)).xyz);
+    vec3 B = normalize((u_View * vec4(normalMatrix * inBiTangent, 0)).xyz);
+    vec3 N = normalize((u_View * vec4(normalMatrix * inNormal, 0)).xyz);
+    outTBN = mat3(T, B, N);
+
+	// Pass our UV coords to the fragment shader
+	outUV = inUV;
+	outColor = inColor;
+
+	outLayers = instance.Layers;
+	outParams = instance.Params;
+}
@@ -0,0 +1,41 @@
+#version 440
+
+#include "../fragments/frame_uniforms.glsl"
+#include "../fragments/impostor_common.glsl"
+
+layout(location = 0) out vec3 outViewPos;
+layout(location = 1) out vec2 outUV;
+layout(location = 2) flat out float outFade;
+// Takes normals from the baked frame's view space to our view space
+layout(location = 3) flat out mat3 outFrameToView;
+
+// Draws a quad facing the closest baked frame, the corners come from the vertex ID so there are no vertex buffers
+void main() {
+	ImpostorInstance instance = Impostors[u_BaseInstance + gl_InstanceID];
+	vec3  center = instance.Bounds.xyz;
+	float radius = instance.Bounds.w;
+
+	// Snap to the frame that was baked closest to our view direction
+	vec2 frame = clamp(floor(OctahedralEncode(normalize(instance.ViewDir.xyz)) * u_FramesPerSide), vec2(0), vec2(u_FramesPerSide - 1));
+	vec3 frameDir = OctahedralDecode((frame + 0.5) / u_FramesPerSide);
+	vec3 right, up;
+	GetFrameBasis(frameDir, right, up);
+
+	// Drawn as a triangle strip, so the corners go (-1, -1), (1, -1), (-1, 1), (1, 1)
+	vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1) * 2.0 - 1.0;
+	vec3 modelPos = center + (right * corner.x + up * corner.y) * radius;
+
+	mat4 modelView = u_View * instance.Model;
+	vec4 viewPos = modelView * vec4(modelPos, 1.0);
+	gl_Position = u_Projection * viewPos;
+	outViewPos = viewPos.xyz;
+
+	// Find where this corner of the frame is in the atlas
+	int slot = int(instance.Params.y + 0.5);
+	vec2 slotOrigin = vec2(slot % u_SlotsPerSide, slot / u_SlotsPerSide) * u_FramesPerSide;
+	outUV = (slotOrigin + frame + (corner * 0.5 + 0.5)) / (u_FramesPerSide * u_SlotsPerSide);
+
+	outFade = instance.Params.x;
+	mat3 modelViewRot = mat3(modelView);
+	outFrameToView = mat3(normalize(modelViewRot * right), normalize(modelViewRot * up), normalize(modelViewRot * frameDir));
+}
@@ -0,0 +1,40 @@
+#version 450
+
+#include "../fragments/particle_pool.glsl"
+
+// Either the sorted particle indices, or the current alive list
+layout (std430, binding = 7) buffer DrawListBuffer {
+    uint DrawList[];
+};
+uniform uint u_ListOffset;
+
+// Matches the inputs of particles_render_fs.glsl
+layout (location = 0) out vec4 outFragColor;
+layout (location = 1) out vec2 outUV;
+layout (location = 2) out flat uint outTexID;
+
+#include "../fragments/frame_uniforms.glsl"
+
+// Corners of a particle's quad along the camera's right and up vectors, as two triangles wound the
+// same way as the strip that particle_render_gs.glsl emits
+const vec2 CORNERS[6] = vec2[](
+    vec2(-1,  1), vec2(-1, -1), vec2( 1,  1),
+    vec2( 1,  1), vec2(-1, -1), vec2( 1, -1)
+);
+
+// Pulls six vertices per particle straight from the pool, instead of expanding points in a geometry shader
+void main() {
+    Particle p = Particles[DrawList[u_ListOffset + gl_VertexID / 6]];
+    vec2 corner = CORNERS[gl_VertexID % 6];
+
+    // Extract the right and up vectors from the view matrix
+    vec3 right = vec3(u_View[0][0], u_View[1][0], u_View[2][0]);
+    vec3 up    = vec3(u_View[0][1], u_View[1][1], u_View[2][1]);
+
+    vec3 position = p.PositionLife.xyz + (right * corner.x + up * corner.y) * p.Size / 2;
+
+    outFragColor = p.Color;
+    outUV        = corner * 0.5 + 0.5;
+    outTexID     = p.TexID;
+    gl_Position  = u_ViewProjection * vec4(position, 1);
+}
@@ -1,6 +1,8 @@
 #include "Application/Application.h"
 
+#ifdef _WIN32
 #include <Windows.h>
+#endif
 #include <GLFW/glfw3.h>
 #include <glad/glad.h>
 
@@ -8,10 +10,12 @@
 #include "Gameplay/InputEngine.h"
 #include "Application/Timing.h"
 #include <filesystem>
+#include <chrono>
 #include "Layers/GLAppLayer.h"
 #include "Utils/FileHelpers.h"
 #include "Utils/ResourceManager/ResourceManager.h"
 #include "Utils/ImGuiHelper.h"
+#include "Utils/JobSystem.h"
 
 // Graphics
 #include "Graphics/Buffers/IndexBuffer.h"
@@ -31,6 +35,7 @@
 // Gameplay
 #include "Gameplay/Material.h"
 #include "Gameplay/GameObject.h"
+#include "Gameplay/Prefab.h"
 #include "Gameplay/Scene.h"
 
 // Components
@@ -62,6 +67,7 @@
 #include "Layers/InstancedRenderingTestLayer.h"
 #include "Layers/ParticleLayer.h"
 #include "Layers/PostProcessingLayer.h"
+#include "Layers/BenchmarkLayer.h"
 
 Application* Application::_singleton = nullptr;
 std::string Application::_applicationName = "INFR-2350U - DEMO";
@@ -76,7 +82,10 @@ Application::Application() :
 	_isEditor(true),
 	_windowTitle("INFR - 2350U"),
 	_currentScene(nullptr),
-	_targetScene(nullptr)
+	_targetScene(nullptr),
+	_tickRate(-1.0f),
+	_maxTicksPerFrame(5),
+	_tickAccumulator(0.0f)
 { }
 
 Application::~Application() = default; 
@@ -89,6 +98,7 @@ Application& Application::Get() {
 void Application::Start(int argCount, char** arguments) {
 	LOG_ASSERT(_singleton == nullptr, "Application has already been started!");
 	_singleton = new Application();
+	_singleton->_ParseArguments(argCount, arguments);
 	_singleton->_Run();
 }
 
@@ -116,12 +126,7 @@ void Application::Quit() {
 
 bool Application::LoadScene(const std::string& path) {
 	if (std::filesystem::exists(path)) { 
-
-		std::string manifestPath = std::filesystem::path(path).stem().string() + "-manifest.json";
-		if (std::filesystem::exists(manifestPath)) {
-			LOG_INFO("Loading manifest from \"{}\"", manifestPath);
-			ResourceManager::LoadManifest(manifestPath);
-		}
+		_LoadSceneManifest(path);
 
 		Gameplay::Scene::Sptr scene = Gameplay::Scene::Load(path);
 		LoadScene(scene);
@@ -134,13 +139,22 @@ void Application::LoadScene(const Gameplay::Scene::Sptr& scene) {
 	_targetScene = scene;
 }
 
+void Application::_LoadSceneManifest(const std::string& scenePath) {
+	// JSON and binary scenes with the same name share a manifest
+	std::string manifestPath = std::filesystem::path(scenePath).stem().string() + "-manifest.json";
+	if (std::filesystem::exists(manifestPath)) {
+		LOG_INFO("Loading manifest from \"{}\"", manifestPath);
+		ResourceManager::LoadManifest(manifestPath);
+	}
+}
+
 void Application::SaveSettings()
 {
-	std::filesystem::path appdata = getenv("APPDATA");
-	std::filesystem::path settingsPath = appdata / _applicationName / "app-settings.json";
+	std::filesystem::path settingsDir = _GetSettingsDirectory();
+	std::filesystem::path settingsPath = settingsDir / "app-settings.json";
 
-	if (!std::filesystem::exists(appdata / _applicationName)) {
-		std::filesystem::create_directory(appdata / _applicationName);
+	if (!std::filesystem::exists(settingsDir)) {
+		std::filesystem::create_directories(settingsDir);
 	}
 
 	FileHelpers::WriteContentsToFile(settingsPath.string(), _appSettings.dump(1, '\t'));
@@ -161,7 +175,15 @@ void Application::_Run()
 		_layers.push_back(std::make_shared<ImGuiDebugLayer>());
 	}
 
-	_layers.push_back(std::make_shared<DefaultSceneLayer>());
+	// Only build the default scene if we haven't been asked to load one from disk
+	if (BenchmarkState.ScenePath.empty()) {
+		_layers.push_back(std::make_shared<DefaultSceneLayer>());
+	}
+
+	// The benchmark layer goes last so that it sees the final output of every other layer
+	if (BenchmarkState.IsHeadless) {
+		_layers.push_back(std::make_shared<BenchmarkLayer>());
+	}
 
 	// Either load the settings, or use the defaults
 	_ConfigureSettings();
@@ -170,6 +192,21 @@ void Application::_Run()
 	_windowSize.x = JsonGet(_appSettings, "window_width", DEFAULT_WINDOW_WIDTH);
 	_windowSize.y = JsonGet(_appSettings, "window_height", DEFAULT_WINDOW_HEIGHT);
 
+	// A tick rate given on the command line wins over the one in the settings
+	if (_tickRate < 0.0f) {
+		_tickRate = JsonGet(_appSettings, "tick_rate", 0.0f);
+	}
+	_maxTicksPerFrame = std::max(1, JsonGet(_appSettings, "max_ticks_per_frame", _maxTicksPerFrame));
+	Timing::_singleton._isFixedTimestep = _tickRate > 0.0f;
+	if (_tickRate > 0.0f) {
+		Timing::_singleton._fixedDeltaTime = 1.0f / _tickRate;
+	}
+
+	// Headless runs always use the requested resolution so that results are comparable between machines
+	if (BenchmarkState.IsHeadless) {
+		_windowSize = BenchmarkState.Resolution;
+	}
+
 	// By default, we want our viewport to be the whole screen
 	_primaryViewport = { 0, 0, _windowSize.x, _windowSize.y };
 
@@ -181,11 +218,36 @@ void Application::_Run()
 	_Load();
 
 	// Grab current time as the previous frame
-	double lastFrame =  glfwGetTime();
+	double lastFrame = _GetTime();
 
 	// Done loading, app is now running!
 	_isRunning = true;
 
+	// Converting a scene needs the resources it references, but nothing else, so we're done as soon as it's written
+	if (!BenchmarkState.ConvertScenePath.empty()) {
+		const std::string& path = BenchmarkState.ConvertScenePath;
+		_LoadSceneManifest(path);
+		bool converted = false;
+		if (BenchmarkState.SectorSize > 0.0f) {
+			Gameplay::Scene::Sptr scene = Gameplay::Scene::Load(path);
+			converted = scene != nullptr &&
+				scene->ExportSectors(std::filesystem::path(path).replace_extension(".bin").string(), BenchmarkState.SectorSize);
+		} else {
+			converted = Gameplay::Scene::ConvertToBinary(path);
+		}
+		if (!converted) {
+			LOG_ERROR("Failed to convert scene \"{}\"", path);
+		}
+		_isRunning = false;
+	}
+	// If a scene was given on the command line, load it in place of the default scene
+	else if (!BenchmarkState.ScenePath.empty()) {
+		if (!LoadScene(BenchmarkState.ScenePath)) {
+			LOG_ERROR("Failed to load scene from \"{}\"", BenchmarkState.ScenePath);
+			_isRunning = false;
+		}
+	}
+
 	// Infinite loop as long as the application is running
 	while (_isRunning) {
 		// Handle scene switching
@@ -193,20 +255,30 @@ void Application::_Run()
 			_HandleSceneChange();
 		}
 
+		// Run any OpenGL work that background jobs have handed back to us (ex: uploading loaded resources)
+		JobSystem::PumpMainThread();
+
 		// Receive events like input and window position/size changes from GLFW
-		glfwPollEvents();
+		// Headless runs have no window to poll, and quit on their own
+		if (!BenchmarkState.IsHeadless) {
+			glfwPollEvents();
 
-		// Handle closing the app via the close button
-		if (glfwWindowShouldClose(_window)) {
-			_isRunning = false;
+			// Handle closing the app via the close button
+			if (glfwWindowShouldClose(_window)) {
+				_isRunning = false;
+			}
 		}
 
 		// Grab the timing singleton instance as a reference
 		Timing& timing = Timing::_singleton;
 
 		// Figure out the current time, and the time since the last frame
-		double thisFrame = glfwGetTime();
+		double thisFrame = _GetTime();
 		float dt = static_cast<float>(thisFrame - lastFrame);
+		// Benchmarks step with a fixed delta so that captures are the same between runs
+		if (BenchmarkState.IsHeadless && BenchmarkState.FixedDeltaTime > 0.0f) {
+			dt = BenchmarkState.FixedDeltaTime;
+		}
 		float scaledDt = dt * timing._timeScale;
 
 		// Update all timing values
@@ -217,12 +289,19 @@ void Application::_Run()
 		timing._timeSinceSceneLoad += scaledDt;
 		timing._unscaledTimeSinceSceneLoad += dt;
 
-		ImGuiHelper::StartFrame();
+		if (!BenchmarkState.IsHeadless) {
+			ImGuiHelper::StartFrame();
+		}
 
 		// Core update loop
 		if (_currentScene != nullptr) {
+			_Simulate(scaledDt);
 			_Update();
 			_LateUpdate();
+			// Blend what we render between the last two ticks, once anything that moves objects every frame has had its turn
+			if (timing._isFixedTimestep) {
+				_currentScene->InterpolateTransforms(timing._tickAlpha);
+			}
 			_PreRender();
 			_RenderScene(); 
 			_PostRender();
@@ -231,10 +310,12 @@ void Application::_Run()
 		// Store timing for next loop
 		lastFrame = thisFrame;
 
-		InputEngine::EndFrame();
-		ImGuiHelper::EndFrame();
+		if (!BenchmarkState.IsHeadless) {
+			InputEngine::EndFrame();
+			ImGuiHelper::EndFrame();
 
-		glfwSwapBuffers(_window);
+			glfwSwapBuffers(_window);
+		}
 
 	}
 
@@ -242,6 +323,80 @@ void Application::_Run()
 	_Unload();
 }
 
+void Application::_ParseArguments(int argCount, char** arguments)
+{
+	// Skip the first argument, it's the path to the executable
+	for (int ix = 1; ix < argCount; ix++) {
+		std::string arg = arguments[ix];
+		// Most of our flags take a value, so grab the next argument if there is one
+		const char* value = (ix + 1 < argCount) ? arguments[ix + 1] : nullptr;
+
+		if (arg == "--headless") {
+			BenchmarkState.IsHeadless = true;
+			// There's no one to use the editor when headless, so scenes play right away
+			_isEditor = false;
+			EditorState.IsEditor = false;
+		}
+		else if (value == nullptr) {
+			LOG_WARN("Ignoring argument \"{}\", it is unknown or missing a value", arg);
+		}
+		else if (arg == "--scene") {
+			BenchmarkState.ScenePath = value; ix++;
+		}
+		else if (arg == "--frames") {
+			BenchmarkState.FrameCount = std::max(1, std::atoi(value)); ix++;
+		}
+		else if (arg == "--warmup") {
+			BenchmarkState.WarmupFrames = std::max(0, std::atoi(value)); ix++;
+		}
+		else if (arg == "--width") {
+			BenchmarkState.Resolution.x = std::max(1, std::atoi(value)); ix++;
+		}
+		else if (arg == "--height") {
+			BenchmarkState.Resolution.y = std::max(1, std::atoi(value)); ix++;
+		}
+		else if (arg == "--dt") {
+			BenchmarkState.FixedDeltaTime = static_cast<float>(std::atof(value)); ix++;
+		}
+		else if (arg == "--capture") {
+			BenchmarkState.CaptureDir = value; ix++;
+		}
+		else if (arg == "--capture-every") {
+			BenchmarkState.CaptureInterval = std::max(0, std::atoi(value)); ix++;
+		}
+		else if (arg == "--timings") {
+			BenchmarkState.TimingsPath = value; ix++;
+		}
+		else if (arg == "--bench-components") {
+			BenchmarkState.ComponentBenchmarkCount = std::max(0, std::atoi(value)); ix++;
+		}
+		else if (arg == "--bench-spawn") {
+			BenchmarkState.SpawnBenchmarkCount = std::max(0, std::atoi(value)); ix++;
+		}
+		else if (arg == "--bench-scene-load") {
+			BenchmarkState.SceneLoadBenchmarkCount = std::max(0, std::atoi(value)); ix++;
+		}
+		else if (arg == "--bench-prefab") {
+			BenchmarkState.PrefabBenchmarkCount = std::max(0, std::atoi(value)); ix++;
+		}
+		else if (arg == "--bench-particles") {
+			BenchmarkState.ParticleBenchmarkCount = std::max(0, std::atoi(value)); ix++;
+		}
+		else if (arg == "--convert-scene") {
+			BenchmarkState.ConvertScenePath = value; ix++;
+		}
+		else if (arg == "--sector-size") {
+			BenchmarkState.SectorSize = std::max(0.0f, static_cast<float>(std::atof(value))); ix++;
+		}
+		else if (arg == "--tick-rate") {
+			_tickRate = std::max(0.0f, static_cast<float>(std::atof(value))); ix++;
+		}
+		else {
+			LOG_WARN("Ignoring unknown argument \"{}\"", arg);
+		}
+	}
+}
+
 void Application::_RegisterClasses()
 {
 	using namespace Gameplay;
@@ -259,6 +414,7 @@ void Application::_RegisterClasses()
 	ResourceManager::RegisterType<ShaderProgram>();
 	ResourceManager::RegisterType<Material>();
 	ResourceManager::RegisterType<MeshResource>();
+	ResourceManager::RegisterType<Prefab>();
 	ResourceManager::RegisterType<Font>();
 	ResourceManager::RegisterType<Framebuffer>();
 
@@ -282,17 +438,23 @@ void Application::_RegisterClasses()
 }
 
 void Application::_Load() {
+	// Start our worker threads before any layers have a chance to submit jobs
+	JobSystem::Init();
+
 	for (const auto& layer : _layers) {
 		if (layer->Enabled && *(layer->Overrides & AppLayerFunctions::OnAppLoad)) {
 			layer->OnAppLoad(_appSettings);
 		}
 	}
 
-	// Pass the window to the input engine and let it initialize itself
-	InputEngine::Init(_window);
-	
-	// Initialize our ImGui helper
-	ImGuiHelper::Init(_window);
+	// Input and ImGui both need a window, so we skip them when running headless
+	if (!BenchmarkState.IsHeadless) {
+		// Pass the window to the input engine and let it initialize itself
+		InputEngine::Init(_window);
+
+		// Initialize our ImGui helper
+		ImGuiHelper::Init(_window);
+	}
 
 	GuiBatcher::SetWindowSize(_windowSize);
 }
@@ -305,64 +467,131 @@ bool projectileMovingRight = false;
 bool yOverlap = false;
 bool zOverlap = false;
 
-void Application::_Update() {
+// The objects the game logic below works with, looked up once per scene rather than by name every time they're used
+const Gameplay::Scene* gameScene = nullptr;
+Gameplay::GameObject::WeakRef projectileRef;
+Gameplay::GameObject::WeakRef mainCharacterRef;
+Gameplay::GameObject::WeakRef enemyRef;
+
+void Application::_Simulate(float dt) {
+	Timing& timing = Timing::_singleton;
+	if (!timing._isFixedTimestep) {
+		InputEngine::BeginTick();
+		_FixedUpdate();
+		InputEngine::EndTick();
+		return;
+	}
+
+	// Ticks see the tick length as their delta time, everything after them sees the frame time again
+	float frameDeltaTime = timing._deltaTime;
+	timing._deltaTime = timing._fixedDeltaTime;
+
+	_tickAccumulator += dt;
+	int ticks = 0;
+	while (_tickAccumulator >= timing._fixedDeltaTime) {
+		// When ticks take longer than the time they simulate, catching up only makes the next frame longer still.
+		// Once we've run as many ticks as we're allowed, we drop any whole ticks we're still behind by
+		if (ticks == _maxTicksPerFrame) {
+			_tickAccumulator = std::fmod(_tickAccumulator, timing._fixedDeltaTime);
+			break;
+		}
+
+		// Presses and releases stay latched until a tick has seen them, so they are never dropped by a frame
+		// that runs no ticks, or repeated by one that runs several
+		_currentScene->SaveTransformState();
+		InputEngine::BeginTick();
+		_FixedUpdate();
+		InputEngine::EndTick();
+		_tickAccumulator -= timing._fixedDeltaTime;
+		ticks++;
+	}
+
+	timing._deltaTime = frameDeltaTime;
+	timing._tickAlpha = _tickAccumulator / timing._fixedDeltaTime;
+}
+
+void Application::_FixedUpdate() {
 	for (const auto& layer : _layers) {
-		if (layer->Enabled && *(layer->Overrides & AppLayerFunctions::OnUpdate)) {
-			layer->OnUpdate();
+		if (layer->Enabled && *(layer->Overrides & AppLayerFunctions::OnFixedUpdate)) {
+			layer->OnFixedUpdate();
 		}
 	}
 
 	//Game Loop
 	Application& app = Application::Get();
 
+	// Look the objects up again if the scene changed, or if one of them was destroyed (it may have been replaced)
+	if (gameScene != app.CurrentScene().get() || !projectileRef.IsAlive() || !mainCharacterRef.IsAlive() || !enemyRef.IsAlive()) {
+		gameScene = app.CurrentScene().get();
+		projectileRef    = gameScene->FindObjectRefByName("Projectile");
+		mainCharacterRef = gameScene->FindObjectRefByName("Main Character");
+		enemyRef         = gameScene->FindObjectRefByName("Enemy");
+	}
+	Gameplay::GameObject::Sptr projectile    = projectileRef;
+	Gameplay::GameObject::Sptr mainCharacter = mainCharacterRef;
+	Gameplay::GameObject::Sptr enemy         = enemyRef;
+
+	// The game logic below only applies to the default scene, so skip it for scenes loaded from the command line
+	if (projectile == nullptr || mainCharacter == nullptr || enemy == nullptr) {
+		return;
+	}
+
 	if ((InputEngine::GetKeyState(GLFW_KEY_LEFT) == ButtonState::Down)|| projectileMovingLeft == true) {
-		app.CurrentScene()->FindObjectByName("Projectile")->SetPostion(glm::vec3(0, tempypos, tempzpos));
+		projectile->SetPostion(glm::vec3(0, tempypos, tempzpos));
 		tempypos = tempypos + 0.3;
 		projectileMovingLeft = true;
 	}
 	else if ((InputEngine::GetKeyState(GLFW_KEY_RIGHT) == ButtonState::Down) || projectileMovingRight == true) {
-		app.CurrentScene()->FindObjectByName("Projectile")->SetPostion(glm::vec3(0, tempypos, tempzpos));
+		projectile->SetPostion(glm::vec3(0, tempypos, tempzpos));
 		tempypos = tempypos - 0.3;
 		projectileMovingRight = true;
 	}
 	else {
-		tempzpos = app.CurrentScene()->FindObjectByName("Main Character")->GetPosition().z;
-		tempypos = app.CurrentScene()->FindObjectByName("Main Character")->GetPosition().y;
-		app.CurrentScene()->FindObjectByName("Projectile")->SetPostion(glm::vec3(app.CurrentScene()->FindObjectByName("Main Character")->GetPosition().x, tempypos, tempzpos));
+		tempzpos = mainCharacter->GetPosition().z;
+		tempypos = mainCharacter->GetPosition().y;
+		projectile->SetPostion(glm::vec3(mainCharacter->GetPosition().x, tempypos, tempzpos));
 	}
 
 	//resets projectile if it goes too far
-	if (app.CurrentScene()->FindObjectByName("Projectile")->GetPosition().y < -30 || app.CurrentScene()->FindObjectByName("Projectile")->GetPosition().y > 30) {
+	if (projectile->GetPosition().y < -30 || projectile->GetPosition().y > 30) {
 		projectileMovingLeft = false;
 		projectileMovingRight = false;
 	}
 
 	//collisions
 	//yoverlap (left and right)
-	yOverlap = (app.CurrentScene()->FindObjectByName("Enemy")->GetPosition().y < (app.CurrentScene()->FindObjectByName("Projectile")->GetPosition().y + 1) && app.CurrentScene()->FindObjectByName("Enemy")->GetPosition().y >= (app.CurrentScene()->FindObjectByName("Projectile")->GetPosition().y - 1));
+	yOverlap = (enemy->GetPosition().y < (projectile->GetPosition().y + 1) && enemy->GetPosition().y >= (projectile->GetPosition().y - 1));
 	//zoverlap (up and down)
-	zOverlap = (app.CurrentScene()->FindObjectByName("Enemy")->GetPosition().z < (app.CurrentScene()->FindObjectByName("Projectile")->GetPosition().z + 1) && app.CurrentScene()->FindObjectByName("Enemy")->GetPosition().z >= (app.CurrentScene()->FindObjectByName("Projectile")->GetPosition().z - 1));
+	zOverlap = (enemy->GetPosition().z < (projectile->GetPosition().z + 1) && enemy->GetPosition().z >= (projectile->GetPosition().z - 1));
 
 	std::cout << "Y overlap " << yOverlap << "\n";
 	std::cout << "Z overlap " << zOverlap << "\n";
 
 	if (yOverlap && zOverlap) {
-		//app.CurrentScene()->FindObjectByName("Enemy")->SetPostion(glm::vec3(2000,2000,2000));
+		//enemy->SetPostion(glm::vec3(2000,2000,2000));
 		std::cout << "winner";
-		app.CurrentScene()->FindObjectByName("Main Character")->Get<JumpBehaviour>()->win = true;
-		app.CurrentScene()->FindObjectByName("Main Character")->GetParent()->GetChildren()[4]->Get<GuiPanel>()->IsEnabled = true;
+		mainCharacter->Get<JumpBehaviour>()->win = true;
+		mainCharacter->GetParent()->GetChildren()[4]->Get<GuiPanel>()->IsEnabled = true;
 	}
 
 	if (InputEngine::GetKeyState(GLFW_KEY_P) == ButtonState::Down) {
-		//app.CurrentScene()->FindObjectByName("Enemy")->SetPostion(glm::vec3(2000,2000,2000));
+		//enemy->SetPostion(glm::vec3(2000,2000,2000));
 		std::cout << "winner";
-		app.CurrentScene()->FindObjectByName("Main Character")->Get<JumpBehaviour>()->win = false;
-		app.CurrentScene()->FindObjectByName("Main Character")->GetParent()->GetChildren()[4]->Get<GuiPanel>()->IsEnabled = false;
-		app.CurrentScene()->FindObjectByName("Main Character")->GetParent()->GetChildren()[5]->Get<GuiPanel>()->IsEnabled = false;
+		mainCharacter->Get<JumpBehaviour>()->win = false;
+		mainCharacter->GetParent()->GetChildren()[4]->Get<GuiPanel>()->IsEnabled = false;
+		mainCharacter->GetParent()->GetChildren()[5]->Get<GuiPanel>()->IsEnabled = false;
 	}
 
 	//keeps the enemy at the same z coordinate
-	app.CurrentScene()->FindObjectByName("Enemy")->SetPostion(glm::vec3(0, app.CurrentScene()->FindObjectByName("Enemy")->GetPosition().y, app.CurrentScene()->FindObjectByName("Enemy")->GetPosition().z));
+	enemy->SetPostion(glm::vec3(0, enemy->GetPosition().y, enemy->GetPosition().z));
+}
+
+void Application::_Update() {
+	for (const auto& layer : _layers) {
+		if (layer->Enabled && *(layer->Overrides & AppLayerFunctions::OnUpdate)) {
+			layer->OnUpdate();
+		}
+	}
 }
 
 void Application::_LateUpdate() {
@@ -375,8 +604,10 @@ void Application::_LateUpdate() {
 
 void Application::_PreRender()
 {
-	glm::ivec2 size ={ 0, 0 };
-	glfwGetWindowSize(_window, &size.x, &size.y);
+	glm::ivec2 size = _windowSize;
+	if (_window != nullptr) {
+		glfwGetWindowSize(_window, &size.x, &size.y);
+	}
 	glViewport(0, 0, size.x, size.y);
 	glScissor(0, 0, size.x, size.y);
 
@@ -419,8 +650,12 @@ void Application::_Unload() {
 		}
 	}
 
-	// Clean up ImGui
-	ImGuiHelper::Cleanup();
+	// Clean up ImGui, which was never started if we're headless
+	if (!BenchmarkState.IsHeadless) {
+		ImGuiHelper::Cleanup();
+	}
+
+	JobSystem::Shutdown();
 }
 
 void Application::_HandleSceneChange() {
@@ -470,8 +705,7 @@ void Application::_ConfigureSettings() {
 	_appSettings = _GetDefaultAppSettings();
 
 	// We'll store our settings in the %APPDATA% directory, under our application name
-	std::filesystem::path appdata = getenv("APPDATA");
-	std::filesystem::path settingsPath = appdata / _applicationName / "app-settings.json";
+	std::filesystem::path settingsPath = _GetSettingsDirectory() / "app-settings.json";
 
 	// If the settings file exists, we can load it in!
 	if (std::filesystem::exists(settingsPath)) {
@@ -504,6 +738,34 @@ nlohmann::json Application::_GetDefaultAppSettings()
 
 	result["window_width"]  = DEFAULT_WINDOW_WIDTH;
 	result["window_height"] = DEFAULT_WINDOW_HEIGHT;
+	// Simulation ticks per second, 0 to simulate once per frame
+	result["tick_rate"] = 0;
+	result["max_ticks_per_frame"] = 5;
 	return result;
 }
 
+std::filesystem::path Application::_GetSettingsDirectory() const
+{
+	// Windows has %APPDATA%, other platforms follow the XDG convention, and if all else fails
+	// we use the working directory
+	if (const char* appdata = getenv("APPDATA")) {
+		return std::filesystem::path(appdata) / _applicationName;
+	}
+	else if (const char* xdgConfig = getenv("XDG_CONFIG_HOME")) {
+		return std::filesystem::path(xdgConfig) / _applicationName;
+	}
+	else if (const char* home = getenv("HOME")) {
+		return std::filesystem::path(home) / ".config" / _applicationName;
+	}
+	return std::filesystem::current_path() / _applicationName;
+}
+
+double Application::_GetTime() const
+{
+	// GLFW isn't initialized when we're running headless, so we use the standard clock instead
+	if (BenchmarkState.IsHeadless) {
+		static const auto startTime = std::chrono::steady_clock::now();
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+	}
+	return glfwGetTime();
+}
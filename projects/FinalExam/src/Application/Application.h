@@ -1,5 +1,6 @@
 #pragma once
 #include <string>
+#include <filesystem>
 #include <GLM/glm.hpp>
 #include <json.hpp>
 #include "Utils/Macros.h"
@@ -27,6 +28,43 @@ public:
 		Gameplay::GameObject::Wptr SelectedObject;
 	} EditorState;
 
+	// Settings for running without a window, used for automated benchmarks and image regression checks
+	// See Application::_ParseArguments for the command line flags that fill this in
+	struct {
+		// True to create an offscreen GL context instead of a window
+		bool        IsHeadless = false;
+		// Optional path to a scene file to load instead of the default scene
+		std::string ScenePath = "";
+		// The number of frames to record before quitting
+		int         FrameCount = 300;
+		// The number of frames to render before we start recording timings
+		int         WarmupFrames = 10;
+		// The resolution to render at when running headless
+		glm::ivec2  Resolution = { 1280, 720 };
+		// When > 0, overrides the measured delta time so that captured frames are reproducible
+		float       FixedDeltaTime = 1.0f / 60.0f;
+		// The directory to write PNG captures to, leave empty to disable captures
+		std::string CaptureDir = "";
+		// Capture every Nth recorded frame (0 captures only the last frame)
+		int         CaptureInterval = 0;
+		// The path of the CSV file that per-frame timings will be written to
+		std::string TimingsPath = "benchmark.csv";
+		// When > 0, times iterating this many render components before the scene runs (see BenchmarkLayer)
+		int         ComponentBenchmarkCount = 0;
+		// When > 0, times creating and then removing this many objects before the scene runs (see BenchmarkLayer)
+		int         SpawnBenchmarkCount = 0;
+		// When > 0, times loading a scene with this many objects from JSON and from binary (see BenchmarkLayer)
+		int         SceneLoadBenchmarkCount = 0;
+		// When > 0, times spawning this many copies of a prefab, compared to building them in code (see BenchmarkLayer)
+		int         PrefabBenchmarkCount = 0;
+		// When > 0, times simulating this many particles on each particle backend (see BenchmarkLayer)
+		int         ParticleBenchmarkCount = 0;
+		// Optional path to a JSON scene to convert to a binary scene, the application quits once it's converted
+		std::string ConvertScenePath = "";
+		// When > 0, the converted scene is split into sectors of this size (see Scene::ExportSectors)
+		float       SectorSize = 0.0f;
+	} BenchmarkState;
+
 	static Application& Get();
 	/**
 	 * Called by the entry point to begin the application, creating the singleton 
@@ -35,7 +73,7 @@ public:
 	static void Start(int argCount, char** arguments);
 
 	/**
-	 * Gets the GLFW window for the application
+	 * Gets the GLFW window for the application, will be nullptr when running headless
 	 */
 	GLFWwindow* GetWindow();
 
@@ -137,12 +175,23 @@ protected:
 	// The scene to switch to at the start of the next frame
 	Gameplay::Scene::Sptr _targetScene;
 
+	// The number of simulation ticks per second, or 0 to simulate once per frame with a variable delta time.
+	// Negative until it's been read from the settings, unless it was given on the command line
+	float       _tickRate;
+	// The most ticks to run in one frame, if we fall further behind than this the extra time is dropped
+	int         _maxTicksPerFrame;
+	// Time that has passed but has not been simulated yet, when running at a fixed tick rate
+	float       _tickAccumulator;
+
 	// Stores all the layers of the application, in the order they should be invoked
 	std::vector<ApplicationLayer::Sptr> _layers;
 
 	void _Run();
+	void _ParseArguments(int argCount, char** arguments);
 	void _RegisterClasses();
 	void _Load();
+	void _Simulate(float dt);
+	void _FixedUpdate();
 	void _Update();
 	void _LateUpdate();
 	void _PreRender();
@@ -150,9 +199,12 @@ protected:
 	void _PostRender();
 	void _Unload();
 	void _HandleSceneChange();
+	void _LoadSceneManifest(const std::string& scenePath);
 	void _HandleWindowSizeChanged(const glm::ivec2& newSize);
 	void _ConfigureSettings();
 	nlohmann::json _GetDefaultAppSettings();
+	std::filesystem::path _GetSettingsDirectory() const;
+	double _GetTime() const;
 
 	static Application* _singleton;
 	static std::string  _applicationName;
@@ -24,6 +24,7 @@ ENUM_FLAGS(AppLayerFunctions, uint32_t,
 	OnRender       = 1 << 7,
     OnPostRender   = 1 << 8,
 	OnWindowResize = 1 << 9,
+	OnFixedUpdate  = 1 << 10,
 
 	All = 0xFFFFFFFF
 )
@@ -74,6 +75,12 @@ public:
 	 */
 	virtual void OnSceneUnload() {};
 
+	/**
+	 * Invoked for every simulation tick. With a fixed tick rate this may run any number of times
+	 * per frame, each time with the tick length as the delta time, otherwise it runs once per
+	 * frame just before OnUpdate (see Timing class)
+	 */
+	virtual void OnFixedUpdate() {};
 	/**
 	 * Invoked when the application updates, at varying time steps (see Timing class)
 	 */
@@ -0,0 +1,559 @@
+#include "BenchmarkLayer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <sstream>
+
+#include "Logging.h"
+#include "Application/Application.h"
+#include "Utils/FileHelpers.h"
+#include "RenderLayer.h"
+#include "PostProcessingLayer.h"
+#include "Gameplay/Components/ComponentManager.h"
+#include "Gameplay/Components/RenderComponent.h"
+#include "Gameplay/Components/RotatingBehaviour.h"
+#include "Gameplay/Components/JumpBehaviour.h"
+#include "Gameplay/Components/ParticleSystem.h"
+#include "Gameplay/Prefab.h"
+#include "Gameplay/Scene.h"
+#include "Gameplay/Physics/RigidBody.h"
+#include "Gameplay/Physics/Colliders/SphereCollider.h"
+
+BenchmarkLayer::BenchmarkLayer() :
+	ApplicationLayer(),
+	_capture(nullptr),
+	_hasDefaultFramebuffer(false),
+	_frameIndex(0),
+	_lastFrameEnd(0.0),
+	_isRunning(false),
+	_timings(std::vector<FrameTiming>())
+{
+	Name = "Benchmark";
+	Overrides =
+		AppLayerFunctions::OnAppLoad | AppLayerFunctions::OnAppUnload |
+		AppLayerFunctions::OnSceneLoad | AppLayerFunctions::OnUpdate |
+		AppLayerFunctions::OnPostRender;
+
+	memset(_queries, 0, sizeof(_queries));
+	for (int ix = 0; ix < QUERY_RING_SIZE; ix++) {
+		_querySlotFrame[ix] = -1;
+	}
+}
+
+BenchmarkLayer::~BenchmarkLayer() = default;
+
+void BenchmarkLayer::OnAppLoad(const nlohmann::json& config)
+{
+	Application& app = Application::Get();
+
+	// Surfaceless contexts have no default framebuffer, in which case we capture the post processing output instead
+	_hasDefaultFramebuffer = glCheckNamedFramebufferStatus(0, GL_READ_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+	if (!_hasDefaultFramebuffer) {
+		LOG_WARN("No default framebuffer available, captures will not include the interface layer");
+
+		// Keep the post processing result offscreen so that we can read it back
+		PostProcessingLayer::Sptr postProcessing = app.GetLayer<PostProcessingLayer>();
+		if (postProcessing != nullptr) {
+			postProcessing->PresentToScreen = false;
+		}
+	}
+
+	// We use timestamps instead of GL_TIME_ELAPSED so that we can't conflict with queries in other systems
+	glCreateQueries(GL_TIMESTAMP, QUERY_RING_SIZE * 2, &_queries[0][0]);
+
+	const std::string& captureDir = app.BenchmarkState.CaptureDir;
+	if (!captureDir.empty()) {
+		_capture = std::make_shared<FrameCapture>();
+		_capture->Start(captureDir);
+	}
+
+	LOG_INFO("Benchmark: {} frames ({} warmup) at {}x{}",
+		app.BenchmarkState.FrameCount, app.BenchmarkState.WarmupFrames, app.GetWindowSize().x, app.GetWindowSize().y);
+
+	if (app.BenchmarkState.ComponentBenchmarkCount > 0) {
+		_RunComponentBenchmark(app.BenchmarkState.ComponentBenchmarkCount);
+	}
+	if (app.BenchmarkState.SpawnBenchmarkCount > 0) {
+		_RunSpawnBenchmark(app.BenchmarkState.SpawnBenchmarkCount);
+	}
+	if (app.BenchmarkState.SceneLoadBenchmarkCount > 0) {
+		_RunSceneLoadBenchmark(app.BenchmarkState.SceneLoadBenchmarkCount);
+	}
+	if (app.BenchmarkState.PrefabBenchmarkCount > 0) {
+		_RunPrefabBenchmark(app.BenchmarkState.PrefabBenchmarkCount);
+	}
+	if (app.BenchmarkState.ParticleBenchmarkCount > 0) {
+		_RunParticleBenchmark(app.BenchmarkState.ParticleBenchmarkCount);
+	}
+}
+
+void BenchmarkLayer::OnAppUnload()
+{
+	glDeleteQueries(QUERY_RING_SIZE * 2, &_queries[0][0]);
+	_capture = nullptr;
+}
+
+void BenchmarkLayer::OnSceneLoad()
+{
+	// We start counting from when the scene is loaded, so scene loading does not skew our first frame
+	_isRunning = true;
+	_frameIndex = 0;
+	_timings.clear();
+	// Any queries still in flight were measuring frames of the last scene, which we just threw away
+	for (int ix = 0; ix < QUERY_RING_SIZE; ix++) {
+		_querySlotFrame[ix] = -1;
+	}
+	_lastFrameEnd = _GetTime();
+}
+
+void BenchmarkLayer::OnUpdate()
+{
+	if (!_isRunning) return;
+
+	Application& app = Application::Get();
+	int recorded = _frameIndex - app.BenchmarkState.WarmupFrames;
+
+	// Warmup frames are not recorded
+	if (recorded >= 0) {
+		int slot = recorded % QUERY_RING_SIZE;
+
+		// Read back whichever frame was using this slot before we reuse it, it's a few frames old so it
+		// should already be done on the GPU
+		_ResolveQuerySlot(slot);
+
+		glQueryCounter(_queries[slot][0], GL_TIMESTAMP);
+		_querySlotFrame[slot] = recorded;
+		_timings.push_back({ recorded, 0.0, -1.0 });
+	}
+}
+
+void BenchmarkLayer::OnPostRender()
+{
+	if (!_isRunning) return;
+
+	Application& app = Application::Get();
+	int recorded = _frameIndex - app.BenchmarkState.WarmupFrames;
+
+	if (recorded >= 0) {
+		int slot = recorded % QUERY_RING_SIZE;
+		glQueryCounter(_queries[slot][1], GL_TIMESTAMP);
+
+		// CPU time is the full time between frames, including update and render submission
+		_timings[recorded].CpuMs = (_GetTime() - _lastFrameEnd) * 1000.0;
+
+		bool isLastFrame = recorded == app.BenchmarkState.FrameCount - 1;
+		int  interval    = app.BenchmarkState.CaptureInterval;
+
+		if (_capture != nullptr) {
+			if ((interval > 0 && recorded % interval == 0) || (interval == 0 && isLastFrame)) {
+				_CaptureFrame(recorded);
+			}
+			_capture->Poll();
+		}
+
+		if (isLastFrame) {
+			// Wait on all our outstanding queries and dump the results
+			for (int ix = 0; ix < QUERY_RING_SIZE; ix++) {
+				_ResolveQuerySlot(ix);
+			}
+			_WriteResults();
+
+			// Flush any captures that are still in flight, we're done timing so it's fine to wait
+			if (_capture != nullptr) {
+				_capture->Stop();
+			}
+
+			_isRunning = false;
+			app.Quit();
+		}
+	}
+
+	_frameIndex++;
+
+	// Grab the time after captures, so that queueing readbacks doesn't count towards the next frame
+	_lastFrameEnd = _GetTime();
+}
+
+BenchmarkLayer::StageTimer::StageTimer(int passes, const char* unit) :
+	_passes(passes),
+	_unit(unit),
+	_totalMs(std::unordered_map<std::string, double>())
+{ }
+
+void BenchmarkLayer::StageTimer::Log(const std::string& stage, const std::string& detail) const
+{
+	auto it = _totalMs.find(stage);
+	double totalMs = it != _totalMs.end() ? it->second : 0.0;
+	LOG_INFO("  {:<28} {:.3f} ms per {}{}", stage, totalMs / _passes, _unit, detail);
+}
+
+void BenchmarkLayer::_RunComponentBenchmark(int count)
+{
+	using namespace Gameplay;
+
+	const int passes = 20;
+
+	// Use our own manager, so that the test components never show up in the scene. The components
+	// have to be destroyed before the manager, so they're declared after it
+	ComponentManager manager;
+	std::vector<RenderComponent::Sptr> components;
+	components.reserve(count);
+	for (int ix = 0; ix < count; ix++) {
+		components.push_back(manager.Create<RenderComponent>());
+		// Keep some disabled, so that every path has to check IsEnabled
+		components.back()->IsEnabled = (ix % 8) != 0;
+	}
+
+	// Each pass touches the component the same way the render layer's gather does, and the sum keeps
+	// the compiler from throwing the loops away. The first pass is untimed, so every path starts warm
+	StageTimer timer(passes);
+	auto time = [&](const char* label, const std::function<size_t()>& pass) {
+		size_t visited = pass();
+		for (int ix = 0; ix < passes; ix++) {
+			timer.Time(label, [&]() { visited += pass(); });
+		}
+		timer.Log(label, " (" + std::to_string(visited / (passes + 1)) + " visited)");
+	};
+
+	LOG_INFO("Iterating {} render components:", count);
+
+	// What ComponentManager::Each used to do, a weak pointer per component that had to be locked,
+	// then dynamic cast and passed through a std::function
+	std::vector<std::weak_ptr<IComponent>> weakPool(components.begin(), components.end());
+	time("weak_ptr pool (before)", [&]() {
+		size_t visited = 0;
+		std::function<void(const RenderComponent::Sptr&)> callback = [&](const RenderComponent::Sptr& renderable) {
+			visited += renderable->GetMesh() == nullptr;
+		};
+		for (auto& wptr : weakPool) {
+			std::shared_ptr<IComponent> sptr = wptr.lock();
+			if (sptr && sptr->IsEnabled) {
+				callback(std::dynamic_pointer_cast<RenderComponent>(sptr));
+			}
+		}
+		return visited;
+	});
+	time("Each, shared_ptr callback", [&]() {
+		size_t visited = 0;
+		manager.Each<RenderComponent>([&](const RenderComponent::Sptr& renderable) {
+			visited += renderable->GetMesh() == nullptr;
+		});
+		return visited;
+	});
+	time("Each, reference callback", [&]() {
+		size_t visited = 0;
+		manager.Each<RenderComponent>([&](RenderComponent& renderable) {
+			visited += renderable.GetMesh() == nullptr;
+		});
+		return visited;
+	});
+
+	components.clear();
+}
+
+void BenchmarkLayer::_RunSpawnBenchmark(int count)
+{
+	using namespace Gameplay;
+
+	const int passes = 5;
+
+	// An empty scene, so that the object count at the end only includes anything our removals missed
+	Scene::Sptr scene = std::make_shared<Scene>();
+
+	LOG_INFO("Spawning and removing {} objects:", count);
+
+	StageTimer timer(passes);
+	for (int pass = 0; pass < passes; pass++) {
+		std::vector<GameObject::Handle> handles;
+		handles.reserve(count);
+		timer.Time("Spawn", [&]() {
+			GameObject::Sptr parent = nullptr;
+			for (int ix = 0; ix < count; ix++) {
+				GameObject::Sptr object = scene->CreateGameObject("Spawned");
+				object->SetPostion(glm::vec3((float)ix, 0.0f, 0.0f));
+				object->Add<RotatingBehaviour>();
+				// Every fourth object is attached to the one before it, so that removal has children to deal with
+				if (ix % 4 == 3) {
+					parent->AddChild(object);
+				}
+				parent = object;
+				handles.push_back(object->GetHandle());
+			}
+		});
+
+		timer.Time("Remove + flush", [&]() {
+			// Removing the roots takes their children with them
+			for (const GameObject::Handle& handle : handles) {
+				GameObject::Sptr object = scene->FindObjectByHandle(handle);
+				if (object != nullptr && object->GetParent() == nullptr) {
+					scene->RemoveGameObject(object);
+				}
+			}
+			// Scenes flush removed objects at the start of their update, nothing plays while IsPlaying is false
+			scene->Update(0.0f);
+		});
+
+		// Handles to removed objects must not resolve, even once their slots get reused
+		LOG_ASSERT(scene->FindObjectByHandle(handles.front()) == nullptr, "Handle to a removed object is still valid");
+	}
+
+	timer.Log("Spawn");
+	timer.Log("Remove + flush", " (" + std::to_string(scene->NumObjects()) + " objects left)");
+}
+
+void BenchmarkLayer::_RunSceneLoadBenchmark(int count)
+{
+	using namespace Gameplay;
+
+	const int passes = 5;
+
+	// Build the scene to load, with a mix of components that have binary serializers and ones that don't
+	Scene::Sptr scene = std::make_shared<Scene>();
+	GameObject::Sptr parent = nullptr;
+	for (int ix = 0; ix < count; ix++) {
+		GameObject::Sptr object = scene->CreateGameObject("Object " + std::to_string(ix));
+		object->SetPostion(glm::vec3((float)ix, 0.0f, 0.0f));
+		object->Add<RenderComponent>();
+		object->Add<RotatingBehaviour>();
+		// JumpBehaviour has no binary serializer, so it gets stored as JSON in the binary scene
+		if (ix % 10 == 0) {
+			object->Add<JumpBehaviour>();
+		}
+		if (ix % 4 == 3) {
+			parent->AddChild(object);
+		}
+		parent = object;
+	}
+	parent = nullptr;
+
+	std::filesystem::path tempDir = std::filesystem::temp_directory_path();
+	std::string jsonPath   = (tempDir / "scene-load-benchmark.json").string();
+	std::string binaryPath = (tempDir / "scene-load-benchmark.bin").string();
+	scene->Save(jsonPath);
+	scene->SaveBinary(binaryPath);
+	scene = nullptr;
+
+	LOG_INFO("Loading a scene with {} objects:", count);
+
+	StageTimer timer(passes, "load");
+	for (const std::string& path : { jsonPath, binaryPath }) {
+		const char* label = path == jsonPath ? "JSON" : "Binary";
+		int objectCount = 0;
+		for (int pass = 0; pass < passes; pass++) {
+			Scene::Sptr loaded = nullptr;
+			timer.Time(label, [&]() { loaded = Scene::Load(path); });
+			objectCount = loaded != nullptr ? loaded->NumObjects() : 0;
+		}
+		LOG_ASSERT(objectCount == count, "Loaded scene has {} objects, expected {}", objectCount, count);
+
+		timer.Log(label, " (" + std::to_string(std::filesystem::file_size(path) / 1024) + " KB)");
+	}
+
+	std::filesystem::remove(jsonPath);
+	std::filesystem::remove(binaryPath);
+}
+
+void BenchmarkLayer::_RunPrefabBenchmark(int count)
+{
+	using namespace Gameplay;
+	using namespace Gameplay::Physics;
+
+	const int passes = 5;
+
+	// Both ways of spawning have to end up with exactly the same objects, which is easiest to check
+	// in a scene that only ever holds the copies
+	Scene::Sptr scene = std::make_shared<Scene>();
+
+	// Something like a projectile, a body with a collider and a trail attached to it
+	auto build = [&](const glm::vec3& position) {
+		GameObject::Sptr object = scene->CreateGameObject("Projectile");
+		object->SetPostion(position);
+		object->Add<RenderComponent>();
+		object->Add<RotatingBehaviour>();
+		object->Add<RigidBody>(RigidBodyType::Dynamic)->AddCollider(SphereCollider::Create());
+
+		GameObject::Sptr trail = scene->CreateGameObject("Trail");
+		trail->Add<RenderComponent>();
+		object->AddChild(trail);
+		return object;
+	};
+
+	GameObject::Sptr source = build(glm::vec3(0.0f));
+	Prefab::Sptr prefab = Prefab::Create(source);
+	scene->RemoveGameObject(source);
+	source = nullptr;
+	scene->Update(0.0f);
+
+	std::vector<glm::vec3> positions;
+	positions.reserve(count);
+	for (int ix = 0; ix < count; ix++) {
+		positions.push_back(glm::vec3((float)ix, 0.0f, 0.0f));
+	}
+
+	// Removing the copies isn't part of what we're measuring
+	std::vector<GameObject::Sptr> roots;
+	auto removeRoots = [&]() {
+		for (const GameObject::Sptr& root : roots) {
+			scene->RemoveGameObject(root);
+		}
+		roots.clear();
+		scene->Update(0.0f);
+	};
+
+	LOG_INFO("Spawning {} copies of a prefab with {} objects:", count, prefab->GetObjectCount());
+
+	StageTimer timer(passes);
+	for (int pass = 0; pass < passes; pass++) {
+		roots.reserve(count);
+		timer.Time("Add<T> in code", [&]() {
+			for (const glm::vec3& position : positions) {
+				roots.push_back(build(position));
+			}
+		});
+		removeRoots();
+
+		timer.Time("Scene::Instantiate", [&]() { roots = scene->Instantiate(prefab, positions); });
+		LOG_ASSERT(scene->NumObjects() == count * (int)prefab->GetObjectCount(), "Scene has {} objects, expected {}",
+			scene->NumObjects(), count * prefab->GetObjectCount());
+		removeRoots();
+	}
+
+	timer.Log("Add<T> in code");
+	timer.Log("Scene::Instantiate");
+}
+
+void BenchmarkLayer::_RunParticleBenchmark(int count)
+{
+	using namespace Gameplay;
+
+	const int   passes    = 120;
+	const float deltaTime = 1.0f / 60.0f;
+	const float lifetime  = 2.0f;
+	// The transform feedback backend can only spawn a few particles per emitter each step, so every backend
+	// gets enough emitters spawning at that rate to keep count particles alive
+	const int   spawnsPerStep = ParticleSystem::MAX_GS_SPAWNS;
+	const int   stepsAlive    = (int)(lifetime / deltaTime);
+	const int   emitterCount  = std::max(1, (count + spawnsPerStep * stepsAlive - 1) / (spawnsPerStep * stepsAlive));
+
+	Scene::Sptr scene = std::make_shared<Scene>();
+
+	LOG_INFO("Simulating {} particles from {} emitters:", count, emitterCount);
+
+	StageTimer timer(passes, "step");
+	for (ParticleBackend backend : { ParticleBackend::Gpu, ParticleBackend::Cpu, ParticleBackend::Compute }) {
+		const std::string label = ~backend;
+
+		GameObject::Sptr object = scene->CreateGameObject("Particles");
+		ParticleSystem::Sptr system = object->Add<ParticleSystem>();
+		system->SetBackend(backend);
+		system->SetMaxParticles(count);
+		for (int ix = 0; ix < emitterCount; ix++) {
+			ParticleSystem::ParticleData emitter;
+			emitter.Type     = ParticleType::SphereEmitter;
+			emitter.TexID    = 0;
+			emitter.Position = glm::vec3((float)ix, 0.0f, 0.0f);
+			emitter.Color    = glm::vec4(1.0f);
+			emitter.Lifetime = 0.0f;
+			emitter.SphereEmitterData.Timer     = deltaTime / spawnsPerStep;
+			emitter.SphereEmitterData.Velocity  = 1.0f;
+			emitter.SphereEmitterData.Radius    = 0.5f;
+			emitter.SphereEmitterData.LifeRange = { lifetime, lifetime };
+			emitter.SphereEmitterData.SizeRange = { 0.5f, 0.5f };
+			system->AddEmitter(emitter);
+		}
+
+		// Untimed steps until the first particles start dying, so every pass simulates a full system. Waiting on
+		// the GPU after each step means the GPU backends are timed on their actual work, not just their submission
+		for (int ix = 0; ix < stepsAlive; ix++) {
+			system->Update(deltaTime);
+		}
+		glFinish();
+		for (int ix = 0; ix < passes; ix++) {
+			timer.Time(label, [&]() {
+				system->Update(deltaTime);
+				glFinish();
+			});
+		}
+
+		// The transform feedback count is read back a few steps late, so give it one more step to catch up
+		system->Update(deltaTime);
+		glFinish();
+		timer.Log(label, " (" + std::to_string(system->GetParticleCount()) + " particles)");
+
+		scene->RemoveGameObject(object);
+		scene->Update(0.0f);
+	}
+}
+
+void BenchmarkLayer::_ResolveQuerySlot(int slot)
+{
+	int frame = _querySlotFrame[slot];
+	if (frame < 0 || frame >= static_cast<int>(_timings.size())) {
+		_querySlotFrame[slot] = -1;
+		return;
+	}
+
+	GLuint64 start = 0, end = 0;
+	glGetQueryObjectui64v(_queries[slot][0], GL_QUERY_RESULT, &start);
+	glGetQueryObjectui64v(_queries[slot][1], GL_QUERY_RESULT, &end);
+
+	// Timestamps are in nanoseconds
+	_timings[frame].GpuMs = static_cast<double>(end - start) / 1000000.0;
+	_querySlotFrame[slot] = -1;
+}
+
+void BenchmarkLayer::_CaptureFrame(int frame)
+{
+	Application& app = Application::Get();
+
+	// Read straight from the final image, the capture handles getting it to disk
+	if (_hasDefaultFramebuffer) {
+		const glm::ivec2& size = app.GetWindowSize();
+		_capture->Capture(0, glm::ivec4(0, 0, size.x, size.y), 0, frame);
+	} else {
+		PostProcessingLayer::Sptr postProcessing = app.GetLayer<PostProcessingLayer>();
+		Framebuffer::Sptr source = (postProcessing != nullptr && postProcessing->Enabled && postProcessing->GetOutput() != nullptr) ?
+			postProcessing->GetOutput() : app.GetLayer<RenderLayer>()->GetRenderOutput();
+		_capture->Capture(source->GetHandle(), glm::ivec4(0, 0, source->GetWidth(), source->GetHeight()), 0, frame);
+	}
+}
+
+void BenchmarkLayer::_WriteResults()
+{
+	Application& app = Application::Get();
+
+	std::stringstream csv;
+	csv << "frame,cpu_ms,gpu_ms\n";
+	for (const auto& timing : _timings) {
+		csv << timing.Frame << "," << timing.CpuMs << "," << timing.GpuMs << "\n";
+	}
+	FileHelpers::WriteContentsToFile(app.BenchmarkState.TimingsPath, csv.str());
+
+	// Summarize the run in the log as well, so we can eyeball results without opening the CSV
+	auto summarize = [&](const char* label, double FrameTiming::*member) {
+		std::vector<double> values;
+		values.reserve(_timings.size());
+		for (const auto& timing : _timings) {
+			values.push_back(timing.*member);
+		}
+		if (values.empty()) return;
+
+		std::sort(values.begin(), values.end());
+		double sum = 0.0;
+		for (double value : values) {
+			sum += value;
+		}
+		double p95 = values[std::min(values.size() - 1, (size_t)(values.size() * 0.95))];
+		LOG_INFO("{} ms: avg {:.3f} min {:.3f} max {:.3f} p95 {:.3f}", label, sum / values.size(), values.front(), values.back(), p95);
+	};
+	summarize("CPU", &FrameTiming::CpuMs);
+	summarize("GPU", &FrameTiming::GpuMs);
+
+	LOG_INFO("Wrote {} frame timings to \"{}\"", _timings.size(), app.BenchmarkState.TimingsPath);
+}
+
+double BenchmarkLayer::_GetTime()
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
@@ -0,0 +1,127 @@
+#pragma once
+#include "Application/ApplicationLayer.h"
+#include "Graphics/Framebuffer.h"
+#include "Graphics/FrameCapture.h"
+#include <glad/glad.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * The benchmark layer drives headless runs of the application (see Application::BenchmarkState). It
+ * renders a fixed number of frames into an offscreen framebuffer, records per-frame CPU and GPU timings,
+ * optionally writes PNG captures of the output (read back asynchronously, see FrameCapture), and quits
+ * the application when it is done
+ *
+ * This layer should be the last layer in the application, so that it sees the result of all other layers
+ */
+class BenchmarkLayer final : public ApplicationLayer {
+public:
+	MAKE_PTRS(BenchmarkLayer);
+
+	BenchmarkLayer();
+	virtual ~BenchmarkLayer();
+
+	// Inherited from ApplicationLayer
+
+	virtual void OnAppLoad(const nlohmann::json& config) override;
+	virtual void OnAppUnload() override;
+	virtual void OnSceneLoad() override;
+	virtual void OnUpdate() override;
+	virtual void OnPostRender() override;
+
+protected:
+	// Timing results for a single recorded frame
+	struct FrameTiming {
+		int    Frame;
+		double CpuMs;
+		// Negative until the GPU has returned the timestamps for the frame
+		double GpuMs;
+	};
+
+	/**
+	 * Adds up the time spent in each stage of a CPU benchmark over a number of passes, and logs the
+	 * average for each stage in the same format
+	 */
+	class StageTimer {
+	public:
+		/**
+		 * @param passes The number of passes that the totals get averaged over
+		 * @param unit   What a single pass is called in the log (ex: "load")
+		 */
+		StageTimer(int passes, const char* unit = "pass");
+
+		/**
+		 * Runs func, adding the time it took to the total for the stage
+		 */
+		template <typename Func>
+		void Time(const std::string& stage, Func&& func) {
+			double start = _GetTime();
+			func();
+			_totalMs[stage] += (_GetTime() - start) * 1000.0;
+		}
+
+		/**
+		 * Logs the average time per pass for a stage, followed by any extra detail (ex: " (12 KB)")
+		 */
+		void Log(const std::string& stage, const std::string& detail = "") const;
+
+	protected:
+		int         _passes;
+		const char* _unit;
+		std::unordered_map<std::string, double> _totalMs;
+	};
+
+	// We keep a few frames worth of timestamp queries in flight so that reading them back does not stall
+	static const int QUERY_RING_SIZE = 4;
+
+	// Reads back and writes captures without stalling the frames we are timing
+	FrameCapture::Sptr _capture;
+	// True if the context has a default framebuffer we can read from (ex: an EGL pbuffer)
+	bool              _hasDefaultFramebuffer;
+
+	// Start and end timestamps for each slot in the query ring
+	GLuint _queries[QUERY_RING_SIZE][2];
+	// The index into _timings that each query slot is measuring, or -1 if the slot is free
+	int    _querySlotFrame[QUERY_RING_SIZE];
+
+	// The number of frames rendered since the scene was loaded, including warmup frames
+	int    _frameIndex;
+	// Time that the previous frame finished, in seconds
+	double _lastFrameEnd;
+	// True once the scene has loaded and we've started counting frames
+	bool   _isRunning;
+
+	std::vector<FrameTiming> _timings;
+
+	/**
+	 * Times iterating render components through the component manager, compared to the weak pointer
+	 * pools it used to keep, and logs the results
+	 * @param count The number of render components to create for the test
+	 */
+	void _RunComponentBenchmark(int count);
+	/**
+	 * Times spawning a batch of objects into a scene and removing them all again, and logs the results
+	 * @param count The number of objects to spawn, a quarter of them are children of another object
+	 */
+	void _RunSpawnBenchmark(int count);
+	/**
+	 * Times loading a scene from JSON and from the binary scene format, and logs the results
+	 * @param count The number of objects to put in the scene
+	 */
+	void _RunSceneLoadBenchmark(int count);
+	/**
+	 * Times spawning copies of a prefab, compared to building the same objects in code, and logs the results
+	 * @param count The number of copies to spawn
+	 */
+	void _RunPrefabBenchmark(int count);
+	/**
+	 * Times stepping a particle system on each backend (transform feedback, CPU and compute), and logs the results
+	 * @param count The number of particles to keep alive
+	 */
+	void _RunParticleBenchmark(int count);
+	void _ResolveQuerySlot(int slot);
+	void _CaptureFrame(int frame);
+	void _WriteResults();
+	static double _GetTime();
+};
@@ -71,6 +71,7 @@
 #include "Graphics/Textures/Texture3D.h"
 #include "Graphics/Textures/Texture1D.h"
 #include "Application/Layers/ImGuiDebugLayer.h"
+#include "Application/Layers/RenderLayer.h"
 #include "Application/Windows/DebugWindow.h"
 #include "Gameplay/Components/ShadowCamera.h"
 #include "Gameplay/Components/ShipMoveBehaviour.h"
@@ -148,22 +149,32 @@ void DefaultSceneLayer::_CreateScene()
 		MeshResource::Sptr knightMesh = ResourceManager::CreateAsset<MeshResource>("knightModel.obj");
 		MeshResource::Sptr swordMesh = ResourceManager::CreateAsset<MeshResource>("swordModel.obj");
 
-		// Load in some textures
-		Texture2D::Sptr    boxTexture   = ResourceManager::CreateAsset<Texture2D>("textures/box-diffuse.png");
-		Texture2D::Sptr    linkTexture = ResourceManager::CreateAsset<Texture2D>("textures/linkTex.png");
-		Texture2D::Sptr    knightTexture = ResourceManager::CreateAsset<Texture2D>("textures/knightTex.png");
-		Texture2D::Sptr    swordTexture = ResourceManager::CreateAsset<Texture2D>("textures/swordTex.png");
-		Texture2D::Sptr    boxSpec      = ResourceManager::CreateAsset<Texture2D>("textures/box-specular.png");
-		Texture2D::Sptr    monkeyTex    = ResourceManager::CreateAsset<Texture2D>("textures/monkey-uvMap.png");
-		Texture2D::Sptr    leafTex      = ResourceManager::CreateAsset<Texture2D>("textures/leaves.png");
+		// Load in some textures, the last few are images for drag n' drop. The files are decoded across the job system
+		std::vector<Texture2D::Sptr> textures = Texture2D::LoadFromFiles({
+			"textures/box-diffuse.png",
+			"textures/linkTex.png",
+			"textures/knightTex.png",
+			"textures/swordTex.png",
+			"textures/box-specular.png",
+			"textures/monkey-uvMap.png",
+			"textures/leaves.png",
+			"textures/flashlight.png",
+			"textures/flashlight-2.png",
+			"textures/light_projection.png"
+		});
+		for (const Texture2D::Sptr& texture : textures) {
+			ResourceManager::AddAsset(texture);
+		}
+		Texture2D::Sptr    boxTexture   = textures[0];
+		Texture2D::Sptr    linkTexture = textures[1];
+		Texture2D::Sptr    knightTexture = textures[2];
+		Texture2D::Sptr    swordTexture = textures[3];
+		Texture2D::Sptr    boxSpec      = textures[4];
+		Texture2D::Sptr    monkeyTex    = textures[5];
+		Texture2D::Sptr    leafTex      = textures[6];
 		leafTex->SetMinFilter(MinFilter::Nearest);
 		leafTex->SetMagFilter(MagFilter::Nearest);
 
-		// Load some images for drag n' drop
-		ResourceManager::CreateAsset<Texture2D>("textures/flashlight.png");
-		ResourceManager::CreateAsset<Texture2D>("textures/flashlight-2.png");
-		ResourceManager::CreateAsset<Texture2D>("textures/light_projection.png");
-
 		Texture2DArray::Sptr particleTex = ResourceManager::CreateAsset<Texture2DArray>("textures/particles.png", 2, 2);
 
 		//DebugWindow::Sptr debugWindow = app.GetLayer<ImGuiDebugLayer>()->GetWindow<DebugWindow>();
@@ -271,6 +282,15 @@ void DefaultSceneLayer::_CreateScene()
 			swordMaterial->Set("u_Material.NormalMap", normalMapDefault);
 		}
 
+		// Pack the textures for everything using the basic deferred shader into shared arrays, so the renderer
+		// can draw objects with different materials in the same batch
+		RenderLayer::Sptr renderLayer = app.GetLayer<RenderLayer>();
+		for (const Material::Sptr& material : { boxMaterial, monkeyMaterial, testMaterial, linkMaterial, knightMaterial, swordMaterial }) {
+			if (!material->PackTextures(*renderLayer->GetTexturePacker(), renderLayer->GetBatchedShader())) {
+				LOG_WARN("Could not pack textures for material \"{}\", it will not be batched", material->Name);
+			}
+		}
+
 		// Our foliage vertex shader material 
 		Material::Sptr foliageMaterial = ResourceManager::CreateAsset<Material>(foliageShader);
 		{
@@ -428,13 +448,18 @@ void DefaultSceneLayer::_CreateScene()
 			wall->GenerateMesh();
 
 			GameObject::Sptr wall1 = scene->CreateGameObject("Wall1");
-			wall1->Add<RenderComponent>()->SetMesh(wall)->SetMaterial(whiteBrick);
+			RenderComponent::Sptr wall1Renderer = wall1->Add<RenderComponent>();
+			wall1Renderer->SetMesh(wall)->SetMaterial(whiteBrick);
+			// The walls are big and solid, so they're good at hiding things behind them
+			wall1Renderer->IsOccluder = true;
 			wall1->SetScale(glm::vec3(20.0f, 1.0f, 3.0f));
 			wall1->SetPostion(glm::vec3(0.0f, 10.0f, 1.5f));
 			plane->AddChild(wall1);
 
 			GameObject::Sptr wall2 = scene->CreateGameObject("Wall2");
-			wall2->Add<RenderComponent>()->SetMesh(wall)->SetMaterial(whiteBrick);
+			RenderComponent::Sptr wall2Renderer = wall2->Add<RenderComponent>();
+			wall2Renderer->SetMesh(wall)->SetMaterial(whiteBrick);
+			wall2Renderer->IsOccluder = true;
 			wall2->SetScale(glm::vec3(20.0f, 1.0f, 3.0f));
 			wall2->SetPostion(glm::vec3(0.0f, -10.0f, 1.5f));
 			plane->AddChild(wall2);
@@ -548,6 +573,8 @@ void DefaultSceneLayer::_CreateScene()
 			RenderComponent::Sptr renderer = enemyCharacter->Add<RenderComponent>();
 			renderer->SetMesh(knightMesh);
 			renderer->SetMaterial(knightMaterial);
+			// The ship circles the scene, so it spends a lot of time far away from the camera
+			renderer->UseImpostor = true;
 
 			// Add a dynamic rigid body to this monkey
 			RigidBody::Sptr physics = enemyCharacter->Add<RigidBody>(RigidBodyType::Dynamic); //might change to kinematic later
@@ -3,8 +3,19 @@
 #include "Logging.h"
 #include "Application/Application.h"
 
+#ifdef __linux__
+// Keep Xlib out of our includes, it defines macros like None that collide with our enums
+#define EGL_NO_X11
+#define MESA_EGL_NO_X11_HEADERS
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
 GLAppLayer::GLAppLayer() :
-	ApplicationLayer() {
+	ApplicationLayer(),
+	_eglDisplay(nullptr),
+	_eglSurface(nullptr),
+	_eglContext(nullptr) {
 	Name = "OpenGL Layer";
 	Overrides = AppLayerFunctions::OnAppLoad | AppLayerFunctions::OnAppUnload;
 }
@@ -12,6 +23,43 @@ GLAppLayer::GLAppLayer() :
 GLAppLayer::~GLAppLayer() = default;
 
 void GLAppLayer::OnAppLoad(const nlohmann::json& config) {
+	Application& app = Application::Get();
+
+	// Try for an offscreen context first if we're headless, otherwise (or if that fails) we use GLFW
+	if (!app.BenchmarkState.IsHeadless || !_CreateHeadlessContext()) {
+		_CreateWindowContext(!app.BenchmarkState.IsHeadless);
+	}
+
+	glEnable(GL_PROGRAM_POINT_SIZE);
+
+	glEnable(GL_DEBUG_OUTPUT);
+	glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+	glDebugMessageCallback(GlDebugMessageCallback, &app);
+
+	// Display our GPU and OpenGL version
+	LOG_INFO(glGetString(GL_RENDERER));
+	LOG_INFO(glGetString(GL_VERSION));
+}
+
+void GLAppLayer::OnAppUnload()
+{
+	Application& app = Application::Get();
+
+	// If we have an EGL context, we never created a window or initialized GLFW
+	if (_eglContext != nullptr) {
+		_DestroyHeadlessContext();
+	} else {
+		glfwDestroyWindow(app._window);
+		glfwTerminate();
+	}
+
+	app._window = nullptr;
+	app._windowSize = glm::ivec2(0, 0);
+	app._windowTitle = "";
+}
+
+void GLAppLayer::_CreateWindowContext(bool visible)
+{
 	// Initialize GLFW
 	LOG_ASSERT(glfwInit() == GLFW_TRUE, "Failed to initialize GLFW");
 
@@ -21,6 +69,7 @@ void GLAppLayer::OnAppLoad(const nlohmann::json& config) {
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
 	glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
 	glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+	glfwWindowHint(GLFW_VISIBLE, visible);
 
 	//Create a new GLFW window and make it current
 	app._window = glfwCreateWindow(app._windowSize.x, app._windowSize.y, app._windowTitle.c_str(), nullptr, nullptr);
@@ -30,27 +79,122 @@ void GLAppLayer::OnAppLoad(const nlohmann::json& config) {
 	glfwSetWindowSizeCallback(app._window, GlWindowResizedCallback);
 
 	LOG_ASSERT(gladLoadGLLoader((GLADloadproc)glfwGetProcAddress) != 0, "Failed to initialize glad");
+}
 
-	glEnable(GL_PROGRAM_POINT_SIZE);
+bool GLAppLayer::_CreateHeadlessContext()
+{
+#ifdef __linux__
+	Application& app = Application::Get();
 
-	glEnable(GL_DEBUG_OUTPUT);
-	glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
-	glDebugMessageCallback(GlDebugMessageCallback, &app);
+	// Prefer Mesa's surfaceless platform, it doesn't need an X or Wayland server to be running
+	EGLDisplay display = EGL_NO_DISPLAY;
+	PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+	if (getPlatformDisplay != nullptr) {
+		display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+	}
+	if (display == EGL_NO_DISPLAY) {
+		display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+	}
 
-	// Display our GPU and OpenGL version
-	LOG_INFO(glGetString(GL_RENDERER));
-	LOG_INFO(glGetString(GL_VERSION));
+	EGLint major = 0, minor = 0;
+	if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor)) {
+		LOG_WARN("Failed to initialize EGL, falling back to a hidden window");
+		return false;
+	}
+	LOG_INFO("Initialized EGL {}.{}", major, minor);
+
+	if (!eglBindAPI(EGL_OPENGL_API)) {
+		LOG_WARN("EGL display does not support desktop OpenGL, falling back to a hidden window");
+		eglTerminate(display);
+		return false;
+	}
+
+	// We ask for a pbuffer so that the default framebuffer exists for the layers that blit to it
+	const EGLint pbufferConfigAttribs[] = {
+		EGL_SURFACE_TYPE,    EGL_PBUFFER_BIT,
+		EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+		EGL_RED_SIZE,   8, EGL_GREEN_SIZE,   8, EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8,
+		EGL_DEPTH_SIZE, 24, EGL_STENCIL_SIZE, 8,
+		EGL_NONE
+	};
+	const EGLint surfacelessConfigAttribs[] = {
+		EGL_SURFACE_TYPE,    0,
+		EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+		EGL_NONE
+	};
+
+	EGLConfig eglConfig = nullptr;
+	EGLint numConfigs = 0;
+	EGLSurface surface = EGL_NO_SURFACE;
+	if (eglChooseConfig(display, pbufferConfigAttribs, &eglConfig, 1, &numConfigs) && numConfigs > 0) {
+		const EGLint pbufferAttribs[] = {
+			EGL_WIDTH,  app._windowSize.x,
+			EGL_HEIGHT, app._windowSize.y,
+			EGL_NONE
+		};
+		surface = eglCreatePbufferSurface(display, eglConfig, pbufferAttribs);
+	}
+	// No pbuffer support, we can still render into our own framebuffers with a surfaceless context
+	if (surface == EGL_NO_SURFACE) {
+		LOG_WARN("EGL pbuffers are unavailable, using a surfaceless context. Blits to the default framebuffer will be discarded");
+		if (!eglChooseConfig(display, surfacelessConfigAttribs, &eglConfig, 1, &numConfigs) || numConfigs == 0) {
+			LOG_WARN("Failed to find an EGL config, falling back to a hidden window");
+			eglTerminate(display);
+			return false;
+		}
+	}
+
+	// Try for 4.6 to match our windowed context, but llvmpipe on older Mesa versions tops out at 4.5
+	EGLContext context = EGL_NO_CONTEXT;
+	for (EGLint minorVersion = 6; minorVersion >= 5 && context == EGL_NO_CONTEXT; minorVersion--) {
+		const EGLint contextAttribs[] = {
+			EGL_CONTEXT_MAJOR_VERSION,       4,
+			EGL_CONTEXT_MINOR_VERSION,       minorVersion,
+			EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+			EGL_CONTEXT_OPENGL_DEBUG,        EGL_TRUE,
+			EGL_NONE
+		};
+		context = eglCreateContext(display, eglConfig, EGL_NO_CONTEXT, contextAttribs);
+	}
+
+	if (context == EGL_NO_CONTEXT || !eglMakeCurrent(display, surface, surface, context)) {
+		LOG_WARN("Failed to create a GL 4.5+ core context with EGL, falling back to a hidden window");
+		if (context != EGL_NO_CONTEXT) {
+			eglDestroyContext(display, context);
+		}
+		if (surface != EGL_NO_SURFACE) {
+			eglDestroySurface(display, surface);
+		}
+		eglTerminate(display);
+		return false;
+	}
+
+	_eglDisplay = display;
+	_eglSurface = surface;
+	_eglContext = context;
+
+	LOG_ASSERT(gladLoadGLLoader((GLADloadproc)eglGetProcAddress) != 0, "Failed to initialize glad");
+	return true;
+#else
+	LOG_INFO("Offscreen contexts are not supported on this platform, using a hidden window instead");
+	return false;
+#endif
 }
 
-void GLAppLayer::OnAppUnload()
+void GLAppLayer::_DestroyHeadlessContext()
 {
-	Application& app = Application::Get();
-	glfwDestroyWindow(app._window);
-	app._window = nullptr;
-	app._windowSize = glm::ivec2(0, 0);
-	app._windowTitle = "";
-
-	glfwTerminate();
+#ifdef __linux__
+	EGLDisplay display = static_cast<EGLDisplay>(_eglDisplay);
+	eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+	eglDestroyContext(display, static_cast<EGLContext>(_eglContext));
+	if (_eglSurface != EGL_NO_SURFACE) {
+		eglDestroySurface(display, static_cast<EGLSurface>(_eglSurface));
+	}
+	eglTerminate(display);
+#endif
+	_eglDisplay = nullptr;
+	_eglSurface = nullptr;
+	_eglContext = nullptr;
 }
 
 void GLAppLayer::GlDebugMessageCallback(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar* message, const void* userParam) {
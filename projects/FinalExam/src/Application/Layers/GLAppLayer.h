@@ -8,6 +8,10 @@ struct GLFWwindow;
 /**
  * The GL Application Layer will handle initializing and cleaning up OpenGL and GLFW, as well as handling
  * things like debug and window size callbacks
+ * 
+ * When the application is running headless, an offscreen context is created instead of a window. On Linux
+ * this uses EGL (pbuffer, or surfaceless if pbuffers are unavailable), which Mesa's llvmpipe supports, so
+ * that we can render on build servers without a GPU. Other platforms fall back to a hidden GLFW window.
  */
 class GLAppLayer final : public ApplicationLayer {
 public:
@@ -22,6 +26,16 @@ public:
 	virtual void OnAppUnload() override;
 
 protected:
+	// Handles for our EGL display, surface and context when running headless. We store these as
+	// opaque pointers so that we don't need to include the EGL headers everywhere
+	void* _eglDisplay;
+	void* _eglSurface;
+	void* _eglContext;
+
+	void _CreateWindowContext(bool visible);
+	bool _CreateHeadlessContext();
+	void _DestroyHeadlessContext();
+
 	static void GlDebugMessageCallback(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar* message, const void* userParam);
 	static void GlWindowResizedCallback(GLFWwindow* window, int width, int height);
 };
\ No newline at end of file
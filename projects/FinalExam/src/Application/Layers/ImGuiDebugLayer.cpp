@@ -20,7 +20,8 @@
 
 ImGuiDebugLayer::ImGuiDebugLayer() :
 	ApplicationLayer(),
-	_dockInvalid(true)
+	_dockInvalid(true),
+	_sectorSize(64.0f)
 {
 	Name = "ImGui Debug Layer";
 	Overrides = AppLayerFunctions::OnAppLoad | AppLayerFunctions::OnAppUnload | AppLayerFunctions::OnPreRender | AppLayerFunctions::OnRender | AppLayerFunctions::OnPostRender;
@@ -165,7 +166,7 @@ void ImGuiDebugLayer::OnRender(const Framebuffer::Sptr& prevLayer)
 
 				// Load scene item
 				if (ImGui::MenuItem("Load Scene", NULL, false)) {
-					std::optional<std::string> path = FileDialogs::OpenFile("Scene File\0*.json\0\0");
+					std::optional<std::string> path = FileDialogs::OpenFile("Scene File\0*.json;*.bin\0\0");
 					if (path.has_value()) {
 						app.LoadScene(path.value());
 					}
@@ -182,6 +183,30 @@ void ImGuiDebugLayer::OnRender(const Framebuffer::Sptr& prevLayer)
 					}
 				}
 
+				// Save binary scene item, binary scenes share their manifest with the JSON scene of the same name
+				if (ImGui::MenuItem("Save Binary Scene", NULL, false)) {
+					std::optional<std::string> path = FileDialogs::SaveFile("Binary Scene File\0*.bin\0\0");
+					if (path.has_value()) {
+						app.CurrentScene()->SaveBinary(path.value());
+
+						std::string newFilename = std::filesystem::path(path.value()).stem().string() + "-manifest.json";
+						ResourceManager::SaveManifest(newFilename);
+					}
+				}
+
+				// Export the scene as a binary scene split into streamed sectors
+				if (ImGui::BeginMenu("Export Sectors")) {
+					LABEL_LEFT(ImGui::DragFloat, "Sector Size", &_sectorSize, 1.0f, 1.0f, 10000.0f);
+					if (ImGui::MenuItem("Export...", NULL, false)) {
+						std::optional<std::string> path = FileDialogs::SaveFile("Binary Scene File\0*.bin\0\0");
+						if (path.has_value() && app.CurrentScene()->ExportSectors(path.value(), _sectorSize)) {
+							std::string newFilename = std::filesystem::path(path.value()).stem().string() + "-manifest.json";
+							ResourceManager::SaveManifest(newFilename);
+						}
+					}
+					ImGui::EndMenu();
+				}
+
 				ImGui::EndMenu();
 			}
 
@@ -293,7 +318,7 @@ void ImGuiDebugLayer::_RenderGameWindow()
 
 	// Janky ass button text for the play/stop button
 	static char buffer[64];
-	sprintf_s(buffer, "%s###PLAY_STOP", scene->IsPlaying ? "[]" : ">");
+	snprintf(buffer, sizeof(buffer), "%s###PLAY_STOP", scene->IsPlaying ? "[]" : ">");
 
 	// Remove spacing around buttons
 	ImGui::PushStyleVar(ImGuiStyleVar_ItemSpacing, ImVec2(0, 0));
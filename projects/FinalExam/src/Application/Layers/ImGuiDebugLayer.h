@@ -4,6 +4,8 @@
 #include "../IEditorWindow.h"
 #include "Logging.h"
 
+#include <typeindex>
+
 /**
  * The ImGui Debug Layer allows us to handle editor and debug windows using ImGUI
  */
@@ -51,6 +53,8 @@ protected:
 	std::vector<IEditorWindow::Sptr> _windows;
 	nlohmann::json _backupState;
 	bool           _dockInvalid;
+	// The size of the sectors to split scenes into from the File menu, see Scene::ExportSectors
+	float          _sectorSize;
 
 	void _RenderGameWindow();
 	ImGuiID& _FindOpenParentWindow(const IEditorWindow::Sptr& window, ImGuiID& mainID, ImGuiDir* direction, float* dist);
@@ -93,8 +93,8 @@ void InstancedRenderingTestLayer::_UpdateInstances() {
 	for (int ix = 0; ix < _instances.size(); ix++) {
 		// For now just update everything regardless of if it's changed or not
 		// A smarter system would only update if the data is old
-		data[ix].ModelMatrix  = _instances[ix]->GetTransform();
-		data[ix].NormalMatrix = glm::mat3(glm::transpose(glm::inverse(_instances[ix]->GetTransform())));
+		data[ix].ModelMatrix  = _instances[ix]->GetRenderTransform();
+		data[ix].NormalMatrix = glm::mat3(glm::transpose(_instances[ix]->GetInverseRenderTransform()));
 	}
 
 	// Unmap the buffer so that the GPU can see it again
@@ -6,12 +6,12 @@ LogicUpdateLayer::LogicUpdateLayer() :
 	ApplicationLayer()
 {
 	Name = "Logic";
-	Overrides = AppLayerFunctions::OnUpdate;
+	Overrides = AppLayerFunctions::OnFixedUpdate | AppLayerFunctions::OnUpdate;
 }
 
 LogicUpdateLayer::~LogicUpdateLayer() = default;
 
-void LogicUpdateLayer::OnUpdate()
+void LogicUpdateLayer::OnFixedUpdate()
 {
 	Application& app = Application::Get();
 
@@ -20,4 +20,13 @@ void LogicUpdateLayer::OnUpdate()
 
 	// Update our worlds physics!
 	app.CurrentScene()->DoPhysics(Timing::Current().DeltaTime());
+
+	// Bring all the transforms that moved this tick up to date in one go, before anything renders them
+	app.CurrentScene()->UpdateTransforms();
+}
+
+void LogicUpdateLayer::OnUpdate()
+{
+	// Streaming follows the camera, which may move every frame rather than every tick
+	Application::Get().CurrentScene()->UpdateStreaming();
 }
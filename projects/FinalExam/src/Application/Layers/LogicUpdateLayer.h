@@ -10,6 +10,7 @@ public:
 
 	// Inherited from ApplicationLayer
 
+	virtual void OnFixedUpdate() override;
 	virtual void OnUpdate() override;
 
 protected:
@@ -1,31 +1,179 @@
 #include "ParticleLayer.h"
 #include "Gameplay/Components/ParticleSystem.h"
 #include "Application/Application.h"
+#include "Application/Timing.h"
+#include "Utils/JsonGlmHelpers.h"
 #include "RenderLayer.h"
 
+// Particle buffers are reserved in pages of this size, systems bigger than this get a page to themselves
+static const size_t PARTICLE_PAGE_SIZE = 4 * 1024 * 1024;
+static const size_t DEFAULT_MEMORY_BUDGET_MB = 64;
+
 ParticleLayer::ParticleLayer() :
-	ApplicationLayer()
+	ApplicationLayer(),
+	_settings(BudgetSettings()),
+	_stats(Stats()),
+	_bufferPool(nullptr),
+	_frameIndex(0)
 {
 	Name = "Particles";
-	Overrides = AppLayerFunctions::OnUpdate | AppLayerFunctions::OnPostRender;
+	Overrides = AppLayerFunctions::OnAppLoad | AppLayerFunctions::OnUpdate | AppLayerFunctions::OnPostRender;
+
+	// Two buffers per allocation, since the systems ping-pong between them
+	_bufferPool = std::make_shared<BufferPool>(2, PARTICLE_PAGE_SIZE, DEFAULT_MEMORY_BUDGET_MB * 1024 * 1024);
 }
 
 ParticleLayer::~ParticleLayer()
 { }
 
+void ParticleLayer::OnAppLoad(const nlohmann::json& config)
+{
+	if (config.contains(Name)) {
+		const nlohmann::json& blob = config[Name];
+		_settings.ParticleBudget = JsonGet(blob, "particle_budget", _settings.ParticleBudget);
+		SetMemoryBudget(JsonGet(blob, "memory_budget_mb", DEFAULT_MEMORY_BUDGET_MB) * 1024 * 1024);
+	}
+}
+
+nlohmann::json ParticleLayer::GetDefaultConfig()
+{
+	return {
+		{ "particle_budget", BudgetSettings().ParticleBudget },
+		{ "memory_budget_mb", DEFAULT_MEMORY_BUDGET_MB }
+	};
+}
+
 void ParticleLayer::OnUpdate()
 {
 	Application& app = Application::Get();
 
 	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
 
+	float deltaTime = Timing::Current().DeltaTime();
+	_UpdateBudgets();
+
 	// Only update the particle systems when the game is playing, so we can edit them in
 	// the inspector
 	if (app.CurrentScene()->IsPlaying) {
-		app.CurrentScene()->Components().Each<ParticleSystem>([](const ParticleSystem::Sptr& system) {
-			if (system->IsEnabled) {
-				system->Update();
+		uint32_t systemIx = 0;
+		app.CurrentScene()->Components().Each<ParticleSystem>([&](const ParticleSystem::Sptr& system) {
+			if (!system->IsEnabled) return;
+
+			ParticleSystem::BudgetState& budget = system->_budget;
+			budget.PendingTime += deltaTime;
+			systemIx++;
+
+			if (budget.Culled) {
+				return;
+			}
+
+			// Offset by the system index so that throttled systems don't all land on the same frame
+			if ((_frameIndex + systemIx) % budget.Interval != 0) {
+				_stats.SystemsSkipped++;
+				return;
 			}
+
+			// Systems coming back into view can have a lot of time to make up for, anything past the
+			// longest particle lifetime wouldn't be visible anyways
+			float time = glm::min(budget.PendingTime, _settings.MaxCatchUpTime);
+			int steps = glm::max((int)glm::ceil(time / _settings.CatchUpStepTime), 1);
+			for (int ix = 0; ix < steps; ix++) {
+				system->Update(time / steps);
+			}
+			budget.PendingTime = 0.0f;
+			_stats.SystemsSimulated++;
+		});
+	}
+
+	_frameIndex++;
+}
+
+void ParticleLayer::_UpdateBudgets()
+{
+	Application& app = Application::Get();
+	Gameplay::Camera::Sptr camera = app.CurrentScene()->MainCamera;
+
+	_stats = Stats();
+
+	glm::vec3 cameraPos = glm::vec3(0.0f);
+	glm::vec4 planes[6];
+	float projScale = 1.0f;
+	if (camera != nullptr) {
+		cameraPos = camera->GetGameObject()->GetWorldPosition();
+		projScale = camera->GetProjection()[1][1];
+
+		// Same plane extraction as the render layer, but normalized so we can test spheres
+		glm::mat4 m = glm::transpose(camera->GetViewProjection());
+		planes[0] = m[3] + m[0];
+		planes[1] = m[3] - m[0];
+		planes[2] = m[3] + m[1];
+		planes[3] = m[3] - m[1];
+		planes[4] = m[3] + m[2];
+		planes[5] = m[3] - m[2];
+		for (int ix = 0; ix < 6; ix++) {
+			planes[ix] /= glm::length(glm::vec3(planes[ix]));
+		}
+	}
+
+	// First pass works out each system's level of detail, and estimates how many particles
+	// all the visible systems would have if they were running at full rate
+	float expectedParticles = 0.0f;
+	app.CurrentScene()->Components().Each<ParticleSystem>([&](const ParticleSystem::Sptr& system) {
+		if (!system->IsEnabled) return;
+
+		ParticleSystem::BudgetState& budget = system->_budget;
+
+		if (camera == nullptr) {
+			budget.Culled = false;
+			budget.Interval = 1;
+		} else {
+			const glm::mat4& transform = system->GetGameObject()->GetTransform();
+			glm::vec3 center = glm::vec3(transform[3]);
+			float scale = glm::max(glm::length(glm::vec3(transform[0])), glm::max(glm::length(glm::vec3(transform[1])), glm::length(glm::vec3(transform[2]))));
+			float radius = system->BoundingRadius * scale;
+
+			budget.Distance = glm::distance(center, cameraPos);
+			budget.ScreenSize = budget.Distance > radius ? (radius * projScale) / budget.Distance : 1.0f;
+
+			bool inFrustum = true;
+			for (int ix = 0; ix < 6 && inFrustum; ix++) {
+				inFrustum = glm::dot(glm::vec3(planes[ix]), center) + planes[ix].w >= -radius;
+			}
+
+			budget.Culled =
+				!inFrustum ||
+				budget.Distance - radius > _settings.CullDistance ||
+				budget.ScreenSize < _settings.MinScreenSize;
+
+			// Fade the spawn rate out between the full rate and cull distances
+			float t = glm::clamp((budget.Distance - _settings.FullRateDistance) / glm::max(_settings.CullDistance - _settings.FullRateDistance, 0.001f), 0.0f, 1.0f);
+			float emissionScale = glm::mix(1.0f, _settings.MinEmissionScale, t);
+
+			// Estimate from the last scale we gave this system, so we don't need to know anything about its emitters
+			float fullRateCount = glm::min((float)system->GetMaxParticles(), system->GetParticleCount() / glm::max(budget.EmissionScale, 0.01f));
+			budget.EmissionScale = emissionScale;
+
+			budget.Interval = budget.ScreenSize >= _settings.FullRateScreenSize ? 1 :
+				glm::min(_settings.MaxSimulationInterval, (uint32_t)glm::ceil(_settings.FullRateScreenSize / glm::max(budget.ScreenSize, 0.0001f)));
+			budget.Interval = glm::max(budget.Interval, 1u);
+
+			if (!budget.Culled) {
+				expectedParticles += fullRateCount * emissionScale;
+			}
+		}
+
+		if (budget.Culled) {
+			_stats.SystemsCulled++;
+		} else {
+			_stats.ParticleCount += system->GetParticleCount();
+		}
+	});
+
+	// Second pass scales everything down evenly if we're going to be over budget
+	if (expectedParticles > _settings.ParticleBudget) {
+		_stats.BudgetScale = _settings.ParticleBudget / expectedParticles;
+		app.CurrentScene()->Components().Each<ParticleSystem>([&](const ParticleSystem::Sptr& system) {
+			system->_budget.EmissionScale *= _stats.BudgetScale;
 		});
 	}
 }
@@ -42,10 +190,30 @@ void ParticleLayer::OnPostRender()
 	glViewport(0, 0, renderOutput->GetWidth(), renderOutput->GetHeight());
 
 	Application::Get().CurrentScene()->Components().Each<ParticleSystem>([](const ParticleSystem::Sptr& system) {
-		if (system->IsEnabled) {
-			system->Render(); 
+		if (system->IsEnabled && !system->_budget.Culled) {
+			system->Render();
 		}
 	});
 
 	//renderer->GetRenderOutput()->Unbind();
 }
+
+ParticleLayer::BudgetSettings& ParticleLayer::GetBudgetSettings() {
+	return _settings;
+}
+
+void ParticleLayer::SetMemoryBudget(size_t bytes) {
+	_bufferPool->SetBudget(bytes);
+}
+
+size_t ParticleLayer::GetMemoryBudget() const {
+	return _bufferPool->GetBudget();
+}
+
+const BufferPool::Sptr& ParticleLayer::GetBufferPool() const {
+	return _bufferPool;
+}
+
+const ParticleLayer::Stats& ParticleLayer::GetStats() const {
+	return _stats;
+}
@@ -1,14 +1,85 @@
 #pragma once
 #include "../ApplicationLayer.h"
+#include "Graphics/Buffers/BufferPool.h"
 
-
+/// <summary>
+/// Updates and renders all the particle systems in the scene, keeping them within a global
+/// particle and GPU memory budget
+///
+/// Systems share their buffers from a single pool instead of allocating their own. Each frame
+/// systems are given a level of detail based on their distance and size on screen, which scales
+/// their spawn rates and how often they are simulated. Systems that are off screen or too far away
+/// are not simulated at all, and catch up on the time they missed once they come back into view
+/// </summary>
 class ParticleLayer : public ApplicationLayer {
 public:
 	MAKE_PTRS(ParticleLayer);
+
+	/// <summary>
+	/// Tuning for how particle systems are throttled
+	/// </summary>
+	struct BudgetSettings {
+		// The maximum number of live particles across all systems
+		uint32_t ParticleBudget        = 100000;
+		// Systems closer than this spawn at their full rate
+		float    FullRateDistance      = 20.0f;
+		// Systems further than this are not simulated or drawn
+		float    CullDistance          = 150.0f;
+		// The lowest spawn rate multiplier a visible system can have before the global budget is applied
+		float    MinEmissionScale      = 0.1f;
+		// Systems at least this tall (as a fraction of the screen height) are simulated every frame
+		float    FullRateScreenSize    = 0.1f;
+		// Systems smaller than this on screen are culled
+		float    MinScreenSize         = 0.005f;
+		// Small systems are simulated at most this many frames apart
+		uint32_t MaxSimulationInterval = 4;
+		// The most time a culled system will catch up on when it comes back into view, in seconds
+		float    MaxCatchUpTime        = 2.0f;
+		// Catch up time is split into steps no longer than this, so that emitters can keep up
+		float    CatchUpStepTime       = 0.25f;
+	};
+
+	/// <summary>
+	/// Statistics about the current frame, for debugging
+	/// </summary>
+	struct Stats {
+		int      SystemsSimulated = 0;
+		int      SystemsSkipped   = 0;
+		int      SystemsCulled    = 0;
+		uint32_t ParticleCount    = 0;
+		// The extra multiplier applied to all spawn rates to stay within the particle budget
+		float    BudgetScale      = 1.0f;
+	};
+
 	ParticleLayer();
 	virtual ~ParticleLayer();
 
+	BudgetSettings& GetBudgetSettings();
+
+	/// <summary>
+	/// Sets the maximum number of bytes that particle buffers can use in GPU memory
+	/// </summary>
+	void SetMemoryBudget(size_t bytes);
+	size_t GetMemoryBudget() const;
+
+	/// <summary>
+	/// Gets the pool that all particle systems allocate their buffers from
+	/// </summary>
+	const BufferPool::Sptr& GetBufferPool() const;
+	const Stats& GetStats() const;
+
+	// Inherited from ApplicationLayer
+
+	void OnAppLoad(const nlohmann::json& config) override;
 	void OnUpdate() override;
 	void OnPostRender() override;
+	nlohmann::json GetDefaultConfig() override;
+
+protected:
+	BudgetSettings   _settings;
+	Stats            _stats;
+	BufferPool::Sptr _bufferPool;
+	uint32_t         _frameIndex;
 
-};
\ No newline at end of file
+	void _UpdateBudgets();
+};
@@ -7,9 +7,12 @@
 #include <GLM/glm.hpp>
 
 BoxFilter3x3::BoxFilter3x3() :
-	PostProcessingLayer::Effect()
+	PostProcessingLayer::Effect(),
+	Mode(BoxFilterMode::Direct),
+	_separable(SeparableFilter()),
+	_kawase(DualKawaseBlur())
 {
-	Name = "Box Filter";
+	Name = "Box Filter 3x3";
 	_format = RenderTargetType::ColorRgb8;
 
 	// Zero the memory, then set center pixel to 1.0
@@ -31,10 +34,45 @@ void BoxFilter3x3::Apply(const Framebuffer::Sptr& gBuffer)
 	_shader->SetUniform("u_PixelSize", glm::vec2(1.0f) / (glm::vec2)gBuffer->GetSize()); 
 }
 
+RenderGraph::ResourceHandle BoxFilter3x3::Setup(RenderGraph& graph, RenderGraph::ResourceHandle input, RenderGraph::ResourceHandle gBuffer)
+{
+	switch (Mode) {
+		case BoxFilterMode::Separable:
+			_separable.SetKernel(Filter, 3);
+			return _separable.Setup(graph, input, Name, { _outputScale, _format });
+		case BoxFilterMode::DualKawase:
+			return _kawase.Setup(graph, input, Name, { _outputScale, _format });
+		default:
+			return Effect::Setup(graph, input, gBuffer);
+	}
+}
+
 void BoxFilter3x3::RenderImGui()
 {
 	ImGui::PushID(this);
 
+	ENUM_COMBO("Mode", &Mode, BoxFilterMode);
+
+	// Give some idea of how the modes compare, the GPU time is shown by the settings window. At 3x3 the
+	// separable passes only save 3 taps, and the extra pass can cost more than that
+	switch (Mode) {
+		case BoxFilterMode::Direct:
+			ImGui::Text("Taps per pixel: 9");
+			break;
+		case BoxFilterMode::Separable:
+			_separable.SetKernel(Filter, 3);
+			ImGui::Text("Taps per pixel: %d", _separable.GetTapCount());
+			ImGui::Text("Approximation error: %.1f%%", _separable.GetError() * 100.0f);
+			break;
+		case BoxFilterMode::DualKawase:
+			ImGui::Text("Taps per pixel: %.1f", _kawase.GetTapCount());
+			LABEL_LEFT(ImGui::SliderInt, "Iterations", &_kawase.Iterations, 1, 8);
+			LABEL_LEFT(ImGui::SliderFloat, "Offset", &_kawase.Offset, 0.5f, 4.0f);
+			ImGui::PopID();
+			// The kernel isn't used by the Kawase blur
+			return;
+	}
+
 	ImGui::Columns(3); 
 	for (int iy = 0; iy < 3; iy++) { 
 		for (int ix = 0; ix < 3; ix++) {
@@ -80,6 +118,9 @@ BoxFilter3x3::Sptr BoxFilter3x3::FromJson(const nlohmann::json& data)
 {
 	BoxFilter3x3::Sptr result = std::make_shared<BoxFilter3x3>();
 	result->Enabled = JsonGet(data, "enabled", true);
+	result->Mode = JsonParseEnum(BoxFilterMode, data, "mode", BoxFilterMode::Direct);
+	result->_kawase.Iterations = JsonGet(data, "kawase_iterations", result->_kawase.Iterations);
+	result->_kawase.Offset = JsonGet(data, "kawase_offset", result->_kawase.Offset);
 	std::vector<float> filter = JsonGet(data, "filter", std::vector<float>(9, 0.0f));
 	for (int ix = 0; ix < 9; ix++) {
 		result->Filter[ix] = filter[ix];
@@ -95,6 +136,9 @@ nlohmann::json BoxFilter3x3::ToJson() const
 	}
 	return {
 		{ "enabled", Enabled },
+		{ "mode", ~Mode },
+		{ "kawase_iterations", _kawase.Iterations },
+		{ "kawase_offset", _kawase.Offset },
 		{ "filter", filter }
 	};
 }
@@ -3,16 +3,21 @@
 #include "Graphics/ShaderProgram.h"
 #include "Graphics/Textures/Texture3D.h"
 #include "Graphics/Framebuffer.h"
+#include "BoxFilterMode.h"
+#include "SeparableFilter.h"
+#include "DualKawaseBlur.h"
 
 class BoxFilter3x3 : public PostProcessingLayer::Effect {
 public:
 	MAKE_PTRS(BoxFilter3x3);
 	float Filter[9];
+	BoxFilterMode Mode;
 
 	BoxFilter3x3();
 	virtual ~BoxFilter3x3();
 
 	virtual void Apply(const Framebuffer::Sptr& gBuffer) override;
+	virtual RenderGraph::ResourceHandle Setup(RenderGraph& graph, RenderGraph::ResourceHandle input, RenderGraph::ResourceHandle gBuffer) override;
 	virtual void RenderImGui() override;
 
 	// Inherited from IResource
@@ -22,5 +27,7 @@ public:
 
 protected:
 	ShaderProgram::Sptr _shader;
+	SeparableFilter     _separable;
+	DualKawaseBlur      _kawase;
 };
 
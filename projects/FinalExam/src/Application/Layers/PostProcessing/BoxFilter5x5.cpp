@@ -7,9 +7,12 @@
 #include <GLM/glm.hpp>
 
 BoxFilter5x5::BoxFilter5x5() :
-	PostProcessingLayer::Effect()
+	PostProcessingLayer::Effect(),
+	Mode(BoxFilterMode::Direct),
+	_separable(SeparableFilter()),
+	_kawase(DualKawaseBlur())
 {
-	Name = "Box Filter";
+	Name = "Box Filter 5x5";
 	_format = RenderTargetType::ColorRgb8;
 
 	memset(Filter, 0, sizeof(float) * 25);
@@ -30,10 +33,44 @@ void BoxFilter5x5::Apply(const Framebuffer::Sptr& gBuffer)
 	_shader->SetUniform("u_PixelSize", glm::vec2(1.0f) / (glm::vec2)gBuffer->GetSize()); 
 }
 
+RenderGraph::ResourceHandle BoxFilter5x5::Setup(RenderGraph& graph, RenderGraph::ResourceHandle input, RenderGraph::ResourceHandle gBuffer)
+{
+	switch (Mode) {
+		case BoxFilterMode::Separable:
+			_separable.SetKernel(Filter, 5);
+			return _separable.Setup(graph, input, Name, { _outputScale, _format });
+		case BoxFilterMode::DualKawase:
+			return _kawase.Setup(graph, input, Name, { _outputScale, _format });
+		default:
+			return Effect::Setup(graph, input, gBuffer);
+	}
+}
+
 void BoxFilter5x5::RenderImGui()
 {
 	ImGui::PushID(this);
 
+	ENUM_COMBO("Mode", &Mode, BoxFilterMode);
+
+	// Give some idea of how the modes compare, the GPU time is shown by the settings window
+	switch (Mode) {
+		case BoxFilterMode::Direct:
+			ImGui::Text("Taps per pixel: 25");
+			break;
+		case BoxFilterMode::Separable:
+			_separable.SetKernel(Filter, 5);
+			ImGui::Text("Taps per pixel: %d", _separable.GetTapCount());
+			ImGui::Text("Approximation error: %.1f%%", _separable.GetError() * 100.0f);
+			break;
+		case BoxFilterMode::DualKawase:
+			ImGui::Text("Taps per pixel: %.1f", _kawase.GetTapCount());
+			LABEL_LEFT(ImGui::SliderInt, "Iterations", &_kawase.Iterations, 1, 8);
+			LABEL_LEFT(ImGui::SliderFloat, "Offset", &_kawase.Offset, 0.5f, 4.0f);
+			ImGui::PopID();
+			// The kernel isn't used by the Kawase blur
+			return;
+	}
+
 	ImGui::Columns(5); 
 	for (int iy = 0; iy < 5; iy++) { 
 		for (int ix = 0; ix < 5; ix++) {
@@ -78,6 +115,9 @@ BoxFilter5x5::Sptr BoxFilter5x5::FromJson(const nlohmann::json& data)
 {
 	BoxFilter5x5::Sptr result = std::make_shared<BoxFilter5x5>();
 	result->Enabled = JsonGet(data, "enabled", true);
+	result->Mode = JsonParseEnum(BoxFilterMode, data, "mode", BoxFilterMode::Direct);
+	result->_kawase.Iterations = JsonGet(data, "kawase_iterations", result->_kawase.Iterations);
+	result->_kawase.Offset = JsonGet(data, "kawase_offset", result->_kawase.Offset);
 	std::vector<float> filter = JsonGet(data, "filter", std::vector<float>(25, 0.0f));
 	for (int ix = 0; ix < 25; ix++) {
 		result->Filter[ix] = filter[ix];
@@ -93,6 +133,9 @@ nlohmann::json BoxFilter5x5::ToJson() const
 	}
 	return {
 		{ "enabled", Enabled },
+		{ "mode", ~Mode },
+		{ "kawase_iterations", _kawase.Iterations },
+		{ "kawase_offset", _kawase.Offset },
 		{ "filter", filter }
 	};
 }
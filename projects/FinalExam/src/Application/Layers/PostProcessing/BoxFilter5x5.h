@@ -3,16 +3,21 @@
 #include "Graphics/ShaderProgram.h"
 #include "Graphics/Textures/Texture3D.h"
 #include "Graphics/Framebuffer.h"
+#include "BoxFilterMode.h"
+#include "SeparableFilter.h"
+#include "DualKawaseBlur.h"
 
 class BoxFilter5x5 : public PostProcessingLayer::Effect {
 public:
 	MAKE_PTRS(BoxFilter5x5);
 	float Filter[25];
+	BoxFilterMode Mode;
 
 	BoxFilter5x5();
 	virtual ~BoxFilter5x5();
 
 	virtual void Apply(const Framebuffer::Sptr& gBuffer) override;
+	virtual RenderGraph::ResourceHandle Setup(RenderGraph& graph, RenderGraph::ResourceHandle input, RenderGraph::ResourceHandle gBuffer) override;
 	virtual void RenderImGui() override;
 
 	// Inherited from IResource
@@ -22,4 +27,6 @@ public:
 
 protected:
 	ShaderProgram::Sptr _shader;
+	SeparableFilter     _separable;
+	DualKawaseBlur      _kawase;
 };
\ No newline at end of file
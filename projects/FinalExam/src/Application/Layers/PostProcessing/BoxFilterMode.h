@@ -0,0 +1,15 @@
+#pragma once
+#include <EnumToString.h>
+
+/**
+ * The ways that the box filters can be applied, for an NxN kernel
+ *    Direct     - Samples all N^2 taps in a single pass
+ *    Separable  - Splits the kernel into a horizontal and vertical pass (2N taps), approximating
+ *                 kernels that are not separable
+ *    DualKawase - Ignores the kernel and uses a dual Kawase blur, for large blur radii
+ */
+ENUM(BoxFilterMode, int,
+	Direct,
+	Separable,
+	DualKawase
+);
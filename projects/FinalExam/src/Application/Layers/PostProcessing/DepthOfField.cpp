@@ -7,15 +7,22 @@
 
 DepthOfField::DepthOfField() :
 	PostProcessingLayer::Effect(),
-	_shader(nullptr)
+	Mode(DepthOfFieldMode::FullResolution),
+	_shader(nullptr),
+	_upsampleShader(nullptr)
 {
 	Name = "Depth of Field";
 	_format = RenderTargetType::ColorRgb8;
+	_gBufferInputs = { { RenderTargetAttachment::Depth, 1 } };
 
 	_shader = ResourceManager::CreateAsset<ShaderProgram>(std::unordered_map<ShaderPartType, std::string>{
 		{ ShaderPartType::Vertex, "shaders/vertex_shaders/fullscreen_quad.glsl" },
 		{ ShaderPartType::Fragment, "shaders/fragment_shaders/post_effects/depth_of_field.glsl" }
 	});
+	_upsampleShader = ResourceManager::CreateAsset<ShaderProgram>(std::unordered_map<ShaderPartType, std::string>{
+		{ ShaderPartType::Vertex, "shaders/vertex_shaders/fullscreen_quad.glsl" },
+		{ ShaderPartType::Fragment, "shaders/fragment_shaders/post_effects/depth_of_field_upsample.glsl" }
+	});
 }
 
 DepthOfField::~DepthOfField() = default;
@@ -23,13 +30,45 @@ DepthOfField::~DepthOfField() = default;
 void DepthOfField::Apply(const Framebuffer::Sptr& gBuffer)
 {
 	_shader->Bind();
-	gBuffer->BindAttachment(RenderTargetAttachment::Depth, 1);
+}
+
+RenderGraph::ResourceHandle DepthOfField::Setup(RenderGraph& graph, RenderGraph::ResourceHandle input, RenderGraph::ResourceHandle gBuffer)
+{
+	if (Mode == DepthOfFieldMode::FullResolution) {
+		return Effect::Setup(graph, input, gBuffer);
+	}
+
+	// The blur stores the distance to the camera in alpha, so that the upsample can avoid bleeding across edges
+	RenderGraph::ResourceHandle blurred = graph.CreateTexture(Name + " Half Res", { _outputScale * 0.5f, RenderTargetType::ColorRgba16F });
+	RenderGraph::ResourceHandle output  = graph.CreateTexture(Name, { _outputScale, _format });
+
+	graph.AddPass(Name + ": Blur", {
+		{ input,   RenderTargetAttachment::Color0, 0 },
+		{ gBuffer, RenderTargetAttachment::Depth,  1 }
+	}, blurred, [this]() {
+		_shader->Bind();
+		DrawFullscreen();
+	});
+
+	graph.AddPass(Name + ": Upsample", {
+		{ input,   RenderTargetAttachment::Color0, 0 },
+		{ gBuffer, RenderTargetAttachment::Depth,  1 },
+		{ blurred, RenderTargetAttachment::Color0, 2 }
+	}, output, [this]() {
+		_upsampleShader->Bind();
+		DrawFullscreen();
+	});
+
+	return output;
 }
 
 void DepthOfField::RenderImGui()
 {
 	const auto& cam = Application::Get().CurrentScene()->MainCamera;
 
+	ENUM_COMBO("Mode", &Mode, DepthOfFieldMode);
+	ImGui::TextUnformatted(Mode == DepthOfFieldMode::HalfResolution ? "Blurred pixels: 1/4 + bilateral upsample" : "Blurred pixels: all");
+
 	if (cam != nullptr) {
 		ImGui::DragFloat("Focal Depth", &cam->FocalDepth, 0.1f, 0.1f, 100.0f);
 		ImGui::DragFloat("Lens Dist. ", &cam->LensDepth,  0.01f, 0.001f, 50.0f);
@@ -41,12 +80,14 @@ DepthOfField::Sptr DepthOfField::FromJson(const nlohmann::json& data)
 {
 	DepthOfField::Sptr result = std::make_shared<DepthOfField>();
 	result->Enabled = JsonGet(data, "enabled", true);
+	result->Mode = JsonParseEnum(DepthOfFieldMode, data, "mode", DepthOfFieldMode::FullResolution);
 	return result;
 }
 
 nlohmann::json DepthOfField::ToJson() const
 {
 	return {
-		{ "enabled", Enabled }
+		{ "enabled", Enabled },
+		{ "mode", ~Mode }
 	};
 }
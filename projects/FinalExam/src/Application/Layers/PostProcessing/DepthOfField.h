@@ -5,14 +5,27 @@
 #include "Graphics/Textures/Texture3D.h"
 #include "Graphics/Framebuffer.h"
 
+/**
+ * The resolution that the depth of field blur is calculated at
+ *    FullResolution - Gathers samples for every pixel on the screen
+ *    HalfResolution - Blurs at half resolution, and then upsamples with a depth-aware bilateral
+ *                     filter, keeping in-focus pixels at full resolution
+ */
+ENUM(DepthOfFieldMode, int,
+	FullResolution,
+	HalfResolution
+);
+
 class DepthOfField : public PostProcessingLayer::Effect {
 public:
 	MAKE_PTRS(DepthOfField);
+	DepthOfFieldMode Mode;
 
 	DepthOfField();
 	virtual ~DepthOfField();
 
 	virtual void Apply(const Framebuffer::Sptr& gBuffer) override;
+	virtual RenderGraph::ResourceHandle Setup(RenderGraph& graph, RenderGraph::ResourceHandle input, RenderGraph::ResourceHandle gBuffer) override;
 	virtual void RenderImGui() override;
 
 	// Inherited from IResource
@@ -22,4 +35,5 @@ public:
 
 protected:
 	ShaderProgram::Sptr _shader;
+	ShaderProgram::Sptr _upsampleShader;
 };
\ No newline at end of file
@@ -0,0 +1,78 @@
+#include "DualKawaseBlur.h"
+#include "Application/Layers/PostProcessingLayer.h"
+#include "Utils/ResourceManager/ResourceManager.h"
+
+DualKawaseBlur::DualKawaseBlur() :
+	Iterations(3),
+	Offset(1.0f),
+	_downsampleShader(nullptr),
+	_upsampleShader(nullptr)
+{
+	_downsampleShader = ResourceManager::CreateAsset<ShaderProgram>(std::unordered_map<ShaderPartType, std::string>{
+		{ ShaderPartType::Vertex, "shaders/vertex_shaders/fullscreen_quad.glsl" },
+		{ ShaderPartType::Fragment, "shaders/fragment_shaders/post_effects/kawase_downsample.glsl" }
+	});
+	_upsampleShader = ResourceManager::CreateAsset<ShaderProgram>(std::unordered_map<ShaderPartType, std::string>{
+		{ ShaderPartType::Vertex, "shaders/vertex_shaders/fullscreen_quad.glsl" },
+		{ ShaderPartType::Fragment, "shaders/fragment_shaders/post_effects/kawase_upsample.glsl" }
+	});
+}
+
+DualKawaseBlur::~DualKawaseBlur() = default;
+
+float DualKawaseBlur::GetTapCount() const
+{
+	// Downsampling takes 5 samples, upsampling takes 8, and each level has a quarter of the pixels of the last
+	float result = 0.0f;
+	float area = 1.0f;
+	for (int ix = 0; ix < Iterations; ix++) {
+		result += 8.0f * area;
+		area *= 0.25f;
+		result += 5.0f * area;
+	}
+	return result;
+}
+
+RenderGraph::ResourceHandle DualKawaseBlur::Setup(RenderGraph& graph, RenderGraph::ResourceHandle input, const std::string& name, const RenderGraph::TextureDescriptor& output)
+{
+	if (Iterations <= 0) {
+		return input;
+	}
+
+	RenderGraph::ResourceHandle current = input;
+	glm::vec2 scale = output.Scale;
+	float offset = Offset;
+
+	// Walk down the pyramid, the graph will recycle each level once the next one has been made
+	for (int ix = 0; ix < Iterations; ix++) {
+		scale *= 0.5f;
+		RenderGraph::ResourceHandle next = graph.CreateTexture(name + " Down " + std::to_string(ix), { scale, RenderTargetType::ColorRgb16F });
+		glm::vec2 halfPixel = 0.5f / glm::vec2(graph.GetSize(current));
+
+		graph.AddPass(name + ": Downsample", { { current, RenderTargetAttachment::Color0, 0 } }, next, [this, halfPixel, offset]() {
+			_downsampleShader->Bind();
+			_downsampleShader->SetUniform("u_HalfPixel", halfPixel);
+			_downsampleShader->SetUniform("u_Offset", offset);
+			PostProcessingLayer::Effect::DrawFullscreen();
+		});
+		current = next;
+	}
+
+	// And back up again, with the last level being written to the output format
+	for (int ix = Iterations - 1; ix >= 0; ix--) {
+		scale *= 2.0f;
+		RenderGraph::TextureDescriptor descriptor = ix == 0 ? output : RenderGraph::TextureDescriptor{ scale, RenderTargetType::ColorRgb16F };
+		RenderGraph::ResourceHandle next = graph.CreateTexture(ix == 0 ? name : name + " Up " + std::to_string(ix), descriptor);
+		glm::vec2 halfPixel = 0.5f / glm::vec2(graph.GetSize(current));
+
+		graph.AddPass(name + ": Upsample", { { current, RenderTargetAttachment::Color0, 0 } }, next, [this, halfPixel, offset]() {
+			_upsampleShader->Bind();
+			_upsampleShader->SetUniform("u_HalfPixel", halfPixel);
+			_upsampleShader->SetUniform("u_Offset", offset);
+			PostProcessingLayer::Effect::DrawFullscreen();
+		});
+		current = next;
+	}
+
+	return current;
+}
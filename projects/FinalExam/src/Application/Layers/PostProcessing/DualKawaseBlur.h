@@ -0,0 +1,43 @@
+#pragma once
+#include "Graphics/RenderGraph.h"
+#include "Graphics/ShaderProgram.h"
+
+/**
+ * A dual Kawase blur, which repeatedly downsamples the image to half resolution and then
+ * upsamples it back, with a small bilinear filter at each step. The blur radius roughly
+ * doubles with each iteration, while the cost stays close to a couple of fullscreen passes
+ *
+ * Based on "Bandwidth-Efficient Rendering" (Marius Bjorge, SIGGRAPH 2015)
+ */
+class DualKawaseBlur {
+public:
+	MAKE_PTRS(DualKawaseBlur);
+
+	// The number of times to downsample the image, each iteration doubles the blur radius
+	int   Iterations;
+	// Scales the sample offsets, larger values give a wider blur at the cost of some artifacts
+	float Offset;
+
+	DualKawaseBlur();
+	~DualKawaseBlur();
+
+	/**
+	 * Gets the number of texture samples taken per output pixel, counting the work done
+	 * at lower resolutions
+	 */
+	float GetTapCount() const;
+
+	/**
+	 * Adds the downsample and upsample passes to a render graph
+	 * @param graph The graph to add the passes to
+	 * @param input The image to blur
+	 * @param name The name to use for the passes and targets
+	 * @param output The scale and format of the blurred image
+	 * @returns The resource holding the blurred image
+	 */
+	RenderGraph::ResourceHandle Setup(RenderGraph& graph, RenderGraph::ResourceHandle input, const std::string& name, const RenderGraph::TextureDescriptor& output);
+
+protected:
+	ShaderProgram::Sptr _downsampleShader;
+	ShaderProgram::Sptr _upsampleShader;
+};
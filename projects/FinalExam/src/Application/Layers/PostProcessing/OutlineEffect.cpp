@@ -15,6 +15,10 @@ OutlineEffect::OutlineEffect() :
 {
 	Name = "Outline Effect";
 	_format = RenderTargetType::ColorRgb8;
+	_gBufferInputs = {
+		{ RenderTargetAttachment::Depth,  1 },
+		{ RenderTargetAttachment::Color1, 2 } // The normal buffer
+	};
 
 	_shader = ResourceManager::CreateAsset<ShaderProgram>(std::unordered_map<ShaderPartType, std::string>{
 		{ ShaderPartType::Vertex, "shaders/vertex_shaders/fullscreen_quad.glsl" },
@@ -34,8 +38,6 @@ void OutlineEffect::Apply(const Framebuffer::Sptr& gBuffer)
 	_shader->SetUniform("u_DepthNormThreshold", _depthNormalThreshold);
 	_shader->SetUniform("u_DepthNormThresholdScale", _depthNormalThresholdScale);
 	_shader->SetUniform("u_PixelSize", glm::vec2(1.0f) / (glm::vec2)gBuffer->GetSize());
-	gBuffer->BindAttachment(RenderTargetAttachment::Depth, 1);
-	gBuffer->BindAttachment(RenderTargetAttachment::Color1, 2); // The normal buffer
 }
 
 void OutlineEffect::RenderImGui()
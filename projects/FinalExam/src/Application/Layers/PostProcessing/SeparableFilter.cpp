@@ -0,0 +1,130 @@
+#include "SeparableFilter.h"
+#include "Application/Layers/PostProcessingLayer.h"
+#include "Utils/ResourceManager/ResourceManager.h"
+#include "Logging.h"
+
+SeparableFilter::SeparableFilter() :
+	_shader(nullptr),
+	_size(1),
+	_error(0.0f)
+{
+	memset(_horizontal, 0, sizeof(float) * MAX_TAPS);
+	memset(_vertical, 0, sizeof(float) * MAX_TAPS);
+	_horizontal[0] = 1.0f;
+	_vertical[0]   = 1.0f;
+
+	_shader = ResourceManager::CreateAsset<ShaderProgram>(std::unordered_map<ShaderPartType, std::string>{
+		{ ShaderPartType::Vertex, "shaders/vertex_shaders/fullscreen_quad.glsl" },
+		{ ShaderPartType::Fragment, "shaders/fragment_shaders/post_effects/separable_filter.glsl" }
+	});
+}
+
+SeparableFilter::~SeparableFilter() = default;
+
+void SeparableFilter::SetKernel(const float* kernel, int size)
+{
+	LOG_ASSERT(size > 0 && size <= MAX_TAPS && size % 2 == 1, "Kernel size must be odd and no larger than {}", MAX_TAPS);
+	_size = size;
+
+	// We want the rank 1 matrix (vertical * horizontal^T) closest to the kernel, which comes from its
+	// largest singular value. Power iteration converges quickly for kernels this small. Note that we
+	// start from a non-uniform vector so that kernels whose rows sum to 0 (ex: edge detection) work
+	float u[MAX_TAPS], v[MAX_TAPS];
+	for (int ix = 0; ix < size; ix++) {
+		v[ix] = 1.0f + 0.1f * ix;
+	}
+
+	float sigma = 0.0f;
+	for (int iteration = 0; iteration < 32; iteration++) {
+		// u = Kv
+		float length = 0.0f;
+		for (int iy = 0; iy < size; iy++) {
+			u[iy] = 0.0f;
+			for (int ix = 0; ix < size; ix++) {
+				u[iy] += kernel[iy * size + ix] * v[ix];
+			}
+			length += u[iy] * u[iy];
+		}
+		length = sqrtf(length);
+		if (length == 0.0f) break;
+		for (int iy = 0; iy < size; iy++) {
+			u[iy] /= length;
+		}
+
+		// v = K^T u, the length of v is our singular value
+		sigma = 0.0f;
+		for (int ix = 0; ix < size; ix++) {
+			v[ix] = 0.0f;
+			for (int iy = 0; iy < size; iy++) {
+				v[ix] += kernel[iy * size + ix] * u[iy];
+			}
+			sigma += v[ix] * v[ix];
+		}
+		sigma = sqrtf(sigma);
+		if (sigma == 0.0f) break;
+		for (int ix = 0; ix < size; ix++) {
+			v[ix] /= sigma;
+		}
+	}
+
+	// Split the singular value between both passes, and keep the weights positive for typical blurs
+	float uSum = 0.0f;
+	for (int ix = 0; ix < size; ix++) {
+		uSum += u[ix];
+	}
+	float sign  = uSum < 0.0f ? -1.0f : 1.0f;
+	float scale = sqrtf(sigma);
+	for (int ix = 0; ix < size; ix++) {
+		_vertical[ix]   = u[ix] * scale * sign;
+		_horizontal[ix] = v[ix] * scale * sign;
+	}
+
+	// Track how far off our approximation is so we can show it to the user
+	float errorSum = 0.0f, kernelSum = 0.0f;
+	for (int iy = 0; iy < size; iy++) {
+		for (int ix = 0; ix < size; ix++) {
+			float value = kernel[iy * size + ix];
+			float delta = value - _vertical[iy] * _horizontal[ix];
+			errorSum  += delta * delta;
+			kernelSum += value * value;
+		}
+	}
+	_error = kernelSum > 0.0f ? sqrtf(errorSum / kernelSum) : 0.0f;
+}
+
+float SeparableFilter::GetError() const
+{
+	return _error;
+}
+
+int SeparableFilter::GetTapCount() const
+{
+	return _size * 2;
+}
+
+RenderGraph::ResourceHandle SeparableFilter::Setup(RenderGraph& graph, RenderGraph::ResourceHandle input, const std::string& name, const RenderGraph::TextureDescriptor& output)
+{
+	// The intermediate result is stored as floating point, since kernels may have negative weights
+	RenderGraph::ResourceHandle horizontal = graph.CreateTexture(name + " Horizontal", { output.Scale, RenderTargetType::ColorRgb16F });
+	RenderGraph::ResourceHandle result     = graph.CreateTexture(name, output);
+
+	glm::vec2 inputPixel = 1.0f / glm::vec2(graph.GetSize(input));
+	glm::vec2 outputPixel = 1.0f / glm::vec2(graph.GetSize(horizontal));
+
+	graph.AddPass(name + ": Horizontal", { { input, RenderTargetAttachment::Color0, 0 } }, horizontal, [this, inputPixel]() {
+		_shader->Bind();
+		_shader->SetUniform("u_Kernel", _horizontal, MAX_TAPS);
+		_shader->SetUniform("u_TapCount", _size);
+		_shader->SetUniform("u_Direction", glm::vec2(inputPixel.x, 0.0f));
+		PostProcessingLayer::Effect::DrawFullscreen();
+	});
+	graph.AddPass(name + ": Vertical", { { horizontal, RenderTargetAttachment::Color0, 0 } }, result, [this, outputPixel]() {
+		_shader->Bind();
+		_shader->SetUniform("u_Kernel", _vertical, MAX_TAPS);
+		_shader->SetUniform("u_TapCount", _size);
+		_shader->SetUniform("u_Direction", glm::vec2(0.0f, outputPixel.y));
+		PostProcessingLayer::Effect::DrawFullscreen();
+	});
+
+	return result;
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include "Graphics/RenderGraph.h"
+#include "Graphics/ShaderProgram.h"
+
+/**
+ * Applies a square convolution kernel as a horizontal pass followed by a vertical pass, which
+ * takes 2N texture samples per pixel instead of N^2. Kernels that are not separable are replaced
+ * by their closest separable approximation, see GetError
+ */
+class SeparableFilter {
+public:
+	MAKE_PTRS(SeparableFilter);
+
+	// The largest kernel width that the shader supports
+	static const int MAX_TAPS = 15;
+
+	SeparableFilter();
+	~SeparableFilter();
+
+	/**
+	 * Factorizes a kernel into a horizontal and vertical kernel
+	 * @param kernel The kernel weights, stored row by row
+	 * @param size The width and height of the kernel, should be odd and no larger than MAX_TAPS
+	 */
+	void SetKernel(const float* kernel, int size);
+
+	/**
+	 * Gets the relative error between the kernel and its separable approximation, this will be 0
+	 * for kernels that are separable (ex: box and gaussian filters)
+	 */
+	float GetError() const;
+	/**
+	 * Gets the number of texture samples taken per pixel
+	 */
+	int GetTapCount() const;
+
+	/**
+	 * Adds the horizontal and vertical passes to a render graph
+	 * @param graph The graph to add the passes to
+	 * @param input The image to filter
+	 * @param name The name to use for the passes and targets
+	 * @param output The scale and format of the filtered image
+	 * @returns The resource holding the filtered image
+	 */
+	RenderGraph::ResourceHandle Setup(RenderGraph& graph, RenderGraph::ResourceHandle input, const std::string& name, const RenderGraph::TextureDescriptor& output);
+
+protected:
+	ShaderProgram::Sptr _shader;
+	float _horizontal[MAX_TAPS];
+	float _vertical[MAX_TAPS];
+	int   _size;
+	float _error;
+};
@@ -14,7 +14,7 @@ PostProcessingLayer::PostProcessingLayer() :
 {
 	Name = "Post Processing";
 	Overrides =
-		AppLayerFunctions::OnAppLoad |
+		AppLayerFunctions::OnAppLoad | AppLayerFunctions::OnAppUnload |
 		AppLayerFunctions::OnSceneLoad | AppLayerFunctions::OnSceneUnload | 
 		AppLayerFunctions::OnPostRender |
 		AppLayerFunctions::OnWindowResize;
@@ -37,18 +37,8 @@ void PostProcessingLayer::OnAppLoad(const nlohmann::json& config)
 
 	GetEffect<OutlineEffect>()->Enabled = false;
 
-	Application& app = Application::Get();
-	const glm::uvec4& viewport = app.GetPrimaryViewport();
-
-	// Initialize all the effect's output FBOs (inefficient) 
-	for (const auto& effect : _effects) {
-		FramebufferDescriptor fboDesc = FramebufferDescriptor();
-		fboDesc.Width  = viewport.z * effect->_outputScale.x;
-		fboDesc.Height = viewport.w * effect->_outputScale.y;
-		fboDesc.RenderTargets[RenderTargetAttachment::Color0] = RenderTargetDescriptor(effect->_format);
-
-		effect->_output = std::make_shared<Framebuffer>(fboDesc);
-	}
+	// Render targets for the effects are allocated by the graph as needed
+	_graph = std::make_shared<RenderGraph>();
 
 	// We need a mesh for drawing fullscreen quads
 	glm::vec2 positions[6] = {
@@ -63,6 +53,14 @@ void PostProcessingLayer::OnAppLoad(const nlohmann::json& config)
 	_quadVAO->AddVertexBuffer(vbo, {
 		BufferAttribute(0, 2, AttributeType::Float, sizeof(glm::vec2), 0, AttribUsage::Position)
 	});
+
+	_capture = std::make_shared<FrameCapture>();
+}
+
+void PostProcessingLayer::OnAppUnload()
+{
+	// Make sure any in flight frames get written while we still have a context
+	_capture->Stop();
 }
 
 void PostProcessingLayer::OnPostRender()
@@ -72,11 +70,22 @@ void PostProcessingLayer::OnPostRender()
 
 	// Grab the render layer from the app, get it's output and the G-Buffer
 	const RenderLayer::Sptr& renderer = app.GetLayer<RenderLayer>();
-	const Framebuffer::Sptr& output = renderer->GetRenderOutput();
-	const Framebuffer::Sptr& gBuffer = renderer->GetGBuffer();
 
-	// Stores the input FBO to the effect, we start with the renderlayer's output 
-	Framebuffer::Sptr current = output;
+	// Build the graph for this frame, we start with the renderlayer's output
+	_graph->Reset({ viewport.z, viewport.w });
+	RenderGraph::ResourceHandle gBuffer = _graph->Import("G-Buffer", renderer->GetGBuffer());
+	RenderGraph::ResourceHandle current = _graph->Import("Scene Color", renderer->GetRenderOutput());
+
+	// Disabled effects never make it into the graph
+	for (const auto& effect : _effects) {
+		if (effect->Enabled) {
+			_graph->SetGroup(effect->Name);
+			current = effect->Setup(*_graph, current, gBuffer);
+		}
+	}
+
+	// The last pass will render directly to the screen if it can, otherwise the graph blits it
+	_graph->SetOutput(current, viewport, PresentToScreen);
 
 	// Disable depth testing and depth writing, as well as blending
 	glDisable(GL_DEPTH_TEST);
@@ -85,53 +94,25 @@ void PostProcessingLayer::OnPostRender()
 
 	// Bind the quad VAO so our effects can use it
 	_quadVAO->Bind();
+	_graph->Execute();
+	_quadVAO->Unbind();
 
-	// Iterate over all the effects in the queue
-	for (const auto& effect : _effects) {
-		// Only render if it's enabled
-		if (effect->Enabled) {
-			// Bind the FBO and make sure we're rendering to the whole thing
-			effect->_output->Bind();
-			glViewport(0, 0, effect->_output->GetWidth(), effect->_output->GetHeight());
-
-			// Bind color 0 from previous pass to texture slot 0 so our effects can access
-			current->BindAttachment(RenderTargetAttachment::Color0, 0);
-
-			// Apply the effect and render the fullscreen quad
-			effect->Apply(gBuffer);
-			_quadVAO->Draw();
-
-			// Unbind output and set it as input for next pass
-			effect->_output->Unbind();
-			current = effect->_output;
+	// Store the result so that other layers can read from it
+	_finalOutput = _graph->GetFramebuffer(current);
+
+	// Queue a readback of the final image, if it went straight to the screen we read it from there
+	if (_capture->IsRecording()) {
+		GLuint depthSource = renderer->GetRenderOutput()->GetHandle();
+		if (_finalOutput != nullptr) {
+			_capture->Capture(_finalOutput->GetHandle(), glm::ivec4(0, 0, _finalOutput->GetWidth(), _finalOutput->GetHeight()), depthSource);
+		} else {
+			// The render output holds just the viewport's image, so its depth starts at the bottom left
+			_capture->Capture(0, glm::ivec4(viewport), depthSource, -1, glm::ivec2(0));
 		}
 	}
-	_quadVAO->Unbind();
 
 	// Restore viewport to game viewport
 	glViewport(viewport.x, viewport.y, viewport.z, viewport.w);
-
-	// Bind the output of our post processing as the source for the blit
-	current->Bind(FramebufferBinding::Read);
-	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
-
-	// Blit the color buffer to our game window
-	current->Blit(
-		{ 0, 0, current->GetWidth(), current->GetHeight() },
-		{ viewport.x, viewport.y, viewport.x + viewport.z, viewport.y + viewport.w },
-		BufferFlags::Color,
-		MagFilter::Linear
-	);
-
-	gBuffer->Bind(FramebufferBinding::Read);
-	current->Blit(
-		{ 0, 0, gBuffer->GetWidth(), gBuffer->GetHeight() },
-		{ viewport.x, viewport.y, viewport.x + viewport.z, viewport.y + viewport.w },
-		BufferFlags::Depth,
-		MagFilter::Nearest
-	);
-
-	gBuffer->Unbind();
 }
 
 void PostProcessingLayer::OnSceneLoad()
@@ -152,7 +133,6 @@ void PostProcessingLayer::OnWindowResize(const glm::ivec2& oldSize, const glm::i
 {
 	for (const auto& effect : _effects) {
 		effect->OnWindowResize(oldSize, newSize);
-		effect->_output->Resize(newSize.x, newSize.y);
 	}
 }
 
@@ -161,6 +141,39 @@ const std::vector<PostProcessingLayer::Effect::Sptr>& PostProcessingLayer::GetEf
 	return _effects;
 }
 
+const Framebuffer::Sptr& PostProcessingLayer::GetOutput() const
+{
+	return _finalOutput;
+}
+
+const RenderGraph::Sptr& PostProcessingLayer::GetRenderGraph() const
+{
+	return _graph;
+}
+
+const FrameCapture::Sptr& PostProcessingLayer::GetFrameCapture() const
+{
+	return _capture;
+}
+
+RenderGraph::ResourceHandle PostProcessingLayer::Effect::Setup(RenderGraph& graph, RenderGraph::ResourceHandle input, RenderGraph::ResourceHandle gBuffer)
+{
+	RenderGraph::ResourceHandle output = graph.CreateTexture(Name, { _outputScale, _format });
+
+	std::vector<RenderGraph::PassInput> inputs = { { input, RenderTargetAttachment::Color0, 0 } };
+	for (const auto& binding : _gBufferInputs) {
+		inputs.push_back({ gBuffer, binding.first, binding.second });
+	}
+
+	Framebuffer::Sptr gBufferFbo = graph.GetFramebuffer(gBuffer);
+	graph.AddPass(Name, inputs, output, [this, gBufferFbo]() {
+		Apply(gBufferFbo);
+		DrawFullscreen();
+	});
+
+	return output;
+}
+
 void PostProcessingLayer::Effect::DrawFullscreen()
 {
 	glDrawArrays(GL_TRIANGLES, 0, 6);
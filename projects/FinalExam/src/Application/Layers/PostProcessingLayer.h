@@ -3,6 +3,10 @@
 #include "Application/ApplicationLayer.h"
 #include "Utils/Macros.h"
 #include "Graphics/VertexArrayObject.h"
+#include "Graphics/RenderGraph.h"
+#include "Graphics/FrameCapture.h"
+
+#include <typeindex>
 
 /**
  * The post processing layer will handle rendering effects after the primary
@@ -29,10 +33,21 @@ public:
 
 		/**
 		 * Overload this in derived classes to apply the effect. Texture slot 0
-		 * will contain the image from the previous pass
+		 * will contain the image from the previous pass, and any G-Buffer inputs
+		 * declared in _gBufferInputs will be bound to their slots
 		 * @param gBuffer The G-Buffer from the deferred rendering pipeline
 		 */
 		virtual void Apply(const Framebuffer::Sptr& gBuffer) = 0;
+		/**
+		 * Adds this effect's passes to the render graph. By default, this adds a single fullscreen
+		 * pass that invokes Apply, writing to a target with the effect's scale and format. Effects
+		 * that need multiple passes can override this
+		 * @param graph The graph to add passes to
+		 * @param input The result of the previous effect
+		 * @param gBuffer The G-Buffer from the deferred rendering pipeline
+		 * @returns The resource holding this effect's result
+		 */
+		virtual RenderGraph::ResourceHandle Setup(RenderGraph& graph, RenderGraph::ResourceHandle input, RenderGraph::ResourceHandle gBuffer);
 		/**
 		 * Allows this effect to perform logic when a new scene is loaded
 		 */
@@ -43,7 +58,7 @@ public:
 		virtual void OnSceneUnload() {}
 		/**
 		 * Allows this effect to perform additional logic when the window is resized
-		 * Note that the output framebuffer will already be resized by the post processing layer
+		 * Note that render targets are managed by the post processing layer's render graph
 		 */
 		virtual void OnWindowResize(const glm::ivec2& oldSize, const glm::ivec2& newSize) {}
 		/**
@@ -56,17 +71,17 @@ public:
 		 * state from the post processing layer, and cannot be used outside of
 		 * that context
 		 */
-		void DrawFullscreen();
+		static void DrawFullscreen();
 
 	protected:
 		friend class PostProcessingLayer;
 
-		// The output that this effect will render into
-		Framebuffer::Sptr _output = nullptr;
 		// The scaling between this effect's output and the screen size, default 1
 		glm::vec2 _outputScale = glm::vec2(1);
 		// The render target format for the effect's buffer
 		RenderTargetType _format = RenderTargetType::ColorRgba8;
+		// G-Buffer attachments that the default Setup will bind, and the texture slots to bind them to
+		std::vector<std::pair<RenderTargetAttachment, int>> _gBufferInputs;
 		
 		Effect() = default;
 	};
@@ -99,9 +114,31 @@ public:
 	 */
 	void AddEffect(const Effect::Sptr& effect);
 
+	/**
+	 * Gets the framebuffer holding the result of the last effect that ran this frame,
+	 * or the render layer's output if no effects are enabled. Note that this will be
+	 * nullptr if the final effect rendered directly to the screen (see PresentToScreen)
+	 */
+	const Framebuffer::Sptr& GetOutput() const;
+
+	/**
+	 * Gets the render graph used to schedule the effects
+	 */
+	const RenderGraph::Sptr& GetRenderGraph() const;
+
+	/**
+	 * Gets the frame capture that records this layer's output. While it is recording, the final
+	 * image (and optionally the scene depth) is read back at the end of every frame
+	 */
+	const FrameCapture::Sptr& GetFrameCapture() const;
+
+	// True if the result should be rendered to the default framebuffer, false to keep it offscreen
+	bool PresentToScreen = true;
+
 	// Inherited from ApplicationLayer
 
 	virtual void OnAppLoad(const nlohmann::json& config) override;
+	virtual void OnAppUnload() override;
 	virtual void OnPostRender() override;
 	virtual void OnSceneLoad() override;
 	virtual void OnSceneUnload() override;
@@ -112,4 +149,9 @@ protected:
 
 	std::vector<Effect::Sptr> _effects;
 	VertexArrayObject::Sptr _quadVAO;
+	// Rebuilt every frame from the enabled effects
+	RenderGraph::Sptr _graph;
+	// The output from the last pass of the previous OnPostRender
+	Framebuffer::Sptr _finalOutput;
+	FrameCapture::Sptr _capture;
 };
\ No newline at end of file
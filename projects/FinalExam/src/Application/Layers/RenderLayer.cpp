@@ -8,6 +8,7 @@
 #include "Gameplay/Components/ComponentManager.h"
 #include "Gameplay/Components/RenderComponent.h"
 #include "Gameplay/Components/Light.h"
+#include "PostProcessingLayer.h"
 
 // GLM math library
 #include <GLM/glm.hpp>
@@ -16,20 +17,69 @@
 #define GLM_ENABLE_EXPERIMENTAL
 #include <GLM/gtx/common.hpp> // for fmod (floating modulus)
 #include "Gameplay/Components/ShadowCamera.h"
+#include "Utils/JobSystem.h"
+#include "Utils/JsonGlmHelpers.h"
+#include "Utils/ResourceManager/ResourceManager.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <map>
+#include <tuple>
+#include <unordered_map>
 
 
 RenderLayer::RenderLayer() :
 	ApplicationLayer(),
 	_primaryFBO(nullptr),
-	_blitFbo(true),
+	_blitFbo(false),
 	_frameUniforms(nullptr),
 	_instanceUniforms(nullptr),
 	_renderFlags(RenderFlags::None),
-	_clearColor({ 0.1f, 0.1f, 0.1f, 1.0f })
+	_clearColor({ 0.1f, 0.1f, 0.1f, 1.0f }),
+	_occlusionCuller(std::make_shared<OcclusionCuller>()),
+	_occlusionCullingEnabled(true),
+	_occlusionCulledCount(0),
+	_dynamicResolution(DynamicResolutionSettings()),
+	_resolutionScale(1.0f),
+	_renderSize(glm::ivec2(0)),
+	_gpuFrameTime(0.0f),
+	_gpuTimers(),
+	_gpuTimerPending(),
+	_gpuTimerIndex(0),
+	_gpuTimerActive(false),
+	_texturePacker(std::make_shared<TextureArrayPacker>()),
+	_batchedShader(nullptr),
+	_batchingEnabled(true),
+	_batchBuffer(0),
+	_batchBufferSize(0),
+	_batchInstances(std::vector<BatchedInstance>()),
+	_batchedDrawCount(0),
+	_batchedInstanceCount(0),
+	_gpuCuller(nullptr),
+	_gpuCullingEnabled(true),
+	_gpuCulledShader(nullptr),
+	_gpuBatches(std::vector<GpuBatch>()),
+	_gpuBatchLookup(std::map<GpuBatchKey, uint32_t>()),
+	_gpuCommands(std::vector<GpuCuller::DrawCommand>()),
+	_gpuSlotOwners(std::vector<RenderComponent*>()),
+	_gpuSlotLastSeen(std::vector<uint32_t>()),
+	_gpuFrameIndex(0),
+	_impostorSettings(ImpostorSettings()),
+	_impostorAtlases(std::vector<ImpostorAtlas::Sptr>()),
+	_impostorEntries(std::vector<ImpostorEntry>()),
+	_impostorLookup(std::map<std::pair<Guid, Guid>, int>()),
+	_impostorBakeQueue(),
+	_impostorShader(nullptr),
+	_impostorVao(0),
+	_impostorBuffer(0),
+	_impostorBufferSize(0),
+	_impostorInstances(std::vector<std::vector<ImpostorInstance>>()),
+	_impostorCount(0),
+	_impostorDrawCount(0)
 {
 	Name = "Rendering";
 	Overrides = 
-		AppLayerFunctions::OnAppLoad | 
+		AppLayerFunctions::OnAppLoad | AppLayerFunctions::OnAppUnload | AppLayerFunctions::OnSceneLoad |
 		AppLayerFunctions::OnPreRender | AppLayerFunctions::OnRender | AppLayerFunctions::OnPostRender | 
 		AppLayerFunctions::OnWindowResize;
 }
@@ -42,6 +92,13 @@ void RenderLayer::OnPreRender()
 
 	Application& app = Application::Get();
 
+	// Pick this frame's resolution before anything is drawn, then start timing the GPU work that it affects
+	_UpdateResolutionScale();
+	_gpuTimerActive = !_gpuTimerPending[_gpuTimerIndex];
+	if (_gpuTimerActive) {
+		glQueryCounter(_gpuTimers[_gpuTimerIndex][0], GL_TIMESTAMP);
+	}
+
 	// Clear the color and depth buffers
 	const glm::vec4 colors[4] = {
 		glm::vec4(0.0f),
@@ -52,7 +109,7 @@ void RenderLayer::OnPreRender()
 
 	_primaryFBO->Bind();
 	// Clear the framebuffer. Note that this also binds and sets the viewport
-	_ClearFramebuffer(_primaryFBO, colors, 4);
+	_ClearFramebuffer(_primaryFBO, colors, 4, _renderSize);
 
 	
 	// Grab shorthands to the camera and shader from the scene
@@ -104,14 +161,23 @@ void RenderLayer::OnRender(const Framebuffer::Sptr& prevLayer)
 	// Disable blending, we want to override any existing colors
 	glDisable(GL_BLEND);
 
-	// Grab shorthands to the camera and shader from the scene
-	Camera::Sptr camera = app.CurrentScene()->MainCamera;
+	// Work out what each view needs to draw before we start submitting anything
+	_PrepareFrame();
 
-	// We can now render all our scene elements via the helper function
-	_RenderScene(camera->GetView(), camera->GetProjection(), _primaryFBO->GetSize());
+	// We can now render all our scene elements via the helper function, only into the part of the
+	// G-buffer that we're using this frame
+	glViewport(0, 0, _renderSize.x, _renderSize.y);
+	_RenderScene(_views[0], _renderSize);
+	_RenderGpuCulled();
+	_RenderImpostors();
 
-	// Use our cubemap to draw our skybox
-	app.CurrentScene()->DrawSkybox();
+	// Build the Hi-Z pyramid from this frame's depth, the GPU culler tests next frame's objects against it
+	if (!_gpuCommands.empty()) {
+		_gpuCuller->BuildHiZ(_primaryFBO->GetTextureAttachment(RenderTargetAttachment::Depth)->GetHandle(), _renderSize, _views[0].ViewProjection);
+	}
+
+	// The skybox isn't drawn into the G-buffer, since it doesn't need lighting. It gets drawn once
+	// the scene has been composited, see _Composite
 
 	VertexArrayObject::Unbind(); 
 }
@@ -131,26 +197,32 @@ void RenderLayer::OnPostRender() {
 	// Restore viewport to game viewport
 	glViewport(viewport.x, viewport.y, viewport.z, viewport.w);
 
-	// Blit our depth to the primary framebuffer so that other rendering can use it
-	glBlitNamedFramebuffer(
-		_primaryFBO->GetHandle(), 0,
-		0, 0, _primaryFBO->GetWidth(), _primaryFBO->GetHeight(),
-		viewport.x, viewport.y, viewport.x + viewport.z, viewport.y + viewport.w,
-		GL_DEPTH_BUFFER_BIT,
-		GL_NEAREST
-	);
-
-	// TODO: post processing effects
+	// Later layers should depth test against the render output, this copy is only for anything that
+	// needs to draw straight to the screen with depth
+	if (_blitFbo) {
+		glBlitNamedFramebuffer(
+			_outputBuffer->GetHandle(), 0,
+			0, 0, _outputBuffer->GetWidth(), _outputBuffer->GetHeight(),
+			viewport.x, viewport.y, viewport.x + viewport.z, viewport.y + viewport.w,
+			GL_DEPTH_BUFFER_BIT,
+			GL_NEAREST
+		);
+	}
 
 	_outputBuffer->Unbind();
-	_outputBuffer->Bind(FramebufferBinding::Read);
-	Framebuffer::Blit(
-		{ 0, 0, _outputBuffer->GetWidth(), _outputBuffer->GetHeight() },
-		{ viewport.x, viewport.y, viewport.x + viewport.z, viewport.y + viewport.w },
-		BufferFlags::Color
-	);
 
-	_outputBuffer->Unbind();
+	// The post processing layer will handle getting our output to the screen, so we can skip the copy
+	PostProcessingLayer::Sptr postProcessing = app.GetLayer<PostProcessingLayer>();
+	if (postProcessing == nullptr || !postProcessing->Enabled) {
+		_outputBuffer->Bind(FramebufferBinding::Read);
+		Framebuffer::Blit(
+			{ 0, 0, _outputBuffer->GetWidth(), _outputBuffer->GetHeight() },
+			{ viewport.x, viewport.y, viewport.x + viewport.z, viewport.y + viewport.w },
+			BufferFlags::Color
+		);
+
+		_outputBuffer->Unbind();
+	}
 }
 
 void RenderLayer::_AccumulateLighting()
@@ -158,7 +230,7 @@ void RenderLayer::_AccumulateLighting()
 	using namespace Gameplay;
 
 	Application& app = Application::Get();
-	Scene::Sptr& scene = app.CurrentScene();
+	Scene::Sptr scene = app.CurrentScene();
 
 	Camera::Sptr camera = app.CurrentScene()->MainCamera;
 	const glm::mat4& view = camera->GetView();
@@ -174,7 +246,7 @@ void RenderLayer::_AccumulateLighting()
 		{ 0.0f, 0.0f, 0.0f, 1.0f } // specular (additive)
 	};
 	_lightingFBO->Bind();
-	_ClearFramebuffer(_lightingFBO, colors, 2);
+	_ClearFramebuffer(_lightingFBO, colors, 2, _renderSize);
 
 	glEnable(GL_BLEND);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE); 
@@ -195,7 +267,7 @@ void RenderLayer::_AccumulateLighting()
 	int ix = 0;
 	app.CurrentScene()->Components().Each<Light>([&](const Light::Sptr& light) {
 		// Get the light's position in view space, since we're doing view space lighting
-		glm::vec4 pos = glm::vec4(light->GetGameObject()->GetWorldPosition(), 1.0f);
+		glm::vec4 pos = light->GetGameObject()->GetRenderTransform()[3];
 		pos = view * pos;
 
 		// Copy to the ubo data
@@ -231,14 +303,15 @@ void RenderLayer::_AccumulateLighting()
 		_fullscreenQuad->Draw();
 	}
 
-	// Re-render the scene for shadows
+	// Re-render the scene for shadows, views were prepared in the same order that we visit the shadow cameras
+	size_t viewIx = 1;
 	app.CurrentScene()->Components().Each<ShadowCamera>([&](const ShadowCamera::Sptr& shadowCam) {
 		// Bind the shadow camera's depth buffer and clear it
 		shadowCam->GetDepthBuffer()->Bind();
 		glClear(GL_DEPTH_BUFFER_BIT);
 		glViewport(0, 0, shadowCam->GetBufferResolution().x, shadowCam->GetBufferResolution().y);
 
-		_RenderScene(shadowCam->GetGameObject()->GetInverseTransform(), shadowCam->GetProjection(), shadowCam->GetDepthBuffer()->GetSize());
+		_RenderScene(_views[viewIx++], shadowCam->GetDepthBuffer()->GetSize());
 
 		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
 	});
@@ -247,7 +320,7 @@ void RenderLayer::_AccumulateLighting()
 	_InitFrameUniforms();
 
 	_lightingFBO->Bind();
-	glViewport(0, 0, _lightingFBO->GetWidth(), _lightingFBO->GetHeight());
+	glViewport(0, 0, _renderSize.x, _renderSize.y);
 
 	// Bind our G-Buffer textures so that they're readable
 	_primaryFBO->GetTextureAttachment(RenderTargetAttachment::Depth)->Bind(0);  // depth
@@ -263,7 +336,7 @@ void RenderLayer::_AccumulateLighting()
 	app.CurrentScene()->Components().Each<ShadowCamera>([&](const ShadowCamera::Sptr& shadowCam) {
 
 		// This gets us the light -> view space matrix, which we'll inverse to go from view space to light space
-		glm::mat4 lightSpaceMatrix = camera->GetView() * shadowCam->GetGameObject()->GetTransform();
+		glm::mat4 lightSpaceMatrix = camera->GetView() * shadowCam->GetGameObject()->GetRenderTransform();
 
 		// Or we have a matrix to go from view space to shadow space
 		glm::mat4 viewToShadow = shadowCam->GetProjection() * glm::inverse(lightSpaceMatrix);
@@ -307,21 +380,36 @@ void RenderLayer::_Composite()
 	using namespace Gameplay;
 	Application& app = Application::Get();
 
-	Scene::Sptr& scene = app.CurrentScene();
+	Scene::Sptr scene = app.CurrentScene();
 
 	_AccumulateLighting();
 
-	// We want to switch to our compositing shader
+	// We want to switch to our compositing shader, which also handles upscaling if we've rendered below full resolution
 	_compositingShader->Bind();
+	_compositingShader->SetUniform("u_Sharpness", _renderSize != glm::ivec2(_primaryFBO->GetSize()) ? _dynamicResolution.Sharpness : 0.0f);
 
 	// Switch rendering to output
 	_outputBuffer->Bind();
 	glViewport(0, 0, _outputBuffer->GetWidth(), _outputBuffer->GetHeight());
 
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	// Depth gets overwritten by the copy below, so we only need to clear color
+	glClear(GL_COLOR_BUFFER_BIT);
 
-	// Disable blending, we want to override any existing colors
+	// Copy our depth from the G-buffer into the output, upscaling it if needed. This is the only copy of
+	// the scene's depth, everything after this reads or tests against the output's depth buffer
+	glBlitNamedFramebuffer(
+		_primaryFBO->GetHandle(), _outputBuffer->GetHandle(),
+		0, 0, _renderSize.x, _renderSize.y,
+		0, 0, _outputBuffer->GetWidth(), _outputBuffer->GetHeight(),
+		GL_DEPTH_BUFFER_BIT,
+		GL_NEAREST
+	);
+
+	// Disable blending, we want to override any existing colors. The composite skips far plane pixels
+	// itself, so there's no need for depth testing
 	glDisable(GL_BLEND);
+	glDisable(GL_DEPTH_TEST);
+	glDepthMask(false);
 
 	// Bind our albedo and lighting buffers so we can composite a final scene
 	_primaryFBO->GetTextureAttachment(RenderTargetAttachment::Color0)->Bind(0);
@@ -329,29 +417,29 @@ void RenderLayer::_Composite()
 	_lightingFBO->GetTextureAttachment(RenderTargetAttachment::Color0)->Bind(2); 
 	_lightingFBO->GetTextureAttachment(RenderTargetAttachment::Color1)->Bind(3);
 	_primaryFBO->GetTextureAttachment(RenderTargetAttachment::Color2)->Bind(4);  
+	_primaryFBO->GetTextureAttachment(RenderTargetAttachment::Depth)->Bind(5);
 	_fullscreenQuad->Draw(); 
 
 	// Re-enable depth testing
 	glEnable(GL_DEPTH_TEST);
+	glDepthMask(true);
 
-	// Blit our depth from primary FBO to our output depth buffer
-	glBlitNamedFramebuffer(
-		_primaryFBO->GetHandle(), _outputBuffer->GetHandle(),
-		0, 0, _primaryFBO->GetWidth(), _primaryFBO->GetHeight(),
-		0, 0, _outputBuffer->GetWidth(), _outputBuffer->GetHeight(),
-		GL_DEPTH_BUFFER_BIT,
-		GL_NEAREST
-	);
-
-	// Use our cubemap to draw our skybox
+	// Use our cubemap to draw our skybox, this only touches pixels that are still on the far plane
 	scene->DrawSkybox();
 
+	// Everything after this point runs at the window's resolution, so we stop timing here
+	if (_gpuTimerActive) {
+		glQueryCounter(_gpuTimers[_gpuTimerIndex][1], GL_TIMESTAMP);
+		_gpuTimerPending[_gpuTimerIndex] = true;
+	}
+	_gpuTimerIndex = (_gpuTimerIndex + 1) % GPU_TIMER_FRAMES;
+
 	_outputBuffer->Unbind();
 }
 
-void RenderLayer::_ClearFramebuffer(Framebuffer::Sptr& buffer, const glm::vec4* colors, int layers) {
-	// Make the entire buffer visible
-	glViewport(0, 0, buffer->GetWidth(), buffer->GetHeight());
+void RenderLayer::_ClearFramebuffer(Framebuffer::Sptr& buffer, const glm::vec4* colors, int layers, const glm::ivec2& size) {
+	// Only the region that we're rendering into needs to be cleared
+	glViewport(0, 0, size.x, size.y);
 	// Disable depth testing
 	glEnable(GL_DEPTH_TEST); 
 	// Enable depth writing
@@ -377,10 +465,15 @@ void RenderLayer::OnWindowResize(const glm::ivec2& oldSize, const glm::ivec2& ne
 {
 	if (newSize.x * newSize.y == 0) return;
 
-	// Set viewport and resize our primary FBO and light accumulation FBO
+	// Set viewport and resize our primary FBO and light accumulation FBO. These always stay at the full
+	// window size, dynamic resolution renders into a smaller region of them rather than reallocating
 	_primaryFBO->Resize(newSize);
 	_lightingFBO->Resize(newSize);
 	_outputBuffer->Resize(newSize);
+	_renderSize = glm::max(glm::ivec2(glm::round(glm::vec2(newSize) * _resolutionScale)), glm::ivec2(1));
+	if (_gpuCuller != nullptr) {
+		_gpuCuller->InvalidateHiZ();
+	}
 
 	// Update the main camera's projection
 	Application& app = Application::Get();
@@ -391,6 +484,25 @@ void RenderLayer::OnAppLoad(const nlohmann::json& config)
 {
 	Application& app = Application::Get();
 
+	if (config.contains(Name) && config[Name].contains("dynamic_resolution")) {
+		const nlohmann::json& blob = config[Name]["dynamic_resolution"];
+		_dynamicResolution.Enabled     = JsonGet(blob, "enabled", _dynamicResolution.Enabled);
+		_dynamicResolution.TargetGpuMs = JsonGet(blob, "target_gpu_ms", _dynamicResolution.TargetGpuMs);
+		_dynamicResolution.MinScale    = glm::clamp(JsonGet(blob, "min_scale", _dynamicResolution.MinScale), 0.1f, 1.0f);
+		_dynamicResolution.Sharpness   = JsonGet(blob, "sharpness", _dynamicResolution.Sharpness);
+	}
+	if (config.contains(Name)) {
+		_gpuCullingEnabled = JsonGet(config[Name], "gpu_culling", _gpuCullingEnabled);
+	}
+	if (config.contains(Name) && config[Name].contains("impostors")) {
+		const nlohmann::json& blob = config[Name]["impostors"];
+		_impostorSettings.Enabled    = JsonGet(blob, "enabled", _impostorSettings.Enabled);
+		_impostorSettings.ScreenSize = JsonGet(blob, "screen_size", _impostorSettings.ScreenSize);
+		_impostorSettings.FadeTime   = JsonGet(blob, "fade_time", _impostorSettings.FadeTime);
+		_impostorSettings.FrameSize  = glm::clamp(JsonGet(blob, "frame_size", _impostorSettings.FrameSize), 16u, 256u);
+		_impostorSettings.BakesPerFrame = glm::max(JsonGet(blob, "bakes_per_frame", _impostorSettings.BakesPerFrame), 1);
+	}
+
 	// GL states, we'll enable depth testing and backface fulling
 	glEnable(GL_DEPTH_TEST);
 	glEnable(GL_CULL_FACE);
@@ -427,6 +539,10 @@ void RenderLayer::OnAppLoad(const nlohmann::json& config)
 	fboDescriptor.RenderTargets[RenderTargetAttachment::Color0] = RenderTargetDescriptor(RenderTargetType::ColorRgba8);
 
 	_outputBuffer = std::make_shared<Framebuffer>(fboDescriptor);
+	_renderSize = _primaryFBO->GetSize();
+
+	// We use timestamps instead of GL_TIME_ELAPSED so that we can't conflict with queries in other systems
+	glCreateQueries(GL_TIMESTAMP, GPU_TIMER_FRAMES * 2, &_gpuTimers[0][0]);
 
 	// We'll use one shader for light accumulation for now
 	_lightAccumulationShader = ShaderProgram::Create();
@@ -449,6 +565,34 @@ void RenderLayer::OnAppLoad(const nlohmann::json& config)
 	_shadowShader->LoadShaderPartFromFile("shaders/fragment_shaders/shadow_composite.glsl", ShaderPartType::Fragment);
 	_shadowShader->Link();
 
+	// Batched materials all go through this shader, see Material::PackTextures
+	_batchedShader = ShaderProgram::Create();
+	_batchedShader->LoadShaderPartFromFile("shaders/vertex_shaders/basic_batched.glsl", ShaderPartType::Vertex);
+	_batchedShader->LoadShaderPartFromFile("shaders/fragment_shaders/deferred_forward_batched.glsl", ShaderPartType::Fragment);
+	_batchedShader->Link();
+	_batchedShader->SetDebugName("Deferred - Batched GBuffer Generation");
+	glCreateBuffers(1, &_batchBuffer);
+
+	// Batched objects are culled on the GPU where we can, otherwise everything stays on the CPU path
+	_gpuCuller = std::make_shared<GpuCuller>(sizeof(BatchedInstance));
+	if (_gpuCuller->IsValid()) {
+		_gpuCulledShader = ShaderProgram::Create();
+		_gpuCulledShader->LoadShaderPartFromFile("shaders/vertex_shaders/basic_gpu_culled.glsl", ShaderPartType::Vertex);
+		_gpuCulledShader->LoadShaderPartFromFile("shaders/fragment_shaders/deferred_forward_batched.glsl", ShaderPartType::Fragment);
+		_gpuCulledShader->Link();
+		_gpuCulledShader->SetDebugName("Deferred - GPU Culled GBuffer Generation");
+	} else {
+		_gpuCuller = nullptr;
+	}
+
+	_impostorShader = ShaderProgram::Create();
+	_impostorShader->LoadShaderPartFromFile("shaders/vertex_shaders/impostor.glsl", ShaderPartType::Vertex);
+	_impostorShader->LoadShaderPartFromFile("shaders/fragment_shaders/deferred_impostor.glsl", ShaderPartType::Fragment);
+	_impostorShader->Link();
+	_impostorShader->SetDebugName("Deferred - Impostors");
+	glCreateVertexArrays(1, &_impostorVao);
+	glCreateBuffers(1, &_impostorBuffer);
+
 	// We need a mesh for drawing fullscreen quads
 
 	glm::vec2 positions[6] = {
@@ -470,12 +614,85 @@ void RenderLayer::OnAppLoad(const nlohmann::json& config)
 	_lightingUbo = std::make_shared<UniformBuffer<LightingUboStruct>>(BufferUsage::DynamicDraw);
 }
 
+void RenderLayer::OnAppUnload()
+{
+	glDeleteQueries(GPU_TIMER_FRAMES * 2, &_gpuTimers[0][0]);
+	glDeleteBuffers(1, &_batchBuffer);
+	_texturePacker->Clear();
+	_gpuCuller = nullptr;
+	glDeleteBuffers(1, &_impostorBuffer);
+	glDeleteVertexArrays(1, &_impostorVao);
+	_impostorAtlases.clear();
+}
+
+void RenderLayer::OnSceneLoad()
+{
+	// Materials loaded from a file remember that they were batched, but not where their textures were packed,
+	// so we pack them again here. Ones that are already packed (ex: the default scene's) are left alone
+	ResourceManager::Each<Gameplay::Material>([&](const Gameplay::Material::Sptr& material) {
+		if (material->IsBatchRequested() && material->GetBatchShader() == nullptr) {
+			if (!material->PackTextures(*_texturePacker, _batchedShader)) {
+				LOG_WARN("Could not pack textures for material \"{}\", it will not be batched", material->Name);
+			}
+		}
+	});
+
+	// Bake the impostors the scene starts with up front, rather than stalling the first frames they're seen in
+	if (_impostorSettings.Enabled) {
+		Gameplay::Material::Sptr defaultMat = Application::Get().CurrentScene()->DefaultMaterial;
+		Application::Get().CurrentScene()->Components().Each<RenderComponent>([&](RenderComponent& renderable) {
+			const Gameplay::MeshResource::Sptr& mesh = renderable.GetMeshResource();
+			const Gameplay::Material::Sptr& material = renderable.GetMaterial() != nullptr ? renderable.GetMaterial() : defaultMat;
+			if (!renderable.UseImpostor || mesh == nullptr || mesh->Mesh == nullptr || material == nullptr) {
+				return;
+			}
+			if (mesh->IsBoundsStale()) {
+				mesh->CalculateBounds();
+			}
+			_GetImpostor(mesh, material);
+		}, true);
+		_BakeQueuedImpostors(-1);
+	}
+
+	// The old scene's components are gone, so none of their slots or batches can be reused
+	if (_gpuCuller != nullptr) {
+		_gpuCuller->Clear();
+	}
+	_gpuBatches.clear();
+	_gpuBatchLookup.clear();
+	_gpuCommands.clear();
+	_gpuSlotOwners.clear();
+	_gpuSlotLastSeen.clear();
+}
+
+nlohmann::json RenderLayer::GetDefaultConfig()
+{
+	DynamicResolutionSettings settings;
+	ImpostorSettings impostors;
+	return {
+		{ "gpu_culling", true },
+		{ "dynamic_resolution", {
+			{ "enabled", settings.Enabled },
+			{ "target_gpu_ms", settings.TargetGpuMs },
+			{ "min_scale", settings.MinScale },
+			{ "sharpness", settings.Sharpness }
+		}},
+		{ "impostors", {
+			{ "enabled", impostors.Enabled },
+			{ "screen_size", impostors.ScreenSize },
+			{ "fade_time", impostors.FadeTime },
+			{ "frame_size", impostors.FrameSize },
+			{ "bakes_per_frame", impostors.BakesPerFrame }
+		}}
+	};
+}
+
 const Framebuffer::Sptr& RenderLayer::GetPrimaryFBO() const {
 	return _primaryFBO;
 }
 
 bool RenderLayer::IsBlitEnabled() const {
-	return false;
+	return _blitFbo;
 }
 
 void RenderLayer::SetBlitEnabled(bool value) {
@@ -530,13 +747,14 @@ void RenderLayer::_InitFrameUniforms()
 	frameData.u_InvProjection = glm::inverse(camera->GetProjection());
 	frameData.u_View = camera->GetView();
 	frameData.u_ViewProjection = camera->GetViewProjection();
-	frameData.u_CameraPos = glm::vec4(camera->GetGameObject()->GetPosition(), 1.0f);
+	frameData.u_CameraPos = camera->GetGameObject()->GetRenderTransform()[3];
 	frameData.u_Time = static_cast<float>(Timing::Current().TimeSinceSceneLoad());
 	frameData.u_DeltaTime = Timing::Current().DeltaTime();
 	frameData.u_RenderFlags = _renderFlags;
 	frameData.u_ZNear = camera->GetNearPlane();
 	frameData.u_ZFar = camera->GetFarPlane();
-	frameData.u_Viewport = { 0.0f, 0.0f, _primaryFBO->GetWidth(), _primaryFBO->GetHeight() };
+	frameData.u_Viewport = { 0.0f, 0.0f, _renderSize.x, _renderSize.y };
+	frameData.u_RenderScale = glm::vec4(glm::vec2(_renderSize) / glm::vec2(_primaryFBO->GetSize()), glm::vec2(_renderSize));
 
 	frameData.u_Aperture   = camera->Aperture;
 	frameData.u_LensDepth  = camera->LensDepth;
@@ -544,72 +762,693 @@ void RenderLayer::_InitFrameUniforms()
 	_frameUniforms->Update();
 }
 
-void RenderLayer::_RenderScene(const glm::mat4& view, const glm::mat4& projection, const glm::ivec2& screenSize)
+void RenderLayer::_PrepareFrame()
 {
 	using namespace Gameplay;
 
 	Application& app = Application::Get();
-
-	glm::mat4 viewProj = projection * view;
-
-	// The current material that is bound for rendering
-	Material::Sptr currentMat = nullptr;
-	ShaderProgram::Sptr shader = nullptr;
-
 	Material::Sptr defaultMat = app.CurrentScene()->DefaultMaterial;
 
-	auto& frameData = _frameUniforms->GetData();
-	frameData.u_Projection = projection;
-	frameData.u_View = view;
-	frameData.u_ViewProjection = viewProj;
-	frameData.u_CameraPos = view * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
-	frameData.u_Viewport = { 0.0f, 0.0f, screenSize.x, screenSize.y };
-	_frameUniforms->Update();
-
-	// Render all our objects
-	app.CurrentScene()->Components().Each<RenderComponent>([&](const RenderComponent::Sptr& renderable) {
+	// Make sure any newly packed textures have their mip maps before we sample them
+	_texturePacker->Flush();
+
+	// Gather everything we need from the scene on the main thread, object transforms are calculated lazily
+	// and bounds need the GL context, so the jobs below can't safely do this themselves
+	_renderItems.clear();
+	std::unordered_map<Material*, uint32_t> materialKeys;
+	// Batched items can only share a draw if they have the same shader, texture pages and mesh
+	typedef std::tuple<ShaderProgram*, Texture2DArray*, Texture2DArray*, Texture2DArray*, Texture2DArray*, VertexArrayObject*> BatchKey;
+	std::map<BatchKey, uint32_t> batchKeys;
+	// Impostors requested since the scene loaded are spread over several frames
+	const size_t impostorCount = _impostorEntries.size();
+	_BakeQueuedImpostors(_impostorSettings.BakesPerFrame);
+	const bool gpuCulling = _gpuCuller != nullptr && _gpuCullingEnabled;
+	app.CurrentScene()->Components().Each<RenderComponent>([&](RenderComponent& renderable) {
 		// Early bail if mesh not set
-		if (renderable->GetMesh() == nullptr) {
+		if (renderable.GetMesh() == nullptr) {
 			return;
 		}
 
 		// If we don't have a material, try getting the scene's fallback material
 		// If none exists, do not draw anything
-		if (renderable->GetMaterial() == nullptr) {
+		if (renderable.GetMaterial() == nullptr) {
 			if (defaultMat != nullptr) {
-				renderable->SetMaterial(defaultMat);
+				renderable.SetMaterial(defaultMat);
 			}
 			else {
 				return;
 			}
 		}
 
-		// If the material has changed, we need to bind the new shader and set up our material and frame data
-		// Note: This is a good reason why we should be sorting the render components in ComponentManager
-		if (renderable->GetMaterial() != currentMat) {
-			currentMat = renderable->GetMaterial();
-			shader = currentMat->GetShader();
+		const MeshResource::Sptr& mesh = renderable.GetMeshResource();
+		if (mesh->IsBoundsStale()) {
+			mesh->CalculateBounds();
+		}
+
+		// Materials using the same shader get neighbouring keys, so sorting keeps shader switches to a minimum
+		Material* material = renderable.GetMaterial().get();
+		bool batched = _batchingEnabled && material->GetBatchShader() != nullptr;
+		uint32_t materialKey;
+		if (batched) {
+			const Material::TextureBatch& batch = material->GetTextureBatch();
+			BatchKey key = std::make_tuple(
+				material->GetBatchShader().get(),
+				batch.Pages[0].get(), batch.Pages[1].get(), batch.Pages[2].get(), batch.Pages[3].get(),
+				mesh->Mesh.get()
+			);
+			auto it = batchKeys.find(key);
+			if (it == batchKeys.end()) {
+				uint32_t shader = material->GetBatchShader()->GetHandle();
+				it = batchKeys.emplace(key, (shader << 16) | (uint32_t)((materialKeys.size() + batchKeys.size()) & 0xFFFF)).first;
+			}
+			materialKey = it->second;
+		} else {
+			auto it = materialKeys.find(material);
+			if (it == materialKeys.end()) {
+				uint32_t shader = material->GetShader()->GetHandle();
+				it = materialKeys.emplace(material, (shader << 16) | (uint32_t)((materialKeys.size() + batchKeys.size()) & 0xFFFF)).first;
+			}
+			materialKey = it->second;
+		}
+
+		RenderItem item;
+		item.Material    = material;
+		item.Mesh        = mesh->Mesh.get();
+		item.Transform   = renderable.GetGameObject()->GetRenderTransform();
+		item.BoundsMin   = mesh->GetBoundsMin();
+		item.BoundsMax   = mesh->GetBoundsMax();
+		item.HasBounds   = mesh->HasBounds();
+		item.OccluderTriangles = (renderable.IsOccluder && _occlusionCullingEnabled) ? &mesh->GetOccluderTriangles() : nullptr;
+		item.MaterialKey = materialKey;
+		item.Batched     = batched;
+		item.Impostor    = (_impostorSettings.Enabled && renderable.UseImpostor) ? _GetImpostor(mesh, renderable.GetMaterial()) : -1;
+		if (item.Impostor == -1) {
+			renderable._impostorFade = 0.0f;
+		}
+		item.ImpostorFade = item.Impostor != -1 ? &renderable._impostorFade : nullptr;
+		// Impostors and occluders need the CPU to know what's visible, so they stay on the CPU path
+		item.GpuCulled    = gpuCulling && batched && material->GetBatchShader() == _batchedShader &&
+			item.Impostor == -1 && item.OccluderTriangles == nullptr;
+		item.Renderable   = &renderable;
+		_renderItems.push_back(item);
+	});
+
+	// Baking impostors draws into their atlases, so we need to put the G-buffer back
+	if (_impostorEntries.size() != impostorCount) {
+		_primaryFBO->Bind();
+	}
+
+	// The main camera is always the first view, followed by all the shadow cameras
+	size_t viewCount = 1;
+	app.CurrentScene()->Components().Each<ShadowCamera>([&](ShadowCamera&) { viewCount++; });
+	_views.resize(viewCount);
+
+	Camera::Sptr camera = app.CurrentScene()->MainCamera;
+	_views[0].View       = camera->GetView();
+	_views[0].Projection = camera->GetProjection();
+	size_t viewIx = 1;
+	app.CurrentScene()->Components().Each<ShadowCamera>([&](const ShadowCamera::Sptr& shadowCam) {
+		_views[viewIx].View       = shadowCam->GetGameObject()->GetInverseRenderTransform();
+		_views[viewIx].Projection = shadowCam->GetProjection();
+		viewIx++;
+	});
+
+	const uint32_t itemCount = (uint32_t)_renderItems.size();
+	for (RenderView& view : _views) {
+		view.ViewProjection = view.Projection * view.View;
+
+		// Extract the clip planes from the rows of the view projection matrix (Gribb & Hartmann)
+		glm::mat4 m = glm::transpose(view.ViewProjection);
+		view.FrustumPlanes[0] = m[3] + m[0];
+		view.FrustumPlanes[1] = m[3] - m[0];
+		view.FrustumPlanes[2] = m[3] + m[1];
+		view.FrustumPlanes[3] = m[3] - m[1];
+		view.FrustumPlanes[4] = m[3] + m[2];
+		view.FrustumPlanes[5] = m[3] - m[2];
+
+		view.Instances.resize(itemCount);
+		view.SortKeys.resize(itemCount);
+		view.Visible.resize(itemCount);
+	}
+
+	// A fade time of 0 switches instantly
+	const float fadeStep = Timing::Current().DeltaTime() / glm::max(_impostorSettings.FadeTime, 0.0001f);
+
+	// Calculate per item data once, then cull and build instance data for every view
+	JobSystem::ParallelFor(itemCount, 64, [this, fadeStep](uint32_t start, uint32_t end) {
+		for (uint32_t ix = start; ix < end; ix++) {
+			RenderItem& item = _renderItems[ix];
+			item.NormalMatrix = glm::mat3(glm::transpose(glm::inverse(item.Transform)));
+
+			// Transform the bounds into world space by projecting the extents onto each axis
+			glm::vec3 center  = (item.BoundsMin + item.BoundsMax) * 0.5f;
+			glm::vec3 extents = (item.BoundsMax - item.BoundsMin) * 0.5f;
+			glm::mat3 rotScale = glm::mat3(item.Transform);
+			item.WorldCenter  = glm::vec3(item.Transform * glm::vec4(center, 1.0f));
+			item.WorldExtents =
+				glm::abs(rotScale[0]) * extents.x +
+				glm::abs(rotScale[1]) * extents.y +
+				glm::abs(rotScale[2]) * extents.z;
+
+			// Fade towards the impostor once the object is small enough on the main camera's screen. Objects
+			// sitting between the two thresholds keep fading whichever way they're closest to, so that they
+			// don't flicker back and forth
+			if (item.ImpostorFade != nullptr) {
+				const RenderView& mainView = _views[0];
+				float distance = glm::length(glm::vec3(mainView.View * glm::vec4(item.WorldCenter, 1.0f)));
+				float radius = glm::length(item.WorldExtents);
+				float screenSize = distance > radius ? (radius * mainView.Projection[1][1]) / distance : 1.0f;
+
+				float& fade = *item.ImpostorFade;
+				bool toImpostor =
+					screenSize < _impostorSettings.ScreenSize ||
+					(screenSize < _impostorSettings.ScreenSize * 1.1f && fade >= 0.5f);
+				fade = glm::clamp(fade + (toImpostor ? fadeStep : -fadeStep), 0.0f, 1.0f);
+			}
+
+			for (RenderView& view : _views) {
+				// The main camera culls these on the GPU, see _RenderGpuCulled
+				if (item.GpuCulled && &view == &_views[0]) {
+					view.Visible[ix] = false;
+					continue;
+				}
+
+				bool visible = true;
+				if (item.HasBounds) {
+					for (int p = 0; p < 6 && visible; p++) {
+						const glm::vec4& plane = view.FrustumPlanes[p];
+						float radius = glm::dot(glm::abs(glm::vec3(plane)), item.WorldExtents);
+						visible = glm::dot(glm::vec3(plane), item.WorldCenter) + plane.w >= -radius;
+					}
+				}
+				view.Visible[ix] = visible;
+				if (!visible) continue;
+
+				InstanceLevelUniforms& instance = view.Instances[ix];
+				instance.u_Model = item.Transform;
+				instance.u_ModelView = view.View * item.Transform;
+				instance.u_ModelViewProjection = view.ViewProjection * item.Transform;
+				instance.u_NormalMatrix = item.NormalMatrix;
+				// Impostors are only used for the main camera, shadows always come from the mesh
+				instance.u_LodFade = glm::vec4((item.ImpostorFade != nullptr && &view == &_views[0]) ? *item.ImpostorFade : 0.0f, 0.0f, 0.0f, 0.0f);
+
+				// Within a material, draw front to back so that early depth testing can reject more fragments.
+				// Positive floats sort the same as their bit patterns, so the depth can go straight into the key
+				float depth = glm::max(-instance.u_ModelView[3].z, 0.0f);
+				uint32_t depthBits;
+				memcpy(&depthBits, &depth, sizeof(float));
+				view.SortKeys[ix] = ((uint64_t)item.MaterialKey << 32) | depthBits;
+			}
+		}
+	});
+
+	_OcclusionCull(_views[0]);
+	_GatherImpostors(_views[0]);
+	_PrepareGpuCulling();
+
+	// Sort each view's draw list, views are independent so each one can be its own job
+	JobSystem::ParallelFor((uint32_t)_views.size(), 1, [this, itemCount](uint32_t start, uint32_t end) {
+		for (uint32_t viewIx = start; viewIx < end; viewIx++) {
+			RenderView& view = _views[viewIx];
+			view.DrawList.clear();
+			for (uint32_t ix = 0; ix < itemCount; ix++) {
+				if (view.Visible[ix]) {
+					view.DrawList.push_back(ix);
+				}
+			}
+			std::sort(view.DrawList.begin(), view.DrawList.end(), [&view](uint32_t a, uint32_t b) {
+				return view.SortKeys[a] < view.SortKeys[b];
+			});
+		}
+	});
+}
 
+void RenderLayer::_OcclusionCull(RenderView& view)
+{
+	_occlusionCulledCount = 0;
+	if (!_occlusionCullingEnabled) return;
+
+	// Keep the occlusion buffer's aspect ratio matching the screen so pixels stay square
+	const int occlusionWidth = 256;
+	int occlusionHeight = (int)(occlusionWidth * _primaryFBO->GetHeight() / glm::max(_primaryFBO->GetWidth(), 1u));
+	int tiledHeight = (occlusionHeight + OcclusionCuller::TILE_SIZE - 1) / OcclusionCuller::TILE_SIZE * OcclusionCuller::TILE_SIZE;
+	if (_occlusionCuller->GetSize() != glm::ivec2(occlusionWidth, glm::max(tiledHeight, OcclusionCuller::TILE_SIZE))) {
+		_occlusionCuller->Resize(occlusionWidth, occlusionHeight);
+	}
+
+	// Occluders that were frustum culled can't hide anything on screen
+	const uint32_t itemCount = (uint32_t)_renderItems.size();
+	_occlusionCuller->BeginFrame(view.ViewProjection);
+	for (uint32_t ix = 0; ix < itemCount; ix++) {
+		const RenderItem& item = _renderItems[ix];
+		if (item.OccluderTriangles != nullptr && view.Visible[ix]) {
+			_occlusionCuller->RenderOccluder(item.Transform, *item.OccluderTriangles);
+		}
+	}
+	_occlusionCuller->EndFrame();
+	if (_occlusionCuller->GetStats().OccludersRendered == 0) return;
+
+	// Testing doesn't modify the culler, so we can spread it across the job system
+	std::atomic<int> culled(0);
+	JobSystem::ParallelFor(itemCount, 64, [&](uint32_t start, uint32_t end) {
+		int localCulled = 0;
+		for (uint32_t ix = start; ix < end; ix++) {
+			const RenderItem& item = _renderItems[ix];
+			if (!view.Visible[ix] || !item.HasBounds || item.OccluderTriangles != nullptr) continue;
+
+			if (!_occlusionCuller->IsVisible(item.WorldCenter, item.WorldExtents)) {
+				view.Visible[ix] = false;
+				localCulled++;
+			}
+		}
+		culled += localCulled;
+	});
+	_occlusionCulledCount = culled;
+}
+
+void RenderLayer::_RenderScene(const RenderView& view, const glm::ivec2& screenSize)
+{
+	using namespace Gameplay;
+
+	// The current material that is bound for rendering
+	Material* currentMat = nullptr;
+
+	auto& frameData = _frameUniforms->GetData();
+	frameData.u_Projection = view.Projection;
+	frameData.u_View = view.View;
+	frameData.u_ViewProjection = view.ViewProjection;
+	frameData.u_CameraPos = view.View * glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+	frameData.u_Viewport = { 0.0f, 0.0f, screenSize.x, screenSize.y };
+	_frameUniforms->Update();
+
+	// Gather the instance data for every batch in draw order, so that the whole view only needs one upload
+	_batchInstances.clear();
+	for (uint32_t ix : view.DrawList) {
+		const RenderItem& item = _renderItems[ix];
+		if (item.Batched) {
+			BatchedInstance instance;
+			instance.Model        = item.Transform;
+			instance.NormalMatrix = item.NormalMatrix;
+			instance.Layers       = item.Material->GetTextureBatch().Layers;
+			instance.Params       = glm::vec4(item.Material->Get<float>("u_Material.DiscardThreshold"), view.Instances[ix].u_LodFade.x, 0.0f, 0.0f);
+			_batchInstances.push_back(instance);
+		}
+	}
+	if (!_batchInstances.empty()) {
+		size_t size = _batchInstances.size() * sizeof(BatchedInstance);
+		// Orphan the buffer rather than waiting on the previous view to finish with it
+		_batchBufferSize = glm::max(_batchBufferSize, size);
+		glNamedBufferData(_batchBuffer, _batchBufferSize, nullptr, GL_STREAM_DRAW);
+		glNamedBufferSubData(_batchBuffer, 0, size, _batchInstances.data());
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, BATCH_SSBO_BINDING, _batchBuffer);
+	}
+
+	const bool isMainView = &view == &_views[0];
+	if (isMainView) {
+		_batchedDrawCount = 0;
+		_batchedInstanceCount = 0;
+	}
+
+	// Everything was culled and sorted in _PrepareFrame, so all that's left is to submit
+	uint32_t batchOffset = 0;
+	for (size_t drawIx = 0; drawIx < view.DrawList.size(); drawIx++) {
+		const RenderItem& item = _renderItems[view.DrawList[drawIx]];
+
+		// Batched items that can share a draw have the same key, and sorting put them next to each other
+		if (item.Batched) {
+			uint32_t count = 1;
+			while (drawIx + count < view.DrawList.size() && _renderItems[view.DrawList[drawIx + count]].MaterialKey == item.MaterialKey) {
+				count++;
+			}
+
+			const ShaderProgram::Sptr& shader = item.Material->GetBatchShader();
+			const Material::TextureBatch& batch = item.Material->GetTextureBatch();
 			shader->Bind();
-			currentMat->Apply();
+			shader->SetUniform("u_BaseInstance", (int)batchOffset);
+			for (int slot = 0; slot < Material::BATCHED_TEXTURE_COUNT; slot++) {
+				if (batch.Pages[slot] != nullptr) {
+					batch.Pages[slot]->Bind(slot);
+				} else {
+					ITexture::Unbind(slot);
+				}
+			}
+			item.Mesh->DrawInstanced(count);
+
+			if (isMainView) {
+				_batchedDrawCount++;
+				_batchedInstanceCount += count;
+			}
+
+			batchOffset += count;
+			drawIx += count - 1;
+
+			// We've changed shaders and stomped on texture slots, so the next material needs to be re-applied
+			currentMat = nullptr;
+			continue;
 		}
 
-		// Grab the game object so we can do some stuff with it
-		GameObject* object = renderable->GetGameObject();
+		// If the material has changed, we need to bind the new shader and set up our material and frame data
+		if (item.Material != currentMat) {
+			currentMat = item.Material;
+			currentMat->GetShader()->Bind();
+			currentMat->Apply();
+		}
 
 		// Use our uniform buffer for our instance level uniforms
-		auto& instanceData = _instanceUniforms->GetData();
-		instanceData.u_Model = object->GetTransform();
-		instanceData.u_ModelViewProjection = viewProj * object->GetTransform();
-		instanceData.u_ModelView = view * object->GetTransform();
-		instanceData.u_NormalMatrix = glm::mat3(glm::transpose(glm::inverse(object->GetTransform())));
+		_instanceUniforms->GetData() = view.Instances[view.DrawList[drawIx]];
 		_instanceUniforms->Update();
 
 		// Draw the object
-		renderable->GetMesh()->Draw();
+		item.Mesh->Draw();
+	}
+}
 
-	});
+void RenderLayer::_PrepareGpuCulling()
+{
+	using namespace Gameplay;
+
+	_gpuCommands.clear();
+	if (_gpuCuller == nullptr || !_gpuCullingEnabled) return;
+	_gpuFrameIndex++;
+
+	// Batched items that can share a draw have the same texture pages and mesh, so each of those gets a batch
+	const uint32_t itemCount = (uint32_t)_renderItems.size();
+	std::vector<uint32_t> itemBatches(itemCount);
+	for (GpuBatch& batch : _gpuBatches) {
+		batch.Count = 0;
+	}
+	for (uint32_t ix = 0; ix < itemCount; ix++) {
+		const RenderItem& item = _renderItems[ix];
+		if (!item.GpuCulled) continue;
+
+		const Material::TextureBatch& textures = item.Material->GetTextureBatch();
+		GpuBatchKey key = std::make_tuple(
+			textures.Pages[0].get(), textures.Pages[1].get(), textures.Pages[2].get(), textures.Pages[3].get(),
+			item.Mesh
+		);
+		auto it = _gpuBatchLookup.find(key);
+		if (it == _gpuBatchLookup.end()) {
+			it = _gpuBatchLookup.emplace(key, (uint32_t)_gpuBatches.size()).first;
+			_gpuBatches.push_back({ item.Material, item.Mesh, 0, 0, 0 });
+		}
+
+		// Any of the batch's materials will do for binding its pages, but it has to be one that's still alive
+		GpuBatch& batch = _gpuBatches[it->second];
+		batch.Material = item.Material;
+		batch.Count++;
+		itemBatches[ix] = it->second;
+	}
+
+	// Lay out each batch's range of the visible list, ranges grow by doubling so they rarely move
+	uint32_t first = 0;
+	uint32_t objectCount = 0;
+	for (GpuBatch& batch : _gpuBatches) {
+		while (batch.Capacity < batch.Count) {
+			batch.Capacity = std::max(batch.Capacity * 2, 16u);
+		}
+		batch.First = first;
+		first += batch.Capacity;
+		objectCount += batch.Count;
+
+		// Instance counts are filled in by the culling pass. Everything else is 0 for both indexed and
+		// non-indexed meshes, since the vertex shader offsets instances with u_BaseInstance. Empty batches
+		// are never drawn, and their mesh may have been deleted
+		_gpuCommands.push_back({ batch.Count > 0 ? batch.Mesh->GetDrawCount() : 0, 0, 0, 0, 0 });
+	}
+
+	// Each component keeps its slot for as long as it's drawn, and only rewrites it when its transform,
+	// material or batch changes, so a scene that isn't moving uploads nothing
+	for (uint32_t ix = 0; ix < itemCount; ix++) {
+		const RenderItem& item = _renderItems[ix];
+		if (!item.GpuCulled) continue;
+
+		RenderComponent::GpuSlot& slot = item.Renderable->_gpuSlot;
+		if (slot.Index >= _gpuSlotOwners.size() || _gpuSlotOwners[slot.Index] != item.Renderable) {
+			slot.Index = _gpuCuller->AllocateSlot();
+			if (slot.Index >= _gpuSlotOwners.size()) {
+				_gpuSlotOwners.resize(slot.Index + 1, nullptr);
+				_gpuSlotLastSeen.resize(slot.Index + 1, 0);
+			}
+			_gpuSlotOwners[slot.Index] = item.Renderable;
+			slot.Dirty = true;
+		}
+		_gpuSlotLastSeen[slot.Index] = _gpuFrameIndex;
+
+		const uint32_t batchIx = itemBatches[ix];
+		const GpuBatch& batch = _gpuBatches[batchIx];
+		const uint32_t transformVersion = item.Renderable->GetGameObject()->GetRenderTransformVersion();
+		const uint32_t materialVersion  = item.Material->GetVersion();
+
+		const bool transformChanged = slot.Dirty || slot.TransformVersion != transformVersion;
+		if (transformChanged || slot.Batch != batchIx || slot.First != batch.First) {
+			GpuCuller::CullObject object;
+			object.Center  = glm::vec4(item.WorldCenter, 1.0f);
+			object.Extents = glm::vec4(item.WorldExtents, 0.0f);
+			object.Batch   = glm::uvec4(batchIx, batch.First, item.HasBounds ? 0 : 1, 0);
+			_gpuCuller->SetCullObject(slot.Index, object);
+		}
+		if (transformChanged || slot.MaterialVersion != materialVersion) {
+			BatchedInstance instance;
+			instance.Model        = item.Transform;
+			instance.NormalMatrix = item.NormalMatrix;
+			instance.Layers       = item.Material->GetTextureBatch().Layers;
+			instance.Params       = glm::vec4(item.Material->Get<float>("u_Material.DiscardThreshold"), 0.0f, 0.0f, 0.0f);
+			_gpuCuller->SetDrawData(slot.Index, &instance);
+		}
+
+		slot.Batch            = batchIx;
+		slot.First            = batch.First;
+		slot.TransformVersion = transformVersion;
+		slot.MaterialVersion  = materialVersion;
+		slot.Dirty            = false;
+	}
+
+	// Anything that wasn't drawn this frame was deleted or disabled, so its slot can go to someone else
+	for (uint32_t ix = 0; ix < (uint32_t)_gpuSlotOwners.size(); ix++) {
+		if (_gpuSlotOwners[ix] != nullptr && _gpuSlotLastSeen[ix] != _gpuFrameIndex) {
+			_gpuCuller->FreeSlot(ix);
+			_gpuSlotOwners[ix] = nullptr;
+		}
+	}
+
+	_gpuCuller->Upload();
+	if (objectCount == 0) {
+		_gpuCommands.clear();
+		return;
+	}
+	_gpuCuller->SetCommands(_gpuCommands, first);
+}
+
+void RenderLayer::_RenderGpuCulled()
+{
+	using namespace Gameplay;
+
+	if (_gpuCommands.empty()) return;
 
+	// Everything the draws need is written by the culling pass, the CPU never finds out what was visible
+	_gpuCuller->Cull(_views[0].ViewProjection);
+	_gpuCuller->BindForDrawing(BATCH_SSBO_BINDING);
+
+	_gpuCulledShader->Bind();
+	for (size_t batchIx = 0; batchIx < _gpuBatches.size(); batchIx++) {
+		const GpuBatch& batch = _gpuBatches[batchIx];
+		if (batch.Count == 0) continue;
+
+		const Material::TextureBatch& textures = batch.Material->GetTextureBatch();
+		_gpuCulledShader->SetUniform("u_BaseInstance", (int)batch.First);
+		for (int slot = 0; slot < Material::BATCHED_TEXTURE_COUNT; slot++) {
+			if (textures.Pages[slot] != nullptr) {
+				textures.Pages[slot]->Bind(slot);
+			} else {
+				ITexture::Unbind(slot);
+			}
+		}
+		batch.Mesh->DrawIndirect(batchIx * sizeof(GpuCuller::DrawCommand));
+	}
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+int RenderLayer::_GetImpostor(const Gameplay::MeshResource::Sptr& mesh, const Gameplay::Material::Sptr& material)
+{
+	std::pair<Guid, Guid> key = std::make_pair(mesh->GetGUID(), material->GetGUID());
+	auto it = _impostorLookup.find(key);
+	if (it != _impostorLookup.end()) {
+		// Queued impostors are drawn as plain meshes until they've been baked
+		return it->second == IMPOSTOR_QUEUED ? -1 : it->second;
+	}
+
+	_impostorLookup[key] = IMPOSTOR_QUEUED;
+	_impostorBakeQueue.push_back(std::make_pair(mesh, material));
+	return -1;
+}
+
+int RenderLayer::_BakeQueuedImpostors(int limit)
+{
+	int baked = 0;
+	size_t ix = 0;
+	for (; ix < _impostorBakeQueue.size() && (limit < 0 || baked < limit); ix++) {
+		const Gameplay::MeshResource::Sptr& mesh = _impostorBakeQueue[ix].first;
+		const Gameplay::Material::Sptr& material = _impostorBakeQueue[ix].second;
+
+		// Remember meshes that can't have an impostor too, so we don't keep trying every frame
+		int result = -1;
+		float radius = glm::length(mesh->GetBoundsMax() - mesh->GetBoundsMin()) * 0.5f;
+		if (mesh->HasBounds() && radius > 0.0f) {
+			// Atlases are only added once all the others are full
+			if (_impostorAtlases.empty() || _impostorAtlases.back()->IsFull()) {
+				_impostorAtlases.push_back(std::make_shared<ImpostorAtlas>(_impostorSettings.FrameSize));
+				_impostorInstances.resize(_impostorAtlases.size());
+			}
+
+			ImpostorEntry entry;
+			entry.Atlas  = (int)_impostorAtlases.size() - 1;
+			entry.Slot   = _impostorAtlases.back()->Allocate();
+			entry.Center = (mesh->GetBoundsMin() + mesh->GetBoundsMax()) * 0.5f;
+			entry.Radius = radius;
+			_BakeImpostor(entry, mesh->Mesh.get(), material.get());
+
+			result = (int)_impostorEntries.size();
+			_impostorEntries.push_back(entry);
+			baked++;
+			LOG_INFO("Baked impostor for \"{}\" with material \"{}\"", mesh->Filename.empty() ? "Generated" : mesh->Filename, material->Name);
+		}
+
+		_impostorLookup[std::make_pair(mesh->GetGUID(), material->GetGUID())] = result;
+	}
+	_impostorBakeQueue.erase(_impostorBakeQueue.begin(), _impostorBakeQueue.begin() + ix);
+
+	return baked;
+}
+
+void RenderLayer::_BakeImpostor(const ImpostorEntry& entry, VertexArrayObject* mesh, Gameplay::Material* material)
+{
+	const ImpostorAtlas::Sptr& atlas = _impostorAtlases[entry.Atlas];
+	atlas->GetFramebuffer()->Bind();
+
+	// The material's own shader fills in the G-buffer data, which is exactly what the frames need
+	material->GetShader()->Bind();
+	material->Apply();
+
+	// The mesh is baked in model space, and never faded
+	InstanceLevelUniforms& instance = _instanceUniforms->GetData();
+	instance.u_Model        = glm::mat4(1.0f);
+	instance.u_NormalMatrix = glm::mat4(1.0f);
+	instance.u_LodFade      = glm::vec4(0.0f);
+
+	FrameLevelUniforms& frameData = _frameUniforms->GetData();
+	frameData.u_Projection = ImpostorAtlas::GetFrameProjection(entry.Radius);
+
+	for (uint32_t y = 0; y < atlas->GetFramesPerSide(); y++) {
+		for (uint32_t x = 0; x < atlas->GetFramesPerSide(); x++) {
+			glm::ivec4 viewport = atlas->GetFrameViewport(entry.Slot, x, y);
+			glm::mat4 view = ImpostorAtlas::GetFrameView(atlas->GetFrameDirection(x, y), entry.Center, entry.Radius);
+
+			frameData.u_View = view;
+			frameData.u_ViewProjection = frameData.u_Projection * view;
+			frameData.u_Viewport = glm::vec4(viewport);
+			_frameUniforms->Update();
+
+			instance.u_ModelView = view;
+			instance.u_ModelViewProjection = frameData.u_ViewProjection;
+			_instanceUniforms->Update();
+
+			glViewport(viewport.x, viewport.y, viewport.z, viewport.w);
+			mesh->Draw();
+		}
+	}
+
+	atlas->GetFramebuffer()->Unbind();
+}
+
+void RenderLayer::_GatherImpostors(RenderView& view)
+{
+	for (std::vector<ImpostorInstance>& instances : _impostorInstances) {
+		instances.clear();
+	}
+
+	glm::vec3 cameraPos = glm::vec3(glm::inverse(view.View)[3]);
+	const uint32_t itemCount = (uint32_t)_renderItems.size();
+	for (uint32_t ix = 0; ix < itemCount; ix++) {
+		const RenderItem& item = _renderItems[ix];
+		if (item.ImpostorFade == nullptr || *item.ImpostorFade <= 0.0f || !view.Visible[ix]) continue;
+
+		const ImpostorEntry& entry = _impostorEntries[item.Impostor];
+		ImpostorInstance instance;
+		instance.Model   = item.Transform;
+		instance.Bounds  = glm::vec4(entry.Center, entry.Radius);
+		instance.ViewDir = glm::vec4(glm::vec3(glm::inverse(item.Transform) * glm::vec4(cameraPos, 1.0f)) - entry.Center, 0.0f);
+		instance.Params  = glm::vec4(*item.ImpostorFade, (float)entry.Slot, 0.0f, 0.0f);
+		_impostorInstances[entry.Atlas].push_back(instance);
+
+		// Once the impostor has fully faded in, the mesh doesn't need to be drawn at all
+		if (*item.ImpostorFade >= 1.0f) {
+			view.Visible[ix] = false;
+		}
+	}
+}
+
+void RenderLayer::_RenderImpostors()
+{
+	_impostorCount = 0;
+	_impostorDrawCount = 0;
+	for (const std::vector<ImpostorInstance>& instances : _impostorInstances) {
+		_impostorCount += (int)instances.size();
+	}
+	if (_impostorCount == 0) return;
+
+	// Upload every atlas' instances one after the other, orphaning the buffer like the batched draws do
+	size_t size = _impostorCount * sizeof(ImpostorInstance);
+	_impostorBufferSize = glm::max(_impostorBufferSize, size);
+	glNamedBufferData(_impostorBuffer, _impostorBufferSize, nullptr, GL_STREAM_DRAW);
+	size_t offset = 0;
+	for (const std::vector<ImpostorInstance>& instances : _impostorInstances) {
+		if (!instances.empty()) {
+			glNamedBufferSubData(_impostorBuffer, offset * sizeof(ImpostorInstance), instances.size() * sizeof(ImpostorInstance), instances.data());
+			offset += instances.size();
+		}
+	}
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, IMPOSTOR_SSBO_BINDING, _impostorBuffer);
+
+	_impostorShader->Bind();
+	glBindVertexArray(_impostorVao);
+
+	int baseInstance = 0;
+	for (size_t atlasIx = 0; atlasIx < _impostorAtlases.size(); atlasIx++) {
+		const std::vector<ImpostorInstance>& instances = _impostorInstances[atlasIx];
+		if (instances.empty()) continue;
+
+		const ImpostorAtlas::Sptr& atlas = _impostorAtlases[atlasIx];
+		atlas->GetFramebuffer()->BindAttachment(RenderTargetAttachment::Color0, 0);
+		atlas->GetFramebuffer()->BindAttachment(RenderTargetAttachment::Color1, 1);
+		atlas->GetFramebuffer()->BindAttachment(RenderTargetAttachment::Color2, 2);
+		_impostorShader->SetUniform("u_BaseInstance", baseInstance);
+		_impostorShader->SetUniform("u_FramesPerSide", (int)atlas->GetFramesPerSide());
+		_impostorShader->SetUniform("u_SlotsPerSide", (int)atlas->GetSlotsPerSide());
+		glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (GLsizei)instances.size());
+
+		baseInstance += (int)instances.size();
+		_impostorDrawCount++;
+	}
+}
+
+const OcclusionCuller::Sptr& RenderLayer::GetOcclusionCuller() const
+{
+	return _occlusionCuller;
+}
+
+bool RenderLayer::IsOcclusionCullingEnabled() const
+{
+	return _occlusionCullingEnabled;
+}
+
+void RenderLayer::SetOcclusionCullingEnabled(bool value)
+{
+	_occlusionCullingEnabled = value;
+}
+
+int RenderLayer::GetOcclusionCulledCount() const
+{
+	return _occlusionCulledCount;
 }
 
 const UniformBuffer<RenderLayer::FrameLevelUniforms>::Sptr& RenderLayer::GetFrameUniforms() const
@@ -617,3 +1456,135 @@ const UniformBuffer<RenderLayer::FrameLevelUniforms>::Sptr& RenderLayer::GetFram
 	return _frameUniforms;
 }
 
+
+RenderLayer::DynamicResolutionSettings& RenderLayer::GetDynamicResolutionSettings()
+{
+	return _dynamicResolution;
+}
+
+float RenderLayer::GetResolutionScale() const
+{
+	return _resolutionScale;
+}
+
+const glm::ivec2& RenderLayer::GetRenderSize() const
+{
+	return _renderSize;
+}
+
+float RenderLayer::GetGpuFrameTime() const
+{
+	return _gpuFrameTime;
+}
+
+void RenderLayer::_UpdateResolutionScale()
+{
+	// The slot we're about to reuse holds our oldest timing, only read it if the GPU is done with it
+	bool hasSample = false;
+	float sample = 0.0f;
+	if (_gpuTimerPending[_gpuTimerIndex]) {
+		GLint available = 0;
+		glGetQueryObjectiv(_gpuTimers[_gpuTimerIndex][1], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available) {
+			GLuint64 start = 0, end = 0;
+			glGetQueryObjectui64v(_gpuTimers[_gpuTimerIndex][0], GL_QUERY_RESULT, &start);
+			glGetQueryObjectui64v(_gpuTimers[_gpuTimerIndex][1], GL_QUERY_RESULT, &end);
+			_gpuTimerPending[_gpuTimerIndex] = false;
+
+			// Timestamps are in nanoseconds
+			sample = static_cast<float>(end - start) / 1000000.0f;
+			hasSample = true;
+		}
+	}
+
+	if (hasSample) {
+		// Smooth out single frame spikes so the resolution doesn't jump around
+		_gpuFrameTime = _gpuFrameTime > 0.0f ? glm::mix(_gpuFrameTime, sample, 0.1f) : sample;
+	}
+
+	if (!_dynamicResolution.Enabled) {
+		_resolutionScale = 1.0f;
+	} else if (hasSample && _gpuFrameTime > 0.0f) {
+		// Most of what we're timing scales with the number of pixels, which goes with the square of the scale
+		float ratio = _dynamicResolution.TargetGpuMs / _gpuFrameTime;
+		float desired = _resolutionScale * glm::sqrt(ratio);
+
+		// Leave some room around the target so we aren't changing resolution every frame, and only move
+		// part of the way there since our timings are a few frames behind
+		if (glm::abs(1.0f - ratio) > 0.05f) {
+			_resolutionScale = glm::mix(_resolutionScale, desired, 0.2f);
+		}
+	}
+	_resolutionScale = glm::clamp(_resolutionScale, glm::min(_dynamicResolution.MinScale, 1.0f), 1.0f);
+
+	_renderSize = glm::max(glm::ivec2(glm::round(glm::vec2(_primaryFBO->GetSize()) * _resolutionScale)), glm::ivec2(1));
+}
+
+const TextureArrayPacker::Sptr& RenderLayer::GetTexturePacker() const
+{
+	return _texturePacker;
+}
+
+const ShaderProgram::Sptr& RenderLayer::GetBatchedShader() const
+{
+	return _batchedShader;
+}
+
+bool RenderLayer::IsBatchingEnabled() const
+{
+	return _batchingEnabled;
+}
+
+void RenderLayer::SetBatchingEnabled(bool value)
+{
+	_batchingEnabled = value;
+}
+
+int RenderLayer::GetBatchedDrawCount() const
+{
+	return _batchedDrawCount;
+}
+
+int RenderLayer::GetBatchedInstanceCount() const
+{
+	return _batchedInstanceCount;
+}
+
+RenderLayer::ImpostorSettings& RenderLayer::GetImpostorSettings()
+{
+	return _impostorSettings;
+}
+
+int RenderLayer::GetImpostorCount() const
+{
+	return _impostorCount;
+}
+
+int RenderLayer::GetImpostorDrawCount() const
+{
+	return _impostorDrawCount;
+}
+
+const std::vector<ImpostorAtlas::Sptr>& RenderLayer::GetImpostorAtlases() const
+{
+	return _impostorAtlases;
+}
+
+const GpuCuller::Sptr& RenderLayer::GetGpuCuller() const
+{
+	return _gpuCuller;
+}
+
+bool RenderLayer::IsGpuCullingEnabled() const
+{
+	return _gpuCullingEnabled;
+}
+
+void RenderLayer::SetGpuCullingEnabled(bool value)
+{
+	_gpuCullingEnabled = value;
+	// Last frame's depth may have been drawn without the objects we'd be culling
+	if (_gpuCuller != nullptr) {
+		_gpuCuller->InvalidateHiZ();
+	}
+}
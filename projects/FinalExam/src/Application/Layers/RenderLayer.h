@@ -1,12 +1,24 @@
 #pragma once
+#include <map>
 #include "../ApplicationLayer.h"
 #include "Graphics/Framebuffer.h"
 #include "Graphics/Buffers/UniformBuffer.h"
 #include "Graphics/ShaderProgram.h"
 #include "Graphics/VertexArrayObject.h"
+#include "Graphics/OcclusionCuller.h"
+#include "Graphics/ImpostorAtlas.h"
+#include "Graphics/GpuCuller.h"
+#include "Graphics/Textures/TextureArrayPacker.h"
+#include "Utils/GUID.hpp"
 
 #define MAX_LIGHTS 8
 
+class RenderComponent;
+namespace Gameplay {
+	class Material;
+	class MeshResource;
+}
+
 ENUM_FLAGS(RenderFlags, uint32_t,
 	None = 0,
 	EnableColorCorrection = 1 << 0
@@ -49,8 +61,8 @@ public:
 		float u_Aperture = 20.0f;
 
 		glm::vec4 u_Viewport;
-
-
+		// The fraction of the G-buffer that was rendered into (xy), and the size of that region in pixels (zw)
+		glm::vec4 u_RenderScale;
 	};
 
 	// Structure for our instance-level uniforms, matches layout from
@@ -65,6 +77,8 @@ public:
 		glm::mat4 u_ModelView;
 		// Normal Matrix for transforming normals
 		glm::mat4 u_NormalMatrix;
+		// x is how far the object has crossfaded to its impostor
+		glm::vec4 u_LodFade;
 	};
 
 	/// <summary>
@@ -93,6 +107,63 @@ public:
 		glm::mat4 EnvironmentRotation;
 	};
 
+	/// <summary>
+	/// Per instance data for batched draws, matches the layout in fragments/batched_instances.glsl
+	/// </summary>
+	struct BatchedInstance {
+		glm::mat4  Model;
+		// Padded to a mat4 to match std430 layout
+		glm::mat4  NormalMatrix;
+		// The layer of each of the material's textures, see Material::BATCHED_TEXTURE_NAMES
+		glm::ivec4 Layers;
+		// x is the material's discard threshold, y is how far the object has crossfaded to its impostor
+		glm::vec4  Params;
+	};
+
+	/// <summary>
+	/// Per instance data for impostor draws, matches the layout in fragments/impostor_common.glsl
+	/// </summary>
+	struct ImpostorInstance {
+		glm::mat4 Model;
+		// The center (xyz) and radius (w) of the mesh's bounding sphere, in model space
+		glm::vec4 Bounds;
+		// The direction from the center towards the camera, in model space
+		glm::vec4 ViewDir;
+		// x is how far the impostor has faded in, y is the impostor's slot in its atlas
+		glm::vec4 Params;
+	};
+
+	/// <summary>
+	/// Settings for swapping render components with UseImpostor set to impostors when they get small on screen
+	/// </summary>
+	struct ImpostorSettings {
+		bool     Enabled    = true;
+		// The size of the object's bounding sphere on screen, as a fraction of half the screen height,
+		// below which we switch to its impostor
+		float    ScreenSize = 0.05f;
+		// The time in seconds to crossfade between the mesh and its impostor
+		float    FadeTime   = 0.25f;
+		// The size of each baked frame in pixels, only used for atlases created after it is changed
+		uint32_t FrameSize  = 64;
+		// Impostors are baked when a scene loads, any that are needed after that (ex: objects added at
+		// runtime) are queued and baked at most this many per frame
+		int      BakesPerFrame = 2;
+	};
+
+	/// <summary>
+	/// Settings for dynamic resolution, which renders the G-buffer and lighting into a smaller region
+	/// of the render targets when the GPU is over budget, and upscales the result when compositing
+	/// </summary>
+	struct DynamicResolutionSettings {
+		bool  Enabled     = false;
+		// The GPU time we're aiming for the scene and lighting passes to take, in milliseconds
+		float TargetGpuMs = 12.0f;
+		// The smallest fraction of the window's width and height that we'll render at
+		float MinScale    = 0.5f;
+		// How strongly to sharpen the image when it has been upscaled, from 0 to 1
+		float Sharpness   = 0.5f;
+	};
+
 	RenderLayer();
 	virtual ~RenderLayer();
 
@@ -101,6 +172,10 @@ public:
 	/// </summary>
 	const Framebuffer::Sptr& GetPrimaryFBO() const;
 
+	/// <summary>
+	/// Whether the scene's depth is copied to the default framebuffer after compositing, for anything
+	/// that draws directly to the screen and needs to depth test against the scene. Off by default
+	/// </summary>
 	bool IsBlitEnabled() const;
 	void SetBlitEnabled(bool value);
 
@@ -111,18 +186,95 @@ public:
 	RenderFlags GetRenderFlags() const;
 
 	const Framebuffer::Sptr& GetLightingBuffer() const;
+	/// <summary>
+	/// Gets the composited scene. Its depth buffer holds the scene's depth at the window's resolution,
+	/// and should be used by anything after this layer instead of making its own copy
+	/// </summary>
 	const Framebuffer::Sptr& GetRenderOutput() const;
 	const Framebuffer::Sptr& GetGBuffer() const;
 
+	/// <summary>
+	/// Gets the CPU occlusion culler that objects visible to the main camera are tested against
+	/// </summary>
+	const OcclusionCuller::Sptr& GetOcclusionCuller() const;
+	bool IsOcclusionCullingEnabled() const;
+	void SetOcclusionCullingEnabled(bool value);
+	/// <summary>
+	/// Gets the number of objects that were hidden by occluders during the last frame
+	/// </summary>
+	int GetOcclusionCulledCount() const;
+
 	const UniformBuffer<FrameLevelUniforms>::Sptr& GetFrameUniforms() const;
 
+	/// <summary>
+	/// Gets the packer that batched materials should store their textures in
+	/// </summary>
+	const TextureArrayPacker::Sptr& GetTexturePacker() const;
+	/// <summary>
+	/// Gets the texture array version of the basic deferred shader (basic.glsl and deferred_forward.glsl),
+	/// materials using that shader can pass this to Material::PackTextures to be drawn in batches
+	/// </summary>
+	const ShaderProgram::Sptr& GetBatchedShader() const;
+	/// <summary>
+	/// When enabled, batched materials sharing texture pages and a mesh are drawn with a single instanced
+	/// draw, otherwise they are drawn one at a time like any other material
+	/// </summary>
+	bool IsBatchingEnabled() const;
+	void SetBatchingEnabled(bool value);
+	/// <summary>
+	/// Gets the number of instanced draws, and the number of objects drawn by them, for the main camera last frame
+	/// </summary>
+	int GetBatchedDrawCount() const;
+	int GetBatchedInstanceCount() const;
+
+	ImpostorSettings& GetImpostorSettings();
+	/// <summary>
+	/// Gets the number of impostors drawn for the main camera last frame, and the number of draws it took
+	/// </summary>
+	int GetImpostorCount() const;
+	int GetImpostorDrawCount() const;
+	/// <summary>
+	/// Gets the atlases that impostors have been baked into
+	/// </summary>
+	const std::vector<ImpostorAtlas::Sptr>& GetImpostorAtlases() const;
+
+	/// <summary>
+	/// Gets the GPU culler that batched objects are culled and drawn through, or nullptr if the
+	/// current context doesn't support it
+	/// </summary>
+	const GpuCuller::Sptr& GetGpuCuller() const;
+	/// <summary>
+	/// When enabled, batched objects seen by the main camera are frustum and occlusion culled on the GPU
+	/// and drawn with indirect draws, otherwise they go through the CPU path with everything else
+	/// </summary>
+	bool IsGpuCullingEnabled() const;
+	void SetGpuCullingEnabled(bool value);
+
+	DynamicResolutionSettings& GetDynamicResolutionSettings();
+	/// <summary>
+	/// Gets the fraction of the window's width and height that the scene is currently rendered at
+	/// </summary>
+	float GetResolutionScale() const;
+	/// <summary>
+	/// Gets the size of the region in the G-buffer and lighting buffer that the scene is being rendered
+	/// into, the targets themselves are always kept at the window size
+	/// </summary>
+	const glm::ivec2& GetRenderSize() const;
+	/// <summary>
+	/// Gets the smoothed GPU time of the scene, lighting and composite passes, in milliseconds
+	/// </summary>
+	float GetGpuFrameTime() const;
+
 	// Inherited from ApplicationLayer
 
 	virtual void OnAppLoad(const nlohmann::json& config) override;
+	virtual void OnAppUnload() override;
+	virtual void OnSceneLoad() override;
 	virtual void OnPreRender() override;
 	virtual void OnRender(const Framebuffer::Sptr& prevLayer) override;
 	virtual void OnPostRender() override;
 	virtual void OnWindowResize(const glm::ivec2& oldSize, const glm::ivec2& newSize) override;
+	virtual nlohmann::json GetDefaultConfig() override;
 
 protected:
 	Framebuffer::Sptr   _primaryFBO;
@@ -140,6 +292,21 @@ protected:
 	glm::vec4         _clearColor;
 	RenderFlags       _renderFlags;
 
+	OcclusionCuller::Sptr _occlusionCuller;
+	bool                  _occlusionCullingEnabled;
+	int                   _occlusionCulledCount;
+
+	// GPU timings are read a few frames late so that we never wait on the GPU
+	static const int GPU_TIMER_FRAMES = 4;
+	DynamicResolutionSettings _dynamicResolution;
+	float                     _resolutionScale;
+	glm::ivec2                _renderSize;
+	float                     _gpuFrameTime;
+	GLuint                    _gpuTimers[GPU_TIMER_FRAMES][2];
+	bool                      _gpuTimerPending[GPU_TIMER_FRAMES];
+	int                       _gpuTimerIndex;
+	bool                      _gpuTimerActive;
+
 	const int FRAME_UBO_BINDING = 0;
 	UniformBuffer<FrameLevelUniforms>::Sptr _frameUniforms;
 
@@ -149,10 +316,176 @@ protected:
 	const int LIGHTING_UBO_BINDING = 2;
 	UniformBuffer<LightingUboStruct>::Sptr _lightingUbo;
 
+	const int BATCH_SSBO_BINDING = 8;
+	TextureArrayPacker::Sptr      _texturePacker;
+	ShaderProgram::Sptr           _batchedShader;
+	bool                          _batchingEnabled;
+	GLuint                        _batchBuffer;
+	size_t                        _batchBufferSize;
+	std::vector<BatchedInstance>  _batchInstances;
+	int                           _batchedDrawCount;
+	int                           _batchedInstanceCount;
+
+	// A batch of objects drawn by a single indirect draw, indexed the same as the culler's draw commands.
+	// Batches are kept until the scene changes, so that objects keep the same batch between frames
+	struct GpuBatch {
+		Gameplay::Material* Material;
+		VertexArrayObject*  Mesh;
+		// The first slot in the visible list for the batch
+		uint32_t            First;
+		// The number of objects in the batch this frame
+		uint32_t            Count;
+		// The size of the batch's range of the visible list. It only grows, so that a few objects coming
+		// and going don't move every later batch's range and force their objects to be uploaded again
+		uint32_t            Capacity;
+	};
+	typedef std::tuple<Texture2DArray*, Texture2DArray*, Texture2DArray*, Texture2DArray*, VertexArrayObject*> GpuBatchKey;
+
+	GpuCuller::Sptr                       _gpuCuller;
+	bool                                  _gpuCullingEnabled;
+	// basic_batched.glsl, but reading its instances through the visible list
+	ShaderProgram::Sptr                   _gpuCulledShader;
+	std::vector<GpuBatch>                 _gpuBatches;
+	std::map<GpuBatchKey, uint32_t>       _gpuBatchLookup;
+	std::vector<GpuCuller::DrawCommand>   _gpuCommands;
+	// The component holding each of the culler's slots (nullptr if free), and the last frame it was drawn
+	std::vector<RenderComponent*>         _gpuSlotOwners;
+	std::vector<uint32_t>                 _gpuSlotLastSeen;
+	uint32_t                              _gpuFrameIndex;
+
+	// Where a mesh and material pair's impostor was baked
+	struct ImpostorEntry {
+		int       Atlas;
+		int       Slot;
+		// The mesh's bounding sphere in model space
+		glm::vec3 Center;
+		float     Radius;
+	};
+
+	const int IMPOSTOR_SSBO_BINDING = 9;
+	ImpostorSettings                              _impostorSettings;
+	std::vector<ImpostorAtlas::Sptr>              _impostorAtlases;
+	std::vector<ImpostorEntry>                    _impostorEntries;
+	// Maps mesh and material GUIDs to an index in _impostorEntries, -1 if they can't have an impostor,
+	// or IMPOSTOR_QUEUED if they're waiting in _impostorBakeQueue
+	std::map<std::pair<Guid, Guid>, int>          _impostorLookup;
+	const int IMPOSTOR_QUEUED = -2;
+	std::vector<std::pair<std::shared_ptr<Gameplay::MeshResource>, std::shared_ptr<Gameplay::Material>>> _impostorBakeQueue;
+	ShaderProgram::Sptr                           _impostorShader;
+	// Impostors don't have any vertex attributes, but a VAO still needs to be bound to draw
+	GLuint                                        _impostorVao;
+	GLuint                                        _impostorBuffer;
+	size_t                                        _impostorBufferSize;
+	// The impostors to draw for the main camera this frame, one list per atlas
+	std::vector<std::vector<ImpostorInstance>>    _impostorInstances;
+	int                                           _impostorCount;
+	int                                           _impostorDrawCount;
+
+	/// <summary>
+	/// A renderable that was gathered from the scene on the main thread, with everything
+	/// that the preparation jobs need so that they don't have to touch the scene
+	/// </summary>
+	struct RenderItem {
+		Gameplay::Material* Material;
+		VertexArrayObject*  Mesh;
+		glm::mat4           Transform;
+		glm::mat4           NormalMatrix;
+		// Model space bounds, copied from the mesh resource
+		glm::vec3           BoundsMin;
+		glm::vec3           BoundsMax;
+		// World space bounds, calculated by the preparation jobs
+		glm::vec3           WorldCenter;
+		glm::vec3           WorldExtents;
+		bool                HasBounds;
+		// The triangles to draw into the occlusion buffer, or nullptr if the item is not an occluder
+		const std::vector<glm::vec3>* OccluderTriangles;
+		// Groups items by shader and then material when sorting, batched items that can share a draw have the same key
+		uint32_t            MaterialKey;
+		// True if the item is drawn as part of an instanced batch
+		bool                Batched;
+		// The index of the item's impostor in _impostorEntries, or -1 if it doesn't have one
+		int                 Impostor;
+		// Points at the render component's crossfade, so that the preparation jobs can update it
+		float*              ImpostorFade;
+		// True if the main camera culls and draws the item on the GPU, see _PrepareGpuCulling
+		bool                GpuCulled;
+		// The component the item was gathered from, so the GPU culler can keep track of its slot
+		RenderComponent*    Renderable;
+	};
+
+	/// <summary>
+	/// Everything needed to submit the scene from a single point of view (the main camera or a shadow camera)
+	/// </summary>
+	struct RenderView {
+		glm::mat4 View;
+		glm::mat4 Projection;
+		glm::mat4 ViewProjection;
+		// Planes are stored as (normal, distance), with normals pointing inwards
+		glm::vec4 FrustumPlanes[6];
+		// Per item data, indexed the same as _renderItems, only valid for visible items
+		std::vector<InstanceLevelUniforms> Instances;
+		std::vector<uint64_t>              SortKeys;
+		std::vector<uint8_t>               Visible;
+		// Indices of visible items, in the order they should be drawn
+		std::vector<uint32_t>              DrawList;
+	};
+
+	// Rebuilt every frame by _PrepareFrame
+	std::vector<RenderItem> _renderItems;
+	// The main camera is always the first view, followed by each shadow camera
+	std::vector<RenderView> _views;
+
 	void _InitFrameUniforms();
-	void _RenderScene(const glm::mat4& view, const glm::mat4&Projection, const glm::ivec2& screenSize);
+	/// <summary>
+	/// Reads back the oldest finished GPU timing, and nudges the resolution scale towards the
+	/// scale we expect to hit our GPU time target
+	/// </summary>
+	void _UpdateResolutionScale();
+	/// <summary>
+	/// Gathers renderables and views from the scene, then calculates instance data, culling and sort
+	/// order for every view across the job system so that rendering only needs to submit
+	/// </summary>
+	void _PrepareFrame();
+	/// <summary>
+	/// Draws occluders into the occlusion buffer from the main camera, then hides anything they cover
+	/// </summary>
+	void _OcclusionCull(RenderView& view);
+	void _RenderScene(const RenderView& view, const glm::ivec2& screenSize);
+	/// <summary>
+	/// Groups the GPU culled items into batches, and uploads whatever has changed to the GPU culler
+	/// </summary>
+	void _PrepareGpuCulling();
+	/// <summary>
+	/// Culls the GPU culled items against the main camera, then draws every batch with an indirect draw
+	/// </summary>
+	void _RenderGpuCulled();
+
+	/// <summary>
+	/// Gets the impostor for a mesh and material, queueing it to be baked the first time it's requested
+	/// </summary>
+	/// <returns>The index of the impostor in _impostorEntries, or -1 if the mesh can't have one or it hasn't been baked yet</returns>
+	int _GetImpostor(const std::shared_ptr<Gameplay::MeshResource>& mesh, const std::shared_ptr<Gameplay::Material>& material);
+	/// <summary>
+	/// Bakes impostors from the front of the bake queue
+	/// </summary>
+	/// <param name="limit">The most impostors to bake, or -1 to empty the queue</param>
+	/// <returns>The number of impostors that were baked</returns>
+	int _BakeQueuedImpostors(int limit);
+	/// <summary>
+	/// Draws the mesh from every frame direction into the impostor's slot in its atlas
+	/// </summary>
+	void _BakeImpostor(const ImpostorEntry& entry, VertexArrayObject* mesh, Gameplay::Material* material);
+	/// <summary>
+	/// Hides items that have fully faded to their impostors from the view, and gathers instance data
+	/// for every impostor that is at least partly faded in
+	/// </summary>
+	void _GatherImpostors(RenderView& view);
+	/// <summary>
+	/// Draws all the impostors gathered for the main camera, with one instanced draw per atlas
+	/// </summary>
+	void _RenderImpostors();
 
 	void _AccumulateLighting();
 	void _Composite();
-	void _ClearFramebuffer(Framebuffer::Sptr& buffer, const glm::vec4* colors, int layers);
+	void _ClearFramebuffer(Framebuffer::Sptr& buffer, const glm::vec4* colors, int layers, const glm::ivec2& size);
 };
\ No newline at end of file
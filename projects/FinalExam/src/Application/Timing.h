@@ -16,6 +16,21 @@ public:
 	inline float TimeSinceAppLoad() { return _timeSinceSceneLoad; }
 	inline float UnscaledTimeSinceAppLoad() { return _unscaledTimeSinceSceneLoad; }
 
+	/**
+	 * True when the simulation runs in fixed ticks, in which case DeltaTime is the tick length
+	 * during fixed updates, and the frame time everywhere else
+	 */
+	inline bool IsFixedTimestep() { return _isFixedTimestep; }
+	/**
+	 * The length of a simulation tick in seconds, when running at a fixed tick rate
+	 */
+	inline float FixedDeltaTime() { return _fixedDeltaTime; }
+	/**
+	 * How far we are between the last simulation tick and the next, from 0 to 1. Rendering
+	 * blends between the last two ticks by this amount. Always 1 without a fixed tick rate
+	 */
+	inline float TickAlpha() { return _tickAlpha; }
+
 	static inline Timing& Current() { return _singleton; }
 
 	static inline float TimeScale() { return _timeScale; }
@@ -32,6 +47,9 @@ protected:
 	float _unscaledTimeSinceSceneLoad = 0;
 	float _timeSinceAppLoad = 0;
 	float _unscaledTimeSinceAppLoad = 0;
+	bool  _isFixedTimestep = false;
+	float _fixedDeltaTime = 1.0f / 60.0f;
+	float _tickAlpha = 1.0f;
 
 	static inline float _timeScale = 1.0f;
 };
@@ -2,6 +2,7 @@
 #include "Application/Application.h"
 #include "Application/ApplicationLayer.h"
 #include "Application/Layers/RenderLayer.h"
+#include "Application/Layers/ParticleLayer.h"
 
 DebugWindow::DebugWindow() :
 	IEditorWindow()
@@ -24,6 +25,70 @@ void DebugWindow::RenderMenuBar()
 		app.CurrentScene()->SetPhysicsDebugDrawMode(physicsDrawMode);
 	}
 
+	ImGui::Separator();
+
+	bool occlusionCulling = renderLayer->IsOcclusionCullingEnabled();
+	if (ImGui::Checkbox("Occlusion Culling", &occlusionCulling)) {
+		renderLayer->SetOcclusionCullingEnabled(occlusionCulling);
+	}
+	if (occlusionCulling) {
+		ImGui::Text("(%d hidden)", renderLayer->GetOcclusionCulledCount());
+	}
+
+	ImGui::Separator();
+
+	RenderLayer::DynamicResolutionSettings& resolution = renderLayer->GetDynamicResolutionSettings();
+	ImGui::Checkbox("Dynamic Resolution", &resolution.Enabled);
+	if (resolution.Enabled) {
+		ImGui::SetNextItemWidth(80.0f);
+		ImGui::DragFloat("Target ms", &resolution.TargetGpuMs, 0.1f, 1.0f, 100.0f, "%.1f");
+	}
+	ImGui::Text("%d%% (GPU %.2f ms)", (int)glm::round(renderLayer->GetResolutionScale() * 100.0f), renderLayer->GetGpuFrameTime());
+
+	ImGui::Separator();
+
+	bool batching = renderLayer->IsBatchingEnabled();
+	if (ImGui::Checkbox("Texture Batching", &batching)) {
+		renderLayer->SetBatchingEnabled(batching);
+	}
+	if (batching) {
+		ImGui::Text("(%d draws, %d objects)", renderLayer->GetBatchedDrawCount(), renderLayer->GetBatchedInstanceCount());
+	}
+
+	ImGui::Separator();
+
+	if (renderLayer->GetGpuCuller() != nullptr) {
+		bool gpuCulling = renderLayer->IsGpuCullingEnabled();
+		if (ImGui::Checkbox("GPU Culling", &gpuCulling)) {
+			renderLayer->SetGpuCullingEnabled(gpuCulling);
+		}
+		if (gpuCulling) {
+			const GpuCuller::Stats& stats = renderLayer->GetGpuCuller()->GetStats();
+			ImGui::Text("(%d objects, %d draws, %.1f KB uploaded)", stats.Objects, stats.Batches, stats.UploadedBytes / 1024.0f);
+		}
+
+		ImGui::Separator();
+	}
+
+	RenderLayer::ImpostorSettings& impostors = renderLayer->GetImpostorSettings();
+	ImGui::Checkbox("Impostors", &impostors.Enabled);
+	if (impostors.Enabled) {
+		ImGui::SetNextItemWidth(80.0f);
+		ImGui::DragFloat("Screen Size", &impostors.ScreenSize, 0.001f, 0.0f, 1.0f, "%.3f");
+		ImGui::Text("(%d impostors, %d draws)", renderLayer->GetImpostorCount(), renderLayer->GetImpostorDrawCount());
+	}
+
+	ImGui::Separator();
+
+	ParticleLayer::Sptr particleLayer = app.GetLayer<ParticleLayer>();
+	if (particleLayer != nullptr) {
+		const ParticleLayer::Stats& stats = particleLayer->GetStats();
+		const BufferPool::Sptr& pool = particleLayer->GetBufferPool();
+		ImGui::Text("Particles: ~%u / %u (%.1f / %.1f MB)",
+			stats.ParticleCount, particleLayer->GetBudgetSettings().ParticleBudget,
+			pool->GetReservedBytes() / (1024.0f * 1024.0f), pool->GetBudget() / (1024.0f * 1024.0f));
+	}
+
 	/*ImGui::Separator();
 
 	RenderFlags flags = renderLayer->GetRenderFlags();
@@ -19,18 +19,18 @@ void GBufferPreviews::Render()
 	using namespace Gameplay;
 	Application& app = Application::Get();
 
-	RenderLayer::Sptr& renderLayer = app.GetLayer<RenderLayer>();
+	RenderLayer::Sptr renderLayer = app.GetLayer<RenderLayer>();
 	const Framebuffer::Sptr& framebuffer = renderLayer->GetGBuffer();
 	const Framebuffer::Sptr& lightBuffer = renderLayer->GetLightingBuffer();
 
-	Texture2D::Sptr& depth = framebuffer->GetTextureAttachment(RenderTargetAttachment::Depth);
-	Texture2D::Sptr& color = framebuffer->GetTextureAttachment(RenderTargetAttachment::Color0);
-	Texture2D::Sptr& normals = framebuffer->GetTextureAttachment(RenderTargetAttachment::Color1);
-	Texture2D::Sptr& emissive = framebuffer->GetTextureAttachment(RenderTargetAttachment::Color2);
-	Texture2D::Sptr& viewspace = framebuffer->GetTextureAttachment(RenderTargetAttachment::Color3);
+	Texture2D::Sptr depth = framebuffer->GetTextureAttachment(RenderTargetAttachment::Depth);
+	Texture2D::Sptr color = framebuffer->GetTextureAttachment(RenderTargetAttachment::Color0);
+	Texture2D::Sptr normals = framebuffer->GetTextureAttachment(RenderTargetAttachment::Color1);
+	Texture2D::Sptr emissive = framebuffer->GetTextureAttachment(RenderTargetAttachment::Color2);
+	Texture2D::Sptr viewspace = framebuffer->GetTextureAttachment(RenderTargetAttachment::Color3);
 
-	Texture2D::Sptr& diffuse = lightBuffer->GetTextureAttachment(RenderTargetAttachment::Color0);
-	Texture2D::Sptr& specular = lightBuffer->GetTextureAttachment(RenderTargetAttachment::Color1);
+	Texture2D::Sptr diffuse = lightBuffer->GetTextureAttachment(RenderTargetAttachment::Color0);
+	Texture2D::Sptr specular = lightBuffer->GetTextureAttachment(RenderTargetAttachment::Color1);
 
 	int width = (ImGui::GetContentRegionAvailWidth() / 2);
 	float aspect = app.GetWindowSize().x / (float)app.GetWindowSize().y;
@@ -3,9 +3,12 @@
 #include "Utils/ImGuiHelper.h"
 #include "imgui_internal.h"
 #include <set>
+#include <ctime>
 
 PostProcessingSettingsWindow::PostProcessingSettingsWindow()
-	: IEditorWindow()
+	: IEditorWindow(),
+	_captureFormat(CaptureFormat::Y4M),
+	_captureDepth(false)
 {
 	Name = "Post Processing Effects";
 	SplitDirection = ImGuiDir_::ImGuiDir_None;
@@ -22,6 +25,21 @@ void PostProcessingSettingsWindow::Render()
 
 	PostProcessingLayer::Sptr layer = app.GetLayer<PostProcessingLayer>();
 
+	// Show how much work the render graph is doing, useful to see what culling and aliasing saves us
+	if (layer->GetRenderGraph() != nullptr) {
+		const RenderGraph::Stats& stats = layer->GetRenderGraph()->GetStats();
+		ImGui::Text("Passes: %d (%d culled)", stats.PassesExecuted, stats.PassesCulled);
+		ImGui::Text("Render targets: %d", stats.PooledTargets);
+		ImGui::Text("Final blit: %s", stats.OutputFolded ? "folded into last pass" : "yes");
+		ImGui::Checkbox("Profile Effects", &layer->GetRenderGraph()->EnableProfiling);
+		ImGui::Separator();
+	}
+
+	if (layer->GetFrameCapture() != nullptr) {
+		_RenderCapture(layer->GetFrameCapture());
+		ImGui::Separator();
+	}
+
 	std::set<PostProcessingLayer::Effect::Sptr> unique (layer->GetEffects().begin(), layer->GetEffects().end());
 
 	for (const auto& effect : unique) {
@@ -29,6 +47,28 @@ void PostProcessingSettingsWindow::Render()
 	}
 }
 
+void PostProcessingSettingsWindow::_RenderCapture(const FrameCapture::Sptr& capture)
+{
+	if (capture->IsRecording()) {
+		FrameCapture::Stats stats = capture->GetStats();
+		ImGui::Text("Recording to %s", capture->GetDirectory().c_str());
+		ImGui::Text("%d captured, %d written, %d dropped", stats.FramesCaptured, stats.FramesWritten, stats.FramesDropped);
+		if (ImGui::Button("Stop Recording")) {
+			capture->Stop();
+		}
+	} else {
+		ImGuiHelper::DrawEnumCombo("Capture Format", &_captureFormat, GET_ENUM_MAP(CaptureFormat));
+		ImGui::Checkbox("Capture Depth", &_captureDepth);
+		if (ImGui::Button("Start Recording")) {
+			// Each recording gets its own folder, named by when it started
+			char folder[64];
+			time_t now = time(nullptr);
+			strftime(folder, 64, "captures/%Y%m%d_%H%M%S", localtime(&now));
+			capture->Start(folder, _captureFormat, _captureDepth);
+		}
+	}
+}
+
 void PostProcessingSettingsWindow::_RenderEffect(const PostProcessingLayer::Effect::Sptr& value)
 {
 	ImGui::PushID(value.get());
@@ -39,6 +79,16 @@ void PostProcessingSettingsWindow::_RenderEffect(const PostProcessingLayer::Effe
 
 	if (isOpen) {
 		ImGui::Indent();
+
+		// Show the GPU cost of the effect, so that modes can be compared against each other
+		const RenderGraph::Sptr& graph = Application::Get().GetLayer<PostProcessingLayer>()->GetRenderGraph();
+		if (graph != nullptr && graph->EnableProfiling && value->Enabled) {
+			auto it = graph->GetGroupTimings().find(value->Name);
+			if (it != graph->GetGroupTimings().end()) {
+				ImGui::Text("GPU: %.3f ms", it->second);
+			}
+		}
+
 		value->RenderImGui();
 		ImGui::Unindent();
 		ImGui::Separator();
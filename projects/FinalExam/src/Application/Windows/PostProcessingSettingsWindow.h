@@ -17,5 +17,10 @@ public:
 	virtual void Render() override;
 
 protected:
+	// Settings for the next recording
+	CaptureFormat _captureFormat;
+	bool          _captureDepth;
+
 	void _RenderEffect(const PostProcessingLayer::Effect::Sptr& value);
+	void _RenderCapture(const FrameCapture::Sptr& capture);
 };
\ No newline at end of file
@@ -97,7 +97,7 @@ namespace Gameplay {
 	}
 
 	const glm::mat4& Camera::GetView() const {
-		return GetGameObject()->GetInverseTransform();
+		return GetGameObject()->GetInverseRenderTransform();
 	}
 
 	const glm::mat4& Camera::GetProjection() const {
@@ -106,7 +106,7 @@ namespace Gameplay {
 	}
 
 	const glm::mat4& Camera::GetViewProjection() const {
-		_viewProjection = __CalculateProjection() * GetGameObject()->GetInverseTransform();
+		_viewProjection = __CalculateProjection() * GetGameObject()->GetInverseRenderTransform();
 		return _viewProjection;
 	}
 
@@ -73,7 +73,8 @@ namespace Gameplay {
 		bool GetOrthoEnabled() const { return _isOrtho; }
 
 		/// <summary>
-		/// Gets the view matrix for this camera
+		/// Gets the view matrix for this camera, from the object's render transform
+		/// (see GameObject::GetRenderTransform)
 		/// </summary>
 		const glm::mat4& GetView() const;
 		/// <summary>
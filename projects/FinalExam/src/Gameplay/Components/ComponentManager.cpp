@@ -0,0 +1,149 @@
+#include "Gameplay/Components/ComponentManager.h"
+#include <algorithm>
+
+#include "Gameplay/GameObject.h"
+#include "Utils/JobSystem.h"
+
+namespace Gameplay {
+	// One bit per resource, in the same order as the read/write pairs in ComponentAccess
+	static const uint32_t ACCESS_TRANSFORM  = 1 << 0;
+	static const uint32_t ACCESS_COMPONENTS = 1 << 1;
+	static const uint32_t ACCESS_PHYSICS    = 1 << 2;
+	static const uint32_t ACCESS_SCENE      = 1 << 3;
+	static const uint32_t ACCESS_RESOURCE_COUNT = 4;
+
+	// Splits an access set into the resources it reads and the resources it writes
+	static void SplitAccess(ComponentAccess access, uint32_t& reads, uint32_t& writes) {
+		uint32_t bits = *access;
+		reads  = 0;
+		writes = 0;
+		for (uint32_t resource = 0; resource < ACCESS_RESOURCE_COUNT; resource++) {
+			reads  |= ((bits >> (resource * 2))     & 1) << resource;
+			writes |= ((bits >> (resource * 2 + 1)) & 1) << resource;
+		}
+	}
+
+	// Returns true if two different component types can't update at the same time. They may be on the
+	// same object, so their own transforms and components count as shared
+	static bool AccessConflicts(ComponentAccess a, ComponentAccess b) {
+		uint32_t readsA, writesA, readsB, writesB;
+		SplitAccess(a, readsA, writesA);
+		SplitAccess(b, readsB, writesB);
+
+		// Every component reads its own state, which another component on the same object may be writing.
+		// Other objects have transforms and components just like ours, so touching the scene touches those too
+		for (uint32_t* reads : { &readsA, &readsB }) {
+			*reads |= ACCESS_COMPONENTS;
+			if (*reads & ACCESS_SCENE) {
+				*reads |= ACCESS_TRANSFORM | ACCESS_COMPONENTS;
+			}
+		}
+		for (uint32_t* writes : { &writesA, &writesB }) {
+			if (*writes & ACCESS_SCENE) {
+				*writes |= ACCESS_TRANSFORM | ACCESS_COMPONENTS;
+			}
+		}
+
+		return (writesA & (readsB | writesB)) != 0 || (writesB & readsA) != 0;
+	}
+
+	// Returns true if components of a single type can't update at the same time. There's only one
+	// component of a type per object, so only the resources that objects share can conflict
+	static bool AccessConflictsWithSelf(ComponentAccess access) {
+		uint32_t reads, writes;
+		SplitAccess(access, reads, writes);
+		if (writes & (ACCESS_PHYSICS | ACCESS_SCENE)) {
+			return true;
+		}
+		// Reading other objects while each instance writes to its own
+		return (reads & ACCESS_SCENE) && (writes & (ACCESS_TRANSFORM | ACCESS_COMPONENTS));
+	}
+
+	const std::vector<ComponentManager::UpdatePhase>& ComponentManager::GetUpdatePhases() {
+		if (_updatePhaseTypeCount == _TypeUpdateAccess.size()) {
+			return _updatePhases;
+		}
+
+		_updatePhases.clear();
+		for (uint32_t typeId = 0; typeId < _TypeUpdateAccess.size(); typeId++) {
+			const std::optional<ComponentAccess>& access = _TypeUpdateAccess[typeId];
+			if (!access.has_value()) continue;
+
+			// Types join the previous phase if they can run alongside everything already in it. Serial types
+			// can share a phase too, since a serial phase just runs its types one after the other
+			bool isParallel = !AccessConflictsWithSelf(access.value());
+			if (!_updatePhases.empty()) {
+				UpdatePhase& last = _updatePhases.back();
+				bool fits = isParallel ?
+					last.IsParallel && !AccessConflicts(last.Access, access.value()) :
+					!last.IsParallel;
+				if (fits) {
+					last.Types.push_back(typeId);
+					last.Access |= access.value();
+					continue;
+				}
+			}
+			_updatePhases.push_back({ { typeId }, access.value(), isParallel });
+		}
+
+		_updatePhaseTypeCount = _TypeUpdateAccess.size();
+		return _updatePhases;
+	}
+
+	void ComponentManager::RunUpdatePhase(const UpdatePhase& phase, float deltaTime) {
+		if (!phase.IsParallel) {
+			for (uint32_t typeId : phase.Types) {
+				if (_GetPool(typeId) == nullptr) continue;
+
+				// We index rather than use iterators, since updates may add components and grow the pools
+				_iterationDepth++;
+				for (size_t ix = 0; ix < _pools[typeId].Components.size(); ix++) {
+					IComponent* component = _pools[typeId].Components[ix];
+					if (component != nullptr && component->IsEnabled) {
+						component->Update(deltaTime);
+					}
+				}
+				_EndIteration();
+			}
+			return;
+		}
+
+		// Lay the phase's pools end to end, so that one parallel for can cover all of them. Components in a
+		// parallel phase can't add or remove components, so the pools won't change under us
+		_phaseOffsets.clear();
+		uint32_t total = 0;
+		for (uint32_t typeId : phase.Types) {
+			_phaseOffsets.push_back(total);
+			ComponentPool* pool = _GetPool(typeId);
+			total += pool != nullptr ? (uint32_t)pool->Components.size() : 0;
+		}
+		_phaseOffsets.push_back(total);
+
+		JobSystem::ParallelFor(total, UPDATE_BATCH_SIZE, [&](uint32_t start, uint32_t end) {
+			// Find the pool the batch starts in, empty pools share their offset with the next pool so we
+			// want the last pool that starts at or before us
+			size_t poolIx = std::upper_bound(_phaseOffsets.begin(), _phaseOffsets.end(), start) - _phaseOffsets.begin() - 1;
+
+			// Batches may run off the end of one pool and into the next
+			for (uint32_t ix = start; ix < end; poolIx++) {
+				uint32_t poolEnd = std::min(end, _phaseOffsets[poolIx + 1]);
+				for (; ix < poolEnd; ix++) {
+					IComponent* component = _pools[phase.Types[poolIx]].Components[ix - _phaseOffsets[poolIx]];
+					if (component != nullptr && component->IsEnabled) {
+						component->Update(deltaTime);
+					}
+				}
+			}
+		});
+	}
+
+	void ComponentManager::_IndexByGuid(IComponent* component) {
+		auto [it, inserted] = _componentsByGuid.emplace(component->GetGUID(), component);
+		if (!inserted) {
+			GameObject* owner = it->second->GetGameObject();
+			if (owner != nullptr && owner->IsPendingDelete()) {
+				it->second = component;
+			}
+		}
+	}
+}
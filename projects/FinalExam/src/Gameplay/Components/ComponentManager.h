@@ -2,22 +2,72 @@
 #include <functional>
 #include "IComponent.h"
 #include <typeindex>
+#include <type_traits>
 #include <optional>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
 #include <Logging.h>
+#include "Utils/Macros.h"
+#include "Utils/BinaryStream.h"
 
 namespace Gameplay {
 	/// <summary>
 	/// Helper class for component types, this class is what lets us load component types
 	/// from scene files, as well as providing a way to iterate over all active components
 	/// of a given type (and sort them in the future!)
+	/// 
+	/// Components of each type are kept in a dense pool of raw pointers, and each component
+	/// remembers its index in its pool. Iterating a type walks a packed array with no locking
+	/// or casting, and removing a component swaps the last one in the pool into its place.
+	/// The manager does not own components, they are removed when they are destroyed
+	/// 
+	/// Nothing outside of the manager refers to a slot in a pool (components are referenced by shared
+	/// pointer or by GUID), so unlike a slot map the pools don't need generation counts to catch stale handles
 	/// </summary>
 	class ComponentManager {
 	public:
+		NO_COPY(ComponentManager);
+		NO_MOVE(ComponentManager);
+
 		typedef std::function<IComponent::Sptr(const nlohmann::json&)> LoadComponentFunc;
 		typedef std::function<IComponent::Sptr()> CreateComponentFunc;
+		typedef std::function<IComponent::Sptr(BinaryReader&)> LoadBinaryComponentFunc;
+		typedef std::function<void(const IComponent&, BinaryWriter&)> SaveBinaryComponentFunc;
+		typedef std::function<IComponent::Sptr(const IComponent&)> CloneComponentFunc;
+
+		/// <summary>
+		/// A group of component types whose updates can safely run at the same time, see GetUpdatePhases
+		/// </summary>
+		struct UpdatePhase {
+			// The type IDs of the components to update, in the order they were registered
+			std::vector<uint32_t> Types;
+			// Everything that the types in this phase access, combined
+			ComponentAccess       Access;
+			// False if the components have to be updated one at a time on the calling thread
+			bool                  IsParallel;
+		};
+
+		ComponentManager() = default;
+		inline ~ComponentManager() {
+			Clear();
+		}
 
+		/// <summary>
+		/// Removes all components from the pools, any that are still alive will no longer be iterated
+		/// </summary>
 		inline void Clear() {
-			_Components.clear();
+			// Components that outlive us can't be allowed to remove themselves from pools that are gone
+			for (ComponentPool& pool : _pools) {
+				for (IComponent* component : pool.Components) {
+					if (component != nullptr) {
+						component->_manager = nullptr;
+					}
+				}
+			}
+			_pools.clear();
+			_poolsWithHoles.clear();
+			_componentsByGuid.clear();
 		}
 
 		/// <summary>
@@ -41,18 +91,112 @@ namespace Gameplay {
 					IComponent::Sptr result = callback(blob);
 					IComponent::LoadBaseJson(result, blob);
 
-					// Make sure the component knows it's own type
-					result->_realType = typeIndex.value();
-					result->_weakSelfPtr = result;
-
 					// Add the component to the global pools
-					_Components[result->_realType].push_back(result);
+					_Add(result, typeIndex.value());
 					return result;
 				}
 			}
 			return nullptr;
 		}
 
+		/// <summary>
+		/// Loads a component with the given type name from data written by SaveBinary
+		/// If the type name does not correspond to a registered type, or the type has no
+		/// binary loader, will return nullptr without reading anything
+		/// </summary>
+		/// <param name="typeName">The name of the type to load (taken from GetComponentTypeName of component)</param>
+		/// <param name="guid">The GUID to give the component</param>
+		/// <param name="isEnabled">Whether the component should be enabled</param>
+		/// <param name="reader">The reader to load the component's data from</param>
+		/// <returns>The component as decoded from the binary data, or nullptr</returns>
+		inline IComponent::Sptr LoadBinary(const std::string& typeName, const Guid& guid, bool isEnabled, BinaryReader& reader) {
+			std::optional<std::type_index> typeIndex = _TypeNameMap[typeName];
+			if (!typeIndex.has_value()) return nullptr;
+
+			auto it = _TypeLoadBinaryRegistry.find(typeIndex.value());
+			if (it == _TypeLoadBinaryRegistry.end()) return nullptr;
+
+			IComponent::Sptr result = it->second(reader);
+			// The GUID has to be set before the component goes into the GUID lookup
+			result->OverrideGUID(guid);
+			result->IsEnabled = isEnabled;
+
+			_Add(result, typeIndex.value());
+			return result;
+		}
+
+		/// <summary>
+		/// Writes a component's data in the format read by LoadBinary. The GUID and enabled state
+		/// are not included, since the scene stores those for every component
+		/// </summary>
+		/// <param name="component">The component to save</param>
+		/// <param name="writer">The writer to save the component's data to</param>
+		/// <returns>False if the component's type has no binary saver, in which case nothing is written</returns>
+		inline bool SaveBinary(const IComponent& component, BinaryWriter& writer) const {
+			auto it = _TypeSaveBinaryRegistry.find(component._realType);
+			if (it == _TypeSaveBinaryRegistry.end()) return false;
+
+			it->second(component, writer);
+			return true;
+		}
+
+		/// <summary>
+		/// Returns true if the given component type can be saved and loaded with SaveBinary and LoadBinary
+		/// </summary>
+		inline static bool HasBinarySerializer(const std::type_index& type) {
+			return _TypeSaveBinaryRegistry.find(type) != _TypeSaveBinaryRegistry.end();
+		}
+
+		/// <summary>
+		/// Loads a component from a JSON blob without adding it to any pools, so that it can be used as a
+		/// template for Clone (see Prefab). The component does not get OnLoad, and is never iterated
+		/// If the type name does not correspond to a registered type, will return nullptr
+		/// </summary>
+		/// <param name="typeName">The name of the type to load (taken from GetComponentTypeName of component)</param>
+		/// <param name="blob">The JSON blob to decode</param>
+		/// <returns>The component as decoded from the JSON data, or nullptr</returns>
+		inline static IComponent::Sptr LoadTemplate(const std::string& typeName, const nlohmann::json& blob) {
+			auto nameIt = _TypeNameMap.find(typeName);
+			if (nameIt == _TypeNameMap.end() || !nameIt->second.has_value()) return nullptr;
+
+			std::type_index type = nameIt->second.value();
+			IComponent::Sptr result = _TypeLoadRegistry[type](blob);
+			IComponent::LoadBaseJson(result, blob);
+			// Clone looks the type up from the source component, so it needs to know its real type
+			result->_realType = type;
+			result->_weakSelfPtr = result;
+			return result;
+		}
+
+		/// <summary>
+		/// Creates a copy of a component with a new GUID, and adds it to the pools. The copy is not attached
+		/// to any game object, and has not had OnLoad called
+		/// 
+		/// Types are copied with their copy constructor, types that can't be copied (ex: ones that own
+		/// OpenGL objects) are copied by going through their JSON instead, which is much slower
+		/// </summary>
+		/// <param name="source">The component to copy, usually a template from LoadTemplate</param>
+		/// <returns>The new component</returns>
+		inline IComponent::Sptr Clone(const IComponent& source) {
+			IComponent::Sptr result = _TypeCloneRegistry[source._realType](source);
+			// The copy comes with the source's bookkeeping, which we need to reset before the copy can go
+			// into the pools, otherwise destroying it would remove the source instead
+			result->_context = nullptr;
+			result->_manager = nullptr;
+			result->IsEnabled = source.IsEnabled;
+			result->OverrideGUID(Guid::New());
+
+			_Add(result, source._realType);
+			return result;
+		}
+
+		/// <summary>
+		/// Returns true if the given component type overrides IComponent::RemapReferences
+		/// </summary>
+		inline static bool HasReferences(const std::type_index& type) {
+			return _TypesWithReferences.find(type) != _TypesWithReferences.end();
+		}
+
 		/// <summary>
 		/// Creates a component with the given type name
 		/// If the type name does not correspond to a registered type, will
@@ -71,11 +215,8 @@ namespace Gameplay {
 				if (callback) {
 					// Invoke the loader, also load additional component data
 					IComponent::Sptr result = callback();
-					// Make sure the component knows it's own type
-					result->_realType = typeIndex.value();
-					result->_weakSelfPtr = result;
 					// Add the component to the global pools
-					_Components[result->_realType].push_back(result);
+					_Add(result, typeIndex.value());
 					return result;
 				}
 			}
@@ -98,11 +239,8 @@ namespace Gameplay {
 			if (callback) {
 				// Invoke the loader, also load additional component data
 				IComponent::Sptr result = callback();
-				// Make sure the component knows it's own type
-				result->_realType = type;
-				result->_weakSelfPtr = result;
 				// Add the component to the global pools
-				_Components[result->_realType].push_back(result);
+				_Add(result, type);
 				return result;
 			}
 			return nullptr;
@@ -138,13 +276,8 @@ namespace Gameplay {
 			// Create component, forwarding arguments
 			std::shared_ptr<ComponentType> component = std::make_shared<ComponentType>(std::forward<TArgs>(args)...);
 
-			// Make sure the component knows it's concrete type
-			component->_realType = type;
-			// Give the component a weak pointer to itself that it can upcast to a shared pointer when needed
-			component->_weakSelfPtr = component;
-
 			// Add to global component list for that type
-			_Components[type].push_back(component);
+			_Add(component, type);
 
 			// Return the result
 			return component;
@@ -161,56 +294,83 @@ namespace Gameplay {
 			typename ComponentType,
 			typename = typename std::enable_if<std::is_base_of<IComponent, ComponentType>::value>::type>
 		std::shared_ptr<ComponentType> GetComponentByGUID(Guid id) {
-			// We can use typeid and type_index to get a unique ID for our types
-			std::type_index type = std::type_index(typeid(ComponentType));
-			LOG_ASSERT(_TypeLoadRegistry[type] != nullptr, "You must register component types before creating them!");
-
-			// Clear any dead weak pointers
-			auto removeIt = std::remove_if(_Components[type].begin(), _Components[type].end(), [](const std::weak_ptr<IComponent>& ptr) {
-				return ptr.expired();
-			});
-			_Components[type].erase(removeIt, _Components[type].end());
-
-			// Search the component store for a component that matches that ID
-			auto& it = std::find_if(_Components[type].begin(), _Components[type].end(), [&](const std::weak_ptr<IComponent>& ptr) {
-				return (ptr.lock())->GetGUID() == id;
-			});
-
-			// If the component was found, return it. Otherwise return nullptr
-			if (it != _Components[type].end()) {
-				// We need to lock the weak pointer to convert it to a shared ptr
-				return std::dynamic_pointer_cast<ComponentType>((*it).lock());
-			} else {
+			auto it = _componentsByGuid.find(id);
+			if (it == _componentsByGuid.end()) {
 				return nullptr;
 			}
+			// If the type IDs match there's no need to check the cast, otherwise the caller may be asking for a base type
+			if (it->second->_typeId == _TypeId<ComponentType>()) {
+				return std::static_pointer_cast<ComponentType>(it->second->_weakSelfPtr.lock());
+			}
+			return std::dynamic_pointer_cast<ComponentType>(it->second->_weakSelfPtr.lock());
 		}
 
 		/// <summary>
 		/// Iterates over all components of the given type and invokes a method with them
+		/// 
+		/// The callback can either take a const std::shared_ptr<ComponentType>&, or a ComponentType&.
+		/// Taking a reference skips locking each component's shared pointer, and should be preferred
+		/// for hot loops. Components added by the callback will also be visited, and components destroyed
+		/// by the callback are skipped without disturbing the rest of the iteration
 		/// </summary>
 		/// <typeparam name="ComponentType">The type of component to iterate on</typeparam>
 		/// <param name="callback">The callback to invoke with the components</param>
 		/// <param name="includeDisabled">True to include disabled components, false if otherwise</param>
-		template <
-			typename ComponentType,
-			typename = typename std::enable_if<std::is_base_of<IComponent, ComponentType>::value>::type>
-		void Each(std::function<void(const std::shared_ptr<ComponentType>&)> callback, bool includeDisabled = false) {
-			// We can use typeid and type_index to get a unique ID for our types
-			std::type_index type = std::type_index(typeid(ComponentType));
-			LOG_ASSERT(_TypeLoadRegistry[type] != nullptr, "You must register component types before creating them!");
-
-			// Iterate over all the components in the store
-			for (auto& wptr : _Components[type]) {
-				// Lock the weak pointer to get a shared pointer (maybe)
-				std::shared_ptr<IComponent> sptr = wptr.lock();
-				// If the pointer is alive and matches our enabled criteria, invoke the callback
-				if (sptr && sptr->IsEnabled | includeDisabled) {
-					// Upcast to component type and invoke the callback
-					callback(std::dynamic_pointer_cast<ComponentType>(sptr));
+		template <typename ComponentType, typename Callback>
+		void Each(Callback&& callback, bool includeDisabled = false) {
+			static_assert(std::is_base_of<IComponent, ComponentType>::value, "Type is not a valid component type!");
+
+			uint32_t typeId = _TypeId<ComponentType>();
+			if (_GetPool(typeId) == nullptr) return;
+
+			_iterationDepth++;
+			// We index rather than use iterators or hold on to the pool, since callbacks may add components,
+			// which can grow the pool or reallocate the list of pools
+			for (size_t ix = 0; ix < _pools[typeId].Components.size(); ix++) {
+				// Every component in the pool has the pool's type, so a static cast is safe
+				ComponentType* component = static_cast<ComponentType*>(_pools[typeId].Components[ix]);
+				// Removed while we were iterating
+				if (component == nullptr) continue;
+				if (!component->IsEnabled && !includeDisabled) continue;
+
+				if constexpr (std::is_invocable<Callback, ComponentType&>::value) {
+					callback(*component);
+				} else {
+					// Components are only removed from their pool once their destructor runs, so the pointer may have
+					// already expired if we're iterating from inside another component's destructor
+					std::shared_ptr<IComponent> sptr = component->_weakSelfPtr.lock();
+					if (sptr) {
+						callback(std::static_pointer_cast<ComponentType>(sptr));
+					}
 				}
 			}
+			_EndIteration();
+		}
+
+		/// <summary>
+		/// Gets the number of live components of the given type, including disabled ones. While iterating,
+		/// this also counts components that have been removed since the iteration started
+		/// </summary>
+		template <typename ComponentType>
+		size_t Count() {
+			const ComponentPool* pool = _GetPool(_TypeId<ComponentType>());
+			return pool != nullptr ? pool->Components.size() : 0;
 		}
 
+		/// <summary>
+		/// Gets the order to update component types in. Types are updated in the order they were registered,
+		/// with neighbouring types grouped into a phase when their access sets don't conflict, so that their
+		/// updates can be spread across the job system. Types that don't override Update are left out entirely
+		/// </summary>
+		const std::vector<UpdatePhase>& GetUpdatePhases();
+		/// <summary>
+		/// Invokes Update on every enabled component whose type is in the given phase, returning once all of
+		/// them have finished
+		/// </summary>
+		/// <param name="phase">The phase to run, from GetUpdatePhases</param>
+		/// <param name="deltaTime">The time since the last frame, in seconds</param>
+		void RunUpdatePhase(const UpdatePhase& phase, float deltaTime);
+
 		/// <summary>
 		/// Attempts to register a given type as a component, should be called for each component type 
 		/// at the start of you application
@@ -230,7 +390,26 @@ namespace Gameplay {
 				// name to type index mapping
 				_TypeLoadRegistry[type] = &ComponentManager::ParseTypeFromBlob<T>;
 				_TypeCreateRegistry[type] = &ComponentManager::_InternalCreate<T>;
+				_TypeCloneRegistry[type] = &ComponentManager::_CloneType<T>;
+				// Binary serialization is opt in, types without it are stored as JSON in binary scenes
+				if constexpr (_HasBinarySerializer<T>::value) {
+					_TypeLoadBinaryRegistry[type] = &ComponentManager::_ParseTypeFromBinary<T>;
+					_TypeSaveBinaryRegistry[type] = &ComponentManager::_SaveTypeToBinary<T>;
+				}
+				// Same trick as Update below, only types that hold references need them remapped when cloned
+				if (!std::is_same<decltype(&T::RemapReferences), void (IComponent::*)(const GuidRemap&)>::value) {
+					_TypesWithReferences.insert(type);
+				}
 				_TypeNameMap[StringTools::SanitizeClassName(typeid(T).name())] = type;
+				// Each type gets a small ID that indexes its pool
+				_TypeIds.emplace(type, (uint32_t)_TypeIds.size());
+				// Types that never override Update don't need to be scheduled at all. If T overrides it,
+				// &T::Update is a pointer to a member of T rather than of IComponent
+				if (std::is_same<decltype(&T::Update), void (IComponent::*)(float)>::value) {
+					_TypeUpdateAccess.push_back(std::nullopt);
+				} else {
+					_TypeUpdateAccess.push_back(_DeclaredAccess<T>::Get());
+				}
 			}
 		}
 
@@ -238,7 +417,7 @@ namespace Gameplay {
 		/// Removes all components of all types from the registry, whether they are referenced elsewhere or not
 		/// </summary>
 		inline void FlushAll() {
-			_Components = std::unordered_map<std::type_index, std::vector<std::weak_ptr<IComponent>>>();
+			Clear();
 		}
 
 	private:
@@ -253,17 +432,163 @@ namespace Gameplay {
 		inline static std::unordered_map<std::type_index, LoadComponentFunc> _TypeLoadRegistry;
 		// Stores functions to load components from JSON, indexed on the type that they load
 		inline static std::unordered_map<std::type_index, CreateComponentFunc> _TypeCreateRegistry;
+		// Stores functions to load and save components in binary, only for types that define FromBinary and ToBinary
+		inline static std::unordered_map<std::type_index, LoadBinaryComponentFunc> _TypeLoadBinaryRegistry;
+		inline static std::unordered_map<std::type_index, SaveBinaryComponentFunc> _TypeSaveBinaryRegistry;
+		// Stores functions to copy components, indexed on the type that they copy
+		inline static std::unordered_map<std::type_index, CloneComponentFunc> _TypeCloneRegistry;
+		// The types that override RemapReferences
+		inline static std::unordered_set<std::type_index> _TypesWithReferences;
+
+		// Maps each registered type to the index of its pool in _pools
+		inline static std::unordered_map<std::type_index, uint32_t> _TypeIds;
+		// What each type touches in Update indexed by type ID, or nothing if the type does not override Update
+		inline static std::vector<std::optional<ComponentAccess>> _TypeUpdateAccess;
+
+		// The number of components in each batch when updating a phase in parallel
+		static const uint32_t UPDATE_BATCH_SIZE = 64;
+
+		// All the live components of a single type, packed with no gaps. We only store raw pointers,
+		// so components are still destroyed when the last shared pointer to them goes away, and
+		// remove themselves from the pool as they are destroyed
+		struct ComponentPool {
+			std::vector<IComponent*> Components;
+			// True once the pool is in _poolsWithHoles, so it's only listed (and compacted) once
+			bool                     HasHoles = false;
+		};
+		// Indexed by type ID, pools are only created once a component of their type is added
+		std::vector<ComponentPool> _pools;
+		// Every live component by GUID, so that cross references can be resolved without searching the pools
+		std::unordered_map<Guid, IComponent*> _componentsByGuid;
+
+		// Built on demand, and rebuilt if more types are registered
+		std::vector<UpdatePhase> _updatePhases;
+		size_t                   _updatePhaseTypeCount = 0;
+		// Where each pool starts when a phase's pools are laid end to end, see RunUpdatePhase
+		std::vector<uint32_t>    _phaseOffsets;
+
+		// How many iterations over the pools are running (they can nest). While iterating, removed components
+		// leave a hole in their pool rather than having the last component swapped in, which would skip it
+		uint32_t                 _iterationDepth = 0;
+		// The pools with holes to close once the iterations finish
+		std::vector<uint32_t>    _poolsWithHoles;
+
+		// Gets the access set a component type declares with a static UpdateAccess function, or All if it doesn't
+		template <typename T, typename = void>
+		struct _DeclaredAccess {
+			static ComponentAccess Get() { return ComponentAccess::All; }
+		};
+		template <typename T>
+		struct _DeclaredAccess<T, std::void_t<decltype(T::UpdateAccess())>> {
+			static ComponentAccess Get() { return T::UpdateAccess(); }
+		};
+
+		// True if a component type defines static FromBinary(BinaryReader&) and ToBinary(BinaryWriter&) const
+		template <typename T, typename = void>
+		struct _HasBinarySerializer : std::false_type { };
+		template <typename T>
+		struct _HasBinarySerializer<T, std::void_t<
+			decltype(T::FromBinary(std::declval<BinaryReader&>())),
+			decltype(std::declval<const T&>().ToBinary(std::declval<BinaryWriter&>()))>> : std::true_type { };
+
+		/// <summary>
+		/// Gets the ID of a registered component type, asserting if the type was never registered
+		/// </summary>
+		static uint32_t _LookupTypeId(const std::type_index& type) {
+			auto it = _TypeIds.find(type);
+			LOG_ASSERT(it != _TypeIds.end(), "You must register component types before creating them!");
+			return it->second;
+		}
+
+		template <typename ComponentType>
+		static uint32_t _TypeId() {
+			// Types are all registered before any components exist, so we only need to look the ID up once
+			static const uint32_t id = _LookupTypeId(std::type_index(typeid(ComponentType)));
+			return id;
+		}
+
+		inline ComponentPool* _GetPool(uint32_t typeId) {
+			return typeId < _pools.size() ? &_pools[typeId] : nullptr;
+		}
+
+		/// <summary>
+		/// Adds a component to the GUID lookup. If the GUID is already taken by a component whose object is
+		/// waiting to be deleted (ex: a streamed sector that was reloaded before its objects were flushed),
+		/// the new component takes over the entry, otherwise the first component keeps it
+		/// </summary>
+		void _IndexByGuid(IComponent* component);
+
+		/// <summary>
+		/// Ends an iteration started by incrementing _iterationDepth, closing any holes left by components
+		/// that were removed during it once the outermost iteration is done
+		/// </summary>
+		inline void _EndIteration() {
+			if (--_iterationDepth > 0) return;
+
+			for (uint32_t typeId : _poolsWithHoles) {
+				// Shift everything down over the holes, this keeps the pool in the same order
+				_pools[typeId].HasHoles = false;
+				std::vector<IComponent*>& pool = _pools[typeId].Components;
+				uint32_t count = 0;
+				for (IComponent* component : pool) {
+					if (component != nullptr) {
+						component->_poolIndex = count;
+						pool[count++] = component;
+					}
+				}
+				pool.resize(count);
+			}
+			_poolsWithHoles.clear();
+		}
 
-		// Weak pointers let us store a reference to an object stored by a shared pointer, without
-		// actually increasing the reference count. Thus components will be destroyed at the correct
-		// time (when the only reference is the one stored here).
-		std::unordered_map<std::type_index, std::vector<std::weak_ptr<IComponent>>> _Components;  
+		/// <summary>
+		/// Sets up a newly created component, and adds it to the end of its type's pool
+		/// </summary>
+		inline void _Add(const IComponent::Sptr& component, const std::type_index& type) {
+			// Make sure the component knows it's concrete type
+			component->_realType = type;
+			// Give the component a weak pointer to itself that it can upcast to a shared pointer when needed
+			component->_weakSelfPtr = component;
+
+			uint32_t typeId = _LookupTypeId(type);
+			if (typeId >= _pools.size()) {
+				_pools.resize(typeId + 1);
+			}
+			std::vector<IComponent*>& pool = _pools[typeId].Components;
+			component->_manager   = this;
+			component->_typeId    = typeId;
+			component->_poolIndex = (uint32_t)pool.size();
+			pool.push_back(component.get());
+			_IndexByGuid(component.get());
+		}
 
 		template <typename T>
 		static IComponent::Sptr ParseTypeFromBlob(const nlohmann::json& blob) {
 			return T::FromJson(blob);
 		}
 
+		template <typename T>
+		static IComponent::Sptr _ParseTypeFromBinary(BinaryReader& reader) {
+			return T::FromBinary(reader);
+		}
+
+		template <typename T>
+		static void _SaveTypeToBinary(const IComponent& component, BinaryWriter& writer) {
+			// The registry is keyed on the component's real type, so the cast is safe
+			static_cast<const T&>(component).ToBinary(writer);
+		}
+
+		template <typename T>
+		static IComponent::Sptr _CloneType(const IComponent& component) {
+			// The registry is keyed on the component's real type, so the cast is safe
+			const T& source = static_cast<const T&>(component);
+			if constexpr (std::is_copy_constructible<T>::value) {
+				return std::make_shared<T>(source);
+			} else {
+				return T::FromJson(source.ToJson());
+			}
+		}
+
 		template <typename ComponentType>
 		static IComponent::Sptr _InternalCreate() {
 			// We can use typeid and type_index to get a unique ID for our types
@@ -285,26 +610,34 @@ namespace Gameplay {
 		/// <summary>
 		/// Removes a given component from the global pools. To be used in the IComponent destructor
 		/// </summary>
-		/// <typeparam name="ComponentType">The type of component to destroy</typeparam>
 		/// <param name="component">A raw pointer to the component to remove (should be called from IComponent destructor)</param>
-		/// <returns>True if the element was removed, false if not</returns>
-		inline void Remove(const IComponent* component) {
-			if (_Components.size() == 0) return;
-
-			// Make sure the component's type was one that was registered
-			LOG_ASSERT(_TypeLoadRegistry[component->_realType] != nullptr, "You must register component types before creating them!");
-
-			
-			// Get a reference to the vector of components for easy access
-			std::vector<std::weak_ptr<IComponent>>& componentStore = _Components[component->_realType];
-
-			// Clear any dead weak pointers
-			auto it = std::remove_if(componentStore.begin(), componentStore.end(), [](const std::weak_ptr<IComponent>& ptr) {
-				return ptr.expired();
-				});
-			if (it != componentStore.end()) {
-				componentStore.erase(it);
+		inline void Remove(IComponent* component) {
+			if (component->_manager != this) return;
+
+			ComponentPool& typePool = _pools[component->_typeId];
+			std::vector<IComponent*>& pool = typePool.Components;
+			if (_iterationDepth > 0) {
+				// Someone may be part way through the pool, leave a hole that they can skip over
+				pool[component->_poolIndex] = nullptr;
+				if (!typePool.HasHoles) {
+					typePool.HasHoles = true;
+					_poolsWithHoles.push_back(component->_typeId);
+				}
+			} else {
+				// Swap the last component into the removed component's slot, so that the pool stays packed
+				IComponent* last = pool.back();
+				pool[component->_poolIndex] = last;
+				last->_poolIndex = component->_poolIndex;
+				pool.pop_back();
 			}
+
+			// A duplicated GUID stays with whichever component had it first
+			auto it = _componentsByGuid.find(component->GetGUID());
+			if (it != _componentsByGuid.end() && it->second == component) {
+				_componentsByGuid.erase(it);
+			}
+
+			component->_manager = nullptr;
 		}
 	};
 }
\ No newline at end of file
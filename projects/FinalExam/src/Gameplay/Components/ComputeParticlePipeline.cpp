@@ -0,0 +1,351 @@
+#include "Gameplay/Components/ComputeParticlePipeline.h"
+#include <numeric>
+
+// Shader storage bindings, these match the layouts in the compute shaders
+static const GLuint PARTICLE_BINDING   = 0;
+static const GLuint DEAD_LIST_BINDING  = 1;
+static const GLuint ALIVE_LIST_BINDING = 2;
+static const GLuint COUNTER_BINDING    = 3;
+static const GLuint EMITTER_BINDING    = 4;
+static const GLuint INDIRECT_BINDING   = 5;
+static const GLuint SORT_KEY_BINDING   = 6;
+static const GLuint SORT_VALUE_BINDING = 7;
+
+// Offset of the simulation dispatch args in the indirect buffer, after the draw args
+static const GLintptr DISPATCH_ARGS_OFFSET = sizeof(GLuint) * 4;
+
+// Thread group size of the emission shader
+static const GLuint EMIT_GROUP_SIZE = 64;
+// Particles are drawn as two triangles each, pulled from the draw list by the vertex shader
+static const GLuint VERTICES_PER_PARTICLE = 6;
+
+static ShaderProgram::Sptr LoadComputeShader(const char* path) {
+	ShaderProgram::Sptr result = ShaderProgram::Create();
+	result->LoadShaderPartFromFile(path, ShaderPartType::Compute);
+	result->Link();
+	return result;
+}
+
+ComputeParticlePipeline::ComputeParticlePipeline() :
+	_capacity(0),
+	_sortSize(0),
+	_current(0),
+	_frame(0),
+	_hasUpdated(false),
+	_emitters(std::vector<ParticleSystem::ParticleData>()),
+	_emitRequests(std::vector<EmitRequest>()),
+	_particleBuffer(0),
+	_deadListBuffer(0),
+	_aliveListBuffer(0),
+	_counterBuffer(0),
+	_emitterBuffer(0),
+	_indirectBuffer(0),
+	_sortKeyBuffer(0),
+	_sortValueBuffer(0),
+	_emptyVao(0),
+	_emitterBufferSize(0),
+	_readbackBuffers(),
+	_readbackFences(),
+	_readbackIndex(0),
+	_particleCount(0)
+{
+	_simulateShader = LoadComputeShader("shaders/compute_shaders/particles_simulate.glsl");
+	_emitShader     = LoadComputeShader("shaders/compute_shaders/particles_emit.glsl");
+	_finalizeShader = LoadComputeShader("shaders/compute_shaders/particles_finalize.glsl");
+	_sortKeysShader = LoadComputeShader("shaders/compute_shaders/particles_sort_keys.glsl");
+	_sortShader     = LoadComputeShader("shaders/compute_shaders/particles_bitonic_sort.glsl");
+
+	// The vertex shader builds the quads itself, so only the fragment stage is shared with the transform feedback path
+	_renderShader = ShaderProgram::Create();
+	_renderShader->LoadShaderPartFromFile("shaders/vertex_shaders/particles_compute_render_vs.glsl", ShaderPartType::Vertex);
+	_renderShader->LoadShaderPartFromFile("shaders/fragment_shaders/particles_render_fs.glsl", ShaderPartType::Fragment);
+	_renderShader->Link();
+
+	// Core profile won't let us draw without a VAO, even though all our data comes from storage buffers
+	glCreateVertexArrays(1, &_emptyVao);
+	glCreateBuffers(READBACK_FRAMES, _readbackBuffers);
+	for (int ix = 0; ix < READBACK_FRAMES; ix++) {
+		glNamedBufferStorage(_readbackBuffers[ix], sizeof(GLuint), nullptr, GL_CLIENT_STORAGE_BIT | GL_DYNAMIC_STORAGE_BIT);
+	}
+}
+
+ComputeParticlePipeline::~ComputeParticlePipeline()
+{
+	_DeleteBuffers();
+	glDeleteVertexArrays(1, &_emptyVao);
+	glDeleteBuffers(READBACK_FRAMES, _readbackBuffers);
+	for (int ix = 0; ix < READBACK_FRAMES; ix++) {
+		if (_readbackFences[ix] != nullptr) {
+			glDeleteSync(_readbackFences[ix]);
+		}
+	}
+}
+
+uint32_t ComputeParticlePipeline::_CalcSortSize(uint32_t capacity)
+{
+	uint32_t result = SORT_BLOCK_SIZE;
+	while (result < capacity) {
+		result <<= 1;
+	}
+	return result;
+}
+
+size_t ComputeParticlePipeline::CalcMemorySize(uint32_t capacity)
+{
+	// Must match the sizes in _CreateBuffers
+	capacity = std::max(capacity, 1u);
+	uint32_t sortSize = _CalcSortSize(capacity);
+	return
+		capacity * PARTICLE_SIZE +
+		capacity * sizeof(GLuint) * 3 +
+		sizeof(GLuint) * 11 +
+		sortSize * (sizeof(float) + sizeof(GLuint));
+}
+
+void ComputeParticlePipeline::_CreateBuffers()
+{
+	_sortSize = _CalcSortSize(_capacity);
+
+	GLuint buffers[7];
+	glCreateBuffers(7, buffers);
+	_particleBuffer  = buffers[0];
+	_deadListBuffer  = buffers[1];
+	_aliveListBuffer = buffers[2];
+	_counterBuffer   = buffers[3];
+	_indirectBuffer  = buffers[4];
+	_sortKeyBuffer   = buffers[5];
+	_sortValueBuffer = buffers[6];
+
+	glNamedBufferStorage(_particleBuffer,  _capacity * PARTICLE_SIZE, nullptr, 0);
+	glNamedBufferStorage(_deadListBuffer,  _capacity * sizeof(GLuint), nullptr, GL_DYNAMIC_STORAGE_BIT);
+	glNamedBufferStorage(_aliveListBuffer, _capacity * sizeof(GLuint) * 2, nullptr, 0);
+	glNamedBufferStorage(_counterBuffer,   sizeof(GLuint) * 4, nullptr, GL_DYNAMIC_STORAGE_BIT);
+	glNamedBufferStorage(_indirectBuffer,  sizeof(GLuint) * 7, nullptr, GL_DYNAMIC_STORAGE_BIT);
+	glNamedBufferStorage(_sortKeyBuffer,   _sortSize * sizeof(float), nullptr, 0);
+	glNamedBufferStorage(_sortValueBuffer, _sortSize * sizeof(GLuint), nullptr, 0);
+}
+
+void ComputeParticlePipeline::_DeleteBuffers()
+{
+	GLuint buffers[8] = {
+		_particleBuffer, _deadListBuffer, _aliveListBuffer, _counterBuffer,
+		_indirectBuffer, _sortKeyBuffer, _sortValueBuffer, _emitterBuffer
+	};
+	glDeleteBuffers(8, buffers);
+	_particleBuffer = _deadListBuffer = _aliveListBuffer = _counterBuffer = 0;
+	_indirectBuffer = _sortKeyBuffer = _sortValueBuffer = _emitterBuffer = 0;
+	_emitterBufferSize = 0;
+}
+
+void ComputeParticlePipeline::Reset(const std::vector<ParticleSystem::ParticleData>& emitters, uint32_t capacity)
+{
+	_emitters = emitters;
+	capacity = std::max(capacity, 1u);
+
+	if (capacity != _capacity) {
+		_DeleteBuffers();
+		_capacity = capacity;
+		_CreateBuffers();
+	}
+
+	// Every slot starts out free
+	std::vector<GLuint> deadList(_capacity);
+	std::iota(deadList.begin(), deadList.end(), 0);
+	glNamedBufferSubData(_deadListBuffer, 0, deadList.size() * sizeof(GLuint), deadList.data());
+
+	GLuint counters[4] = { _capacity, 0, 0, 0 };
+	glNamedBufferSubData(_counterBuffer, 0, sizeof(counters), counters);
+
+	GLuint args[7] = { 0, 1, 0, 0, 0, 1, 1 };
+	glNamedBufferSubData(_indirectBuffer, 0, sizeof(args), args);
+
+	_current = 0;
+	_hasUpdated = false;
+	_particleCount = 0;
+}
+
+void ComputeParticlePipeline::_BindPool()
+{
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, PARTICLE_BINDING,   _particleBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, DEAD_LIST_BINDING,  _deadListBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, ALIVE_LIST_BINDING, _aliveListBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, COUNTER_BINDING,    _counterBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, INDIRECT_BINDING,   _indirectBuffer);
+}
+
+void ComputeParticlePipeline::Update(float deltaTime, const glm::vec3& gravity, const glm::mat4& model, float emissionScale)
+{
+	if (_capacity == 0) return;
+
+	_ReadCount();
+	_BindPool();
+
+	// Move existing particles, survivors go into the other alive list and the rest go back on the dead list.
+	// The number of groups was written by the GPU at the end of the last update
+	_simulateShader->Bind();
+	_simulateShader->SetUniform("u_Capacity", _capacity);
+	_simulateShader->SetUniform("u_Current", _current);
+	_simulateShader->SetUniform("u_DeltaTime", deltaTime);
+	_simulateShader->SetUniform("u_Gravity", gravity);
+	glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, _indirectBuffer);
+	glDispatchComputeIndirect(DISPATCH_ARGS_OFFSET);
+	glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, 0);
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+	// Emitter timers are cheap enough to keep on the CPU, the GPU only needs to know how many to spawn. There's
+	// no geometry shader limit here, an emitter can spawn as many particles as the pool can hold
+	_emitRequests.clear();
+	uint32_t totalEmit = 0;
+	for (auto& emitter : _emitters) {
+		float startLifetime = 0.0f;
+		int toEmit = ParticleSystem::AdvanceEmitter(emitter, deltaTime, startLifetime, emissionScale, (int)_capacity);
+		if (toEmit == 0) continue;
+
+		EmitRequest request;
+		request.Info      = glm::uvec4(*emitter.Type, emitter.TexID, toEmit, totalEmit);
+		request.Position  = glm::vec4(emitter.Position, startLifetime);
+		request.Velocity  = glm::vec4(emitter.Common.Velocity, 0.0f);
+		request.Color     = emitter.Color;
+		request.Metadata  = emitter.Common.Metadata;
+		request.Metadata2 = emitter.Common.Metadata2;
+		_emitRequests.push_back(request);
+		totalEmit += toEmit;
+	}
+	// Threads past what the pool can hold would only find the dead list empty
+	totalEmit = std::min(totalEmit, _capacity);
+
+	if (!_emitRequests.empty()) {
+		size_t size = _emitRequests.size() * sizeof(EmitRequest);
+		if (size > _emitterBufferSize) {
+			glDeleteBuffers(1, &_emitterBuffer);
+			glCreateBuffers(1, &_emitterBuffer);
+			glNamedBufferStorage(_emitterBuffer, size, nullptr, GL_DYNAMIC_STORAGE_BIT);
+			_emitterBufferSize = size;
+		}
+		glNamedBufferSubData(_emitterBuffer, 0, size, _emitRequests.data());
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, EMITTER_BINDING, _emitterBuffer);
+
+		_emitShader->Bind();
+		_emitShader->SetUniform("u_Capacity", _capacity);
+		_emitShader->SetUniform("u_Current", _current);
+		_emitShader->SetUniformMatrix("u_ModelMatrix", model);
+		_emitShader->SetUniform("u_Seed", _frame);
+		_emitShader->SetUniform("u_EmitterCount", (uint32_t)_emitRequests.size());
+		_emitShader->SetUniform("u_TotalEmit", totalEmit);
+		// One thread per new particle across every emitter, see the prefix sum in Info.w
+		glDispatchCompute((totalEmit + EMIT_GROUP_SIZE - 1) / EMIT_GROUP_SIZE, 1, 1);
+		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+	}
+
+	// Write the draw and dispatch args for the particles we just produced
+	_finalizeShader->Bind();
+	_finalizeShader->SetUniform("u_Capacity", _capacity);
+	_finalizeShader->SetUniform("u_Current", _current);
+	glDispatchCompute(1, 1, 1);
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+
+	// Grab a copy of the draw count, we'll read it once the GPU has caught up. It's in vertices, see _ReadCount
+	glCopyNamedBufferSubData(_indirectBuffer, _readbackBuffers[_readbackIndex], 0, 0, sizeof(GLuint));
+	if (_readbackFences[_readbackIndex] != nullptr) {
+		glDeleteSync(_readbackFences[_readbackIndex]);
+	}
+	_readbackFences[_readbackIndex] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	_readbackIndex = (_readbackIndex + 1) % READBACK_FRAMES;
+
+	_current = 1 - _current;
+	_frame++;
+	_hasUpdated = true;
+}
+
+void ComputeParticlePipeline::_ReadCount()
+{
+	// The oldest copy is the one we're about to overwrite, only read it if the GPU is done with it
+	GLsync fence = _readbackFences[_readbackIndex];
+	if (fence == nullptr) return;
+
+	if (glClientWaitSync(fence, 0, 0) != GL_TIMEOUT_EXPIRED) {
+		GLuint vertexCount = 0;
+		glGetNamedBufferSubData(_readbackBuffers[_readbackIndex], 0, sizeof(GLuint), &vertexCount);
+		_particleCount = vertexCount / VERTICES_PER_PARTICLE;
+	}
+	glDeleteSync(fence);
+	_readbackFences[_readbackIndex] = nullptr;
+}
+
+void ComputeParticlePipeline::_Sort()
+{
+	_BindPool();
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SORT_KEY_BINDING,   _sortKeyBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SORT_VALUE_BINDING, _sortValueBuffer);
+
+	_sortKeysShader->Bind();
+	_sortKeysShader->SetUniform("u_Capacity", _capacity);
+	_sortKeysShader->SetUniform("u_Current", _current);
+	glDispatchCompute(_sortSize / 256, 1, 1);
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+	const uint32_t STAGE_LOCAL_SORT  = 0;
+	const uint32_t STAGE_GLOBAL_STEP = 1;
+	const uint32_t STAGE_LOCAL_MERGE = 2;
+	const GLuint blocks = _sortSize / SORT_BLOCK_SIZE;
+	const GLuint pairGroups = (_sortSize / 2) / (SORT_BLOCK_SIZE / 2);
+
+	_sortShader->Bind();
+
+	// Sort each block in shared memory first, then merge blocks together. Steps where pairs are further
+	// apart than a block have to go through global memory, the rest of each merge can stay in shared memory
+	_sortShader->SetUniform("u_Stage", STAGE_LOCAL_SORT);
+	glDispatchCompute(blocks, 1, 1);
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+
+	for (uint32_t k = SORT_BLOCK_SIZE * 2; k <= _sortSize; k <<= 1) {
+		_sortShader->SetUniform("u_K", k);
+		_sortShader->SetUniform("u_Stage", STAGE_GLOBAL_STEP);
+		for (uint32_t j = k / 2; j >= SORT_BLOCK_SIZE; j >>= 1) {
+			_sortShader->SetUniform("u_J", j);
+			glDispatchCompute(pairGroups, 1, 1);
+			glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+		}
+
+		_sortShader->SetUniform("u_Stage", STAGE_LOCAL_MERGE);
+		glDispatchCompute(blocks, 1, 1);
+		glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+	}
+}
+
+void ComputeParticlePipeline::Render(bool depthSort)
+{
+	if (!_hasUpdated) return;
+
+	if (depthSort) {
+		_Sort();
+	}
+
+	_BindPool();
+	_renderShader->Bind();
+	_renderShader->SetUniform("u_Capacity", _capacity);
+	_renderShader->SetUniform("u_Current", _current);
+	if (depthSort) {
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SORT_VALUE_BINDING, _sortValueBuffer);
+		_renderShader->SetUniform("u_ListOffset", 0u);
+	} else {
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, SORT_VALUE_BINDING, _aliveListBuffer);
+		_renderShader->SetUniform("u_ListOffset", _current * _capacity);
+	}
+
+	glBindVertexArray(_emptyVao);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, _indirectBuffer);
+	glDrawArraysIndirect(GL_TRIANGLES, nullptr);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+	glBindVertexArray(0);
+}
+
+uint32_t ComputeParticlePipeline::GetParticleCount() const
+{
+	return _particleCount;
+}
+
+uint32_t ComputeParticlePipeline::GetCapacity() const
+{
+	return _capacity;
+}
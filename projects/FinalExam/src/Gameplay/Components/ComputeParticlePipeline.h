@@ -0,0 +1,123 @@
+#pragma once
+#include <vector>
+#include "Gameplay/Components/ParticleSystem.h"
+#include "Graphics/ShaderProgram.h"
+
+/// <summary>
+/// Simulates and renders a particle system entirely with compute shaders, as an alternative to the
+/// geometry shader / transform feedback path
+///
+/// Particles live in a fixed size pool, with a dead list of free slots and two alive lists that are
+/// ping-ponged between updates. Emission pops slots off the dead list with atomic counters, and the
+/// draw count is written into an indirect args buffer on the GPU, so the CPU never has to wait on
+/// the simulation. Before drawing, live particles can be bitonic sorted back to front by view depth so
+/// that alpha blending is correct. Particles are drawn as quads that the vertex shader builds from
+/// the draw list, six vertices per particle, so there's no geometry shader on this path
+///
+/// See the shaders in shaders/compute_shaders and fragments/particle_pool.glsl
+/// </summary>
+class ComputeParticlePipeline final {
+public:
+	MAKE_PTRS(ComputeParticlePipeline);
+	NO_COPY(ComputeParticlePipeline);
+	NO_MOVE(ComputeParticlePipeline);
+
+	ComputeParticlePipeline();
+	~ComputeParticlePipeline();
+
+	/// <summary>
+	/// Removes all particles and restarts the emitters, reallocating the pool if the capacity has changed
+	/// </summary>
+	/// <param name="emitters">The emitters to simulate</param>
+	/// <param name="capacity">The maximum number of live particles</param>
+	void Reset(const std::vector<ParticleSystem::ParticleData>& emitters, uint32_t capacity);
+
+	/// <summary>
+	/// Dispatches the simulation and emission for one time step
+	/// </summary>
+	/// <param name="deltaTime">The time step in seconds</param>
+	/// <param name="gravity">The acceleration to apply to all particles, in world units</param>
+	/// <param name="model">The transform of the particle system, emitters are in its local space</param>
+	/// <param name="emissionScale">Multiplier for the emitters' spawn rates</param>
+	void Update(float deltaTime, const glm::vec3& gravity, const glm::mat4& model, float emissionScale = 1.0f);
+
+	/// <summary>
+	/// Draws the live particles, expects the frame uniforms to hold the camera we are drawing for
+	/// </summary>
+	/// <param name="depthSort">True to sort particles back to front before drawing</param>
+	void Render(bool depthSort);
+
+	/// <summary>
+	/// Gets the number of live particles from a few frames ago. This is read back asynchronously,
+	/// so it should only be used for debugging
+	/// </summary>
+	uint32_t GetParticleCount() const;
+	uint32_t GetCapacity() const;
+
+	/// <summary>
+	/// Gets the number of bytes of GPU memory the pipeline allocates for a given capacity, not counting
+	/// the small per-emitter buffer
+	/// </summary>
+	/// <param name="capacity">The maximum number of live particles</param>
+	static size_t CalcMemorySize(uint32_t capacity);
+
+protected:
+	// Matches EmitRequest in particles_emit.glsl, Info.w is the number of particles that the emitters
+	// before this one are spawning, so that emission can be a single dispatch over every new particle
+	struct EmitRequest {
+		glm::uvec4 Info;
+		glm::vec4  Position;
+		glm::vec4  Velocity;
+		glm::vec4  Color;
+		glm::vec4  Metadata;
+		glm::vec4  Metadata2;
+	};
+
+	// Matches Particle in particle_pool.glsl
+	static const size_t PARTICLE_SIZE = sizeof(glm::vec4) * 4;
+	static const uint32_t SORT_BLOCK_SIZE = 1024;
+	static const int READBACK_FRAMES = 3;
+
+	uint32_t _capacity;
+	// The capacity rounded up to a power of two, since that's what the bitonic sort works on
+	uint32_t _sortSize;
+	// The alive list that holds the results of the last update
+	uint32_t _current;
+	uint32_t _frame;
+	bool     _hasUpdated;
+
+	std::vector<ParticleSystem::ParticleData> _emitters;
+	std::vector<EmitRequest> _emitRequests;
+
+	GLuint _particleBuffer;
+	GLuint _deadListBuffer;
+	GLuint _aliveListBuffer;
+	GLuint _counterBuffer;
+	GLuint _emitterBuffer;
+	GLuint _indirectBuffer;
+	GLuint _sortKeyBuffer;
+	GLuint _sortValueBuffer;
+	GLuint _emptyVao;
+	size_t _emitterBufferSize;
+
+	// Small copies of the draw count so we can see how many particles there are without stalling
+	GLuint   _readbackBuffers[READBACK_FRAMES];
+	GLsync   _readbackFences[READBACK_FRAMES];
+	int      _readbackIndex;
+	uint32_t _particleCount;
+
+	ShaderProgram::Sptr _simulateShader;
+	ShaderProgram::Sptr _emitShader;
+	ShaderProgram::Sptr _finalizeShader;
+	ShaderProgram::Sptr _sortKeysShader;
+	ShaderProgram::Sptr _sortShader;
+	ShaderProgram::Sptr _renderShader;
+
+	static uint32_t _CalcSortSize(uint32_t capacity);
+
+	void _CreateBuffers();
+	void _DeleteBuffers();
+	void _BindPool();
+	void _Sort();
+	void _ReadCount();
+};
@@ -0,0 +1,271 @@
+#include "Gameplay/Components/CpuParticleSimulator.h"
+#include <chrono>
+#include <GLM/gtc/constants.hpp>
+#include <immintrin.h>
+#include "Utils/JobSystem.h"
+
+// Number of particles each job integrates, small systems just run on the calling thread
+static const uint32_t CHUNK_SIZE = 4096;
+
+CpuParticleSimulator::CpuParticleSimulator() :
+	_emitters(std::vector<ParticleSystem::ParticleData>()),
+	_rngState(1),
+	_count(0),
+	_lastUpdateMs(0.0)
+{ }
+
+void CpuParticleSimulator::Reset(const std::vector<ParticleSystem::ParticleData>& emitters, uint32_t seed)
+{
+	_emitters = emitters;
+	// Xorshift gets stuck on 0
+	_rngState = seed != 0 ? seed : 1;
+	_count = 0;
+}
+
+void CpuParticleSimulator::Update(float deltaTime, const glm::vec3& gravity, const glm::mat4& model, uint32_t maxParticles, float emissionScale)
+{
+	auto start = std::chrono::steady_clock::now();
+
+	_Reserve(maxParticles);
+
+	// Existing particles first, so that new particles aren't moved on the frame they spawn (same as the GPU)
+	JobSystem::ParallelFor(_count, CHUNK_SIZE, [&](uint32_t begin, uint32_t end) {
+		_Integrate(begin, end, deltaTime, gravity);
+	});
+	_Compact();
+
+	for (auto& emitter : _emitters) {
+		_Emit(emitter, deltaTime, model, maxParticles, emissionScale);
+	}
+
+	_lastUpdateMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void CpuParticleSimulator::_Reserve(uint32_t capacity)
+{
+	if (_lifetime.size() >= capacity) return;
+
+	_positionX.resize(capacity);
+	_positionY.resize(capacity);
+	_positionZ.resize(capacity);
+	_velocityX.resize(capacity);
+	_velocityY.resize(capacity);
+	_velocityZ.resize(capacity);
+	_lifetime.resize(capacity);
+	_startLifetime.resize(capacity);
+	_size.resize(capacity);
+	_alpha.resize(capacity);
+	_color.resize(capacity);
+	_texID.resize(capacity);
+}
+
+void CpuParticleSimulator::_Integrate(uint32_t start, uint32_t end, float deltaTime, const glm::vec3& gravity)
+{
+	float* px = _positionX.data();
+	float* py = _positionY.data();
+	float* pz = _positionZ.data();
+	float* vx = _velocityX.data();
+	float* vy = _velocityY.data();
+	float* vz = _velocityZ.data();
+	float* life = _lifetime.data();
+	const float* startLife = _startLifetime.data();
+	float* alpha = _alpha.data();
+
+	uint32_t ix = start;
+
+	// Note that we stick to separate multiplies and adds, so that the SIMD and scalar paths give the same results
+	{
+		const __m128 dt = _mm_set1_ps(deltaTime);
+		const __m128 gx = _mm_set1_ps(gravity.x * deltaTime);
+		const __m128 gy = _mm_set1_ps(gravity.y * deltaTime);
+		const __m128 gz = _mm_set1_ps(gravity.z * deltaTime);
+		for (; ix + 4 <= end; ix += 4) {
+			__m128 velX = _mm_loadu_ps(vx + ix);
+			__m128 velY = _mm_loadu_ps(vy + ix);
+			__m128 velZ = _mm_loadu_ps(vz + ix);
+			_mm_storeu_ps(px + ix, _mm_add_ps(_mm_loadu_ps(px + ix), _mm_mul_ps(velX, dt)));
+			_mm_storeu_ps(py + ix, _mm_add_ps(_mm_loadu_ps(py + ix), _mm_mul_ps(velY, dt)));
+			_mm_storeu_ps(pz + ix, _mm_add_ps(_mm_loadu_ps(pz + ix), _mm_mul_ps(velZ, dt)));
+			_mm_storeu_ps(vx + ix, _mm_add_ps(velX, gx));
+			_mm_storeu_ps(vy + ix, _mm_add_ps(velY, gy));
+			_mm_storeu_ps(vz + ix, _mm_add_ps(velZ, gz));
+
+			__m128 remaining = _mm_sub_ps(_mm_loadu_ps(life + ix), dt);
+			_mm_storeu_ps(life + ix, remaining);
+			_mm_storeu_ps(alpha + ix, _mm_div_ps(remaining, _mm_loadu_ps(startLife + ix)));
+		}
+	}
+
+	// Whatever doesn't fit into a full register
+	const glm::vec3 gravityStep = gravity * deltaTime;
+	for (; ix < end; ix++) {
+		px[ix] = px[ix] + vx[ix] * deltaTime;
+		py[ix] = py[ix] + vy[ix] * deltaTime;
+		pz[ix] = pz[ix] + vz[ix] * deltaTime;
+		vx[ix] = vx[ix] + gravityStep.x;
+		vy[ix] = vy[ix] + gravityStep.y;
+		vz[ix] = vz[ix] + gravityStep.z;
+		life[ix] = life[ix] - deltaTime;
+		alpha[ix] = life[ix] / startLife[ix];
+	}
+}
+
+void CpuParticleSimulator::_Compact()
+{
+	// Keeps the survivors in their original order, this is what keeps the simulation deterministic
+	uint32_t alive = 0;
+	for (uint32_t ix = 0; ix < _count; ix++) {
+		if (_lifetime[ix] > 0.0f) {
+			if (alive != ix) {
+				_positionX[alive]     = _positionX[ix];
+				_positionY[alive]     = _positionY[ix];
+				_positionZ[alive]     = _positionZ[ix];
+				_velocityX[alive]     = _velocityX[ix];
+				_velocityY[alive]     = _velocityY[ix];
+				_velocityZ[alive]     = _velocityZ[ix];
+				_lifetime[alive]      = _lifetime[ix];
+				_startLifetime[alive] = _startLifetime[ix];
+				_size[alive]          = _size[ix];
+				_alpha[alive]         = _alpha[ix];
+				_color[alive]         = _color[ix];
+				_texID[alive]         = _texID[ix];
+			}
+			alive++;
+		}
+	}
+	_count = alive;
+}
+
+float CpuParticleSimulator::_Random()
+{
+	// Xorshift32, we only need something fast and repeatable
+	_rngState ^= _rngState << 13;
+	_rngState ^= _rngState >> 17;
+	_rngState ^= _rngState << 5;
+	return (_rngState >> 8) * (1.0f / 16777216.0f);
+}
+
+void CpuParticleSimulator::_Spawn(const ParticleSystem::ParticleData& emitter, const glm::vec3& position, const glm::vec3& velocity, const glm::vec2& lifeRange, const glm::vec2& sizeRange)
+{
+	float lifetime = lifeRange.x + (lifeRange.y - lifeRange.x) * _Random();
+	float size     = sizeRange.x + (sizeRange.y - sizeRange.x) * _Random();
+
+	_positionX[_count]     = position.x;
+	_positionY[_count]     = position.y;
+	_positionZ[_count]     = position.z;
+	_velocityX[_count]     = velocity.x;
+	_velocityY[_count]     = velocity.y;
+	_velocityZ[_count]     = velocity.z;
+	_lifetime[_count]      = lifetime;
+	_startLifetime[_count] = lifetime;
+	_size[_count]          = size;
+	_alpha[_count]         = emitter.Color.a;
+	_color[_count]         = glm::vec3(emitter.Color);
+	_texID[_count]         = emitter.TexID;
+	_count++;
+}
+
+void CpuParticleSimulator::_Emit(ParticleSystem::ParticleData& emitter, float deltaTime, const glm::mat4& model, uint32_t maxParticles, float emissionScale)
+{
+	const glm::vec4& meta  = emitter.Common.Metadata;
+	const glm::vec4& meta2 = emitter.Common.Metadata2;
+	float startLife = 0.0f;
+	int toEmit = ParticleSystem::AdvanceEmitter(emitter, deltaTime, startLife, emissionScale);
+
+	const glm::mat3 rotation = glm::mat3(model);
+
+	// Cone emitters need a basis around their direction, this only depends on the emitter
+	glm::vec3 coneAxis, crossX, crossY;
+	if (emitter.Type == ParticleType::ConeEmitter) {
+		coneAxis = glm::normalize(emitter.Common.Velocity);
+		crossX = glm::vec3(-coneAxis.z, coneAxis.x, coneAxis.y);
+		if (glm::dot(crossX, coneAxis) > 0.001f) {
+			crossX = glm::vec3(-coneAxis.y, coneAxis.x, coneAxis.z);
+		}
+		crossY = glm::cross(coneAxis, crossX);
+	}
+
+	for (int ix = 0; ix < toEmit && _count < maxParticles; ix++) {
+		// Back-date each particle to when it should have spawned during this step
+		float timeAdjust = -startLife + (ix * meta.x);
+
+		switch (emitter.Type) {
+			case ParticleType::StreamEmitter:
+			{
+				glm::vec3 velocity = emitter.Common.Velocity;
+				glm::vec3 position = glm::vec3(model * glm::vec4(emitter.Position + velocity * timeAdjust, 1.0f));
+				_Spawn(emitter, position, rotation * velocity, glm::vec2(meta.z, meta.w), glm::vec2(meta2.x, meta2.y));
+			}
+			break;
+			case ParticleType::SphereEmitter:
+			{
+				float speed  = emitter.Common.Velocity.x;
+				float radius = emitter.Common.Velocity.y;
+
+				float z   = _Random() * 2.0f - 1.0f;
+				float rxy = glm::sqrt(1.0f - z * z);
+				float phi = _Random() * glm::two_pi<float>();
+				glm::vec3 direction = glm::vec3(rxy * glm::cos(phi), rxy * glm::sin(phi), z);
+				glm::vec3 offset = direction * _Random() * radius;
+
+				glm::vec3 velocity = direction * speed;
+				glm::vec3 position = glm::vec3(model * glm::vec4(emitter.Position + offset + velocity * timeAdjust, 1.0f));
+				_Spawn(emitter, position, rotation * velocity, glm::vec2(meta.z, meta.w), glm::vec2(meta2.x, meta2.y));
+			}
+			break;
+			case ParticleType::BoxEmitter:
+			{
+				glm::vec3 halfExtents = glm::vec3(meta2.y, meta2.z, meta2.w);
+				glm::vec3 offset = glm::vec3(
+					(_Random() * 2.0f - 1.0f) * halfExtents.x,
+					(_Random() * 2.0f - 1.0f) * halfExtents.y,
+					(_Random() * 2.0f - 1.0f) * halfExtents.z
+				);
+				glm::vec3 velocity = glm::length(offset) > 0.0f ? glm::normalize(offset) * emitter.Common.Velocity : glm::vec3(0.0f);
+				glm::vec3 position = glm::vec3(model * glm::vec4(emitter.Position + offset + velocity * timeAdjust, 1.0f));
+				_Spawn(emitter, position, rotation * velocity, glm::vec2(meta.w, meta2.x), glm::vec2(meta.y, meta.z));
+			}
+			break;
+			case ParticleType::ConeEmitter:
+			{
+				float angle = meta.y;
+				float theta = glm::acos(glm::mix(glm::cos(angle), 1.0f, _Random()));
+				float phi   = _Random() * glm::two_pi<float>();
+
+				glm::vec3 velocity = glm::sin(theta) * (glm::cos(phi) * crossX + glm::sin(phi) * crossY) + glm::cos(theta) * coneAxis;
+				velocity *= glm::length(emitter.Common.Velocity);
+				glm::vec3 position = glm::vec3(model * glm::vec4(emitter.Position + velocity * timeAdjust, 1.0f));
+				_Spawn(emitter, position, rotation * velocity, glm::vec2(meta.z, meta.w), glm::vec2(meta2.x, meta2.y));
+			}
+			break;
+			default:
+				return;
+		}
+	}
+}
+
+void CpuParticleSimulator::WriteParticles(std::vector<ParticleSystem::ParticleData>& output) const
+{
+	output.resize(_count);
+	for (uint32_t ix = 0; ix < _count; ix++) {
+		ParticleSystem::ParticleData& particle = output[ix];
+		particle.Type      = ParticleType::Particle;
+		particle.TexID     = _texID[ix];
+		particle.Position  = glm::vec3(_positionX[ix], _positionY[ix], _positionZ[ix]);
+		particle.Color     = glm::vec4(_color[ix], _alpha[ix]);
+		particle.Lifetime  = _lifetime[ix];
+		particle.Common.Velocity  = glm::vec3(_velocityX[ix], _velocityY[ix], _velocityZ[ix]);
+		particle.Common.Metadata  = glm::vec4(_startLifetime[ix], _size[ix], 0.0f, 0.0f);
+		particle.Common.Metadata2 = glm::vec4(0.0f);
+	}
+}
+
+uint32_t CpuParticleSimulator::GetParticleCount() const
+{
+	return _count;
+}
+
+double CpuParticleSimulator::GetLastUpdateMs() const
+{
+	return _lastUpdateMs;
+}
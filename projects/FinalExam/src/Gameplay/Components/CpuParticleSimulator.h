@@ -0,0 +1,79 @@
+#pragma once
+#include <vector>
+#include "Gameplay/Components/ParticleSystem.h"
+
+/// <summary>
+/// Simulates a particle system on the CPU, matching the behaviour of particle_sim_gs.glsl
+///
+/// Particles are stored as a structure of arrays so that they can be integrated with SSE, and large
+/// systems are split into chunks across the job system.
+/// All randomness comes from a seeded generator and particles are only ever compacted on a single thread,
+/// so the same seed and sequence of time steps will always produce the same particles (ex: for replays)
+/// </summary>
+class CpuParticleSimulator final {
+public:
+	MAKE_PTRS(CpuParticleSimulator);
+	NO_COPY(CpuParticleSimulator);
+	NO_MOVE(CpuParticleSimulator);
+
+	CpuParticleSimulator();
+	~CpuParticleSimulator() = default;
+
+	/// <summary>
+	/// Removes all particles and restarts the emitters
+	/// </summary>
+	/// <param name="emitters">The emitters to simulate, types and metadata match ParticleSystem::ParticleData</param>
+	/// <param name="seed">The seed for the random number generator</param>
+	void Reset(const std::vector<ParticleSystem::ParticleData>& emitters, uint32_t seed);
+
+	/// <summary>
+	/// Steps the simulation forwards, existing particles are moved before the emitters spawn new ones
+	/// </summary>
+	/// <param name="deltaTime">The time step in seconds</param>
+	/// <param name="gravity">The acceleration to apply to all particles, in world units</param>
+	/// <param name="model">The transform of the particle system, emitters are in its local space</param>
+	/// <param name="maxParticles">The maximum number of particles, new particles are dropped once this is reached</param>
+	/// <param name="emissionScale">Multiplier for the emitters' spawn rates</param>
+	void Update(float deltaTime, const glm::vec3& gravity, const glm::mat4& model, uint32_t maxParticles, float emissionScale = 1.0f);
+
+	/// <summary>
+	/// Converts the live particles into the layout that the particle rendering shaders expect
+	/// </summary>
+	/// <param name="output">The array to write into, will be resized to the particle count</param>
+	void WriteParticles(std::vector<ParticleSystem::ParticleData>& output) const;
+
+	uint32_t GetParticleCount() const;
+	/// <summary>
+	/// Gets the wall clock time that the last call to Update took, in milliseconds
+	/// </summary>
+	double GetLastUpdateMs() const;
+
+protected:
+	// Copies of the emitters, so we can track their spawn timers
+	std::vector<ParticleSystem::ParticleData> _emitters;
+
+	uint32_t _rngState;
+	uint32_t _count;
+	double   _lastUpdateMs;
+
+	std::vector<float>    _positionX;
+	std::vector<float>    _positionY;
+	std::vector<float>    _positionZ;
+	std::vector<float>    _velocityX;
+	std::vector<float>    _velocityY;
+	std::vector<float>    _velocityZ;
+	std::vector<float>    _lifetime;
+	std::vector<float>    _startLifetime;
+	std::vector<float>    _size;
+	std::vector<float>    _alpha;
+	std::vector<glm::vec3> _color;
+	std::vector<uint32_t> _texID;
+
+	// Returns a random number in the range [0, 1)
+	float _Random();
+	void _Reserve(uint32_t capacity);
+	void _Integrate(uint32_t start, uint32_t end, float deltaTime, const glm::vec3& gravity);
+	void _Compact();
+	void _Emit(ParticleSystem::ParticleData& emitter, float deltaTime, const glm::mat4& model, uint32_t maxParticles, float emissionScale);
+	void _Spawn(const ParticleSystem::ParticleData& emitter, const glm::vec3& position, const glm::vec3& velocity, const glm::vec2& lifeRange, const glm::vec2& sizeRange);
+};
@@ -14,7 +14,7 @@ namespace Gameplay {
 
 	void IComponent::LoadBaseJson(const Sptr& result, const nlohmann::json& blob)
 	{
-		result->OverrideGUID(Guid(blob["guid"]));
+		result->OverrideGUID(Guid(blob["guid"].get<std::string>()));
 		result->IsEnabled = blob["enabled"];
 	}
 
@@ -28,10 +28,17 @@ namespace Gameplay {
 		IResource(),
 		IsEnabled(true),
 		_realType(typeid(IComponent)),
-		_context(nullptr)
+		_context(nullptr),
+		_manager(nullptr),
+		_typeId(0),
+		_poolIndex(0)
 	{ }
 
 	IComponent::~IComponent() {
-		_context->GetScene()->Components().Remove(this);
+		// Components remember which manager they were added to, so this works even if we were never attached
+		// to an object, or our scene is already gone
+		if (_manager != nullptr) {
+			_manager->Remove(this);
+		}
 	}
 }
@@ -1,5 +1,6 @@
 #pragma once
 #include <memory>
+#include <unordered_map>
 #include "json.hpp"
 #include <imgui.h>
 #include <GLM/glm.hpp>
@@ -8,16 +9,49 @@
 #include "Utils/ResourceManager/ResourceManager.h"
 #include "Utils/ResourceManager/IResource.h"
 #include "Utils/TypeHelpers.h"
+#include "Utils/BinaryStream.h"
+#include "EnumToString.h"
 
 namespace Gameplay {
 	// We pre-declare GameObject to avoid circular dependencies in the headers
 	class GameObject;
+	class ComponentManager;
+	class Scene;
 
 	namespace Physics {
 		class TriggerVolume;
 		class RigidBody;
 	}
 
+	/// <summary>
+	/// Describes what a component type touches in Update, so that the scene can tell which updates are
+	/// safe to run at the same time. Each resource has a read bit followed by a write bit
+	/// 
+	/// Transform:  the local position, rotation and scale of the component's own object
+	/// Components: the state of other components on the component's own object
+	/// Physics:    rigid bodies, trigger volumes and the physics world
+	/// Scene:      anything else, such as other objects, world transforms (which depend on the parents),
+	///             or adding and removing objects and components
+	/// 
+	/// Components can always read their own state. Types that don't declare an access set are treated
+	/// as touching everything, and only ever update on the main thread
+	/// </summary>
+	ENUM_FLAGS(ComponentAccess, uint32_t,
+		None            = 0,
+		ReadTransform   = 1 << 0,
+		WriteTransform  = 1 << 1,
+		ReadComponents  = 1 << 2,
+		WriteComponents = 1 << 3,
+		ReadPhysics     = 1 << 4,
+		WritePhysics    = 1 << 5,
+		ReadScene       = 1 << 6,
+		WriteScene      = 1 << 7,
+		All             = 0xFF
+	);
+
+	// Maps the GUIDs of objects and components in a prefab to the GUIDs of their copies, see IComponent::RemapReferences
+	typedef std::unordered_map<Guid, Guid> GuidRemap;
+
 	/// <summary>
 	/// Base class for components that can be attached to game objects
 	/// 
@@ -27,6 +61,20 @@ namespace Gameplay {
 	/// static std::shared_ptr<Type> FromJson(const nlohmann::json&);
 	/// 
 	/// where Type is the Type of component
+	/// 
+	/// Components that override Update may also define
+	/// 
+	/// static ComponentAccess UpdateAccess();
+	/// 
+	/// to let their updates run in parallel, see ComponentAccess. Components whose access set allows it
+	/// are updated from worker threads, so they must not touch OpenGL, GLFW or ImGui in Update
+	/// 
+	/// Components can also be stored in binary scene files (see Scene::SaveBinary) by defining
+	/// 
+	/// static std::shared_ptr<Type> FromBinary(BinaryReader&);
+	/// void ToBinary(BinaryWriter&) const;
+	/// 
+	/// Types without them are stored in binary scenes as JSON, which works but loads much slower
 	/// </summary>
 	class IComponent : public IResource {
 	public:
@@ -87,6 +135,13 @@ namespace Gameplay {
 		/// <param name="context">The game object that the component belongs to</param>
 		virtual void OnLoad() { };
 		/// <summary>
+		/// Invoked on the copies made when a prefab is instantiated (see Scene::Instantiate), before OnLoad.
+		/// Components that store the GUIDs of other objects or components should replace any that are in the
+		/// map, so that references between parts of the prefab point at the new copies
+		/// </summary>
+		/// <param name="remap">Maps the GUIDs of the prefab's objects and components to the GUIDs of their copies</param>
+		virtual void RemapReferences(const GuidRemap& remap) { };
+		/// <summary>
 		/// Invoked when the scene has finished loading, and all objects and components
 		/// are set up
 		/// </summary>
@@ -125,7 +180,7 @@ namespace Gameplay {
 		/// <typeparam name="T">The type of component to search for</typeparam>
 		template <typename T, typename = typename std::enable_if<std::is_base_of<IComponent, T>::value>::type>
 		bool HasComponent() {
-			return _context->Has<T>();
+			return _context->template Has<T>();
 		}
 
 		/// <summary>
@@ -134,7 +189,7 @@ namespace Gameplay {
 		/// <typeparam name="T">The type of component to search for</typeparam>
 		template <typename T, typename = typename std::enable_if<std::is_base_of<IComponent, T>::value>::type>
 		std::shared_ptr<T> GetComponent() {
-			return _context->Get<T>();
+			return _context->template Get<T>();
 		}
 
 		/// <summary>
@@ -145,7 +200,7 @@ namespace Gameplay {
 		/// <typeparam name="TArgs">The arguments to forward to the component constructor</typeparam>
 		template <typename T, typename ... TArgs>
 		std::shared_ptr<T> AddComponent(TArgs&&... args) {
-			return _context->Add<T>(std::forward<TArgs>(args)...);
+			return _context->template Add<T>(std::forward<TArgs>(args)...);
 		}
 
 		/// <summary>
@@ -159,10 +214,17 @@ namespace Gameplay {
 	private:
 		friend class ComponentManager;
 		friend class GameObject;
+		// Binary scenes load components by type rather than by object, see Scene::LoadBinary
+		friend class Scene;
 
 		std::type_index _realType;
 		GameObject* _context;
 
+		// The manager whose pools we're stored in, and where we are in them, see ComponentManager
+		ComponentManager* _manager;
+		uint32_t          _typeId;
+		uint32_t          _poolIndex;
+
 		// By storing a weak pointer to ourselves, we can pass a pointer to this
 		// for things like bullet user pointers
 		std::weak_ptr<IComponent> _weakSelfPtr;
@@ -66,7 +66,7 @@ void JumpBehaviour::Update(float deltaTime) {
 		Application& app = Application::Get();
 
 		// Grab the render layer from the app, get it's output and the G-Buffer
-		PostProcessingLayer::Sptr& postProc = app.GetLayer<PostProcessingLayer>();
+		PostProcessingLayer::Sptr postProc = app.GetLayer<PostProcessingLayer>();
 		if (ColorCorrectOn == true)
 		{
 			postProc->GetEffect<ColorCorrectionEffect>()->Enabled = false;
@@ -84,8 +84,8 @@ void JumpBehaviour::Update(float deltaTime) {
 		Application& app = Application::Get();
 
 		// Grab the render layer from the app, get it's output and the G-Buffer
-		PostProcessingLayer::Sptr& postProc = app.GetLayer<PostProcessingLayer>();
-		ColorCorrectionEffect::Sptr& colCor = postProc->GetEffect<ColorCorrectionEffect>();
+		PostProcessingLayer::Sptr postProc = app.GetLayer<PostProcessingLayer>();
+		ColorCorrectionEffect::Sptr colCor = postProc->GetEffect<ColorCorrectionEffect>();
 		postProc->GetEffect<ColorCorrectionEffect>()->ChangeStrength(0.2f);
 
 	}
@@ -205,8 +205,8 @@ void JumpBehaviour::Update(float deltaTime) {
 	if (isHurt == true)
 	{
 		Application& app = Application::Get();
-		PostProcessingLayer::Sptr& postProc = app.GetLayer<PostProcessingLayer>();
-		ColorCorrectionEffect::Sptr& colCor = postProc->GetEffect<ColorCorrectionEffect>();
+		PostProcessingLayer::Sptr postProc = app.GetLayer<PostProcessingLayer>();
+		ColorCorrectionEffect::Sptr colCor = postProc->GetEffect<ColorCorrectionEffect>();
 		colCor->ChangeChoice(1.0f);
 		
 		if (startTime <= endTime)
@@ -78,6 +78,26 @@ Light::Sptr Light::FromJson(const nlohmann::json& data) {
 	return result;
 }
 
+void Light::ToBinary(BinaryWriter& writer) const {
+	writer.Write(_color);
+	writer.Write(_radius);
+	writer.Write(_direction);
+	writer.Write(_params);
+	writer.Write(_intensity);
+	writer.Write((int32_t)_type);
+}
+
+Light::Sptr Light::FromBinary(BinaryReader& reader) {
+	Light::Sptr result = std::make_shared<Light>();
+	result->_color = reader.Read<glm::vec3>();
+	result->_radius = reader.Read<float>();
+	result->_direction = reader.Read<glm::vec3>();
+	result->_params = reader.Read<glm::vec3>();
+	result->_intensity = reader.Read<float>();
+	result->_type = (LightType)reader.Read<int32_t>();
+	return result;
+}
+
 /// <summary>
 /// Converts this object into it's JSON representation for storage
 /// </summary>
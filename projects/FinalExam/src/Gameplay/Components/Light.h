@@ -45,6 +45,8 @@ public:
 	MAKE_TYPENAME(Light);
 	virtual nlohmann::json ToJson() const override;
 	static Light::Sptr FromJson(const nlohmann::json& blob);
+	void ToBinary(BinaryWriter& writer) const;
+	static Light::Sptr FromBinary(BinaryReader& reader);
 
 protected:
 	LightType _type;
@@ -39,7 +39,7 @@ nlohmann::json MaterialSwapBehaviour::ToJson() const {
 
 MaterialSwapBehaviour::Sptr MaterialSwapBehaviour::FromJson(const nlohmann::json& blob) {
 	MaterialSwapBehaviour::Sptr result = std::make_shared<MaterialSwapBehaviour>();
-	result->EnterMaterial = ResourceManager::Get<Gameplay::Material>(Guid(blob["enter_material"]));
-	result->ExitMaterial  = ResourceManager::Get<Gameplay::Material>(Guid(blob["exit_material"]));
+	result->EnterMaterial = ResourceManager::Get<Gameplay::Material>(Guid(blob["enter_material"].get<std::string>()));
+	result->ExitMaterial  = ResourceManager::Get<Gameplay::Material>(Guid(blob["exit_material"].get<std::string>()));
 	return result;
 }
@@ -1,7 +1,10 @@
 #include "ParticleSystem.h"
+#include "CpuParticleSimulator.h"
+#include "ComputeParticlePipeline.h"
 #include "Utils/JsonGlmHelpers.h"
 #include "Application/Timing.h"
 #include "Application/Application.h"
+#include "Application/Layers/ParticleLayer.h"
 #include "Utils/ImGuiHelper.h"
 #include "Graphics/DebugDraw.h"
 #include "imgui_internal.h"
@@ -11,9 +14,25 @@ ParticleSystem::ParticleSystem() :
 	_hasInit(false),
 	_maxParticles(1000),
 	_numParticles(0),
-	_particleBuffers(),
+	_bufferPool(nullptr),
+	_allocation(),
+	_chargedBytes(0),
+	_allocatedParticles(0),
+	_budget(),
 	_feedbackBuffers(),
-	_query(0),
+	_queries(),
+	_queryPending(),
+	_queryEmitters(),
+	_timerQueries(),
+	_queryIndex(0),
+	_simulationMs(0.0),
+	_backend(ParticleBackend::Gpu),
+	_cpuSimulator(nullptr),
+	_cpuParticles(),
+	_computePipeline(nullptr),
+	Seed(1),
+	DepthSort(true),
+	BoundingRadius(5.0f),
 	_currentVertexBuffer(0),
 	_currentFeedbackBuffer(1),
 	_updateShader(nullptr),
@@ -27,93 +46,166 @@ ParticleSystem::ParticleSystem() :
 ParticleSystem::~ParticleSystem()
 {
 	if (_hasInit) {
-		glDeleteBuffers(2, _particleBuffers);
+		_FreeBuffers();
 		glDeleteTransformFeedbacks(2, _feedbackBuffers);
-		glDeleteQueries(1, &_query);
+		glDeleteVertexArrays(2, _updateVaos);
+		glDeleteVertexArrays(2, _renderVaos);
+		glDeleteQueries(QUERY_FRAMES, _queries);
+		glDeleteQueries(QUERY_FRAMES, _timerQueries);
 		_updateShader = nullptr;
 		_renderShader = nullptr;
 	}
 }
 
-void ParticleSystem::Update()
+void ParticleSystem::_AllocateBuffers()
+{
+	if (_bufferPool == nullptr) {
+		ParticleLayer::Sptr layer = Application::Get().GetLayer<ParticleLayer>();
+		LOG_ASSERT(layer != nullptr, "Particle systems need a ParticleLayer to manage their memory");
+		_bufferPool = layer->GetBufferPool();
+	}
+	_FreeBuffers();
+
+	// The compute pipeline can't use the pool's interleaved vertex buffers, so it allocates its own
+	// storage buffers and we only count them against the budget
+	const bool compute = _backend == ParticleBackend::Compute;
+	if (!compute) {
+		_computePipeline = nullptr;
+	}
+
+	auto reserve = [&](uint32_t particles) {
+		if (compute) {
+			return _bufferPool->Charge(ComputeParticlePipeline::CalcMemorySize(particles));
+		}
+		return _bufferPool->Allocate((particles + _emitters.size()) * sizeof(ParticleData), _allocation);
+	};
+
+	// If the budget is tight, we'd rather have a smaller system than none at all
+	_allocatedParticles = _maxParticles;
+	while (!reserve(_allocatedParticles)) {
+		if (_allocatedParticles == 0) {
+			LOG_WARN("Particle system on \"{}\" does not fit in the particle memory budget", GetGameObject()->Name);
+			return;
+		}
+		_allocatedParticles /= 2;
+	}
+	if (_allocatedParticles < _maxParticles) {
+		LOG_WARN("Particle system on \"{}\" was limited to {} particles by the particle memory budget", GetGameObject()->Name, _allocatedParticles);
+	}
+	if (compute) {
+		_chargedBytes = ComputeParticlePipeline::CalcMemorySize(_allocatedParticles);
+		return;
+	}
+
+	// Our range of the pool's buffers, offset is added to all the attribute pointers
+	const size_t offset = _allocation.Offset;
+	#define PARTICLE_ATTRIB(member) (const GLvoid*)(offset + offsetof(ParticleData, member))
+
+	for (int ix = 0; ix < 2; ix++) {
+		glBindVertexArray(_updateVaos[ix]);
+
+		// Set up our transform feedback to write to our range of the buffer
+		glTransformFeedbackBufferRange(_feedbackBuffers[ix], 0, _allocation.Buffers[ix], offset, _allocation.Size);
+		glBindBuffer(GL_ARRAY_BUFFER, _allocation.Buffers[ix]);
+
+		// Enable our attributes
+		glEnableVertexAttribArray(0);
+		glEnableVertexAttribArray(1);
+		glEnableVertexAttribArray(2);
+		glEnableVertexAttribArray(3);
+		glEnableVertexAttribArray(4);
+		glEnableVertexAttribArray(5);
+		glEnableVertexAttribArray(6);
+		glEnableVertexAttribArray(7);
+
+		glVertexAttribIPointer(0, 1, GL_UNSIGNED_INT, sizeof(ParticleData), PARTICLE_ATTRIB(Type)); // type
+		glVertexAttribIPointer(1, 1, GL_UNSIGNED_INT, sizeof(ParticleData), PARTICLE_ATTRIB(TexID)); // tex ID
+		glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(ParticleData), PARTICLE_ATTRIB(Position)); // position
+		glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(ParticleData), PARTICLE_ATTRIB(Common.Velocity)); // velocity
+		glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, sizeof(ParticleData), PARTICLE_ATTRIB(Color)); // color 
+		glVertexAttribPointer(5, 1, GL_FLOAT, GL_FALSE, sizeof(ParticleData), PARTICLE_ATTRIB(Lifetime)); // metadata 
+		glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, sizeof(ParticleData), PARTICLE_ATTRIB(Common.Metadata)); // metadata 
+		glVertexAttribPointer(7, 4, GL_FLOAT, GL_FALSE, sizeof(ParticleData), PARTICLE_ATTRIB(Common.Metadata2)); // metadata 
+
+
+		glBindVertexArray(_renderVaos[ix]);
+		glBindBuffer(GL_ARRAY_BUFFER, _allocation.Buffers[ix]);
+
+		// Enable type, position and color 
+		glEnableVertexAttribArray(0);
+		glEnableVertexAttribArray(1);
+		glEnableVertexAttribArray(2);
+		glEnableVertexAttribArray(4); 
+		glEnableVertexAttribArray(6);
+		glEnableVertexAttribArray(7);
+		glVertexAttribIPointer(0, 1, GL_UNSIGNED_INT, sizeof(ParticleData), PARTICLE_ATTRIB(Type)); // type
+		glVertexAttribIPointer(1, 1, GL_UNSIGNED_INT, sizeof(ParticleData), PARTICLE_ATTRIB(TexID)); // type
+		glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(ParticleData), PARTICLE_ATTRIB(Position)); // position
+		glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, sizeof(ParticleData), PARTICLE_ATTRIB(Color)); // color 
+		glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, sizeof(ParticleData), PARTICLE_ATTRIB(Common.Metadata)); // metadata 
+		glVertexAttribPointer(7, 4, GL_FLOAT, GL_FALSE, sizeof(ParticleData), PARTICLE_ATTRIB(Common.Metadata2)); // metadata 
+	}
+
+	#undef PARTICLE_ATTRIB
+
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void ParticleSystem::_FreeBuffers()
+{
+	if (_bufferPool != nullptr) {
+		_bufferPool->Free(_allocation);
+		_bufferPool->Uncharge(_chargedBytes);
+	}
+	_chargedBytes = 0;
+}
+
+bool ParticleSystem::_HasMemory() const
+{
+	return _allocation.IsValid() || _chargedBytes > 0;
+}
+
+void ParticleSystem::Update(float deltaTime)
 {
 	// If we haven't previously initialized our data, initialize it now
 	if (!_hasInit) {
 		_updateShader->Bind();
 
-		int i = 0;
-		glGetIntegerv(GL_MAX_TRANSFORM_FEEDBACK_INTERLEAVED_COMPONENTS, &i);
-
-		// We essentially use double buffering, hence the 2 buffers
+		// We essentially use double buffering, hence the 2 transform feedbacks. The buffers
+		// themselves are shared with other systems, see ParticleLayer
 		glCreateTransformFeedbacks(2, _feedbackBuffers);
-		glCreateBuffers(2, _particleBuffers);
 		glCreateVertexArrays(2, _updateVaos);
 		glCreateVertexArrays(2, _renderVaos);
 
-		size_t dataSize = (_maxParticles + _emitters.size()) * sizeof(ParticleData);
-
-		for (int ix = 0; ix < 2; ix++) {
-			glBindVertexArray(_updateVaos[ix]);
-
-			// Set up our first transform feedback buffer to write to the first buffer
-			glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, _feedbackBuffers[ix]);
-			glBindBuffer(GL_ARRAY_BUFFER, _particleBuffers[ix]);
-			glBufferData(GL_ARRAY_BUFFER, dataSize, nullptr, GL_DYNAMIC_DRAW);
-			glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, _particleBuffers[ix]);
-
-			// Enable our attributes
-			glEnableVertexAttribArray(0);
-			glEnableVertexAttribArray(1);
-			glEnableVertexAttribArray(2);
-			glEnableVertexAttribArray(3);
-			glEnableVertexAttribArray(4);
-			glEnableVertexAttribArray(5);
-			glEnableVertexAttribArray(6);
-			glEnableVertexAttribArray(7);
-
-			glVertexAttribIPointer(0, 1, GL_UNSIGNED_INT, sizeof(ParticleData), (const GLvoid*)offsetof(ParticleData, Type)); // type
-			glVertexAttribIPointer(1, 1, GL_UNSIGNED_INT, sizeof(ParticleData), (const GLvoid*)offsetof(ParticleData, TexID)); // tex ID
-			glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(ParticleData), (const GLvoid*)offsetof(ParticleData, Position)); // position
-			glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, sizeof(ParticleData), (const GLvoid*)offsetof(ParticleData, Velocity)); // velocity
-			glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, sizeof(ParticleData), (const GLvoid*)offsetof(ParticleData, Color)); // color 
-			glVertexAttribPointer(5, 1, GL_FLOAT, GL_FALSE, sizeof(ParticleData), (const GLvoid*)offsetof(ParticleData, Lifetime)); // metadata 
-			glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, sizeof(ParticleData), (const GLvoid*)offsetof(ParticleData, Metadata)); // metadata 
-			glVertexAttribPointer(7, 4, GL_FLOAT, GL_FALSE, sizeof(ParticleData), (const GLvoid*)offsetof(ParticleData, Metadata2)); // metadata 
-
-
-			glBindVertexArray(_renderVaos[ix]);
-			glBindBuffer(GL_ARRAY_BUFFER, _particleBuffers[ix]);
-
-			// Enable type, position and color 
-			glEnableVertexAttribArray(0);
-			glEnableVertexAttribArray(1);
-			glEnableVertexAttribArray(2);
-			glEnableVertexAttribArray(4); 
-			glEnableVertexAttribArray(6);
-			glEnableVertexAttribArray(7);
-			glVertexAttribIPointer(0, 1, GL_UNSIGNED_INT, sizeof(ParticleData), (const GLvoid*)offsetof(ParticleData, Type)); // type
-			glVertexAttribIPointer(1, 1, GL_UNSIGNED_INT, sizeof(ParticleData), (const GLvoid*)offsetof(ParticleData, TexID)); // type
-			glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(ParticleData), (const GLvoid*)offsetof(ParticleData, Position)); // position
-			glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, sizeof(ParticleData), (const GLvoid*)offsetof(ParticleData, Color)); // color 
-			glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, sizeof(ParticleData), (const GLvoid*)offsetof(ParticleData, Metadata)); // metadata 
-			glVertexAttribPointer(7, 4, GL_FLOAT, GL_FALSE, sizeof(ParticleData), (const GLvoid*)offsetof(ParticleData, Metadata2)); // metadata 
-		}
-
-		glBindVertexArray(0);
-
+		// We create a few query objects to track the number of particles we're simulating
+		glGenQueries(QUERY_FRAMES, _queries);
+		glGenQueries(QUERY_FRAMES, _timerQueries);
 
-		// We create a query object to track the number of particles we're simulating
-		glGenQueries(1, &_query);
+		_needsResize = true;
 	}
 
 	if (_needsResize) {
-		size_t dataSize = (_maxParticles + _emitters.size()) * sizeof(ParticleData);
-		glNamedBufferData(_particleBuffers[0], dataSize, nullptr, GL_DYNAMIC_DRAW);
-		glNamedBufferData(_particleBuffers[1], dataSize, nullptr, GL_DYNAMIC_DRAW);
+		_AllocateBuffers();
 		_needsUpload = true;
 		_needsResize = false;
 	}
 
+	// Didn't fit in the budget, try again if our size changes
+	if (!_HasMemory()) {
+		_hasInit = true;
+		return;
+	}
+
+	if (_backend == ParticleBackend::Cpu) {
+		_UpdateCpu(deltaTime);
+		return;
+	}
+	if (_backend == ParticleBackend::Compute) {
+		_UpdateCompute(deltaTime);
+		return;
+	}
+
 	if (_needsUpload) {
 		glBindVertexArray(0);
 
@@ -129,7 +221,7 @@ void ParticleSystem::Update()
 
 		// Update just the first few elements, we'll restart transform feedback with it
 		for (int ix = 0; ix < 2; ix++) {
-			glNamedBufferSubData(_particleBuffers[ix], 0, dataSize, data);
+			glNamedBufferSubData(_allocation.Buffers[ix], _allocation.Offset, dataSize, data);
 		}
 
 		// We no longer need the CPU copy
@@ -142,6 +234,8 @@ void ParticleSystem::Update()
 	// Bind the update shader and send our relevant uniforms
 	_updateShader->Bind();
 	_updateShader->SetUniform("u_Gravity", _gravity); 
+	_updateShader->SetUniform("u_StepTime", deltaTime);
+	_updateShader->SetUniform("u_EmissionScale", _budget.EmissionScale);
 	_updateShader->SetUniformMatrix("u_ModelMatrix", GetGameObject()->GetTransform()); 
 
 	glBindVertexArray(_updateVaos[_currentVertexBuffer]);
@@ -149,8 +243,27 @@ void ParticleSystem::Update()
 	// Bind the buffer and transform feedback
 	glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, _feedbackBuffers[_currentFeedbackBuffer]);
 
+	// Grab the count from the last time we used this query, if the GPU is still behind we'd rather
+	// show a stale count than stall the CPU until the simulation is done
+	uint32_t query = _queries[_queryIndex];
+	if (_queryPending[_queryIndex]) {
+		GLuint available = 0;
+		glGetQueryObjectuiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available) {
+			GLuint written = 0;
+			glGetQueryObjectuiv(query, GL_QUERY_RESULT, &written);
+			GLuint emitters = _queryEmitters[_queryIndex];
+			_numParticles = written >= emitters ? written - emitters : 0;
+
+			GLuint64 elapsed = 0;
+			glGetQueryObjectui64v(_timerQueries[_queryIndex], GL_QUERY_RESULT, &elapsed);
+			_simulationMs = elapsed / 1000000.0;
+		}
+	}
+
 	// Our particles are points that we're simulating
-	glBeginQuery(GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN, _query); 
+	glBeginQuery(GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN, query); 
+	glBeginQuery(GL_TIME_ELAPSED, _timerQueries[_queryIndex]);
 	glBeginTransformFeedback(GL_POINTS);
 
 	// If this is our first pass, or we have fresh emitter data, we use drawArrays 
@@ -164,16 +277,12 @@ void ParticleSystem::Update()
 
 	// End of transform feedback
 	glEndTransformFeedback();
+	glEndQuery(GL_TIME_ELAPSED);
 	glEndQuery(GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN); 
 
-	// Use our query to get the number of particles
-	glGetQueryObjectuiv(_query, GL_QUERY_RESULT, &_numParticles);
-	if (_numParticles >= _emitters.size()) {
-		_numParticles -= _emitters.size();
-	}
-	else {
-		_numParticles = 0;
-	}
+	_queryPending[_queryIndex] = true;
+	_queryEmitters[_queryIndex] = (uint32_t)_emitters.size();
+	_queryIndex = (_queryIndex + 1) % QUERY_FRAMES;
 
 	// Clean up our state
 	glBindTransformFeedback(GL_TRANSFORM_FEEDBACK, 0);
@@ -191,10 +300,65 @@ void ParticleSystem::Update()
 	_currentFeedbackBuffer = (_currentFeedbackBuffer + 1) & 0x01;
 }
 
+void ParticleSystem::_UpdateCpu(float deltaTime)
+{
+	if (_cpuSimulator == nullptr) {
+		_cpuSimulator = std::make_shared<CpuParticleSimulator>();
+	}
+	if (_needsUpload) {
+		_cpuSimulator->Reset(_emitters, Seed);
+	}
+
+	_cpuSimulator->Update(deltaTime, _gravity, GetGameObject()->GetTransform(), _allocatedParticles, _budget.EmissionScale);
+	_numParticles = _cpuSimulator->GetParticleCount();
+	_simulationMs = _cpuSimulator->GetLastUpdateMs();
+
+	// The render buffers are sized for our max particles plus the emitters, so this always fits
+	_cpuSimulator->WriteParticles(_cpuParticles);
+	if (!_cpuParticles.empty()) {
+		glNamedBufferSubData(_allocation.Buffers[_currentVertexBuffer], _allocation.Offset, _cpuParticles.size() * sizeof(ParticleData), _cpuParticles.data());
+	}
+
+	_hasInit = true;
+	_needsUpload = false;
+}
+
+void ParticleSystem::_UpdateCompute(float deltaTime)
+{
+	if (_computePipeline == nullptr) {
+		_computePipeline = std::make_shared<ComputeParticlePipeline>();
+	}
+	if (_needsUpload) {
+		_computePipeline->Reset(_emitters, _allocatedParticles);
+	}
+
+	// Same timing scheme as the transform feedback path, so the backends can be compared directly
+	if (_queryPending[_queryIndex]) {
+		GLuint available = GL_FALSE;
+		glGetQueryObjectuiv(_timerQueries[_queryIndex], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available) {
+			GLuint64 elapsed = 0;
+			glGetQueryObjectui64v(_timerQueries[_queryIndex], GL_QUERY_RESULT, &elapsed);
+			_simulationMs = elapsed / 1000000.0;
+		}
+	}
+
+	glBeginQuery(GL_TIME_ELAPSED, _timerQueries[_queryIndex]);
+	_computePipeline->Update(deltaTime, _gravity, GetGameObject()->GetTransform(), _budget.EmissionScale);
+	glEndQuery(GL_TIME_ELAPSED);
+
+	_queryPending[_queryIndex] = true;
+	_queryIndex = (_queryIndex + 1) % QUERY_FRAMES;
+
+	_numParticles = _computePipeline->GetParticleCount();
+	_hasInit = true;
+	_needsUpload = false;
+}
+
 void ParticleSystem::Render()
 {
 	// Make sure that we've actually initialized our stuff
-	if (_hasInit) {
+	if (_hasInit && _HasMemory()) {
 
 		if (Atlas != nullptr) {
 			Atlas->Bind(0);
@@ -214,11 +378,25 @@ void ParticleSystem::Render()
 		glDepthMask(false);
 		glEnable(GL_DEPTH_TEST);
 
-		// Bind the current feedback buffer as our drawing buffer
-		glBindBuffer(GL_ARRAY_BUFFER, _particleBuffers[_currentVertexBuffer]); 
+		// The compute backend has its own shader and reads straight from its storage buffers
+		if (_backend == ParticleBackend::Compute) {
+			if (_computePipeline != nullptr) {
+				_computePipeline->Render(DepthSort);
+			}
+			glBindVertexArray(0);
+			return;
+		}
 
-		// Draw our particles using whatever data we have in transform feedback buffer
-		glDrawTransformFeedback(GL_POINTS, _feedbackBuffers[_currentVertexBuffer]);
+		// Bind the current feedback buffer as our drawing buffer
+		glBindBuffer(GL_ARRAY_BUFFER, _allocation.Buffers[_currentVertexBuffer]); 
+
+		// Draw our particles using whatever data we have in transform feedback buffer, CPU simulated
+		// particles are uploaded without going through transform feedback so we know the count already
+		if (_backend == ParticleBackend::Cpu) {
+			glDrawArrays(GL_POINTS, 0, _numParticles);
+		} else {
+			glDrawTransformFeedback(GL_POINTS, _feedbackBuffers[_currentVertexBuffer]);
+		}
 
 		glBindVertexArray(0);
 
@@ -241,21 +419,86 @@ uint32_t ParticleSystem::GetMaxParticles() const {
 	return _maxParticles;
 }
 
+uint32_t ParticleSystem::GetParticleCount() const {
+	return _numParticles;
+}
+
+void ParticleSystem::SetBackend(ParticleBackend value)
+{
+	if (value != _backend) {
+		_backend = value;
+		_needsUpload = true;
+		// The compute backend keeps its particles in its own buffers, see _AllocateBuffers
+		_needsResize = true;
+		// Not every backend fills in the primitive queries, so don't try to read back anything stale
+		for (int ix = 0; ix < QUERY_FRAMES; ix++) {
+			_queryPending[ix] = false;
+		}
+	}
+}
+
+ParticleBackend ParticleSystem::GetBackend() const {
+	return _backend;
+}
+
+double ParticleSystem::GetSimulationMs() const {
+	return _simulationMs;
+}
+
 void ParticleSystem::AddEmitter(const ParticleData& emitter)
 {
 	_emitters.push_back(emitter); 
 	_needsUpload = true;
+	// Emitters live at the start of our buffers, so we need a bit more room
+	_needsResize = true;
+}
+
+int ParticleSystem::AdvanceEmitter(ParticleData& emitter, float deltaTime, float& startLifetime, float emissionScale, int maxSpawns)
+{
+	// Slowing the spawn timer down lowers the spawn rate without touching the emitter's settings
+	float lifetime = emitter.Lifetime - deltaTime * emissionScale;
+	startLifetime = lifetime;
+	int toEmit = 0;
+	while (lifetime < 0.0f && toEmit < maxSpawns) {
+		lifetime += emitter.Common.Metadata.x;
+		toEmit++;
+	}
+	emitter.Lifetime = lifetime;
+	return toEmit;
 }
 
 void ParticleSystem::RenderImGui()
 {
-	LABEL_LEFT(ImGui::LabelText, "Particle Count", "%u", _numParticles);
+	LABEL_LEFT(ImGui::LabelText, "Particle Count", "~%u", _numParticles);
+
+	// Handy for comparing the backends against each other
+	ParticleBackend backend = _backend;
+	if (ImGuiHelper::DrawEnumCombo("Backend", &backend, GET_ENUM_MAP(ParticleBackend))) {
+		SetBackend(backend);
+	}
+	if (_backend == ParticleBackend::Cpu) {
+		_needsUpload |= LABEL_LEFT(ImGui::InputScalar, "Seed", ImGuiDataType_U32, &Seed);
+	}
+	if (_backend == ParticleBackend::Compute) {
+		LABEL_LEFT(ImGui::Checkbox, "Depth Sort", &DepthSort);
+	}
+	LABEL_LEFT(ImGui::LabelText, "Simulation", "%.3f ms (%.0f particles/ms)", _simulationMs, _simulationMs > 0.0 ? _numParticles / _simulationMs : 0.0);
 
 	Application& app = Application::Get();
 
 	LABEL_LEFT(ImGui::DragFloat3, "Gravity", &_gravity.x, 0.01f);
 	uint32_t minParticles = _emitters.size();
 	_needsResize |= LABEL_LEFT(ImGui::DragScalarN, "Max Particles", ImGuiDataType_U32, &_maxParticles, 1, 10.0f, &minParticles);
+	if (_hasInit && _allocatedParticles < _maxParticles) {
+		ImGui::TextColored(ImVec4(1.0f, 0.6f, 0.0f, 1.0f), "Limited to %u by the memory budget", _allocatedParticles);
+	}
+
+	LABEL_LEFT(ImGui::DragFloat, "Bounding Radius", &BoundingRadius, 0.1f, 0.0f, 1000.0f);
+	if (_budget.Culled) {
+		LABEL_LEFT(ImGui::LabelText, "Budget", "Culled (%.1f m)", _budget.Distance);
+	} else {
+		LABEL_LEFT(ImGui::LabelText, "Budget", "%.0f%% rate, every %u frame(s)", _budget.EmissionScale * 100.0f, _budget.Interval);
+	}
 
 	ImGui::Separator();
 	ImGui::Text("Emitters:");
@@ -273,7 +516,7 @@ void ParticleSystem::RenderImGui()
 
 		ImGui::PushID(&emitter);
 		static char buffer[255];
-		sprintf_s(buffer, "%s###Emitter", (~emitter.Type).c_str());
+		snprintf(buffer, sizeof(buffer), "%s###Emitter", (~emitter.Type).c_str());
 		ImGuiID id = ImGui::GetID(buffer);
 		bool open = ImGui::CollapsingHeader(buffer, ImGuiTreeNodeFlags_DefaultOpen | ImGuiTreeNodeFlags_AllowItemOverlap | ImGuiTreeNodeFlags_ClipLabelForTrailingButton);
 
@@ -435,7 +678,7 @@ void ParticleSystem::RenderImGui()
 		emitter.Position   = glm::vec3(0.0f);
 		emitter.Color      = glm::vec4(1.0f);
 		emitter.Lifetime   = 1.0f;
-		emitter.Metadata.x = 1.0f;
+		emitter.Common.Metadata.x = 1.0f;
 
 		if (i == 0) {
 			emitter.Type                        = ParticleType::StreamEmitter;
@@ -482,7 +725,7 @@ void ParticleSystem::RenderImGui()
 void ParticleSystem::OnLoad()
 {
 	// There are the things we want the feedback buffers to track
-	const char const* varyings[8] = {
+	const char* varyings[8] = {
 		"out_Type",
 		"out_TexID",
 		"out_Position",
@@ -518,7 +761,11 @@ nlohmann::json ParticleSystem::ToJson() const {
 	nlohmann::json result = {
 		{ "gravity", _gravity },
 		{ "max_particles", _maxParticles },
-		{ "atlas", Atlas ? Atlas->GetGUID().str() : "null" }
+		{ "atlas", Atlas ? Atlas->GetGUID().str() : "null" },
+		{ "backend", ~_backend },
+		{ "seed", Seed },
+		{ "depth_sort", DepthSort },
+		{ "bounding_radius", BoundingRadius }
 	};
 
 	std::vector<float> metaData;
@@ -546,8 +793,12 @@ ParticleSystem::Sptr ParticleSystem::FromJson(const nlohmann::json& blob) {
 	ParticleSystem::Sptr result = std::make_shared<ParticleSystem>();
 
 	result->_gravity = JsonGet(blob, "gravity", result->_gravity);
-	result->_maxParticles = JsonGet(blob, "max_particled", result->_maxParticles);
+	result->_maxParticles = JsonGet(blob, "max_particles", result->_maxParticles);
 	result->Atlas = ResourceManager::Get<Texture2DArray>(Guid(JsonGet<std::string>(blob, "atlas", "null")));
+	result->_backend = JsonParseEnum(ParticleBackend, blob, "backend", ParticleBackend::Gpu);
+	result->Seed = JsonGet(blob, "seed", result->Seed);
+	result->DepthSort = JsonGet(blob, "depth_sort", result->DepthSort);
+	result->BoundingRadius = JsonGet(blob, "bounding_radius", result->BoundingRadius);
 
 	const float DEFAULT_META[4 + 4 + 3] = {
 		0.0f, 0.0f, 0.0f,
@@ -558,7 +809,7 @@ ParticleSystem::Sptr ParticleSystem::FromJson(const nlohmann::json& blob) {
 	if (blob.contains("emitters") && blob["emitters"].is_array()) {
 		for (const auto& data : blob["emitters"]) {
 			ParticleData emitter;
-			emitter.Type     = JsonParseEnum(ParticleType, blob, "type", ParticleType::SphereEmitter);
+			emitter.Type     = JsonParseEnum(ParticleType, data, "type", ParticleType::SphereEmitter);
 			emitter.TexID    = JsonGet(data, "tex_id", 0);
 			emitter.Position = JsonGet(data, "position", glm::vec3(0.0f));
 			emitter.Color    = JsonGet(data, "color", glm::vec4(1.0f));
@@ -567,7 +818,7 @@ ParticleSystem::Sptr ParticleSystem::FromJson(const nlohmann::json& blob) {
 			// Extracting metadata as a float array
 			memcpy(emitter.EmitterData, DEFAULT_META, sizeof(float) * (4 + 4 + 3));
 			std::vector<float> meta = JsonGet(data, "meta", std::vector<float>());
-			memcpy(emitter.EmitterData, meta.data(), std::min(meta.size(), 4ull + 4 + 3) * sizeof(float));
+			memcpy(emitter.EmitterData, meta.data(), std::min<size_t>(meta.size(), 4 + 4 + 3) * sizeof(float));
 
 			result->_emitters.push_back(emitter);
 		}
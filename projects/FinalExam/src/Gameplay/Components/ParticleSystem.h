@@ -1,6 +1,7 @@
 #pragma once
 #include "Gameplay/Components/IComponent.h"
 #include "Graphics/ShaderProgram.h"
+#include "Graphics/Buffers/BufferPool.h"
 #include "Graphics/Textures/Texture2DArray.h"
 
 ENUM(ParticleType, uint32_t,
@@ -11,9 +12,24 @@ ENUM(ParticleType, uint32_t,
 	Particle      = 1 << 17
 );
 
+/// <summary>
+/// Where a particle system runs its simulation
+/// </summary>
+ENUM(ParticleBackend, int,
+	Gpu     = 0, // Transform feedback, see particle_sim_gs.glsl
+	Cpu     = 1, // See CpuParticleSimulator
+	Compute = 2  // See ComputeParticlePipeline
+);
+
+class CpuParticleSimulator;
+class ComputeParticlePipeline;
+
 class ParticleSystem : public Gameplay::IComponent{
 public:
 	MAKE_PTRS(ParticleSystem);
+	// We own OpenGL objects, so prefabs copy us through our JSON instead
+	NO_COPY(ParticleSystem);
+	NO_MOVE(ParticleSystem);
 
 	glm::vec3 _gravity;
 
@@ -26,12 +42,13 @@ public:
 
 		union {
 			float EmitterData[3 + 4 + 4];
+			// Named, since anonymous structs can't hold glm types outside of MSVC
 			struct {
 				glm::vec3    Velocity; // For emitters, this is initial velocity
 				// For emitters, x is time to next particle, y is max deviation from direction in radians, z-w is lifetime range
 				glm::vec4    Metadata;
 				glm::vec4    Metadata2;
-			};
+			} Common;
 			struct {
 				glm::vec3 Velocity;
 				float Timer;
@@ -71,18 +88,67 @@ public:
 	ParticleSystem();
 	~ParticleSystem();
 
-	void Update();
+	/// <summary>
+	/// Steps the simulation forwards, normally invoked by the ParticleLayer
+	/// </summary>
+	/// <param name="deltaTime">The time step in seconds, may cover several frames if the layer has been skipping this system</param>
+	void Update(float deltaTime);
 	void Render();
 
 	void Reset();
 
 	void SetMaxParticles(uint32_t value);
 	uint32_t GetMaxParticles() const;
+	/// <summary>
+	/// Gets an estimate of the number of live particles, may lag a few frames behind
+	/// </summary>
+	uint32_t GetParticleCount() const;
 
 	Texture2DArray::Sptr Atlas;
 
+	/// <summary>
+	/// The seed for the CPU backend's random number generator, the same seed and time steps will
+	/// always produce the same particles
+	/// </summary>
+	uint32_t Seed;
+	/// <summary>
+	/// True if the compute backend should sort particles back to front before drawing them
+	/// </summary>
+	bool DepthSort;
+	/// <summary>
+	/// The radius around the game object that particles are expected to stay within, used by the
+	/// ParticleLayer to decide how much detail the system gets
+	/// </summary>
+	float BoundingRadius;
+
+	void SetBackend(ParticleBackend value);
+	ParticleBackend GetBackend() const;
+
+	/// <summary>
+	/// Gets the time in milliseconds spent simulating during the last measured frame. For the GPU backend
+	/// this is measured with timer queries, and lags a few frames behind
+	/// </summary>
+	double GetSimulationMs() const;
+
 	void AddEmitter(const ParticleData& emitter);
 
+	/// <summary>
+	/// Steps an emitter's spawn timer forwards, matching prep_emitter in particle_sim_gs.glsl
+	/// </summary>
+	/// <param name="emitter">The emitter to update</param>
+	/// <param name="deltaTime">The time step in seconds</param>
+	/// <param name="startLifetime">Receives the timer value before any spawns, used to back-date new particles</param>
+	/// <param name="emissionScale">Multiplier for the emitter's spawn rate, see ParticleLayer</param>
+	/// <param name="maxSpawns">The most particles the emitter may spawn this step, any that don't fit are skipped</param>
+	/// <returns>The number of particles that the emitter should spawn this step</returns>
+	static int AdvanceEmitter(ParticleData& emitter, float deltaTime, float& startLifetime, float emissionScale = 1.0f, int maxSpawns = MAX_GS_SPAWNS);
+
+	/// <summary>
+	/// The most particles an emitter can spawn in one step on the transform feedback path. Matches
+	/// MAX_VERTS_OUT in particle_sim_gs.glsl, minus one for the emitter itself
+	/// </summary>
+	static const int MAX_GS_SPAWNS = 32;
+
 	// Inherited from IComponent
 
 	virtual void RenderImGui() override;
@@ -101,11 +167,54 @@ protected:
 	uint32_t _maxParticles;
 	GLuint _numParticles;
 
-	uint32_t _particleBuffers[2];
+	// Our range of the shared particle buffers, sized for the emitters plus _allocatedParticles
+	BufferPool::Sptr       _bufferPool;
+	BufferPool::Allocation _allocation;
+	// The compute backend makes its own storage buffers instead, their size is charged to the pool's budget
+	size_t                 _chargedBytes;
+	// May be less than _maxParticles if we didn't fit in the memory budget
+	uint32_t               _allocatedParticles;
+
+	// Level of detail state, managed by the ParticleLayer
+	struct BudgetState {
+		float    EmissionScale = 1.0f;
+		// Time that has passed since our last update, for catching up when we are simulated again
+		float    PendingTime   = 0.0f;
+		uint32_t Interval      = 1;
+		bool     Culled        = false;
+		float    Distance      = 0.0f;
+		float    ScreenSize    = 0.0f;
+	} _budget;
+	friend class ParticleLayer;
+
+	void _AllocateBuffers();
+	void _FreeBuffers();
+	// True if we got our particle memory from the pool, either as a range or as charged bytes
+	bool _HasMemory() const;
 	uint32_t _feedbackBuffers[2];
 	uint32_t _updateVaos[2];
 	uint32_t _renderVaos[2];
-	uint32_t _query;
+
+	// Primitive queries are read back a few frames late so that we never wait on the GPU,
+	// which means the particle count is only an estimate for debugging
+	static const int QUERY_FRAMES = 3;
+	uint32_t _queries[QUERY_FRAMES];
+	bool     _queryPending[QUERY_FRAMES];
+	// The number of emitters when each query was issued, emitters are written along with the particles
+	uint32_t _queryEmitters[QUERY_FRAMES];
+	uint32_t _timerQueries[QUERY_FRAMES];
+	int      _queryIndex;
+	double   _simulationMs;
+
+	ParticleBackend _backend;
+	std::shared_ptr<CpuParticleSimulator> _cpuSimulator;
+	// Staging for uploading CPU simulated particles to the render buffer
+	std::vector<ParticleData> _cpuParticles;
+
+	std::shared_ptr<ComputeParticlePipeline> _computePipeline;
+
+	void _UpdateCpu(float deltaTime);
+	void _UpdateCompute(float deltaTime);
 
 	uint32_t _currentVertexBuffer;
 	uint32_t _currentFeedbackBuffer;
@@ -5,19 +5,28 @@
 
 
 RenderComponent::RenderComponent(const Gameplay::MeshResource::Sptr& mesh, const Gameplay::Material::Sptr& material) :
+	IsOccluder(false),
+	UseImpostor(false),
 	_mesh(mesh), 
 	_material(material), 
-	_meshBuilderParams(std::vector<MeshBuilderParam>()) 
+	_meshBuilderParams(std::vector<MeshBuilderParam>()),
+	_impostorFade(0.0f),
+	_gpuSlot(GpuSlot())
 { }
 
 RenderComponent::RenderComponent() : 
+	IsOccluder(false),
+	UseImpostor(false),
 	_mesh(nullptr), 
 	_material(nullptr), 
-	_meshBuilderParams(std::vector<MeshBuilderParam>())
+	_meshBuilderParams(std::vector<MeshBuilderParam>()),
+	_impostorFade(0.0f),
+	_gpuSlot(GpuSlot())
 { }
 
 RenderComponent* RenderComponent::SetMesh(const Gameplay::MeshResource::Sptr& mesh) {
 	_mesh = mesh;
+	_gpuSlot.Dirty = true;
 	return this;
 }
 
@@ -31,6 +40,7 @@ VertexArrayObject::Sptr RenderComponent::GetMesh() const {
 
 RenderComponent* RenderComponent::SetMaterial(const Gameplay::Material::Sptr& mat) {
 	_material = mat;
+	_gpuSlot.Dirty = true;
 	return this;
 }
 
@@ -42,6 +52,8 @@ nlohmann::json RenderComponent::ToJson() const {
 	nlohmann::json result;
 	result["mesh"] = _mesh ? _mesh->GetGUID().str() : "null";
 	result["material"] = _material ? _material->GetGUID().str() : "null";
+	result["is_occluder"] = IsOccluder;
+	result["use_impostor"] = UseImpostor;
 	return result;
 }
 
@@ -49,6 +61,26 @@ RenderComponent::Sptr RenderComponent::FromJson(const nlohmann::json& data) {
 	RenderComponent::Sptr result = std::make_shared<RenderComponent>();
 	result->_mesh = ResourceManager::Get<Gameplay::MeshResource>(Guid(data["mesh"].get<std::string>()));
 	result->_material = ResourceManager::Get<Gameplay::Material>(Guid(data["material"].get<std::string>()));
+	result->IsOccluder = JsonGet(data, "is_occluder", false);
+	result->UseImpostor = JsonGet(data, "use_impostor", false);
+
+	return result;
+}
+
+void RenderComponent::ToBinary(BinaryWriter& writer) const {
+	// Missing resources are stored as an empty GUID, which won't resolve to anything when loaded
+	writer.WriteGuid(_mesh ? _mesh->GetGUID() : Guid());
+	writer.WriteGuid(_material ? _material->GetGUID() : Guid());
+	writer.Write<uint8_t>(IsOccluder);
+	writer.Write<uint8_t>(UseImpostor);
+}
+
+RenderComponent::Sptr RenderComponent::FromBinary(BinaryReader& reader) {
+	RenderComponent::Sptr result = std::make_shared<RenderComponent>();
+	result->_mesh = ResourceManager::Get<Gameplay::MeshResource>(reader.ReadGuid());
+	result->_material = ResourceManager::Get<Gameplay::Material>(reader.ReadGuid());
+	result->IsOccluder = reader.Read<uint8_t>() != 0;
+	result->UseImpostor = reader.Read<uint8_t>() != 0;
 
 	return result;
 }
@@ -59,5 +91,14 @@ void RenderComponent::RenderImGui() {
 	ImGui::Text("Source:    %s", (_mesh == nullptr || _mesh->Filename.empty()) ? "Generated" : _mesh->Filename.c_str());
 	ImGui::Separator();
 	ImGui::Text("Material:  %s", _material != nullptr ? _material->Name.c_str() : "NULL");
-	ImGuiHelper::ResourceDragTarget<Gameplay::Material>(_material);
+	if (ImGuiHelper::ResourceDragTarget<Gameplay::Material>(_material)) {
+		_gpuSlot.Dirty = true;
+	}
+	ImGui::Separator();
+	ImGui::Checkbox("Occluder", &IsOccluder);
+	ImGui::Checkbox("Use Impostor", &UseImpostor);
+	if (UseImpostor) {
+		ImGui::SameLine();
+		ImGui::Text("(%d%%)", (int)glm::round(_impostorFade * 100.0f));
+	}
 }
@@ -16,6 +16,18 @@ public:
 	RenderComponent();
 	RenderComponent(const Gameplay::MeshResource::Sptr& mesh, const Gameplay::Material::Sptr& material);
 
+	/// <summary>
+	/// True if this object should be drawn into the CPU occlusion buffer to hide objects behind it.
+	/// Best suited to large, solid objects like walls and floors
+	/// </summary>
+	bool IsOccluder;
+	/// <summary>
+	/// True if this object should be swapped for an octahedral impostor when it gets small on screen.
+	/// The impostor is baked from the mesh and material the first time it's needed, so this is best
+	/// suited to meshes using deferred materials that get used many times, like trees, rocks and ships
+	/// </summary>
+	bool UseImpostor;
+
 	/// <summary>
 	/// Gets the mesh resource which contains the mesh and serialization info for
 	/// this render component
@@ -47,6 +59,8 @@ public:
 	virtual void RenderImGui() override;
 	virtual nlohmann::json ToJson() const override;
 	static RenderComponent::Sptr FromJson(const nlohmann::json& data);
+	void ToBinary(BinaryWriter& writer) const;
+	static RenderComponent::Sptr FromBinary(BinaryReader& reader);
 	MAKE_TYPENAME(RenderComponent);
 
 protected:
@@ -57,4 +71,23 @@ protected:
 
 	// If we want to use MeshFactory, we can populate this list
 	std::vector<MeshBuilderParam> _meshBuilderParams;
+
+	// The render layer crossfades between the mesh and its impostor over a few frames
+	friend class RenderLayer;
+	// How far this object has faded towards its impostor, from 0 (mesh only) to 1 (impostor only)
+	float _impostorFade;
+
+	// Where the render layer keeps this object in the GPU culler's buffers, and what the data there was
+	// built from, so it's only uploaded again when something changes
+	struct GpuSlot {
+		// The render layer remembers which component holds each slot, so a stale index is never reused
+		uint32_t Index            = UINT32_MAX;
+		uint32_t Batch            = 0;
+		uint32_t First            = 0;
+		uint32_t TransformVersion = 0;
+		uint32_t MaterialVersion  = 0;
+		// Set when the mesh or material is swapped out
+		bool     Dirty            = true;
+	};
+	GpuSlot _gpuSlot;
 };
\ No newline at end of file
@@ -59,3 +59,13 @@ RotatingBehaviour::Sptr RotatingBehaviour::FromJson(const nlohmann::json& data)
 	result->RotationSpeed = JsonGet(data, "speed", result->RotationSpeed);
 	return result;
 }
+
+void RotatingBehaviour::ToBinary(BinaryWriter& writer) const {
+	writer.Write(RotationSpeed);
+}
+
+RotatingBehaviour::Sptr RotatingBehaviour::FromBinary(BinaryReader& reader) {
+	RotatingBehaviour::Sptr result = std::make_shared<RotatingBehaviour>();
+	result->RotationSpeed = reader.Read<glm::vec3>();
+	return result;
+}
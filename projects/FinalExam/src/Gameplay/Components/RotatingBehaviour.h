@@ -12,6 +12,8 @@ public:
 	glm::vec3 RotationSpeed;
 
 	virtual void Update(float deltaTime) override;
+	// Moves the ShipMoveBehaviour on our own object, so every instance can update at once
+	static Gameplay::ComponentAccess UpdateAccess() { return Gameplay::ComponentAccess::ReadTransform | Gameplay::ComponentAccess::WriteComponents; }
 
 	virtual float Lerp(float a, float b, float t);
 
@@ -19,6 +21,8 @@ public:
 
 	virtual nlohmann::json ToJson() const override;
 	static RotatingBehaviour::Sptr FromJson(const nlohmann::json& data);
+	void ToBinary(BinaryWriter& writer) const;
+	static RotatingBehaviour::Sptr FromBinary(BinaryReader& reader);
 
 	MAKE_TYPENAME(RotatingBehaviour);
 protected:
@@ -51,7 +51,7 @@ const glm::mat4& ShadowCamera::GetProjection() const {
 
 glm::mat4 ShadowCamera::GetViewProjection() const
 {
-	return _projectionMatrix * GetGameObject()->GetInverseTransform();
+	return _projectionMatrix * GetGameObject()->GetInverseRenderTransform();
 }
 
 void ShadowCamera::SetProjectionMask(const Texture2D::Sptr& image) {
@@ -46,6 +46,24 @@ ShipMoveBehaviour::Sptr ShipMoveBehaviour::FromJson(const nlohmann::json & blob)
 	return result;
 }
 
+void ShipMoveBehaviour::ToBinary(BinaryWriter& writer) const {
+	writer.Write(Center);
+	writer.Write(Angle);
+	writer.Write(Tilt);
+	writer.Write(Radius);
+	writer.Write(Speed);
+}
+
+ShipMoveBehaviour::Sptr ShipMoveBehaviour::FromBinary(BinaryReader& reader) {
+	ShipMoveBehaviour::Sptr result = std::make_shared<ShipMoveBehaviour>();
+	result->Center = reader.Read<glm::vec3>();
+	result->Angle  = reader.Read<float>();
+	result->Tilt   = reader.Read<float>();
+	result->Radius = reader.Read<float>();
+	result->Speed  = reader.Read<float>();
+	return result;
+}
+
 void ShipMoveBehaviour::Update(float deltaTime) {
 
 	glm::vec3 pos = Center + glm::vec3(
@@ -20,12 +20,16 @@ public:
 	virtual ~ShipMoveBehaviour();
 
 	virtual void Update(float deltaTime) override;
+	// Only moves our own object, so every ship can update at once
+	static Gameplay::ComponentAccess UpdateAccess() { return Gameplay::ComponentAccess::WriteTransform; }
 
 public:
 	virtual void RenderImGui() override;
 	MAKE_TYPENAME(ShipMoveBehaviour);
 	virtual nlohmann::json ToJson() const override;
 	static ShipMoveBehaviour::Sptr FromJson(const nlohmann::json& blob);
+	void ToBinary(BinaryWriter& writer) const;
+	static ShipMoveBehaviour::Sptr FromBinary(BinaryReader& reader);
 
 protected:
 };
\ No newline at end of file
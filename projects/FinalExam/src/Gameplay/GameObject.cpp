@@ -14,64 +14,31 @@
 #include "Gameplay/Scene.h"
 
 namespace Gameplay {
-	GameObject::GameObject() :
+	GameObject::GameObject(Scene* scene) :
 		IResource(),
 		Name("Unknown"),
 		HideInHierarchy(false),
+		AlwaysLoaded(false),
 		_components(std::vector<IComponent::Sptr>()),
-		_scene(nullptr),
-		_position(ZERO),
-		_rotation(glm::quat(glm::vec3(0.0f))),
-		_scale(ONE),
-		_localTransform(MAT4_IDENTITY),
-		_inverseLocalTransform(MAT4_IDENTITY),
-		_isLocalTransformDirty(true),
-		_worldTransform(MAT4_IDENTITY),
-		_inverseWorldTransform(MAT4_IDENTITY),
-		_isWorldTransformDirty(true),
+		_scene(scene),
+		_transforms(scene->_transforms),
+		_transformIndex(scene->_transforms->Allocate()),
+		_sceneIndex(UINT32_MAX),
+		_handle(Handle()),
+		_isPendingDelete(false),
 		_parent(WeakRef()),
 		_children(std::vector<WeakRef>())
 	{ }
 
-	void GameObject::_RecalcLocalTransform() const
-	{
-		if (_isLocalTransformDirty) {
-			_localTransform = glm::translate(MAT4_IDENTITY, _position) * glm::mat4_cast(_rotation) * glm::scale(MAT4_IDENTITY, _scale);
-			_inverseLocalTransform = glm::inverse(_localTransform);
-			_isLocalTransformDirty = false;
-			_isWorldTransformDirty = true;
-
-			// Dirty all the child objects world transforms
-			for (const auto& childPtr : _children) {
-				GameObject::Sptr childSptr = childPtr;
-				if (childSptr != nullptr) {
-					childSptr->_isWorldTransformDirty = true;
-				}
-			}
-		}
-	}
-
-	void GameObject::_RecalcWorldTransform() const {
-		// Start by determining our local transform if required
-		_RecalcLocalTransform();
-
-		// If our world transform has been marked as dirty, we need to recalculate it!
-		if (_isWorldTransformDirty) {
-			GameObject::Sptr parent = _parent;
-
-			// If out parent exists, we apply our local transformation relative to the parent's world transformation
-			if (parent != nullptr) {
-				_worldTransform = parent->GetTransform() * _localTransform;
-				_inverseWorldTransform = glm::inverse(_worldTransform);
-			}
-
-			// If our parent is null, we can simply use the local transform as the world transform
-			else {
-				_worldTransform = _localTransform;
-				_inverseWorldTransform = _inverseLocalTransform;
+	GameObject::~GameObject() {
+		// Any children that are still alive become roots, so that they don't pick up whoever reuses our slot
+		for (const auto& child : _children) {
+			GameObject::Sptr childPtr = child;
+			if (childPtr != nullptr) {
+				_transforms->SetParent(childPtr->_transformIndex, TransformSystem::NO_PARENT);
 			}
-			_isWorldTransformDirty = false;
 		}
+		_transforms->Free(_transformIndex);
 	}
 
 	void GameObject::_PurgeDeletedChildren() {
@@ -82,7 +49,7 @@ namespace Gameplay {
 	}
 
 	void GameObject::LookAt(const glm::vec3& point) {
-		glm::mat4 rot = glm::lookAt(_position, point, glm::vec3(0.0f, 0.0f, 1.0f));
+		glm::mat4 rot = glm::lookAt(GetPosition(), point, glm::vec3(0.0f, 0.0f, 1.0f));
 		// Take the conjugate of the quaternion, as lookAt returns the *inverse* rotation
 		SetRotation(glm::conjugate(glm::quat_cast(rot)));
 	}
@@ -112,12 +79,11 @@ namespace Gameplay {
 	}
 
 	void GameObject::SetPostion(const glm::vec3& position) {
-		_position = position;
-		_isLocalTransformDirty = true;
+		_transforms->SetPosition(_transformIndex, position);
 	}
 
 	const glm::vec3& GameObject::GetPosition() const {
-		return _position;
+		return _transforms->GetPosition(_transformIndex);
 	}
 
 	glm::vec3 GameObject::GetWorldPosition() const {
@@ -125,51 +91,56 @@ namespace Gameplay {
 	}
 
 	void GameObject::SetRotation(const glm::quat& value) {
-		_rotation = value;
-		_isLocalTransformDirty = true;
+		_transforms->SetRotation(_transformIndex, value);
 	}
 
 	const glm::quat& GameObject::GetRotation() const {
-		return _rotation;
+		return _transforms->GetRotation(_transformIndex);
 	}
 
 	void GameObject::SetRotation(const glm::vec3& eulerAngles) {
-		_rotation = glm::quat(glm::radians(eulerAngles));
-		_isLocalTransformDirty = true;
+		_transforms->SetRotation(_transformIndex, glm::quat(glm::radians(eulerAngles)));
 	}
 
 	glm::vec3 GameObject::GetRotationEuler() const {
-		return glm::degrees(glm::eulerAngles(_rotation));
+		return glm::degrees(glm::eulerAngles(GetRotation()));
 	}
 
 	void GameObject::SetScale(const glm::vec3& value) {
-		_scale = value;
-		_isLocalTransformDirty = true;
+		_transforms->SetScale(_transformIndex, value);
 	}
 
 	const glm::vec3& GameObject::GetScale() const {
-		return _scale;
+		return _transforms->GetScale(_transformIndex);
 	}
 
 	const glm::mat4& GameObject::GetTransform() const {
-		_RecalcWorldTransform();
-		return _worldTransform;
+		return _transforms->GetWorldTransform(_transformIndex);
 	}
 
 	const glm::mat4& GameObject::GetInverseTransform() const {
-		_RecalcWorldTransform();
-		return _inverseWorldTransform;
+		return _transforms->GetInverseWorldTransform(_transformIndex);
+	}
+
+	const glm::mat4& GameObject::GetRenderTransform() const {
+		return _transforms->GetRenderTransform(_transformIndex);
+	}
+
+	const glm::mat4& GameObject::GetInverseRenderTransform() const {
+		return _transforms->GetInverseRenderTransform(_transformIndex);
+	}
+
+	uint32_t GameObject::GetRenderTransformVersion() const {
+		return _transforms->GetRenderVersion(_transformIndex);
 	}
 
 	const glm::mat4& GameObject::GetLocalTransform() const
 	{
-		_RecalcLocalTransform();
-		return _localTransform;
+		return _transforms->GetLocalTransform(_transformIndex);
 	}
 
 	const glm::mat4& GameObject::GetInverseLocalTransform() const {
-		_RecalcLocalTransform();
-		return _inverseLocalTransform;
+		return _transforms->GetInverseLocalTransform(_transformIndex);
 	}
 
 	void GameObject::RenderGUI() {
@@ -203,22 +174,28 @@ namespace Gameplay {
 		return _scene;
 	}
 
-	void GameObject::Awake() {
-		for (auto& component : _components) {
-			component->Awake();
+	GameObject::Handle GameObject::GetHandle() const {
+		return _sceneIndex != UINT32_MAX ? _handle : Handle();
+	}
+
+	bool GameObject::IsPendingDelete() const {
+		return _isPendingDelete;
+	}
+
+	void GameObject::SetName(const std::string& name) {
+		if (name == Name) return;
+
+		std::string oldName = Name;
+		Name = name;
+		if (_scene != nullptr) {
+			_scene->_OnObjectRenamed(this, oldName);
 		}
 	}
 
-	void GameObject::Update(float dt) {
+	void GameObject::Awake() {
 		for (auto& component : _components) {
-			if (component->IsEnabled) {
-				component->Update(dt);
-			}
+			component->Awake();
 		}
-
-		_RecalcLocalTransform();
-		_RecalcWorldTransform();
-		_PurgeDeletedChildren();
 	}
 
 	bool GameObject::Has(const std::type_index& type) {
@@ -279,7 +256,7 @@ namespace Gameplay {
 			// applies to the child
 			_children.push_back(child);
 			child->_parent = _selfRef.lock();
-			child->_isWorldTransformDirty = true;
+			_transforms->SetParent(child->_transformIndex, _transformIndex);
 		} else {
 			LOG_WARN("Attempting to add same child twice, ignoring: {}", child->Name);
 		}
@@ -292,6 +269,7 @@ namespace Gameplay {
 		if (it != _children.end()) { 
 			// Clear the object's parent and remove from our list of children
 			child->_parent.Reset();
+			_transforms->SetParent(child->_transformIndex, TransformSystem::NO_PARENT);
 			_children.erase(it);
 			return true;
 		} else {
@@ -315,7 +293,7 @@ namespace Gameplay {
 		ImGui::PushID(this); // Push a new ImGui ID scope for this object
 		// Since we're allowing names to change, we need to use the ### to have a static ID for the header
 		static char buffer[256];
-		sprintf_s(buffer, 256, "%s###GO_HEADER", Name.c_str());
+		snprintf(buffer, 256, "%s###GO_HEADER", Name.c_str());
 		if (ImGui::CollapsingHeader(buffer)) {
 			ImGui::Indent();
 
@@ -324,7 +302,7 @@ namespace Gameplay {
 			memcpy(nameBuff, Name.c_str(), Name.size());
 			nameBuff[Name.size()] = '\0';
 			if (ImGui::InputText("", nameBuff, 256)) {
-				Name = nameBuff;
+				SetName(nameBuff);
 			}
 			ImGui::SameLine();
 			if (ImGuiHelper::WarningButton("Delete")) {
@@ -354,16 +332,19 @@ namespace Gameplay {
 			}
 
 			// Render position label
-			_isLocalTransformDirty |= LABEL_LEFT(ImGui::DragFloat3, "Position", &_position.x, 0.01f);
+			glm::vec3 position = GetPosition();
+			if (LABEL_LEFT(ImGui::DragFloat3, "Position", &position.x, 0.01f)) {
+				SetPostion(position);
+			}
 			
 			// Get the ImGui storage state so we can avoid gimbal locking issues by storing euler angles in the editor
 			glm::vec3 euler = GetRotationEuler();
 			ImGuiStorage* guiStore = ImGui::GetStateStorage();
 
-			// Extract the angles from the storage, note that we're only using the address of the position for unique IDs
-			euler.x = guiStore->GetFloat(ImGui::GetID(&_position.x), euler.x);
-			euler.y = guiStore->GetFloat(ImGui::GetID(&_position.y), euler.y);
-			euler.z = guiStore->GetFloat(ImGui::GetID(&_position.z), euler.z);
+			// Extract the angles from the storage, these IDs are scoped to the object by the PushID above
+			euler.x = guiStore->GetFloat(ImGui::GetID("Euler X"), euler.x);
+			euler.y = guiStore->GetFloat(ImGui::GetID("Euler Y"), euler.y);
+			euler.z = guiStore->GetFloat(ImGui::GetID("Euler Z"), euler.z);
 
 			//Draw the slider for angles
 			if (LABEL_LEFT(ImGui::DragFloat3, "Rotation", &euler.x, 1.0f)) {
@@ -371,16 +352,24 @@ namespace Gameplay {
 				euler = Wrap(euler, -180.0f, 180.0f);
 
 				// Update the editor state with our new values
-				guiStore->SetFloat(ImGui::GetID(&_position.x), euler.x);
-				guiStore->SetFloat(ImGui::GetID(&_position.y), euler.y);
-				guiStore->SetFloat(ImGui::GetID(&_position.z), euler.z);
+				guiStore->SetFloat(ImGui::GetID("Euler X"), euler.x);
+				guiStore->SetFloat(ImGui::GetID("Euler Y"), euler.y);
+				guiStore->SetFloat(ImGui::GetID("Euler Z"), euler.z);
 
 				//Send new rotation to the gameobject
 				SetRotation(euler);
 			}
 			
 			// Draw the scale
-			_isLocalTransformDirty |= LABEL_LEFT(ImGui::DragFloat3, "Scale   ", &_scale.x, 0.01f, 0.0f);
+			glm::vec3 scale = GetScale();
+			if (LABEL_LEFT(ImGui::DragFloat3, "Scale   ", &scale.x, 0.01f, 0.0f)) {
+				SetScale(scale);
+			}
+
+			// Only roots get sorted into sectors, children always go with their root
+			if (_parent == nullptr) {
+				LABEL_LEFT(ImGui::Checkbox, "Always Loaded", &AlwaysLoaded);
+			}
 
 			ImGui::Separator();
 			ImGui::TextUnformatted("Components");
@@ -438,10 +427,6 @@ namespace Gameplay {
 			ImGui::Unindent();
 		}
 		ImGui::PopID(); // Pop the ImGui ID scope for the object
-
-		// For if we're not in play mode
-		_RecalcLocalTransform();
-		_RecalcWorldTransform();
 	}
 
 	std::shared_ptr<GameObject> GameObject::SelfRef() {
@@ -452,19 +437,17 @@ namespace Gameplay {
 	{
 		// We need to manually construct since the GameObject constructor is
 		// protected. We can call it here since Scene is a friend class of GameObjects
-		GameObject::Sptr result(new GameObject());
-		result->_scene = scene;
+		GameObject::Sptr result(new GameObject(scene));
 
 		// Load in basic info
 		result->Name = data["name"];
-		result->_guid = Guid(data["guid"]);
-		result->_parent = WeakRef(Guid(data.contains("parent") ? data["parent"] : "null"), nullptr);
-		result->_position = (data["position"]);
-		result->_rotation = (data["rotation"]);
-		result->_scale    = (data["scale"]);
+		result->_guid = Guid(data["guid"].get<std::string>());
+		result->_parent = WeakRef(Guid(JsonGet<std::string>(data, "parent", "null")), nullptr);
+		result->SetPostion(data["position"]);
+		result->SetRotation((glm::quat)data["rotation"]);
+		result->SetScale(data["scale"]);
 		result->HideInHierarchy = JsonGet(data, "hide_in_inspector", false);
-		result->_isLocalTransformDirty = true;
-		result->_isWorldTransformDirty = true;
+		result->AlwaysLoaded = JsonGet(data, "always_loaded", false);
 
 		// Since our components are stored based on the type name, we iterate
 		// on the keys and values from the components object
@@ -489,11 +472,12 @@ namespace Gameplay {
 		nlohmann::json result = {
 			{ "name", Name },
 			{ "guid", _guid.str() },
-			{ "position", _position },
-			{ "rotation", _rotation },
-			{ "scale",    _scale },
+			{ "position", GetPosition() },
+			{ "rotation", GetRotation() },
+			{ "scale",    GetScale() },
 			{ "parent",   parent == nullptr ? "null" : parent->_guid.str() },
-			{ "hide_in_inspector", HideInHierarchy }
+			{ "hide_in_inspector", HideInHierarchy },
+			{ "always_loaded", AlwaysLoaded }
 		};
 		result["components"] = nlohmann::json();
 		for (auto& component : _components) {
@@ -511,8 +495,8 @@ namespace Gameplay {
 	}
 
 	Gameplay::GameObject::WeakRef& GameObject::WeakRef::operator=(const GameObject::Sptr& ptr) {
-		ResourceGUID = ptr->GetGUID();
-		SceneContext = ptr->GetScene();
+		ResourceGUID = ptr != nullptr ? ptr->GetGUID() : Guid();
+		SceneContext = ptr != nullptr ? ptr->GetScene() : nullptr;
 		Ptr = ptr;
 		isNull = ptr == nullptr;
 		return *this;
@@ -11,6 +11,7 @@
 // Others
 #include "Gameplay/Components/IComponent.h"
 #include "Gameplay/Components/ComponentManager.h"
+#include "Gameplay/TransformSystem.h"
 #include "Utils/ResourceManager/IResource.h"
 
 class InspectorWindow;
@@ -133,11 +134,39 @@ namespace Gameplay {
 			void Reset();
 		};
 
-		// Human readable name for the object
+		/// <summary>
+		/// A lightweight reference to an object in a scene, which can be resolved with Scene::FindObjectByHandle
+		/// 
+		/// The index is a slot in the scene's handle table, and the generation is bumped every time the
+		/// slot is released, so handles to objects that have been removed will resolve to nullptr even
+		/// after their slot is reused. Handles are only meaningful for the scene that gave them out
+		/// </summary>
+		struct Handle {
+			uint32_t Index      = UINT32_MAX;
+			uint32_t Generation = 0;
+
+			bool IsNull() const { return Index == UINT32_MAX; }
+			bool operator ==(const Handle& other) const { return Index == other.Index && Generation == other.Generation; }
+			bool operator !=(const Handle& other) const { return !(*this == other); }
+		};
+
+		~GameObject();
+
+		// Human readable name for the object. Use SetName to rename objects that are already in a
+		// scene, otherwise Scene::FindObjectByName won't be able to find them by their new name
 		std::string             Name;
 
 		// Hack to hide instances from the hierarchy (like when adding lots of instances)
 		bool HideInHierarchy = false;
+		// True to keep this object in the scene file when the scene is split into sectors, rather than
+		// streaming it in and out with the sector it's in (see Scene::ExportSectors). Only used for root objects
+		bool AlwaysLoaded = false;
+
+		/// <summary>
+		/// Renames this object, and updates its scene's name lookup
+		/// </summary>
+		/// <param name="name">The new name for the object</param>
+		void SetName(const std::string& name);
 
 		/// <summary>
 		/// Rotates this object to look at the given point in world coordinates
@@ -222,6 +251,16 @@ namespace Gameplay {
 		/// This matrix transforms points from world space to local space
 		/// </summary>
 		const glm::mat4& GetInverseTransform() const;
+		/// <summary>
+		/// Gets the world transform to render the object with. When the scene runs at a fixed tick
+		/// rate this is blended between the last two ticks, otherwise it's the same as GetTransform
+		/// </summary>
+		const glm::mat4& GetRenderTransform() const;
+		const glm::mat4& GetInverseRenderTransform() const;
+		/// <summary>
+		/// Gets a number that changes whenever the render transform does, see TransformSystem::GetRenderVersion
+		/// </summary>
+		uint32_t GetRenderTransformVersion() const;
 
 		const glm::mat4& GetLocalTransform() const;
 		const glm::mat4& GetInverseLocalTransform() const;
@@ -235,17 +274,20 @@ namespace Gameplay {
 		/// Returns a pointer to the scene that this GameObject belongs to
 		/// </summary>
 		Scene* GetScene() const;
-
 		/// <summary>
-		/// Notify all enabled components in this gameObject that the scene has been loaded
+		/// Gets a handle to this object, or a null handle if the object has been removed from its scene
 		/// </summary>
-		void Awake();
+		Handle GetHandle() const;
+		/// <summary>
+		/// Returns true if the object has been removed from its scene, and is waiting for the end of the
+		/// frame to be deleted
+		/// </summary>
+		bool IsPendingDelete() const;
 
 		/// <summary>
-		/// Calls update on all enabled components in this object
+		/// Notify all enabled components in this gameObject that the scene has been loaded
 		/// </summary>
-		/// <param name="deltaTime">The time since the last frame, in seconds</param>
-		void Update(float dt);
+		void Awake();
 
 		/// <summary>
 		/// Checks whether this gameobject has a component of the given type
@@ -295,7 +337,7 @@ namespace Gameplay {
 			LOG_ASSERT(!Has<T>(), "Cannot add 2 instances of a component type to a game object");
 
 			// Make a new component, forwarding the arguments
-			std::shared_ptr<T> component = _scene->Components().Create<T>(std::forward<TArgs>(args)...);
+			std::shared_ptr<T> component = _scene->Components().template Create<T>(std::forward<TArgs>(args)...);
 			// Let the component know we are the parent
 			component->_context = this;
 
@@ -336,24 +378,19 @@ namespace Gameplay {
 
 	private:
 		friend class Scene;
-		friend class InspectorWindow;
-		friend class HierarchyWindow;
+		friend class ::InspectorWindow;
+		friend class ::HierarchyWindow;
 
-		// Rotation of the object as a quaternion
-		glm::quat _rotation;
-		// Position of the object
-		glm::vec3 _position;
-		// The scale of the object
-		glm::vec3 _scale;
+		// The object's position, rotation, scale and transforms live in the scene's transform system,
+		// we keep our own reference so that objects that outlive their scene can still be cleaned up
+		std::shared_ptr<TransformSystem> _transforms;
+		uint32_t _transformIndex;
 
-		// The object's world transform
-		mutable glm::mat4 _localTransform;
-		mutable glm::mat4 _inverseLocalTransform;
-		mutable bool _isLocalTransformDirty;
-
-		mutable glm::mat4 _worldTransform;
-		mutable glm::mat4 _inverseWorldTransform;
-		mutable bool _isWorldTransformDirty;
+		// Our position in the scene's object list, or UINT32_MAX once we've been removed from the scene
+		uint32_t _sceneIndex;
+		Handle   _handle;
+		// Set once we've been queued for removal, so that we're only ever queued once
+		bool     _isPendingDelete;
 
 		// For the hierarchy
 		WeakRef _parent;
@@ -371,11 +408,7 @@ namespace Gameplay {
 		/// <summary>
 		/// Only scenes will be allowed to create gameobjects
 		/// </summary>
-		GameObject();
-
-		// Recalculates the transform matrix for the object when required
-		void _RecalcLocalTransform() const;
-		void _RecalcWorldTransform() const;
+		GameObject(Scene* scene);
 
 		void _PurgeDeletedChildren();
 	};
@@ -11,6 +11,9 @@ std::wstring InputEngine::__inputText = LR"()";
 
 ButtonState InputEngine::__mouseState[GLFW_MOUSE_BUTTON_LAST + 1];
 ButtonState InputEngine::__keyState[GLFW_KEY_LAST + 1];
+ButtonState InputEngine::__tickMouseState[GLFW_MOUSE_BUTTON_LAST + 1];
+ButtonState InputEngine::__tickKeyState[GLFW_KEY_LAST + 1];
+bool InputEngine::__inTick = false;
 
 void InputEngine::Init(GLFWwindow* window)
 {
@@ -22,12 +25,14 @@ void InputEngine::Init(GLFWwindow* window)
 }
 
 ButtonState InputEngine::GetKeyState(int keyCode) {
-	return (keyCode <= GLFW_KEY_LAST) ? __keyState[keyCode] : ButtonState::Up;
+	if (keyCode > GLFW_KEY_LAST) return ButtonState::Up;
+	return __inTick ? __tickKeyState[keyCode] : __keyState[keyCode];
 }
 
 ButtonState InputEngine::GetMouseState(int button)
 {
-	return (button <= GLFW_MOUSE_BUTTON_LAST) ? __mouseState[button] : ButtonState::Up;
+	if (button > GLFW_MOUSE_BUTTON_LAST) return ButtonState::Up;
+	return __inTick ? __tickMouseState[button] : __mouseState[button];
 }
 
 bool InputEngine::IsKeyDown(int keyCode) {
@@ -79,6 +84,39 @@ void InputEngine::EndFrame() {
 	}
 }
 
+void InputEngine::BeginTick() {
+	__inTick = true;
+}
+
+void InputEngine::EndTick() {
+	__inTick = false;
+
+	for (int ix = 0; ix < GLFW_KEY_LAST + 1; ix++) {
+		__EndTick(__tickKeyState[ix], __keyState[ix]);
+	}
+
+	for (int ix = 0; ix < GLFW_MOUSE_BUTTON_LAST + 1; ix++) {
+		__EndTick(__tickMouseState[ix], __mouseState[ix]);
+	}
+}
+
+void InputEngine::__LatchEdge(ButtonState& tickState, ButtonState edge) {
+	// If a press hasn't been seen by a tick yet, we keep it, EndTick will turn it into a release afterwards
+	if (edge == ButtonState::Released && tickState == ButtonState::Pressed)
+		return;
+	tickState = edge;
+}
+
+void InputEngine::__EndTick(ButtonState& tickState, ButtonState frameState) {
+	// The tick has seen the edge, so we fall back to the button's real state. If the button went up while
+	// we were holding on to the press, the next tick sees that as a release
+	if (*frameState & 0b01) {
+		tickState = ButtonState::Down;
+	} else {
+		tickState = (*tickState & 0b01) ? ButtonState::Released : ButtonState::Up;
+	}
+}
+
 
 void InputEngine::__KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
 	if (key == GLFW_KEY_UNKNOWN)
@@ -87,9 +125,11 @@ void InputEngine::__KeyCallback(GLFWwindow* window, int key, int scancode, int a
 	switch (action) {
 		case GLFW_PRESS:
 			__keyState[key] = ButtonState::Pressed;
+			__LatchEdge(__tickKeyState[key], ButtonState::Pressed);
 			break;
 		case GLFW_RELEASE:
 			__keyState[key] = ButtonState::Released;
+			__LatchEdge(__tickKeyState[key], ButtonState::Released);
 			break;
 		default:
 			break;
@@ -106,8 +146,10 @@ void InputEngine::__MouseButtonCallback(GLFWwindow* window, int button, int acti
 
 	if (action == GLFW_PRESS) {
 		__mouseState[button] = ButtonState::Pressed;
+		__LatchEdge(__tickMouseState[button], ButtonState::Pressed);
 	} else if (action == GLFW_RELEASE) {
 		__mouseState[button] = ButtonState::Released;
+		__LatchEdge(__tickMouseState[button], ButtonState::Released);
 	}
 }
 
@@ -38,10 +38,19 @@ public:
 
 	static void EndFrame();
 
+	// Fixed updates can run several times in a frame, or not at all, so presses and releases are latched
+	// until the first tick after them has seen them. Between these calls, GetKeyState and GetMouseState
+	// return the latched states
+	static void BeginTick();
+	static void EndTick();
+
 private:
 	static GLFWwindow*  __window;
 	static ButtonState  __keyState[GLFW_KEY_LAST + 1];
 	static ButtonState  __mouseState[GLFW_MOUSE_BUTTON_LAST + 1];
+	static ButtonState  __tickKeyState[GLFW_KEY_LAST + 1];
+	static ButtonState  __tickMouseState[GLFW_MOUSE_BUTTON_LAST + 1];
+	static bool         __inTick;
 	static glm::dvec2   __mousePos;
 	static glm::dvec2   __prevMousePos;
 	static glm::dvec2   __scrollDelta;
@@ -51,4 +60,7 @@ private:
 	static void __CharCallback(GLFWwindow* window, uint32_t keycode);
 	static void __MouseButtonCallback(GLFWwindow* window, int button, int action, int mods);
 	static void __MouseScrollCallback(GLFWwindow* window, double x, double y);
+
+	static void __LatchEdge(ButtonState& tickState, ButtonState edge);
+	static void __EndTick(ButtonState& tickState, ButtonState frameState);
 };
\ No newline at end of file
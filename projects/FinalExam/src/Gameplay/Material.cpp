@@ -9,10 +9,21 @@
 #include "Graphics/Textures/Texture3D.h"
 
 namespace Gameplay {
+	const char* const Material::BATCHED_TEXTURE_NAMES[BATCHED_TEXTURE_COUNT] = {
+		"u_Material.AlbedoMap",
+		"u_Material.EmissiveMap",
+		"u_Material.NormalMap",
+		"u_Material.MetallicShininessMap"
+	};
+
 	Material::Material(const ShaderProgram::Sptr& shader) :
 		IResource(),
 		_shader(shader),
-		_uniforms(std::unordered_map<std::string, UniformData>())
+		_uniforms(std::unordered_map<std::string, UniformData>()),
+		_batchShader(nullptr),
+		_textureBatch(TextureBatch()),
+		_batchRequested(false),
+		_version(0)
 	{
 		_PopulateUniforms();
 	}
@@ -20,19 +31,27 @@ namespace Gameplay {
 	Material::Material() :
 		IResource(),
 		_shader(nullptr),
-		_uniforms(std::unordered_map<std::string, UniformData>())
+		_uniforms(std::unordered_map<std::string, UniformData>()),
+		_batchShader(nullptr),
+		_textureBatch(TextureBatch()),
+		_batchRequested(false),
+		_version(0)
 	{ }
 
 	void Material::Set(const std::string& name, ShaderDataType type, const void* value, size_t arraySize)
 	{
 		// Try and find the matching uniform
 		UniformData& uniform = _GetUniform(name);
+		_version++;
 
 		// We have a uniform, let's see if we can update it
 		if (uniform.Location != -2) {
 			// If it's a texture, we update TextureAsset so it adds to the ref count
 			if (GetShaderDataTypeCode(uniform.Type) == ShaderDataTypecode::Texture && type == ShaderDataType::None) {
 				uniform.TextureAsset = *reinterpret_cast<const ITexture::Sptr*>(value);
+
+				// Our packed copy of the textures is out of date now
+				UnpackTextures();
 			}
 			// Check for type mismatch
 			else if (uniform.Type != type && uniform.Type != ShaderDataType::None) {
@@ -97,6 +116,70 @@ namespace Gameplay {
 		}
 	}
 
+	bool Material::PackTextures(TextureArrayPacker& packer, const ShaderProgram::Sptr& batchShader) {
+		UnpackTextures();
+		if (batchShader == nullptr) {
+			return false;
+		}
+
+		TextureBatch batch;
+		for (auto&[name, data] : _uniforms) {
+			if (!data.IsTextureResource() || data.TextureAsset == nullptr) {
+				continue;
+			}
+
+			// Any texture that the batched shader doesn't know about means we can't be batched
+			int index = -1;
+			for (int ix = 0; ix < BATCHED_TEXTURE_COUNT; ix++) {
+				if (name == BATCHED_TEXTURE_NAMES[ix]) {
+					index = ix;
+					break;
+				}
+			}
+			if (index == -1) {
+				return false;
+			}
+
+			Texture2D::Sptr texture = std::dynamic_pointer_cast<Texture2D>(data.TextureAsset);
+			TextureArrayPacker::PackedTexture packed = packer.Pack(texture);
+			if (!packed.IsValid()) {
+				return false;
+			}
+
+			batch.Pages[index]  = packed.Page;
+			batch.Layers[index] = packed.Layer;
+		}
+
+		_batchShader    = batchShader;
+		_textureBatch   = batch;
+		_batchRequested = true;
+		_version++;
+		return true;
+	}
+
+	void Material::UnpackTextures() {
+		_batchShader    = nullptr;
+		_textureBatch   = TextureBatch();
+		_batchRequested = false;
+		_version++;
+	}
+
+	const ShaderProgram::Sptr& Material::GetBatchShader() const {
+		return _batchShader;
+	}
+
+	const Material::TextureBatch& Material::GetTextureBatch() const {
+		return _textureBatch;
+	}
+
+	bool Material::IsBatchRequested() const {
+		return _batchRequested;
+	}
+
+	uint32_t Material::GetVersion() const {
+		return _version;
+	}
+
 	void Material::RenderImGui() {
 		ImGui::PushID(this);
 
@@ -109,7 +192,9 @@ namespace Gameplay {
 			// Draw all of our valid uniforms
 			for (auto&[key, value] : _uniforms) {
 				if (value.Location != -2 && value.Location != -1) {
-					value.RenderImGui();
+					if (value.RenderImGui()) {
+						_version++;
+					}
 				}
 			}
 
@@ -129,9 +214,9 @@ namespace Gameplay {
 	Material::Sptr Material::FromJson(const nlohmann::json& data) {
 		// Load in basic material info like shader and name
 		Material::Sptr result = std::make_shared<Material>();
-		result->OverrideGUID(Guid(data["guid"]));
+		result->OverrideGUID(Guid(data["guid"].get<std::string>()));
 		result->Name = data["name"].get<std::string>();
-		result->_shader = ResourceManager::Get<ShaderProgram>(Guid(data["shader"]));
+		result->_shader = ResourceManager::Get<ShaderProgram>(Guid(data["shader"].get<std::string>()));
 		result->_PopulateUniforms();
 
 		// material specific parameters'
@@ -145,6 +230,7 @@ namespace Gameplay {
 				}
 			}
 		}
+		result->_batchRequested = JsonGet(data, "batched", false);
 		return result;
 	}
 
@@ -153,6 +239,7 @@ namespace Gameplay {
 			{ "guid", GetGUID().str() },
 			{ "name", Name },
 			{ "shader", _shader ? _shader->GetGUID().str() : "null" },
+			{ "batched", _batchRequested },
 			{ "parameters", nlohmann::json() }
 		};
 
@@ -210,7 +297,7 @@ namespace Gameplay {
 		uint8_t* dataStore = ArraySize > 1 ? (uint8_t*)ArrayBlock : Value;
 
 		// We'll need the name regardless, create it here
-		sprintf_s(buffer, "%s:", Name.c_str());
+		snprintf(buffer, sizeof(buffer), "%s:", Name.c_str());
 
 		// If this is an array, draw name and indent items
 		if (ArraySize > 1) {
@@ -223,7 +310,7 @@ namespace Gameplay {
 		for (int ix = 0; ix < ArraySize; ix++) {
 			// If it's an array element, the name is the index
 			if (ArraySize > 1) {
-				sprintf_s(buffer, "[%d]:", ix);
+				snprintf(buffer, sizeof(buffer), "[%d]:", ix);
 			}
 
 			// For arrays determine our data offset
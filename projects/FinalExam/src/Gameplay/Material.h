@@ -2,6 +2,7 @@
 #include <memory>
 #include "Graphics/ShaderProgram.h"
 #include "Graphics/Textures/ITexture.h"
+#include "Graphics/Textures/TextureArrayPacker.h"
 
 namespace Gameplay {
 	/// <summary>
@@ -19,6 +20,25 @@ namespace Gameplay {
 		/// </summary>
 		static const int MAX_TEXTURE_SLOTS = 14;
 
+		/// <summary>
+		/// The number of textures that a batched material can use, see BATCHED_TEXTURE_NAMES
+		/// </summary>
+		static const int BATCHED_TEXTURE_COUNT = 4;
+		/// <summary>
+		/// The parameters that batched shaders read textures from, in the order they are stored in a TextureBatch
+		/// </summary>
+		static const char* const BATCHED_TEXTURE_NAMES[BATCHED_TEXTURE_COUNT];
+
+		/// <summary>
+		/// Where a batched material's textures live in their texture array pages
+		/// </summary>
+		struct TextureBatch {
+			// The page holding each texture, or nullptr if the material does not use that texture
+			Texture2DArray::Sptr Pages[BATCHED_TEXTURE_COUNT];
+			// The layer of each texture within its page, or -1 if the material does not use that texture
+			glm::ivec4           Layers = glm::ivec4(-1);
+		};
+
 		/// <summary>
 		/// A human readable name for the material
 		/// </summary>
@@ -55,6 +75,21 @@ namespace Gameplay {
 		/// <param name="arraySize">The array size in the event that the value is an array</param>
 		void Set(const std::string& name, ShaderDataType type, const void* value, size_t arraySize = 1ul);
 
+		/// <summary>
+		/// Gets the value of a non-texture material parameter
+		/// </summary>
+		/// <typeparam name="T">The type of parameter to get</typeparam>
+		/// <param name="name">The name of the parameter, should match the uniform name</param>
+		/// <param name="fallback">The value to return if the parameter does not exist or has a different type</param>
+		template <typename T>
+		T Get(const std::string& name, const T& fallback = T()) const {
+			auto it = _uniforms.find(name);
+			if (it == _uniforms.end() || it->second.Type != GetShaderDataType<T>() || it->second.ArraySize > 1) {
+				return fallback;
+			}
+			return it->second.Get<T>();
+		}
+
 		/// <summary>
 		/// Gets the shader that this material is using
 		/// </summary>
@@ -66,6 +101,36 @@ namespace Gameplay {
 		/// </summary>
 		virtual void Apply();
 
+		/// <summary>
+		/// Moves this material's textures into shared texture array pages, so that it can be drawn in the same
+		/// instanced draw as other batched materials using the same pages and mesh. Only the textures in
+		/// BATCHED_TEXTURE_NAMES can be batched, materials with any other textures are left as they are
+		/// </summary>
+		/// <param name="packer">The packer to store the textures in</param>
+		/// <param name="batchShader">The shader to draw with when batched, which reads textures from arrays</param>
+		/// <returns>True if all of the material's textures were packed</returns>
+		bool PackTextures(TextureArrayPacker& packer, const ShaderProgram::Sptr& batchShader);
+		/// <summary>
+		/// Stops this material from being batched, this happens automatically if a texture is changed
+		/// </summary>
+		void UnpackTextures();
+		/// <summary>
+		/// Gets the shader to use when drawing this material as part of a batch, or nullptr if the material
+		/// has not been packed
+		/// </summary>
+		const ShaderProgram::Sptr& GetBatchShader() const;
+		const TextureBatch& GetTextureBatch() const;
+		/// <summary>
+		/// True if the material has been packed, or was packed when it was saved. Texture array layers are only
+		/// valid for the current run, so the render layer packs these again when a scene is loaded
+		/// </summary>
+		bool IsBatchRequested() const;
+		/// <summary>
+		/// Gets a number that changes whenever a parameter or the texture batch changes, so that renderers
+		/// caching per object data built from the material can tell when to rebuild it
+		/// </summary>
+		uint32_t GetVersion() const;
+
 		/// <summary>
 		/// Renders some UI controls for manipulating a material at runtime
 		/// </summary>
@@ -175,6 +240,15 @@ namespace Gameplay {
 		/// </summary>
 		std::unordered_map<std::string, UniformData> _uniforms;
 
+		/// <summary>
+		/// Only valid while the material is batched
+		/// </summary>
+		ShaderProgram::Sptr    _batchShader;
+		TextureBatch           _textureBatch;
+		// Saved with the material, so that loaded materials can be packed again
+		bool                   _batchRequested;
+		uint32_t               _version;
+
 		UniformData& _GetUniform(const std::string& name);
 		void _PopulateUniforms();
 	};
@@ -9,7 +9,13 @@ namespace Gameplay {
 		Filename(""),
 		MeshBuilderParams(std::vector<MeshBuilderParam>()),
 		Mesh(nullptr),
-		BulletTriMesh(nullptr)
+		BulletTriMesh(nullptr),
+		_boundsMin(glm::vec3(0.0f)),
+		_boundsMax(glm::vec3(0.0f)),
+		_boundsSource(nullptr),
+		_hasBounds(false),
+		_occluderTriangles(std::vector<glm::vec3>()),
+		_occluderSource(nullptr)
 	{ }
 
 	MeshResource::MeshResource(const std::string& filename) :
@@ -17,9 +23,16 @@ namespace Gameplay {
 		Filename(filename),
 		MeshBuilderParams(std::vector<MeshBuilderParam>()),
 		Mesh(nullptr),
-		BulletTriMesh(nullptr)
+		BulletTriMesh(nullptr),
+		_boundsMin(glm::vec3(0.0f)),
+		_boundsMax(glm::vec3(0.0f)),
+		_boundsSource(nullptr),
+		_hasBounds(false),
+		_occluderTriangles(std::vector<glm::vec3>()),
+		_occluderSource(nullptr)
 	{
 		Mesh = ObjLoader::LoadFromFile(filename);
+		CalculateBounds();
 	}
 
 	MeshResource::~MeshResource() = default;
@@ -63,6 +76,7 @@ namespace Gameplay {
 
 			}
 		}
+		result->CalculateBounds();
 		return result;
 	}
 
@@ -73,9 +87,124 @@ namespace Gameplay {
 		}
 		MeshFactory::CalculateTBN(mesh);
 		Mesh = mesh.Bake();
+		CalculateBounds();
 	}
 
 	void MeshResource::AddParam(const MeshBuilderParam & param) {
 		MeshBuilderParams.push_back(param);
 	}
+
+	bool MeshResource::_ReadPositions(std::vector<glm::vec3>& positions) const {
+		positions.clear();
+		if (Mesh == nullptr) return false;
+
+		// Find the buffer and attribute that feed our positions
+		VertexArrayObject::VertexBufferBinding* binding = Mesh->GetBufferBinding(AttribUsage::Position);
+		if (binding == nullptr) return false;
+
+		const BufferAttribute* position = nullptr;
+		for (const auto& attrib : binding->GetAttributes()) {
+			if (attrib.Usage == AttribUsage::Position) {
+				position = &attrib;
+				break;
+			}
+		}
+		if (position == nullptr || position->Type != AttributeType::Float || position->Size < 3) return false;
+
+		// Read the whole buffer back, this only happens once per mesh
+		const VertexBuffer::Sptr& buffer = binding->GetBuffer();
+		std::vector<uint8_t> data(buffer->GetTotalSize());
+		glGetNamedBufferSubData(buffer->GetHandle(), 0, data.size(), data.data());
+
+		uint32_t stride = position->Stride;
+		if (stride == 0 || data.size() < position->Offset + sizeof(glm::vec3)) return false;
+
+		for (size_t offset = position->Offset; offset + sizeof(glm::vec3) <= data.size(); offset += stride) {
+			glm::vec3 pos;
+			memcpy(&pos, data.data() + offset, sizeof(glm::vec3));
+			positions.push_back(pos);
+		}
+		return true;
+	}
+
+	void MeshResource::CalculateBounds() {
+		_boundsMin = glm::vec3(0.0f);
+		_boundsMax = glm::vec3(0.0f);
+		_boundsSource = Mesh.get();
+		_hasBounds = false;
+
+		std::vector<glm::vec3> positions;
+		if (!_ReadPositions(positions) || positions.empty()) return;
+
+		_boundsMin = glm::vec3(FLT_MAX);
+		_boundsMax = glm::vec3(-FLT_MAX);
+		for (const glm::vec3& pos : positions) {
+			_boundsMin = glm::min(_boundsMin, pos);
+			_boundsMax = glm::max(_boundsMax, pos);
+		}
+		_hasBounds = true;
+	}
+
+	const std::vector<glm::vec3>& MeshResource::GetOccluderTriangles() {
+		// Collider meshes are the closest thing we have to a low detail version of the mesh. We only follow
+		// one level, so a collider mesh that names itself (or a chain that loops back) can't recurse forever
+		if (ColliderMeshData != nullptr) {
+			return ColliderMeshData->_GetMeshTriangles();
+		}
+		return _GetMeshTriangles();
+	}
+
+	const std::vector<glm::vec3>& MeshResource::_GetMeshTriangles() {
+		if (_occluderSource == Mesh.get()) {
+			return _occluderTriangles;
+		}
+		_occluderSource = Mesh.get();
+		_occluderTriangles.clear();
+
+		std::vector<glm::vec3> positions;
+		if (!_ReadPositions(positions)) {
+			return _occluderTriangles;
+		}
+
+		const IndexBuffer::Sptr& indexBuffer = Mesh->GetIndexBuffer();
+		if (indexBuffer == nullptr) {
+			_occluderTriangles = positions;
+		} else {
+			std::vector<uint8_t> data(indexBuffer->GetTotalSize());
+			glGetNamedBufferSubData(indexBuffer->GetHandle(), 0, data.size(), data.data());
+
+			uint32_t count = indexBuffer->GetElementCount();
+			_occluderTriangles.reserve(count);
+			for (uint32_t ix = 0; ix < count; ix++) {
+				uint32_t index = 0;
+				switch (indexBuffer->GetElementType()) {
+					case IndexType::UByte:  index = data[ix]; break;
+					case IndexType::UShort: index = reinterpret_cast<const uint16_t*>(data.data())[ix]; break;
+					case IndexType::UInt:   index = reinterpret_cast<const uint32_t*>(data.data())[ix]; break;
+					default: break;
+				}
+				_occluderTriangles.push_back(index < positions.size() ? positions[index] : glm::vec3(0.0f));
+			}
+		}
+
+		// Drop any trailing vertices that don't make up a full triangle
+		_occluderTriangles.resize(_occluderTriangles.size() - _occluderTriangles.size() % 3);
+		return _occluderTriangles;
+	}
+
+	bool MeshResource::HasBounds() const {
+		return _hasBounds && !IsBoundsStale();
+	}
+
+	bool MeshResource::IsBoundsStale() const {
+		return _boundsSource != Mesh.get();
+	}
+
+	const glm::vec3& MeshResource::GetBoundsMin() const {
+		return _boundsMin;
+	}
+
+	const glm::vec3& MeshResource::GetBoundsMax() const {
+		return _boundsMax;
+	}
 }
\ No newline at end of file
@@ -61,9 +61,55 @@ namespace Gameplay {
 		/// <param name="param">The parameter to add</param>
 		void AddParam(const MeshBuilderParam& param);
 
+		/// <summary>
+		/// Calculates the model space bounding box of the mesh from its position data. This reads
+		/// the vertex buffer back from OpenGL, so it should only be called on the main thread
+		/// </summary>
+		void CalculateBounds();
+		/// <summary>
+		/// True if the bounds have been calculated for the current mesh
+		/// </summary>
+		bool HasBounds() const;
+		/// <summary>
+		/// True if the mesh has changed since CalculateBounds was last called
+		/// </summary>
+		bool IsBoundsStale() const;
+		/// <summary>
+		/// Gets the minimum corner of the model space bounding box
+		/// </summary>
+		const glm::vec3& GetBoundsMin() const;
+		/// <summary>
+		/// Gets the maximum corner of the model space bounding box
+		/// </summary>
+		const glm::vec3& GetBoundsMax() const;
+
+		/// <summary>
+		/// Gets a CPU copy of the mesh's triangles (3 vertices per triangle, in model space) for software
+		/// occlusion culling. If the mesh has collider data, that is used instead since it's usually much
+		/// simpler. The data is read back from OpenGL on first use, so this should only be called on the main thread
+		/// </summary>
+		const std::vector<glm::vec3>& GetOccluderTriangles();
+
 		// Inherited from IResource
 
 		virtual nlohmann::json ToJson() const override;
 		static MeshResource::Sptr FromJson(const nlohmann::json& blob);
+
+	protected:
+		glm::vec3 _boundsMin;
+		glm::vec3 _boundsMax;
+		// The mesh that the bounds were calculated for, so we know if they're stale
+		VertexArrayObject* _boundsSource;
+		// False if the mesh had no position data we could read
+		bool      _hasBounds;
+
+		std::vector<glm::vec3> _occluderTriangles;
+		// The mesh that the occluder triangles were read from, so we know if they're stale
+		VertexArrayObject*     _occluderSource;
+
+		// Reads the positions from the mesh's vertex buffer, returns false if they could not be read
+		bool _ReadPositions(std::vector<glm::vec3>& positions) const;
+		// Gets the triangles of this resource's own mesh, ignoring ColliderMeshData
+		const std::vector<glm::vec3>& _GetMeshTriangles();
 	};
 }
\ No newline at end of file
@@ -76,7 +76,7 @@ namespace Gameplay::Physics {
 			}
 
 			// Get the attribute for positions from the vertex declaration
-			auto& it = std::find_if(VDecl.begin(), VDecl.end(), [](const BufferAttribute& attrib) {
+			auto it = std::find_if(VDecl.begin(), VDecl.end(), [](const BufferAttribute& attrib) {
 				return attrib.Usage == AttribUsage::Position;
 			});
 			if (it == VDecl.end()) {
@@ -79,6 +79,21 @@ namespace Gameplay::Physics {
 		return _guid;
 	}
 
+	ICollider::Sptr ICollider::Clone() const {
+		ICollider::Sptr result = Create(_type);
+		if (result != nullptr) {
+			// The derived settings are only reachable through the JSON, but colliders only have a few of them
+			nlohmann::json blob;
+			ToJson(blob);
+			result->FromJson(blob);
+			result->_position = _position;
+			result->_rotation = _rotation;
+			result->_scale    = _scale;
+			result->_isDirty  = true;
+		}
+		return result;
+	}
+
 	ICollider::Sptr ICollider::Create(ColliderType type) {
 		switch (type)
 		{
@@ -140,6 +140,11 @@ namespace Gameplay::Physics {
 		/// <param name="type">The type of collider to create</param>
 		/// <returns>A new collider of the given type with default values</returns>
 		static ICollider::Sptr Create(ColliderType type);
+		/// <summary>
+		/// Creates a new collider with the same type and settings as this one, and a new GUID. The copy
+		/// does not share this collider's shape, it will create its own
+		/// </summary>
+		ICollider::Sptr Clone() const;
 
 	protected:
 		// Stores type 
@@ -5,7 +5,7 @@
 
 #include "Utils/GlmBulletConversions.h"
 #include "Utils/ImGuiHelper.h"
-#include "utils/JsonGlmHelpers.h"
+#include "Utils/JsonGlmHelpers.h"
 
 namespace Gameplay::Physics {
 int PhysicsBase::_editorSelectedColliderType = 0;
@@ -21,6 +21,26 @@ int PhysicsBase::_editorSelectedColliderType = 0;
 		_prevScale(glm::vec3(1.0f))
 	{ }
 
+	PhysicsBase::PhysicsBase(const PhysicsBase& other) :
+		IComponent(other),
+		_scene(nullptr),
+		_colliders(std::vector<ICollider::Sptr>()),
+		_shape(nullptr),
+		_isShapeDirty(true),
+		_collisionGroup(other._collisionGroup),
+		_collisionMask(other._collisionMask),
+		_isGroupMaskDirty(true),
+		_prevScale(other._prevScale)
+	{
+		_colliders.reserve(other._colliders.size());
+		for (const ICollider::Sptr& collider : other._colliders) {
+			ICollider::Sptr copy = collider->Clone();
+			if (copy != nullptr) {
+				_colliders.push_back(copy);
+			}
+		}
+	}
+
 	PhysicsBase::~PhysicsBase() {
 		if (_scene != nullptr) {
 			delete _shape;
@@ -100,7 +120,7 @@ int PhysicsBase::_editorSelectedColliderType = 0;
 				// If we got a valid shape and thus collider, load and store
 				if (collider != nullptr) {
 					// Copy in collider info
-					collider->_guid = Guid(blob["guid"]);
+					collider->_guid = Guid(blob["guid"].get<std::string>());
 					collider->_position = JsonGet(blob, "position", collider->_position);
 					collider->_rotation = JsonGet(blob, "rotation", collider->_rotation);
 					collider->_scale    = JsonGet(blob, "scale", collider->_scale);
@@ -148,7 +168,7 @@ int PhysicsBase::_editorSelectedColliderType = 0;
 	}
 
 	void PhysicsBase::RemoveCollider(const ICollider::Sptr& collider) {
-		auto& it = std::find(_colliders.begin(), _colliders.end(), collider);
+		auto it = std::find(_colliders.begin(), _colliders.end(), collider);
 		if (it != _colliders.end()) {
 			if (collider->GetShape() != nullptr) {
 				_shape->removeChildShape(collider->GetShape());
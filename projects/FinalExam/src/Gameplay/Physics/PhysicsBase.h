@@ -104,6 +104,11 @@ namespace Gameplay {
 			glm::vec3 _prevScale;
 
 			PhysicsBase();
+			/// <summary>
+			/// Copies the settings and colliders of another physics component, the copy gets its own
+			/// colliders and creates its own bullet objects on Awake
+			/// </summary>
+			PhysicsBase(const PhysicsBase& other);
 
 			void _RenderImGuiBase();
 
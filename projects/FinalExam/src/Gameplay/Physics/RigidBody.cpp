@@ -30,6 +30,25 @@ namespace Gameplay::Physics {
 		_angularFactorDirty(false)
 	{ }
 
+	RigidBody::RigidBody(const RigidBody& other) :
+		PhysicsBase(other),
+		_type(other._type),
+		_mass(other._mass),
+		_isMassDirty(true),
+		_body(nullptr),
+		_motionState(nullptr),
+		_linearDamping(other._linearDamping),
+		_angularDamping(other._angularDamping),
+		_isDampingDirty(true),
+		_inertia(other._inertia),
+		_linearVelocity(other._linearVelocity),
+		_linearVelocityDirty(other._linearVelocityDirty),
+		_angularVelocity(other._angularVelocity),
+		_angularVelocityDirty(other._angularVelocityDirty),
+		_angularFactor(other._angularFactor),
+		_angularFactorDirty(other._angularFactorDirty)
+	{ }
+
 	RigidBody::~RigidBody() {
 		if (_body != nullptr) {
 			// Remove from the physics world
@@ -33,6 +33,11 @@ namespace Gameplay::Physics {
 		typedef std::shared_ptr<RigidBody> Sptr;
 
 		RigidBody(RigidBodyType type = RigidBodyType::Static);
+		/// <summary>
+		/// Copies the settings of another rigid body, used when instantiating prefabs. The copy is not
+		/// in the physics world until it's awoken
+		/// </summary>
+		RigidBody(const RigidBody& other);
 		virtual ~RigidBody();
 
 		/// <summary>
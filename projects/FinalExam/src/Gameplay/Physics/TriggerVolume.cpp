@@ -16,6 +16,13 @@ namespace Gameplay::Physics {
 	{
 	}
 
+	TriggerVolume::TriggerVolume(const TriggerVolume& other) :
+		PhysicsBase(other),
+		_ghost(nullptr),
+		_typeFlags(other._typeFlags),
+		_currentCollisions(std::vector<std::weak_ptr<RigidBody>>())
+	{ }
+
 	TriggerVolume::~TriggerVolume() {
 		if (_ghost != nullptr) {
 			_scene->GetPhysicsWorld()->removeCollisionObject(_ghost);
@@ -101,7 +108,7 @@ namespace Gameplay::Physics {
 							thisFrameCollision.push_back(physicsPtr);
 
 							// Check to see if the object has been added to our object cache
-							auto& it = std::find_if(_currentCollisions.begin(), _currentCollisions.end(), [&](const std::weak_ptr<RigidBody>& item) {
+							auto it = std::find_if(_currentCollisions.begin(), _currentCollisions.end(), [&](const std::weak_ptr<RigidBody>& item) {
 								return item.lock() == physicsPtr;
 							});
 
@@ -120,7 +127,7 @@ namespace Gameplay::Physics {
 		// Compare our current frame list to the previous frame to see if anything has left
 		for (auto& weakPtr : _currentCollisions) {
 			// Search the the current list to see if the item still exists
-			auto& it = std::find_if(thisFrameCollision.begin(), thisFrameCollision.end(), [&](const std::weak_ptr<RigidBody>& item) {
+			auto it = std::find_if(thisFrameCollision.begin(), thisFrameCollision.end(), [&](const std::weak_ptr<RigidBody>& item) {
 				return item.lock() == weakPtr.lock();
 			});
 
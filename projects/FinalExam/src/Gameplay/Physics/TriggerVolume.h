@@ -25,6 +25,11 @@ namespace Gameplay::Physics {
 		typedef std::shared_ptr<TriggerVolume> Sptr;
 		virtual ~TriggerVolume();
 		TriggerVolume();
+		/// <summary>
+		/// Copies the settings of another trigger volume, used when instantiating prefabs. The copy
+		/// starts with nothing inside it
+		/// </summary>
+		TriggerVolume(const TriggerVolume& other);
 
 		/// <summary>
 		/// Invoked for each RigidBody before the physics world is stepped forward a frame,
@@ -0,0 +1,76 @@
+#include "Gameplay/Prefab.h"
+
+#include "Gameplay/Components/ComponentManager.h"
+#include "Utils/JsonGlmHelpers.h"
+
+namespace Gameplay {
+	Prefab::Prefab() :
+		IResource(),
+		Name("Prefab"),
+		_nodes(std::vector<Node>()),
+		_root(nlohmann::json()),
+		_hasReferences(false)
+	{ }
+
+	Prefab::Sptr Prefab::Create(const GameObject::Sptr& root) {
+		// Going through the JSON means the template can't pick up anything the live components have
+		// set up since they were loaded, like bullet objects or pointers to other components
+		return FromJson({
+			{ "guid", Guid::New().str() },
+			{ "name", root->Name },
+			{ "root", root->ToJson() }
+		});
+	}
+
+	Prefab::Sptr Prefab::FromJson(const nlohmann::json& data) {
+		Prefab::Sptr result = std::make_shared<Prefab>();
+		result->OverrideGUID(Guid(data["guid"].get<std::string>()));
+		result->Name = JsonGet<std::string>(data, "name", result->Name);
+		result->_root = data["root"];
+		result->_AddNode(result->_root, UINT32_MAX);
+		return result;
+	}
+
+	nlohmann::json Prefab::ToJson() const {
+		return {
+			{ "guid", GetGUID().str() },
+			{ "name", Name },
+			{ "root", _root }
+		};
+	}
+
+	void Prefab::_AddNode(const nlohmann::json& blob, uint32_t parentIndex) {
+		uint32_t index = (uint32_t)_nodes.size();
+		_nodes.push_back(Node());
+
+		Node& node = _nodes.back();
+		node.Name            = JsonGet<std::string>(blob, "name", "Unknown");
+		node.Id              = Guid(JsonGet<std::string>(blob, "guid", "null"));
+		node.ParentIndex     = parentIndex;
+		node.Position        = JsonGet(blob, "position", glm::vec3(0.0f));
+		node.Rotation        = JsonGet(blob, "rotation", glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+		node.Scale           = JsonGet(blob, "scale", glm::vec3(1.0f));
+		node.HideInHierarchy = JsonGet(blob, "hide_in_inspector", false);
+		node.AlwaysLoaded    = JsonGet(blob, "always_loaded", false);
+
+		if (blob.contains("components") && blob["components"].is_object()) {
+			for (auto& [typeName, value] : blob["components"].items()) {
+				IComponent::Sptr component = ComponentManager::LoadTemplate(typeName, value);
+				if (component == nullptr) {
+					LOG_WARN("Prefab \"{}\" has a component of unknown type \"{}\", skipping", Name, typeName);
+					continue;
+				}
+				_hasReferences |= ComponentManager::HasReferences(std::type_index(typeid(*component)));
+				node.Components.push_back(component);
+			}
+		}
+
+		// Children go after their parent, so that parents always exist by the time their children are copied.
+		// Don't hold on to node past here, adding children may move it
+		if (blob.contains("children") && blob["children"].is_array()) {
+			for (const nlohmann::json& child : blob["children"]) {
+				_AddNode(child, index);
+			}
+		}
+	}
+}
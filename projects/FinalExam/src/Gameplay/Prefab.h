@@ -0,0 +1,89 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <GLM/glm.hpp>
+#include <GLM/gtc/quaternion.hpp>
+#include "json.hpp"
+
+#include "Gameplay/GameObject.h"
+#include "Utils/ResourceManager/IResource.h"
+
+namespace Gameplay {
+	/// <summary>
+	/// A template for a game object and everything attached to it, which can be copied into a scene any
+	/// number of times with Scene::Instantiate (ex: projectiles, enemies, pickups)
+	///
+	/// The template is decoded once when the prefab is created, and instances are made by copying its
+	/// components straight into the scene, so spawning never parses JSON or searches an object's components.
+	/// Each instance gets new GUIDs for its objects and components, see IComponent::RemapReferences
+	/// </summary>
+	class Prefab : public IResource {
+	public:
+		typedef std::shared_ptr<Prefab> Sptr;
+		typedef std::weak_ptr<Prefab>   Wptr;
+
+		/// <summary>
+		/// A human readable name for the prefab
+		/// </summary>
+		std::string Name;
+
+		/// <summary>
+		/// Default constructor, to be used by Resource manager and smart pointers only
+		/// </summary>
+		Prefab();
+
+		/// <summary>
+		/// Creates a prefab from an object in a scene and all of its children. Later changes to the
+		/// objects do not affect the prefab
+		/// </summary>
+		/// <param name="root">The object to make a prefab of</param>
+		static Prefab::Sptr Create(const GameObject::Sptr& root);
+
+		/// <summary>
+		/// Gets the number of objects that each instance of this prefab creates
+		/// </summary>
+		size_t GetObjectCount() const { return _nodes.size(); }
+
+		/// <summary>
+		/// Loads a prefab from a JSON blob, the root object is stored in the same format as
+		/// GameObject::ToJson, including its children
+		/// </summary>
+		static Prefab::Sptr FromJson(const nlohmann::json& data);
+		virtual nlohmann::json ToJson() const override;
+
+	protected:
+		friend class Scene;
+
+		// One object in the template
+		struct Node {
+			std::string Name;
+			// The GUID of the object that the node was made from, for remapping references
+			Guid        Id;
+			// The index of the object's parent in _nodes, parents always come before their children
+			uint32_t    ParentIndex;
+			glm::vec3   Position;
+			glm::quat   Rotation;
+			glm::vec3   Scale;
+			bool        HideInHierarchy;
+			bool        AlwaysLoaded;
+			// Template components, these are never added to a scene or loaded, only copied
+			std::vector<IComponent::Sptr> Components;
+		};
+
+		// The root object is always first
+		std::vector<Node> _nodes;
+		// The root object's JSON, kept so that the prefab can be saved without rebuilding it
+		nlohmann::json    _root;
+		// True if any of the components need their references remapped when they are copied
+		bool              _hasReferences;
+
+		/// <summary>
+		/// Adds an object and its children to the template
+		/// </summary>
+		/// <param name="blob">The object's JSON, as written by GameObject::ToJson</param>
+		/// <param name="parentIndex">The index of the object's parent in _nodes, or UINT32_MAX for the root</param>
+		void _AddNode(const nlohmann::json& blob, uint32_t parentIndex);
+	};
+}
@@ -3,10 +3,17 @@
 #include <GLFW/glfw3.h>
 #include <locale>
 #include <codecvt>
+#include <unordered_set>
+#include <fstream>
+#include <filesystem>
+#include <functional>
+#include <map>
 
 #include "Utils/FileHelpers.h"
+#include "Utils/BinaryStream.h"
 #include "Utils/GlmBulletConversions.h"
 
+#include "Gameplay/SceneStreamer.h"
 #include "Gameplay/Physics/RigidBody.h"
 #include "Gameplay/Physics/TriggerVolume.h"
 #include "Gameplay/MeshResource.h"
@@ -16,11 +23,50 @@
 #include "Graphics/Textures/TextureCube.h"
 #include "Graphics/VertexArrayObject.h"
 #include "Application/Application.h"
+#include "Application/Timing.h"
 
 namespace Gameplay {
+	// Binary scene files start with a header, followed by sections that each start with an ID and their size.
+	// Loaders skip sections they don't recognize, so new sections can be added without breaking old files
+	static const char     BINARY_SCENE_MAGIC[4] = { 'B', 'S', 'C', 'N' };
+	static const uint16_t BINARY_SCENE_VERSION  = 1;
+
+	// Section IDs, read as four characters in the file
+	static const uint32_t SECTION_STRINGS    = 'S' | ('T' << 8) | ('R' << 16) | ('S' << 24);
+	static const uint32_t SECTION_SETTINGS   = 'S' | ('C' << 8) | ('N' << 16) | ('E' << 24);
+	static const uint32_t SECTION_OBJECTS    = 'O' | ('B' << 8) | ('J' << 16) | ('S' << 24);
+	static const uint32_t SECTION_COMPONENTS = 'C' | ('O' << 8) | ('M' << 16) | ('P' << 24);
+
+	// How the entries in a component section are stored
+	static const uint8_t COMPONENT_ENCODING_BINARY = 0;
+	static const uint8_t COMPONENT_ENCODING_JSON   = 1;
+
+	// Bits in BinaryObjectRecord::Flags
+	static const uint32_t OBJECT_HIDE_IN_HIERARCHY = 1 << 0;
+	static const uint32_t OBJECT_ALWAYS_LOADED     = 1 << 1;
+
+	// Every object is stored as one of these, so the whole objects section can be read with a single copy.
+	// Names live in the string table, and parents are referenced by their index in the objects section
+	struct BinaryObjectRecord {
+		uint8_t   Guid[16];
+		uint32_t  NameIndex;
+		uint32_t  ParentIndex;
+		glm::vec3 Position;
+		glm::quat Rotation;
+		glm::vec3 Scale;
+		uint32_t  Flags;
+	};
+	static_assert(sizeof(BinaryObjectRecord) == 68, "Binary object records must not contain padding");
+
 	Scene::Scene() :
 		_objects(std::vector<GameObject::Sptr>()),
 		_deletionQueue(std::vector<std::weak_ptr<GameObject>>()),
+		_objectsByGuid(std::unordered_map<Guid, GameObject*>()),
+		_objectsByName(std::unordered_map<std::string, std::vector<GameObject*>>()),
+		_handleSlots(std::vector<HandleSlot>()),
+		_freeHandleSlots(std::vector<uint32_t>()),
+		_transforms(std::make_shared<TransformSystem>()),
+		_streamer(nullptr),
 		IsPlaying(false),
 		IsDestroyed(false),
 		MainCamera(nullptr),
@@ -42,12 +88,14 @@ namespace Gameplay {
 	}
 
 	Scene::~Scene() {
+		// Stop streaming first, so that no sectors finish loading while we're tearing down
+		_streamer = nullptr;
 		MainCamera = nullptr;
 		DefaultMaterial = nullptr; 
 		_skyboxShader = nullptr;
 		_skyboxMesh = nullptr;
 		_skyboxTexture = nullptr;
-		_objects.clear();
+		_ClearObjects();
 		_components.Clear();
 		_CleanupPhysics();
 		IsDestroyed = true;
@@ -95,33 +143,68 @@ namespace Gameplay {
 
 	GameObject::Sptr Scene::CreateGameObject(const std::string& name)
 	{
-		GameObject::Sptr result(new GameObject());
+		GameObject::Sptr result(new GameObject(this));
 		result->Name = name;
-		result->_scene = this;
 		result->_selfRef = result;
-		_objects.push_back(result);
+		_AddObject(result);
 		return result;
 	}
 
 	void Scene::RemoveGameObject(const GameObject::Sptr& object) {
+		if (object == nullptr || object->_isPendingDelete) return;
+		object->_isPendingDelete = true;
+
 		_deletionQueue.push_back(object);
 		for (const auto& child : object->_children) {
 			RemoveGameObject(child);
 		}
 	}
 
-	GameObject::Sptr Scene::FindObjectByName(const std::string name) const {
-		auto it = std::find_if(_objects.begin(), _objects.end(), [&](const GameObject::Sptr& obj) {
-			return obj->Name == name;
-		});
-		return it == _objects.end() ? nullptr : *it;
+	GameObject::Sptr Scene::Instantiate(const Prefab::Sptr& prefab, const glm::vec3& position, const glm::quat& rotation) {
+		GuidRemap remap;
+		std::vector<GameObject*> objects;
+		objects.reserve(prefab->GetObjectCount());
+		return _Instantiate(*prefab, position, rotation, remap, objects);
+	}
+
+	std::vector<GameObject::Sptr> Scene::Instantiate(const Prefab::Sptr& prefab, const std::vector<glm::vec3>& positions, const std::vector<glm::quat>& rotations) {
+		// Grow by at least double, so that lots of small waves don't reallocate every time
+		size_t required = _objects.size() + positions.size() * prefab->GetObjectCount();
+		if (required > _objects.capacity()) {
+			_objects.reserve(std::max(required, _objects.capacity() * 2));
+		}
+
+		GuidRemap remap;
+		std::vector<GameObject*> objects;
+		objects.reserve(prefab->GetObjectCount());
+
+		std::vector<GameObject::Sptr> result;
+		result.reserve(positions.size());
+		for (size_t ix = 0; ix < positions.size(); ix++) {
+			glm::quat rotation = ix < rotations.size() ? rotations[ix] : glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+			result.push_back(_Instantiate(*prefab, positions[ix], rotation, remap, objects));
+		}
+		return result;
+	}
+
+	GameObject::Sptr Scene::FindObjectByName(const std::string& name) const {
+		auto it = _objectsByName.find(name);
+		return it == _objectsByName.end() ? nullptr : it->second.front()->_selfRef.lock();
 	}
 
 	GameObject::Sptr Scene::FindObjectByGUID(Guid id) const {
-		auto it = std::find_if(_objects.begin(), _objects.end(), [&](const GameObject::Sptr& obj) {
-			return obj->_guid == id;
-		});
-		return it == _objects.end() ? nullptr : *it;
+		auto it = _objectsByGuid.find(id);
+		return it == _objectsByGuid.end() ? nullptr : it->second->_selfRef.lock();
+	}
+
+	GameObject::WeakRef Scene::FindObjectRefByName(const std::string& name) const {
+		return GameObject::WeakRef(FindObjectByName(name));
+	}
+
+	GameObject::Sptr Scene::FindObjectByHandle(const GameObject::Handle& handle) const {
+		if (handle.Index >= _handleSlots.size()) return nullptr;
+		const HandleSlot& slot = _handleSlots[handle.Index];
+		return slot.Object != nullptr && slot.Generation == handle.Generation ? slot.Object->_selfRef.lock() : nullptr;
 	}
 
 	void Scene::SetAmbientLight(const glm::vec3& value) {
@@ -166,7 +249,13 @@ namespace Gameplay {
 
 		if (IsPlaying) {
 
-			_physicsWorld->stepSimulation(dt, 1);
+			// With fixed ticks, each tick is exactly one bullet step, otherwise bullet would substep at
+			// its own 1/60s rate, dropping time below 60Hz and interpolating on top of ours above it
+			if (Timing::Current().IsFixedTimestep()) {
+				_physicsWorld->stepSimulation(dt, 1, dt);
+			} else {
+				_physicsWorld->stepSimulation(dt, 1);
+			}
 
 			_components.Each<Gameplay::Physics::RigidBody>([=](const std::shared_ptr<Gameplay::Physics::RigidBody>& body) {
 				body->PhysicsPostStep(dt);
@@ -177,6 +266,24 @@ namespace Gameplay {
 		}
 	}
 
+	void Scene::UpdateStreaming() {
+		if (_streamer != nullptr && MainCamera != nullptr) {
+			_streamer->Update(MainCamera->GetGameObject()->GetTransform()[3]);
+		}
+	}
+
+	void Scene::UpdateTransforms() {
+		_transforms->Update();
+	}
+
+	void Scene::SaveTransformState() {
+		_transforms->SaveState();
+	}
+
+	void Scene::InterpolateTransforms(float alpha) {
+		_transforms->Interpolate(alpha);
+	}
+
 	void Scene::DrawPhysicsDebug() {
 		if (_bulletDebugDraw->getDebugMode() != btIDebugDraw::DBG_NoDebug) {
 			_physicsWorld->debugDrawWorld();
@@ -187,8 +294,13 @@ namespace Gameplay {
 	void Scene::Update(float dt) {
 		_FlushDeleteQueue();
 		if (IsPlaying) {
-			for (int i = 0; i < _objects.size(); i++) {
-				_objects[i]->Update(dt);
+			for (const ComponentManager::UpdatePhase& phase : _components.GetUpdatePhases()) {
+				// Bringing a world transform up to date isn't safe from several threads at once, so make sure
+				// they're already up to date before any parallel updates read them
+				if (phase.IsParallel && *(phase.Access & ComponentAccess::ReadScene)) {
+					_transforms->Update();
+				}
+				_components.RunUpdatePhase(phase, dt);
 			}
 		}
 		_FlushDeleteQueue();
@@ -213,18 +325,18 @@ namespace Gameplay {
 
 		Scene::Sptr result = std::make_shared<Scene>();
 		result->MainCamera = nullptr;
-		result->_objects.clear();
-		result->DefaultMaterial = ResourceManager::Get<Material>(Guid(data["default_material"]));
+		result->_ClearObjects();
+		result->DefaultMaterial = ResourceManager::Get<Material>(Guid(data["default_material"].get<std::string>()));
 
 		if (data.contains("ambient")) {
 			result->SetAmbientLight((data["ambient"]));
 		}
 
 		if (data.contains("skybox") && data["skybox"].is_object()) {
-			nlohmann::json& blob = data["skybox"].get<nlohmann::json>();
-			result->_skyboxMesh = ResourceManager::Get<MeshResource>(Guid(blob["mesh"]));
-			result->SetSkyboxShader(ResourceManager::Get<ShaderProgram>(Guid(blob["shader"])));
-			result->SetSkyboxTexture(ResourceManager::Get<TextureCube>(Guid(blob["texture"])));
+			const nlohmann::json& blob = data["skybox"];
+			result->_skyboxMesh = ResourceManager::Get<MeshResource>(Guid(blob["mesh"].get<std::string>()));
+			result->SetSkyboxShader(ResourceManager::Get<ShaderProgram>(Guid(blob["shader"].get<std::string>())));
+			result->SetSkyboxTexture(ResourceManager::Get<TextureCube>(Guid(blob["texture"].get<std::string>())));
 			result->SetSkyboxRotation(glm::mat3_cast((glm::quat)(blob["orientation"])));
 		}
 
@@ -235,7 +347,7 @@ namespace Gameplay {
 			obj->_scene = result.get();
 			obj->_parent.SceneContext = result.get();
 			obj->_selfRef = obj;
-			result->_objects.push_back(obj);
+			result->_AddObject(obj);
 		}
 
 		// Re-build the parent hierarchy 
@@ -246,7 +358,7 @@ namespace Gameplay {
 		}
 
 		// Create and load camera config
-		result->MainCamera = result->_components.GetComponentByGUID<Camera>(Guid(data["main_camera"]));
+		result->MainCamera = result->_components.GetComponentByGUID<Camera>(Guid(data["main_camera"].get<std::string>()));
 	
 		return result;
 	}
@@ -288,6 +400,23 @@ namespace Gameplay {
 
 	Scene::Sptr Scene::Load(const std::string& path)
 	{
+		// Binary scenes are recognized by their header rather than their extension
+		char magic[4] = { 0 };
+		std::ifstream file(path, std::ios::binary);
+		if (file.read(magic, 4) && memcmp(magic, BINARY_SCENE_MAGIC, 4) == 0) {
+			file.close();
+			Scene::Sptr result = LoadBinary(path);
+
+			// Scenes exported with ExportSectors have the rest of their objects in a directory next to them. Only
+			// binary scenes are exported, so a JSON scene with the same name is the whole scene and never streams
+			std::string sectorDir = SceneStreamer::GetSectorDirectory(path);
+			if (result != nullptr && std::filesystem::exists(std::filesystem::path(sectorDir) / SceneStreamer::INDEX_FILE)) {
+				result->_streamer = SceneStreamer::Create(result.get(), sectorDir);
+			}
+			return result;
+		}
+		file.close();
+
 		LOG_INFO("Loading scene from \"{}\"", path);
 		std::string content = FileHelpers::ReadFile(path);
 		nlohmann::json blob = nlohmann::json::parse(content);
@@ -296,6 +425,433 @@ namespace Gameplay {
 		return result;
 	}
 
+	// Writes a block of binary data to a file, returning false if the file could not be opened
+	static bool WriteBinaryFile(const std::string& path, const BinaryWriter& writer) {
+		std::ofstream file(path, std::ios::binary);
+		if (!file) {
+			LOG_ERROR("Failed to open \"{}\" for writing", path);
+			return false;
+		}
+		file.write(writer.Data(), writer.Size());
+		return true;
+	}
+
+	void Scene::SaveBinary(const std::string& path) {
+		std::vector<GameObject*> objects;
+		objects.reserve(_objects.size());
+		for (const GameObject::Sptr& object : _objects) {
+			objects.push_back(object.get());
+		}
+
+		BinaryWriter writer;
+		_WriteBinary(writer, objects, true);
+		if (WriteBinaryFile(path, writer)) {
+			_filePath = path;
+			LOG_INFO("Saved binary scene to \"{}\" ({} objects, {} bytes)", path, objects.size(), writer.Size());
+		}
+	}
+
+	void Scene::_WriteBinary(BinaryWriter& writer, const std::vector<GameObject*>& objects, bool includeSettings) const {
+		writer.WriteBytes(BINARY_SCENE_MAGIC, 4);
+		writer.Write(BINARY_SCENE_VERSION);
+		size_t sectionCountOffset = writer.Size();
+		writer.Write<uint16_t>(0);
+
+		uint16_t sectionCount = 0;
+		size_t sectionStart = 0;
+		auto beginSection = [&](uint32_t id) {
+			writer.Write(id);
+			sectionStart = writer.Size();
+			writer.Write<uint64_t>(0);
+			sectionCount++;
+		};
+		auto endSection = [&]() {
+			writer.Patch<uint64_t>(sectionStart, writer.Size() - sectionStart - sizeof(uint64_t));
+		};
+
+		// Names and type names are pooled, so that everything else can be fixed size
+		std::vector<std::string> strings;
+		std::unordered_map<std::string, uint32_t> stringIndices;
+		auto addString = [&](const std::string& value) {
+			auto it = stringIndices.find(value);
+			if (it != stringIndices.end()) return it->second;
+			uint32_t index = (uint32_t)strings.size();
+			strings.push_back(value);
+			stringIndices.emplace(value, index);
+			return index;
+		};
+
+		// Objects are referenced by their index in the file, which won't match their index in the scene if
+		// we're only writing some of them
+		std::unordered_map<const GameObject*, uint32_t> objectIndices;
+		objectIndices.reserve(objects.size());
+		for (uint32_t ix = 0; ix < objects.size(); ix++) {
+			objectIndices.emplace(objects[ix], ix);
+		}
+
+		std::vector<BinaryObjectRecord> records(objects.size());
+		// Components grouped by type name. The map keeps the types sorted, which matches the order that
+		// components come out of a JSON scene, so objects end up with their components in the same order
+		std::map<std::string, std::vector<std::pair<uint32_t, IComponent*>>> componentsByType;
+		for (uint32_t ix = 0; ix < objects.size(); ix++) {
+			const GameObject* object = objects[ix];
+			GameObject::Sptr parent = object->_parent;
+			auto parentIt = parent != nullptr ? objectIndices.find(parent.get()) : objectIndices.end();
+
+			BinaryObjectRecord& record = records[ix];
+			memcpy(record.Guid, object->_guid.bytes(), 16);
+			record.NameIndex   = addString(object->Name);
+			record.ParentIndex = parentIt != objectIndices.end() ? parentIt->second : UINT32_MAX;
+			record.Position    = object->GetPosition();
+			record.Rotation    = object->GetRotation();
+			record.Scale       = object->GetScale();
+			record.Flags       = 
+				(object->HideInHierarchy ? OBJECT_HIDE_IN_HIERARCHY : 0) |
+				(object->AlwaysLoaded ? OBJECT_ALWAYS_LOADED : 0);
+
+			for (const IComponent::Sptr& component : object->_components) {
+				componentsByType[component->ComponentTypeName()].push_back({ ix, component.get() });
+			}
+		}
+		for (const auto& [typeName, components] : componentsByType) {
+			addString(typeName);
+		}
+
+		beginSection(SECTION_STRINGS);
+		writer.Write((uint32_t)strings.size());
+		for (const std::string& value : strings) {
+			writer.WriteString(value);
+		}
+		endSection();
+
+		if (includeSettings) {
+			beginSection(SECTION_SETTINGS);
+			writer.WriteGuid(DefaultMaterial ? DefaultMaterial->GetGUID() : Guid());
+			writer.Write(_ambientLight);
+			writer.WriteGuid(_skyboxMesh ? _skyboxMesh->GetGUID() : Guid());
+			writer.WriteGuid(_skyboxShader ? _skyboxShader->GetGUID() : Guid());
+			writer.WriteGuid(_skyboxTexture ? _skyboxTexture->GetGUID() : Guid());
+			writer.Write(glm::quat_cast(_skyboxRotation));
+			writer.WriteGuid(MainCamera != nullptr ? MainCamera->GetGUID() : Guid());
+			endSection();
+		}
+
+		beginSection(SECTION_OBJECTS);
+		writer.Write((uint32_t)records.size());
+		writer.WriteBytes(records.data(), records.size() * sizeof(BinaryObjectRecord));
+		endSection();
+
+		// One section per component type, each entry is the owning object, the component's GUID and enabled
+		// state, and the size of the component's data followed by the data itself
+		for (const auto& [typeName, components] : componentsByType) {
+			bool isBinary = ComponentManager::HasBinarySerializer(components.front().second->_realType);
+
+			beginSection(SECTION_COMPONENTS);
+			writer.Write(stringIndices[typeName]);
+			writer.Write(isBinary ? COMPONENT_ENCODING_BINARY : COMPONENT_ENCODING_JSON);
+			writer.Write((uint32_t)components.size());
+			for (const auto& [objectIx, component] : components) {
+				writer.Write(objectIx);
+				writer.WriteGuid(component->GetGUID());
+				writer.Write<uint8_t>(component->IsEnabled);
+
+				size_t sizeOffset = writer.Size();
+				writer.Write<uint32_t>(0);
+				if (isBinary) {
+					_components.SaveBinary(*component, writer);
+				} else {
+					std::vector<uint8_t> data = nlohmann::json::to_msgpack(component->ToJson());
+					writer.WriteBytes(data.data(), data.size());
+				}
+				writer.Patch<uint32_t>(sizeOffset, (uint32_t)(writer.Size() - sizeOffset - sizeof(uint32_t)));
+			}
+			endSection();
+		}
+
+		writer.Patch<uint16_t>(sectionCountOffset, sectionCount);
+	}
+
+	Scene::Sptr Scene::LoadBinary(const std::string& path) {
+		LOG_INFO("Loading binary scene from \"{}\"", path);
+
+		// Read the whole file in one go, everything after this works straight out of memory
+		std::vector<char> content;
+		if (!ReadBinaryFile(path, content)) {
+			LOG_ERROR("Failed to open binary scene \"{}\"", path);
+			return nullptr;
+		}
+
+		Scene::Sptr result = std::make_shared<Scene>();
+		result->MainCamera = nullptr;
+		result->_ClearObjects();
+		if (!result->_ReadBinary(content.data(), content.size(), path, nullptr)) {
+			return nullptr;
+		}
+		result->_filePath = path;
+		return result;
+	}
+
+	bool Scene::ReadBinaryFile(const std::string& path, std::vector<char>& result) {
+		std::ifstream file(path, std::ios::binary | std::ios::ate);
+		if (!file) {
+			return false;
+		}
+		result.resize((size_t)file.tellg());
+		file.seekg(0);
+		return (bool)file.read(result.data(), result.size());
+	}
+
+	bool Scene::_ReadBinary(const char* data, size_t size, const std::string& path, std::vector<GameObject::Sptr>* loadedObjects) {
+		BinaryReader reader(data, size);
+		char magic[4] = { 0 };
+		reader.ReadBytes(magic, 4);
+		uint16_t version = reader.Read<uint16_t>();
+		uint16_t sectionCount = reader.Read<uint16_t>();
+		if (memcmp(magic, BINARY_SCENE_MAGIC, 4) != 0) {
+			LOG_ERROR("\"{}\" is not a binary scene file", path);
+			return false;
+		}
+		if (version != BINARY_SCENE_VERSION) {
+			LOG_ERROR("Binary scene \"{}\" has version {}, expected {}", path, version, BINARY_SCENE_VERSION);
+			return false;
+		}
+
+		std::vector<std::string> strings;
+		// The objects from this file, in the order they were written. Components and parents reference these by index
+		std::vector<GameObject::Sptr> objects;
+		bool hasSettings = false;
+		Guid mainCamera;
+		for (uint16_t sectionIx = 0; sectionIx < sectionCount && !reader.HasFailed(); sectionIx++) {
+			uint32_t id = reader.Read<uint32_t>();
+			uint64_t sectionSize = reader.Read<uint64_t>();
+			size_t sectionEnd = reader.Offset() + (size_t)sectionSize;
+
+			if (id == SECTION_STRINGS) {
+				uint32_t count = reader.Read<uint32_t>();
+				// Every string has at least its length, so a count that can't fit is corrupt and must not be allocated
+				if (count > reader.Remaining() / sizeof(uint32_t)) {
+					reader.MarkFailed();
+					break;
+				}
+				strings.reserve(count);
+				for (uint32_t ix = 0; ix < count && !reader.HasFailed(); ix++) {
+					strings.push_back(reader.ReadString());
+				}
+			}
+			else if (id == SECTION_SETTINGS) {
+				DefaultMaterial = ResourceManager::Get<Material>(reader.ReadGuid());
+				SetAmbientLight(reader.Read<glm::vec3>());
+				_skyboxMesh = ResourceManager::Get<MeshResource>(reader.ReadGuid());
+				SetSkyboxShader(ResourceManager::Get<ShaderProgram>(reader.ReadGuid()));
+				SetSkyboxTexture(ResourceManager::Get<TextureCube>(reader.ReadGuid()));
+				SetSkyboxRotation(glm::mat3_cast(reader.Read<glm::quat>()));
+				mainCamera = reader.ReadGuid();
+				hasSettings = true;
+			}
+			else if (id == SECTION_OBJECTS) {
+				uint32_t count = reader.Read<uint32_t>();
+				if (count > reader.Remaining() / sizeof(BinaryObjectRecord)) {
+					reader.MarkFailed();
+					break;
+				}
+				std::vector<BinaryObjectRecord> records(count);
+				if (!reader.ReadBytes(records.data(), count * sizeof(BinaryObjectRecord))) break;
+
+				// Sectors add to a scene that already has objects, where growing the usual way is cheaper
+				if (_objects.empty()) {
+					_objects.reserve(count);
+				}
+				objects.reserve(count);
+				for (const BinaryObjectRecord& record : records) {
+					// Scene is a friend of GameObject, so we can use the protected constructor
+					GameObject::Sptr object(new GameObject(this));
+					object->Name = record.NameIndex < strings.size() ? strings[record.NameIndex] : "Unknown";
+					object->_guid = Guid::FromBytes(const_cast<uint8_t*>(record.Guid));
+					object->SetPostion(record.Position);
+					object->SetRotation(record.Rotation);
+					object->SetScale(record.Scale);
+					object->HideInHierarchy = (record.Flags & OBJECT_HIDE_IN_HIERARCHY) != 0;
+					object->AlwaysLoaded = (record.Flags & OBJECT_ALWAYS_LOADED) != 0;
+					object->_scene = this;
+					object->_parent.SceneContext = this;
+					object->_selfRef = object;
+					_AddObject(object);
+					objects.push_back(object);
+				}
+
+				// Parents are stored by index, so there's no need to look them up by GUID
+				for (uint32_t ix = 0; ix < count; ix++) {
+					uint32_t parentIx = records[ix].ParentIndex;
+					if (parentIx < count && parentIx != ix) {
+						objects[parentIx]->AddChild(objects[ix]);
+					}
+				}
+			}
+			else if (id == SECTION_COMPONENTS) {
+				uint32_t typeNameIx = reader.Read<uint32_t>();
+				uint8_t encoding = reader.Read<uint8_t>();
+				uint32_t count = reader.Read<uint32_t>();
+				const std::string& typeName = typeNameIx < strings.size() ? strings[typeNameIx] : "";
+				// Each entry has an object index, GUID, enabled flag and data size before its data
+				if (count > reader.Remaining() / (sizeof(uint32_t) + 16 + sizeof(uint8_t) + sizeof(uint32_t))) {
+					reader.MarkFailed();
+					break;
+				}
+
+				for (uint32_t ix = 0; ix < count && !reader.HasFailed(); ix++) {
+					uint32_t objectIx = reader.Read<uint32_t>();
+					Guid guid = reader.ReadGuid();
+					bool isEnabled = reader.Read<uint8_t>() != 0;
+					uint32_t dataSize = reader.Read<uint32_t>();
+					if (dataSize > reader.Remaining()) {
+						reader.Skip(dataSize);
+						break;
+					}
+
+					IComponent::Sptr component = nullptr;
+					if (encoding == COMPONENT_ENCODING_BINARY) {
+						// Give the component its own reader, so that it can't run into the next entry
+						BinaryReader componentReader(reader.Current(), dataSize);
+						component = _components.LoadBinary(typeName, guid, isEnabled, componentReader);
+						if (component != nullptr && (componentReader.HasFailed() || componentReader.Remaining() > 0)) {
+							LOG_WARN("Component {} in \"{}\" did not match its binary data, it may have changed since the scene was saved", typeName, path);
+						}
+					} else {
+						// The JSON comes straight from the file, so it's as likely to be corrupt as anything else in it
+						try {
+							const uint8_t* componentData = reinterpret_cast<const uint8_t*>(reader.Current());
+							nlohmann::json blob = nlohmann::json::from_msgpack(componentData, componentData + dataSize);
+							blob["guid"] = guid.str();
+							blob["enabled"] = isEnabled;
+							component = _components.Load(typeName, blob);
+						} catch (const nlohmann::json::exception& e) {
+							LOG_ERROR("Component of type \"{}\" in \"{}\" could not be decoded: {}", typeName, path, e.what());
+							reader.MarkFailed();
+							break;
+						}
+					}
+					reader.Skip(dataSize);
+
+					if (component == nullptr) {
+						LOG_WARN("Could not load component of type \"{}\", skipping {} components", typeName, count);
+						break;
+					}
+					if (objectIx >= objects.size()) {
+						LOG_WARN("Component of type \"{}\" belongs to an object that does not exist", typeName);
+						continue;
+					}
+
+					GameObject* object = objects[objectIx].get();
+					component->_context = object;
+					object->_components.push_back(component);
+				}
+			}
+
+			// Always move on from the end of the section, so skipped or partially read sections can't throw us off
+			reader.Seek(sectionEnd);
+		}
+
+		if (reader.HasFailed()) {
+			LOG_ERROR("Binary scene \"{}\" is truncated or corrupt", path);
+			// Don't leave half of a chunk behind in a scene that's already running
+			for (const GameObject::Sptr& object : objects) {
+				RemoveGameObject(object);
+			}
+			return false;
+		}
+
+		// Components only get OnLoad once every component has been added, so that no object is half loaded
+		for (const GameObject::Sptr& object : objects) {
+			for (const IComponent::Sptr& component : object->_components) {
+				component->OnLoad();
+			}
+		}
+
+		if (hasSettings) {
+			MainCamera = _components.GetComponentByGUID<Camera>(mainCamera);
+		}
+		if (loadedObjects != nullptr) {
+			*loadedObjects = std::move(objects);
+		}
+		return true;
+	}
+
+	bool Scene::ConvertToBinary(const std::string& inFile, const std::string& outFile) {
+		Scene::Sptr scene = Load(inFile);
+		if (scene == nullptr) {
+			return false;
+		}
+		scene->SaveBinary(outFile.empty() ? std::filesystem::path(inFile).replace_extension(".bin").string() : outFile);
+		return true;
+	}
+
+	bool Scene::ExportSectors(const std::string& path, float cellSize) {
+		if (cellSize <= 0.0f) {
+			LOG_ERROR("Sectors must have a size greater than 0");
+			return false;
+		}
+
+		// The main camera is what streaming follows, so it can never be streamed out
+		const GameObject* cameraRoot = MainCamera != nullptr ? MainCamera->GetGameObject() : nullptr;
+		while (cameraRoot != nullptr && cameraRoot->GetParent() != nullptr) {
+			cameraRoot = cameraRoot->GetParent().get();
+		}
+
+		// Objects are sorted by their root, so that a root and everything attached to it stay together
+		std::vector<GameObject*> persistent;
+		std::map<std::pair<int, int>, std::vector<GameObject*>> cells;
+		std::function<void(GameObject*, std::vector<GameObject*>&)> addTree = [&](GameObject* object, std::vector<GameObject*>& list) {
+			list.push_back(object);
+			for (const auto& child : object->_children) {
+				GameObject::Sptr childPtr = child;
+				if (childPtr != nullptr) {
+					addTree(childPtr.get(), list);
+				}
+			}
+		};
+		for (const GameObject::Sptr& object : _objects) {
+			if (object->GetParent() != nullptr) continue;
+
+			if (object->AlwaysLoaded || object.get() == cameraRoot) {
+				addTree(object.get(), persistent);
+			} else {
+				glm::vec3 position = object->GetTransform()[3];
+				std::pair<int, int> cell = { (int)glm::floor(position.x / cellSize), (int)glm::floor(position.y / cellSize) };
+				addTree(object.get(), cells[cell]);
+			}
+		}
+
+		std::filesystem::path sectorDir = SceneStreamer::GetSectorDirectory(path);
+		std::filesystem::create_directories(sectorDir);
+
+		nlohmann::json index = SceneStreamer::CreateIndex(cellSize);
+		for (const auto& [coord, objects] : cells) {
+			std::string fileName = "cell_" + std::to_string(coord.first) + "_" + std::to_string(coord.second) + ".bin";
+			BinaryWriter writer;
+			_WriteBinary(writer, objects, false);
+			if (!WriteBinaryFile((sectorDir / fileName).string(), writer)) {
+				return false;
+			}
+			index["cells"].push_back({
+				{ "x", coord.first },
+				{ "y", coord.second },
+				{ "file", fileName },
+				{ "size", writer.Size() },
+				{ "objects", objects.size() }
+			});
+		}
+		FileHelpers::WriteContentsToFile((sectorDir / SceneStreamer::INDEX_FILE).string(), index.dump(1, '\t'));
+
+		BinaryWriter writer;
+		_WriteBinary(writer, persistent, true);
+		if (!WriteBinaryFile(path, writer)) {
+			return false;
+		}
+
+		LOG_INFO("Exported scene to \"{}\" with {} always loaded objects and {} sectors", path, persistent.size(), cells.size());
+		return true;
+	}
+
 	int Scene::NumObjects() const {
 		return static_cast<int>(_objects.size());
 	}
@@ -335,14 +891,187 @@ namespace Gameplay {
 
 
 	void Scene::_FlushDeleteQueue() {
+		if (_deletionQueue.empty()) return;
+
+		// We hang on to the removed objects until all the bookkeeping is done, so that their components
+		// are all torn down together at the end instead of in the middle of us moving objects around
+		std::vector<GameObject::Sptr> removed;
+		removed.reserve(_deletionQueue.size());
+		std::unordered_set<std::string> removedNames;
+		// Parents drop their references to removed children once the children are gone
+		std::vector<GameObject::Sptr> parents;
+
 		for (auto& weakPtr : _deletionQueue) {
-			if (weakPtr.expired()) continue;
-			auto& it = std::find(_objects.begin(), _objects.end(), weakPtr.lock());
-			if (it != _objects.end()) {
-				_objects.erase(it);
+			GameObject::Sptr object = weakPtr.lock();
+			if (object == nullptr || object->_sceneIndex == UINT32_MAX) continue;
+
+			// Swap the last object into the removed object's place, rather than shifting everything after it
+			uint32_t index = object->_sceneIndex;
+			removed.push_back(std::move(_objects[index]));
+			if (index != _objects.size() - 1) {
+				_objects[index] = std::move(_objects.back());
+				_objects[index]->_sceneIndex = index;
+			}
+			_objects.pop_back();
+			object->_sceneIndex = UINT32_MAX;
+
+			// Bumping the generation invalidates any handles that are still out there
+			HandleSlot& slot = _handleSlots[object->_handle.Index];
+			slot.Object = nullptr;
+			slot.Generation++;
+			_freeHandleSlots.push_back(object->_handle.Index);
+
+			auto guidIt = _objectsByGuid.find(object->_guid);
+			if (guidIt != _objectsByGuid.end() && guidIt->second == object.get()) {
+				_objectsByGuid.erase(guidIt);
+			}
+			removedNames.insert(object->Name);
+
+			GameObject::Sptr parent = object->GetParent();
+			if (parent != nullptr) {
+				parents.push_back(parent);
 			}
 		}
+
+		// Objects often share names (ex: instances), so we clean up each name once rather than once per object
+		for (const std::string& name : removedNames) {
+			auto it = _objectsByName.find(name);
+			if (it == _objectsByName.end()) continue;
+			std::vector<GameObject*>& named = it->second;
+			named.erase(std::remove_if(named.begin(), named.end(), [](GameObject* object) {
+				return object->_sceneIndex == UINT32_MAX;
+			}), named.end());
+			if (named.empty()) {
+				_objectsByName.erase(it);
+			}
+		}
+
 		_deletionQueue.clear();
+		removed.clear();
+
+		for (const GameObject::Sptr& parent : parents) {
+			parent->_PurgeDeletedChildren();
+		}
+	}
+
+	void Scene::_AddObject(const GameObject::Sptr& object) {
+		object->_sceneIndex = (uint32_t)_objects.size();
+		_objects.push_back(object);
+
+		uint32_t handleIndex;
+		if (!_freeHandleSlots.empty()) {
+			handleIndex = _freeHandleSlots.back();
+			_freeHandleSlots.pop_back();
+		} else {
+			handleIndex = (uint32_t)_handleSlots.size();
+			_handleSlots.push_back({ nullptr, 0 });
+		}
+		_handleSlots[handleIndex].Object = object.get();
+		object->_handle = { handleIndex, _handleSlots[handleIndex].Generation };
+
+		// If two objects somehow share a guid, the first one added keeps it, same as searching _objects would.
+		// The exception is an object that's waiting to be deleted (ex: a streamed sector that is reloaded before
+		// its objects were flushed), the new object takes over its entry and the flush leaves it alone
+		auto [guidIt, inserted] = _objectsByGuid.emplace(object->_guid, object.get());
+		if (!inserted && guidIt->second->_isPendingDelete) {
+			guidIt->second = object.get();
+		}
+		_objectsByName[object->Name].push_back(object.get());
+	}
+
+	GameObject::Sptr Scene::_Instantiate(const Prefab& prefab, const glm::vec3& position, const glm::quat& rotation, GuidRemap& remap, std::vector<GameObject*>& objects) {
+		remap.clear();
+		objects.clear();
+
+		for (const Prefab::Node& node : prefab._nodes) {
+			// Scene is a friend of GameObject, so we can use the protected constructor
+			GameObject::Sptr object(new GameObject(this));
+			object->Name = node.Name;
+			object->_guid = Guid::New();
+			object->SetPostion(node.Position);
+			object->SetRotation(node.Rotation);
+			object->SetScale(node.Scale);
+			object->HideInHierarchy = node.HideInHierarchy;
+			object->AlwaysLoaded = node.AlwaysLoaded;
+			object->_parent.SceneContext = this;
+			object->_selfRef = object;
+			_AddObject(object);
+
+			// Parents always come before their children in the prefab
+			if (node.ParentIndex < objects.size()) {
+				objects[node.ParentIndex]->AddChild(object);
+			}
+
+			object->_components.reserve(node.Components.size());
+			for (const IComponent::Sptr& source : node.Components) {
+				IComponent::Sptr component = _components.Clone(*source);
+				component->_context = object.get();
+				object->_components.push_back(component);
+				if (prefab._hasReferences) {
+					remap[source->GetGUID()] = component->GetGUID();
+				}
+			}
+			if (prefab._hasReferences) {
+				remap[node.Id] = object->_guid;
+			}
+			objects.push_back(object.get());
+		}
+
+		GameObject* root = objects.front();
+		root->SetPostion(position);
+		root->SetRotation(rotation);
+
+		// References can point anywhere in the prefab, so we can only remap them once everything is copied
+		if (prefab._hasReferences) {
+			for (GameObject* object : objects) {
+				for (const IComponent::Sptr& component : object->_components) {
+					component->RemapReferences(remap);
+				}
+			}
+		}
+		for (GameObject* object : objects) {
+			for (const IComponent::Sptr& component : object->_components) {
+				component->OnLoad();
+			}
+		}
+		if (_isAwake) {
+			for (GameObject* object : objects) {
+				object->Awake();
+			}
+		}
+
+		return root->_selfRef.lock();
+	}
+
+	void Scene::_ClearObjects() {
+		for (const auto& object : _objects) {
+			object->_sceneIndex = UINT32_MAX;
+		}
+		for (uint32_t ix = 0; ix < _handleSlots.size(); ix++) {
+			if (_handleSlots[ix].Object != nullptr) {
+				_handleSlots[ix].Object = nullptr;
+				_handleSlots[ix].Generation++;
+				_freeHandleSlots.push_back(ix);
+			}
+		}
+		_objects.clear();
+		_objectsByGuid.clear();
+		_objectsByName.clear();
+	}
+
+	void Scene::_OnObjectRenamed(GameObject* object, const std::string& oldName) {
+		// Objects that haven't been added to the scene yet aren't in the lookup
+		auto it = _objectsByName.find(oldName);
+		if (it == _objectsByName.end()) return;
+		std::vector<GameObject*>& named = it->second;
+		auto objectIt = std::find(named.begin(), named.end(), object);
+		if (objectIt == named.end()) return;
+
+		named.erase(objectIt);
+		if (named.empty()) {
+			_objectsByName.erase(it);
+		}
+		_objectsByName[object->Name].push_back(object);
 	}
 
 	void Scene::DrawAllGameObjectGUIs()
@@ -368,9 +1097,11 @@ namespace Gameplay {
 			_skyboxTexture != nullptr &&
 			MainCamera != nullptr) {
 			
+			// The skybox sits exactly on the far plane, so testing for equality only shades pixels that
+			// nothing else has been drawn to
 			glDepthMask(false);
 			glDisable(GL_CULL_FACE);
-			glDepthFunc(GL_LEQUAL); 
+			glDepthFunc(GL_EQUAL); 
 
 			_skyboxShader->Bind();
 			_skyboxShader->SetUniformMatrix("u_ClippedView", MainCamera->GetProjection());
@@ -4,6 +4,9 @@
 
 #include "Gameplay/Components/Camera.h"
 #include "Gameplay/GameObject.h"
+#include "Gameplay/Prefab.h"
+
+#include "Gameplay/SceneStreamer.h"
 
 #include "Physics/BulletDebugDraw.h"
 
@@ -84,19 +87,52 @@ namespace Gameplay {
 		void RemoveGameObject(const GameObject::Sptr& object);
 
 		/// <summary>
-		/// Searches all objects in the scene and returns the first
-		/// one who's name matches the one given, or nullptr if no object
-		/// is found
+		/// Adds a copy of a prefab to the scene. The components are copied from the prefab's template, so
+		/// this is much faster than loading the objects or adding their components one at a time. The
+		/// copies get new GUIDs, and are awoken if the scene already is
+		/// </summary>
+		/// <param name="prefab">The prefab to copy</param>
+		/// <param name="position">The position of the copy's root object</param>
+		/// <param name="rotation">The rotation of the copy's root object</param>
+		/// <returns>The copy's root object</returns>
+		GameObject::Sptr Instantiate(const Prefab::Sptr& prefab, const glm::vec3& position, const glm::quat& rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+		/// <summary>
+		/// Adds a copy of a prefab to the scene for each position given, see above. Space for all of
+		/// the copies is reserved up front, so this is preferred for spawning waves of objects
+		/// </summary>
+		/// <param name="prefab">The prefab to copy</param>
+		/// <param name="positions">The position of each copy's root object</param>
+		/// <param name="rotations">The rotation of each copy's root object, copies without one are not rotated</param>
+		/// <returns>The root object of each copy, in the same order as the positions</returns>
+		std::vector<GameObject::Sptr> Instantiate(const Prefab::Sptr& prefab, const std::vector<glm::vec3>& positions, const std::vector<glm::quat>& rotations = {});
+
+		/// <summary>
+		/// Returns the first object in the scene who's name matches the one
+		/// given, or nullptr if no object is found. Objects are looked up by
+		/// a hash of their name, so this does not search the scene
 		/// </summary>
 		/// <param name="name">The name of the object to find</param>
-		GameObject::Sptr FindObjectByName(const std::string name) const;
+		GameObject::Sptr FindObjectByName(const std::string& name) const;
 		/// <summary>
-		/// Searches all render objects in the scene and returns the first
-		/// one who's guid matches the one given, or nullptr if no object
-		/// is found
+		/// Returns the object in the scene who's guid matches the one given,
+		/// or nullptr if no object is found. Objects are looked up by a hash
+		/// of their guid, so this does not search the scene
 		/// </summary>
 		/// <param name="id">The guid of the object to find</param>
 		GameObject::Sptr FindObjectByGUID(Guid id) const;
+		/// <summary>
+		/// Gets a reference to the first object with the given name, for code that needs the same
+		/// object every frame. Once resolved, the reference holds on to the object itself, so using
+		/// it again costs no more than locking a weak pointer, and it stays valid if the object is renamed
+		/// </summary>
+		/// <param name="name">The name of the object to find</param>
+		/// <returns>A reference to the object, or an empty reference if no object is found</returns>
+		GameObject::WeakRef FindObjectRefByName(const std::string& name) const;
+		/// <summary>
+		/// Gets the object that a handle refers to, or nullptr if the object has been removed
+		/// </summary>
+		/// <param name="handle">A handle from GameObject::GetHandle for an object in this scene</param>
+		GameObject::Sptr FindObjectByHandle(const GameObject::Handle& handle) const;
 
 		/// <summary>
 		/// Sets the ambient light color for this scene
@@ -128,6 +164,31 @@ namespace Gameplay {
 		/// <param name="dt">The time in seconds since the last frame</param>
 		void DoPhysics(float dt);
 		/// <summary>
+		/// Loads and unloads sectors around the main camera, if this scene was exported with
+		/// ExportSectors. Should be called once per frame
+		/// </summary>
+		void UpdateStreaming();
+		/// <summary>
+		/// Gets the streamer that loads this scene's sectors, or nullptr if the scene has no sectors
+		/// </summary>
+		const SceneStreamer::Sptr& GetStreamer() const { return _streamer; }
+		/// <summary>
+		/// Recalculates the world transforms of every object that has moved (or has an ancestor that
+		/// moved) since the last call, should be called once per frame after DoPhysics
+		/// </summary>
+		void UpdateTransforms();
+		/// <summary>
+		/// Saves the current state of every object's transform to interpolate from, should be called at the
+		/// start of each tick when running at a fixed tick rate
+		/// </summary>
+		void SaveTransformState();
+		/// <summary>
+		/// Calculates the transforms that objects will be rendered with, blended between the state saved at the
+		/// start of the last tick and the current state. See GameObject::GetRenderTransform
+		/// </summary>
+		/// <param name="alpha">How far through the next tick we are, from 0 to 1 (see Timing::TickAlpha)</param>
+		void InterpolateTransforms(float alpha);
+		/// <summary>
 		/// Renders debug information for the physics scene
 		/// </summary>
 		void DrawPhysicsDebug();
@@ -136,6 +197,10 @@ namespace Gameplay {
 		/// Performs updates on all enabled components and gameobjects in the
 		/// scene
 		/// 
+		/// Components are updated one type at a time, and types that declare
+		/// non-conflicting access sets are updated in parallel, see
+		/// ComponentManager::GetUpdatePhases
+		/// 
 		/// Only invokes events if IsPlaying is true
 		/// </summary>
 		/// <param name="dt">The time in seconds since the last frame</param>
@@ -171,25 +236,61 @@ namespace Gameplay {
 		ComponentManager& Components() { return _components; }
 		const ComponentManager& Components() const { return _components; }
 
+		const TransformSystem::Sptr& Transforms() const { return _transforms; }
+
 		/// <summary>
 		/// Saves this scene to an output JSON file
 		/// </summary>
 		/// <param name="path">The path of the file to write to</param>
 		void Save(const std::string& path);
 		/// <summary>
-		/// Loads a scene from an input JSON file
+		/// Loads a scene from an input file, which may either be a JSON file or a binary
+		/// file written by SaveBinary. If the scene was exported with ExportSectors, its
+		/// sectors will be streamed in around the main camera (see UpdateStreaming)
 		/// </summary>
 		/// <param name="path">The path of the file to read from</param>
 		/// <returns>A new scene loaded from the file</returns>
 		static Scene::Sptr Load(const std::string& path);
 
+		/// <summary>
+		/// Saves this scene to a binary file, which loads much faster than JSON. Objects are stored as
+		/// fixed size records, and components are grouped by type. Component types that define ToBinary
+		/// and FromBinary are stored natively, and any others are stored as their JSON (see IComponent)
+		/// </summary>
+		/// <param name="path">The path of the file to write to</param>
+		void SaveBinary(const std::string& path);
+		/// <summary>
+		/// Loads a scene from a binary file written by SaveBinary
+		/// </summary>
+		/// <param name="path">The path of the file to read from</param>
+		/// <returns>A new scene loaded from the file, or nullptr if the file is not a valid binary scene</returns>
+		static Scene::Sptr LoadBinary(const std::string& path);
+		/// <summary>
+		/// Converts a JSON scene file into a binary scene file
+		/// </summary>
+		/// <param name="inFile">The path to the JSON scene to convert</param>
+		/// <param name="outFile">The output path for the binary scene, or empty to use the inFile path and replace the extension with .bin</param>
+		/// <returns>True if the scene was converted</returns>
+		static bool ConvertToBinary(const std::string& inFile, const std::string& outFile = "");
+		/// <summary>
+		/// Splits this scene into a square grid of sectors that can be streamed in and out as the camera moves.
+		/// Root objects are placed in the sector that contains their world position, and their children go
+		/// with them. The main camera and objects marked AlwaysLoaded stay in the scene file, and each sector
+		/// is written as its own binary file in a directory next to it (see SceneStreamer)
+		/// </summary>
+		/// <param name="path">The path to write the always loaded part of the scene to, as a binary scene</param>
+		/// <param name="cellSize">The width of each sector along the X and Y axes</param>
+		/// <returns>True if the scene and all of its sectors were written</returns>
+		bool ExportSectors(const std::string& path, float cellSize);
+
 
 		int NumObjects() const;
 		GameObject::Sptr GetObjectByIndex(int index) const;
 
 	protected:
-		friend class HierarchyWindow;
+		friend class ::HierarchyWindow;
 		friend class GameObject;
+		friend class SceneStreamer;
 
 		// The component manager will store all components for objects in this scene
 		ComponentManager _components;
@@ -215,10 +316,30 @@ namespace Gameplay {
 		// Our physics scene's global gravity, default matches earth's gravity (m/s^2)
 		glm::vec3 _gravity;
 
-		// Stores all the objects in our scene
+		// Stores all the objects in our scene, in no particular order. Each object knows its index
+		// (see GameObject::_sceneIndex), so removing an object just swaps the last one into its place
 		std::vector<GameObject::Sptr>  _objects;
 		std::vector<std::weak_ptr<GameObject>>  _deletionQueue;
 
+		// Slots that GameObject::Handles point into, a null object means the slot is free
+		struct HandleSlot {
+			GameObject* Object;
+			uint32_t    Generation;
+		};
+		std::vector<HandleSlot> _handleSlots;
+		std::vector<uint32_t>   _freeHandleSlots;
+
+		// Lookups for objects in _objects, kept up to date as objects are added, renamed and removed.
+		// Objects that share a name are kept in the order they were added
+		std::unordered_map<Guid, GameObject*>                     _objectsByGuid;
+		std::unordered_map<std::string, std::vector<GameObject*>> _objectsByName;
+
+		// Stores the transforms of all of our objects, see GameObject::_transformIndex
+		TransformSystem::Sptr _transforms;
+
+		// Loads and unloads sectors of the scene, only set for scenes exported with ExportSectors
+		SceneStreamer::Sptr _streamer;
+
 		// Info for rendering our skybox will be stored in the scene itself
 		std::shared_ptr<ShaderProgram>       _skyboxShader;
 		std::shared_ptr<MeshResource> _skyboxMesh;
@@ -242,5 +363,46 @@ namespace Gameplay {
 		void _CleanupPhysics();
 
 		void _FlushDeleteQueue();
+
+		/// <summary>
+		/// Writes the given objects and their components in the binary scene format
+		/// </summary>
+		/// <param name="writer">The writer to write the scene to</param>
+		/// <param name="objects">The objects to write, parents that aren't included are left out</param>
+		/// <param name="includeSettings">True to also write the scene's settings, like the skybox and main camera</param>
+		void _WriteBinary(BinaryWriter& writer, const std::vector<GameObject*>& objects, bool includeSettings) const;
+		/// <summary>
+		/// Adds the objects from a binary scene to this scene. If the data includes scene settings, they
+		/// replace this scene's settings. On failure, any objects that were added are queued for removal
+		/// </summary>
+		/// <param name="data">The contents of the binary scene file</param>
+		/// <param name="size">The size of data, in bytes</param>
+		/// <param name="path">The path that the data was loaded from, for error messages</param>
+		/// <param name="loadedObjects">If not null, receives the objects that were added</param>
+		/// <returns>True if the data was loaded successfully</returns>
+		bool _ReadBinary(const char* data, size_t size, const std::string& path, std::vector<GameObject::Sptr>* loadedObjects);
+		/// <summary>
+		/// Reads an entire file into memory, safe to call from any thread
+		/// </summary>
+		static bool ReadBinaryFile(const std::string& path, std::vector<char>& result);
+
+		/// <summary>
+		/// Adds an object to the scene and to the lookups
+		/// </summary>
+		void _AddObject(const GameObject::Sptr& object);
+		/// <summary>
+		/// Copies a prefab into the scene, see Instantiate
+		/// </summary>
+		/// <param name="remap">Scratch space for the prefab's GUID remapping, reused between copies</param>
+		/// <param name="objects">Scratch space for the copy's objects, reused between copies</param>
+		GameObject::Sptr _Instantiate(const Prefab& prefab, const glm::vec3& position, const glm::quat& rotation, GuidRemap& remap, std::vector<GameObject*>& objects);
+		/// <summary>
+		/// Removes all objects from the scene and the lookups
+		/// </summary>
+		void _ClearObjects();
+		/// <summary>
+		/// Moves an object in the name lookup, invoked by GameObject::SetName
+		/// </summary>
+		void _OnObjectRenamed(GameObject* object, const std::string& oldName);
 	};
 }
\ No newline at end of file
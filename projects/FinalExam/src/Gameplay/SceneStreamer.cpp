@@ -0,0 +1,228 @@
+#include "Gameplay/SceneStreamer.h"
+
+#include <algorithm>
+#include <filesystem>
+
+#include "Gameplay/Scene.h"
+#include "Utils/FileHelpers.h"
+#include "Utils/JobSystem.h"
+#include "Utils/JsonGlmHelpers.h"
+
+namespace Gameplay {
+	SceneStreamer::SceneStreamer(Scene* scene, const std::string& directory) :
+		LoadRadius(0.0f),
+		UnloadRadius(0.0f),
+		MemoryBudget(0),
+		MaxPendingLoads(1),
+		_scene(scene),
+		_directory(directory),
+		_cellSize(1.0f),
+		_cells(std::vector<Cell>()),
+		_candidates(std::vector<std::pair<float, uint32_t>>()),
+		_pendingReads(std::vector<std::shared_ptr<PendingRead>>()),
+		_loadedCount(0),
+		_loadedBytes(0),
+		_pendingBytes(0),
+		_pendingLoads(0)
+	{ }
+
+	// Reads that are still running hold on to their own data, so they can finish after we're gone
+	SceneStreamer::~SceneStreamer() = default;
+
+	SceneStreamer::Sptr SceneStreamer::Create(Scene* scene, const std::string& directory) {
+		// The constructor is protected, so we can't use make_shared
+		SceneStreamer::Sptr result(new SceneStreamer(scene, directory));
+
+		std::string indexPath = (std::filesystem::path(directory) / INDEX_FILE).string();
+		nlohmann::json index = nlohmann::json::parse(FileHelpers::ReadFile(indexPath));
+		nlohmann::json defaults = CreateIndex(JsonGet(index, "cell_size", 64.0f));
+
+		result->_cellSize        = defaults["cell_size"];
+		result->LoadRadius       = JsonGet(index, "load_radius", defaults["load_radius"].get<float>());
+		result->UnloadRadius     = std::max(result->LoadRadius, JsonGet(index, "unload_radius", defaults["unload_radius"].get<float>()));
+		result->MemoryBudget     = (size_t)(JsonGet(index, "memory_budget_mb", defaults["memory_budget_mb"].get<float>()) * 1024.0f * 1024.0f);
+		result->MaxPendingLoads  = std::max(1, JsonGet(index, "max_pending_loads", defaults["max_pending_loads"].get<int>()));
+
+		if (index.contains("cells") && index["cells"].is_array()) {
+			for (const nlohmann::json& blob : index["cells"]) {
+				Cell cell;
+				cell.Coord  = glm::ivec2(blob["x"].get<int>(), blob["y"].get<int>());
+				cell.Path   = (std::filesystem::path(directory) / blob["file"].get<std::string>()).string();
+				cell.Size   = blob["size"].get<size_t>();
+				cell.State  = CellState::Unloaded;
+				cell.LoadId = 0;
+				result->_cells.push_back(cell);
+			}
+		}
+
+		LOG_INFO("Streaming {} sectors from \"{}\"", result->_cells.size(), directory);
+		return result;
+	}
+
+	void SceneStreamer::Update(const glm::vec3& focus) {
+		// Add the sectors that have finished reading first, so that they count towards the budget below
+		for (size_t ix = 0; ix < _pendingReads.size(); ) {
+			if (_pendingReads[ix]->Counter->IsDone()) {
+				std::shared_ptr<PendingRead> read = _pendingReads[ix];
+				_pendingReads[ix] = _pendingReads.back();
+				_pendingReads.pop_back();
+				_FinishLoad(read->CellIx, read->LoadId, read->Data, read->Succeeded);
+			} else {
+				ix++;
+			}
+		}
+
+		_candidates.clear();
+		for (uint32_t ix = 0; ix < _cells.size(); ix++) {
+			Cell& cell = _cells[ix];
+			float distance = _DistanceToCell(cell, focus);
+
+			switch (cell.State) {
+				case CellState::Loaded:
+					if (distance > UnloadRadius) {
+						_Unload(ix);
+					}
+					break;
+				case CellState::Loading:
+					// Let the read finish, but throw away what it read
+					if (distance > UnloadRadius) {
+						cell.State = CellState::Unloaded;
+						cell.LoadId++;
+					}
+					break;
+				case CellState::Unloaded:
+					if (distance <= LoadRadius) {
+						_candidates.push_back({ distance, ix });
+					}
+					break;
+				default:
+					break;
+			}
+		}
+
+		// Nearest sectors first, since they're the most likely to be seen
+		std::sort(_candidates.begin(), _candidates.end());
+		for (const auto& [distance, cellIx] : _candidates) {
+			if (_pendingLoads >= MaxPendingLoads) break;
+
+			// Make room by unloading whatever is furthest away, as long as it's further away than the
+			// sector we want to load
+			size_t size = _cells[cellIx].Size;
+			while (_loadedBytes + _pendingBytes + size > MemoryBudget) {
+				uint32_t furthest = UINT32_MAX;
+				float furthestDistance = distance;
+				for (uint32_t ix = 0; ix < _cells.size(); ix++) {
+					if (_cells[ix].State != CellState::Loaded) continue;
+					float cellDistance = _DistanceToCell(_cells[ix], focus);
+					if (cellDistance > furthestDistance) {
+						furthest = ix;
+						furthestDistance = cellDistance;
+					}
+				}
+				if (furthest == UINT32_MAX) break;
+				_Unload(furthest);
+			}
+
+			// Everything after this is further away, so nothing else gets to load either
+			if (_loadedBytes + _pendingBytes + size > MemoryBudget) break;
+
+			_StartLoad(cellIx);
+		}
+	}
+
+	std::string SceneStreamer::GetSectorDirectory(const std::string& scenePath) {
+		std::filesystem::path path(scenePath);
+		return (path.parent_path() / (path.stem().string() + "-sectors")).string();
+	}
+
+	nlohmann::json SceneStreamer::CreateIndex(float cellSize) {
+		return {
+			{ "cell_size", cellSize },
+			{ "load_radius", cellSize * 2.0f },
+			{ "unload_radius", cellSize * 3.0f },
+			{ "memory_budget_mb", 256.0f },
+			{ "max_pending_loads", 4 },
+			{ "cells", nlohmann::json::array() }
+		};
+	}
+
+	float SceneStreamer::_DistanceToCell(const Cell& cell, const glm::vec3& point) const {
+		glm::vec2 min = glm::vec2(cell.Coord) * _cellSize;
+		glm::vec2 max = min + glm::vec2(_cellSize);
+		glm::vec2 nearest = glm::clamp(glm::vec2(point.x, point.y), min, max);
+		return glm::length(glm::vec2(point.x, point.y) - nearest);
+	}
+
+	void SceneStreamer::_StartLoad(uint32_t cellIx) {
+		Cell& cell = _cells[cellIx];
+		cell.State = CellState::Loading;
+		uint32_t loadId = ++cell.LoadId;
+		_pendingLoads++;
+		_pendingBytes += cell.Size;
+
+		// Reading the file is the slow part and is safe anywhere, but creating objects and components has
+		// to happen on the main thread while nothing else is using the scene, so Update picks it up from here
+		std::shared_ptr<PendingRead> read = std::make_shared<PendingRead>();
+		read->CellIx    = cellIx;
+		read->LoadId    = loadId;
+		read->Counter   = std::make_shared<JobCounter>();
+		read->Succeeded = false;
+		_pendingReads.push_back(read);
+
+		std::string path = cell.Path;
+		JobSystem::Run([read, path]() {
+			read->Succeeded = Scene::ReadBinaryFile(path, read->Data);
+		}, read->Counter);
+	}
+
+	void SceneStreamer::_FinishLoad(uint32_t cellIx, uint32_t loadId, const std::vector<char>& data, bool succeeded) {
+		Cell& cell = _cells[cellIx];
+		_pendingLoads--;
+		_pendingBytes -= cell.Size;
+
+		// The sector went out of range while we were reading it
+		if (cell.State != CellState::Loading || cell.LoadId != loadId) return;
+
+		std::vector<GameObject::Sptr> objects;
+		if (!succeeded) {
+			LOG_ERROR("Failed to read sector \"{}\"", cell.Path);
+		}
+		if (!succeeded || !_scene->_ReadBinary(data.data(), data.size(), cell.Path, &objects)) {
+			// Don't try again every frame, the file isn't going to fix itself
+			cell.State = CellState::Failed;
+			return;
+		}
+
+		cell.Objects.clear();
+		cell.Objects.reserve(objects.size());
+		for (const GameObject::Sptr& object : objects) {
+			cell.Objects.push_back(object->GetHandle());
+		}
+		// Objects that arrive after the scene has started need to be woken up, this is where rigid bodies
+		// get added to the physics world
+		if (_scene->GetIsAwake()) {
+			for (const GameObject::Sptr& object : objects) {
+				object->Awake();
+			}
+		}
+
+		cell.State = CellState::Loaded;
+		_loadedCount++;
+		_loadedBytes += cell.Size;
+	}
+
+	void SceneStreamer::_Unload(uint32_t cellIx) {
+		Cell& cell = _cells[cellIx];
+
+		// Removing objects destroys their components at the start of the next scene update, which
+		// takes their rigid bodies out of the physics world
+		for (const GameObject::Handle& handle : cell.Objects) {
+			_scene->RemoveGameObject(_scene->FindObjectByHandle(handle));
+		}
+		cell.Objects.clear();
+
+		cell.State = CellState::Unloaded;
+		_loadedCount--;
+		_loadedBytes -= cell.Size;
+	}
+}
@@ -0,0 +1,156 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <GLM/glm.hpp>
+#include "json.hpp"
+
+#include "Gameplay/GameObject.h"
+#include "Utils/JobSystem.h"
+#include "Utils/Macros.h"
+
+namespace Gameplay {
+	class Scene;
+
+	/// <summary>
+	/// Streams the sectors of a scene in and out around a point (usually the main camera), so that
+	/// levels don't need to fit in memory all at once
+	///
+	/// Scenes are split into sectors with Scene::ExportSectors, which puts each sector in its own
+	/// binary scene file in a directory next to the scene, along with an index of all the sectors.
+	/// Sectors are squares on the XY plane, and are loaded once the nearest point in them is within
+	/// LoadRadius of the camera, and unloaded once it's further than UnloadRadius. Files are read on
+	/// the job system, and the objects are added to the scene by the first Update after the read is done.
+	/// Unloading a sector removes its objects from the scene, taking their rigid bodies out of the
+	/// physics world. Changes made to a sector's objects are lost when it unloads
+	///
+	/// Sectors only load while the total size of the loaded sectors fits in MemoryBudget, nearer sectors
+	/// load first, and sectors further away are unloaded early to make room for nearer ones
+	/// </summary>
+	class SceneStreamer final {
+	public:
+		MAKE_PTRS(SceneStreamer);
+		NO_COPY(SceneStreamer);
+		NO_MOVE(SceneStreamer);
+
+		// The name of the index file in a sector directory
+		static constexpr const char* INDEX_FILE = "index.json";
+
+		// Sectors start loading once they are this close to the camera
+		float  LoadRadius;
+		// Sectors unload once they are further than this from the camera, should be larger than
+		// LoadRadius so that sectors on the edge don't load and unload every frame
+		float  UnloadRadius;
+		// The most sector data to keep loaded at once, in bytes. This is measured by the size of the sector
+		// files rather than what the objects take up in memory, but the two grow together
+		size_t MemoryBudget;
+		// The most sectors that can be loading at once
+		int    MaxPendingLoads;
+
+		~SceneStreamer();
+
+		/// <summary>
+		/// Creates a streamer for a scene, loading the sector index from the given directory. No sectors
+		/// are loaded until the first call to Update
+		/// </summary>
+		/// <param name="scene">The scene to load sectors into, must outlive the streamer</param>
+		/// <param name="directory">The directory containing the sector index and files, see GetSectorDirectory</param>
+		static SceneStreamer::Sptr Create(Scene* scene, const std::string& directory);
+
+		/// <summary>
+		/// Adds the objects from any sectors that have finished reading, then starts loading sectors that have
+		/// come into range, and unloads sectors that have gone out of range. Must be called on the main thread,
+		/// while nothing else is touching the scene
+		/// </summary>
+		/// <param name="focus">The world position to stream around</param>
+		void Update(const glm::vec3& focus);
+
+		/// <summary>
+		/// Gets the width of each sector along the X and Y axes
+		/// </summary>
+		float GetCellSize() const { return _cellSize; }
+		/// <summary>
+		/// Gets the number of sectors in the scene
+		/// </summary>
+		size_t GetCellCount() const { return _cells.size(); }
+		/// <summary>
+		/// Gets the number of sectors that are currently loaded
+		/// </summary>
+		size_t GetLoadedCellCount() const { return _loadedCount; }
+		/// <summary>
+		/// Gets the total size of the loaded sectors, in bytes (see MemoryBudget)
+		/// </summary>
+		size_t GetLoadedBytes() const { return _loadedBytes; }
+
+		/// <summary>
+		/// Gets the directory that a scene's sectors are stored in
+		/// </summary>
+		/// <param name="scenePath">The path of the scene file</param>
+		static std::string GetSectorDirectory(const std::string& scenePath);
+		/// <summary>
+		/// Creates a sector index with no sectors, and default streaming settings for the given sector size
+		/// </summary>
+		static nlohmann::json CreateIndex(float cellSize);
+
+	protected:
+		SceneStreamer(Scene* scene, const std::string& directory);
+
+		enum class CellState {
+			Unloaded,
+			Loading,
+			Loaded,
+			// The sector's file is missing or corrupt, it won't be loaded again
+			Failed
+		};
+
+		struct Cell {
+			glm::ivec2  Coord;
+			std::string Path;
+			size_t      Size;
+			CellState   State;
+			// Bumped whenever a load is started or cancelled, so that a read that finishes after its load
+			// was cancelled can tell that it's out of date
+			uint32_t    LoadId;
+			// Handles rather than pointers, since the scene may remove objects while the sector is loaded
+			std::vector<GameObject::Handle> Objects;
+		};
+
+		Scene*            _scene;
+		std::string       _directory;
+		float             _cellSize;
+		std::vector<Cell> _cells;
+		// Sectors are sorted by distance each update, kept between updates to save reallocating
+		std::vector<std::pair<float, uint32_t>> _candidates;
+
+		// A sector file being read on the job system
+		struct PendingRead {
+			uint32_t          CellIx;
+			uint32_t          LoadId;
+			JobCounter::Sptr  Counter;
+			// Filled in by the worker, only safe to look at once Counter is done
+			std::vector<char> Data;
+			bool              Succeeded;
+		};
+		// Reads are finished from Update rather than from a main thread job, so that sectors only ever
+		// appear at a known point in the frame
+		std::vector<std::shared_ptr<PendingRead>> _pendingReads;
+
+		size_t _loadedCount;
+		size_t _loadedBytes;
+		// The size of the sectors that are loading, they count against the budget as soon as they start
+		size_t _pendingBytes;
+		int    _pendingLoads;
+
+		/// <summary>
+		/// Gets the distance on the XY plane from a point to the nearest point in a sector
+		/// </summary>
+		float _DistanceToCell(const Cell& cell, const glm::vec3& point) const;
+		void _StartLoad(uint32_t cellIx);
+		/// <summary>
+		/// Adds a sector's objects to the scene once its file has been read, invoked from Update
+		/// </summary>
+		void _FinishLoad(uint32_t cellIx, uint32_t loadId, const std::vector<char>& data, bool succeeded);
+		void _Unload(uint32_t cellIx);
+	};
+}
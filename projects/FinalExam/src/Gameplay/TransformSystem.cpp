@@ -0,0 +1,394 @@
+#include "Gameplay/TransformSystem.h"
+#include <atomic>
+#include <xmmintrin.h>
+
+#include "Utils/JobSystem.h"
+
+namespace Gameplay {
+	// Multiplies two affine matrices, b's bottom row is assumed to be (0, 0, 0, 1) so we can skip a
+	// quarter of the work. Result must not alias either input
+	static inline void AffineMultiply(const glm::mat4& a, const glm::mat4& b, glm::mat4& result) {
+		const __m128 a0 = _mm_loadu_ps(&a[0][0]);
+		const __m128 a1 = _mm_loadu_ps(&a[1][0]);
+		const __m128 a2 = _mm_loadu_ps(&a[2][0]);
+		const __m128 a3 = _mm_loadu_ps(&a[3][0]);
+		for (int col = 0; col < 4; col++) {
+			__m128 value = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(a0, _mm_set1_ps(b[col][0])), _mm_mul_ps(a1, _mm_set1_ps(b[col][1]))),
+				_mm_mul_ps(a2, _mm_set1_ps(b[col][2])));
+			if (col == 3) {
+				value = _mm_add_ps(value, a3);
+			}
+			_mm_storeu_ps(&result[col][0], value);
+		}
+	}
+
+	// Builds T * R * S and its inverse directly, rather than multiplying out three matrices and taking a general inverse
+	static inline void ComposeTransform(const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale, glm::mat4& result, glm::mat4& inverse) {
+		const glm::mat3 rotationMatrix = glm::mat3_cast(rotation);
+		result[0] = glm::vec4(rotationMatrix[0] * scale.x, 0.0f);
+		result[1] = glm::vec4(rotationMatrix[1] * scale.y, 0.0f);
+		result[2] = glm::vec4(rotationMatrix[2] * scale.z, 0.0f);
+		result[3] = glm::vec4(position, 1.0f);
+
+		// The inverse of T * R * S is S^-1 * R^T * T^-1
+		const glm::vec3 invScale = 1.0f / scale;
+		const glm::mat3 invRotScale = glm::mat3(
+			glm::vec3(rotationMatrix[0][0], rotationMatrix[1][0], rotationMatrix[2][0]) * invScale,
+			glm::vec3(rotationMatrix[0][1], rotationMatrix[1][1], rotationMatrix[2][1]) * invScale,
+			glm::vec3(rotationMatrix[0][2], rotationMatrix[1][2], rotationMatrix[2][2]) * invScale);
+		inverse[0] = glm::vec4(invRotScale[0], 0.0f);
+		inverse[1] = glm::vec4(invRotScale[1], 0.0f);
+		inverse[2] = glm::vec4(invRotScale[2], 0.0f);
+		inverse[3] = glm::vec4(-(invRotScale * position), 1.0f);
+	}
+
+	TransformSystem::TransformSystem() :
+		_positions(std::vector<glm::vec3>()),
+		_rotations(std::vector<glm::quat>()),
+		_scales(std::vector<glm::vec3>()),
+		_parents(std::vector<uint32_t>()),
+		_flags(std::vector<uint8_t>()),
+		_inUse(std::vector<uint8_t>()),
+		_localTransforms(std::vector<glm::mat4>()),
+		_inverseLocalTransforms(std::vector<glm::mat4>()),
+		_worldTransforms(std::vector<glm::mat4>()),
+		_inverseWorldTransforms(std::vector<glm::mat4>()),
+		_worldVersions(std::vector<uint32_t>()),
+		_parentVersions(std::vector<uint32_t>()),
+		_freeSlots(std::vector<uint32_t>()),
+		_previousPositions(std::vector<glm::vec3>()),
+		_previousRotations(std::vector<glm::quat>()),
+		_previousScales(std::vector<glm::vec3>()),
+		_interpolationFlags(std::vector<uint8_t>()),
+		_renderTransforms(std::vector<glm::mat4>()),
+		_inverseRenderTransforms(std::vector<glm::mat4>()),
+		_renderVersions(std::vector<uint32_t>()),
+		_order(std::vector<uint32_t>()),
+		_chunkEnds(std::vector<uint32_t>()),
+		_isOrderDirty(false),
+		_updatedCount(0)
+	{ }
+
+	uint32_t TransformSystem::Allocate() {
+		uint32_t index;
+		if (!_freeSlots.empty()) {
+			index = _freeSlots.back();
+			_freeSlots.pop_back();
+		} else {
+			index = (uint32_t)_positions.size();
+			_positions.emplace_back();
+			_rotations.emplace_back();
+			_scales.emplace_back();
+			_parents.emplace_back();
+			_flags.emplace_back();
+			_inUse.emplace_back();
+			_localTransforms.emplace_back();
+			_inverseLocalTransforms.emplace_back();
+			_worldTransforms.emplace_back();
+			_inverseWorldTransforms.emplace_back();
+			_worldVersions.emplace_back(0);
+			_parentVersions.emplace_back(0);
+		}
+
+		_positions[index] = glm::vec3(0.0f);
+		_rotations[index] = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+		_scales[index]    = glm::vec3(1.0f);
+		_parents[index]   = NO_PARENT;
+		_flags[index]     = LOCAL_DIRTY | WORLD_DIRTY;
+		_inUse[index]     = true;
+		_isOrderDirty = true;
+		// Don't let a new object blend from, or render with, whatever had the slot before it
+		if (index < _interpolationFlags.size()) {
+			_interpolationFlags[index] = 0;
+		}
+		return index;
+	}
+
+	void TransformSystem::Free(uint32_t index) {
+		_inUse[index]   = false;
+		_parents[index] = NO_PARENT;
+		_freeSlots.push_back(index);
+		_isOrderDirty = true;
+	}
+
+	void TransformSystem::SetParent(uint32_t index, uint32_t parent) {
+		if (_parents[index] == parent) return;
+		_parents[index] = parent;
+		// The new parent's version could happen to match the old one's, so force a recalculation
+		_flags[index] |= WORLD_DIRTY;
+		_isOrderDirty = true;
+	}
+
+	uint32_t TransformSystem::GetParent(uint32_t index) const {
+		return _parents[index];
+	}
+
+	void TransformSystem::SetPosition(uint32_t index, const glm::vec3& value) {
+		_positions[index] = value;
+		_flags[index] |= LOCAL_DIRTY;
+	}
+
+	void TransformSystem::SetRotation(uint32_t index, const glm::quat& value) {
+		_rotations[index] = value;
+		_flags[index] |= LOCAL_DIRTY;
+	}
+
+	void TransformSystem::SetScale(uint32_t index, const glm::vec3& value) {
+		_scales[index] = value;
+		_flags[index] |= LOCAL_DIRTY;
+	}
+
+	const glm::vec3& TransformSystem::GetPosition(uint32_t index) const {
+		return _positions[index];
+	}
+
+	const glm::quat& TransformSystem::GetRotation(uint32_t index) const {
+		return _rotations[index];
+	}
+
+	const glm::vec3& TransformSystem::GetScale(uint32_t index) const {
+		return _scales[index];
+	}
+
+	const glm::mat4& TransformSystem::GetLocalTransform(uint32_t index) {
+		if (_flags[index] & LOCAL_DIRTY) {
+			_RecalculateLocal(index);
+		}
+		return _localTransforms[index];
+	}
+
+	const glm::mat4& TransformSystem::GetInverseLocalTransform(uint32_t index) {
+		if (_flags[index] & LOCAL_DIRTY) {
+			_RecalculateLocal(index);
+		}
+		return _inverseLocalTransforms[index];
+	}
+
+	const glm::mat4& TransformSystem::GetWorldTransform(uint32_t index) {
+		_Resolve(index);
+		return _worldTransforms[index];
+	}
+
+	const glm::mat4& TransformSystem::GetInverseWorldTransform(uint32_t index) {
+		_Resolve(index);
+		return _inverseWorldTransforms[index];
+	}
+
+	void TransformSystem::Update() {
+		if (_isOrderDirty) {
+			_RebuildOrder();
+		}
+
+		// Chunks only hold whole subtrees, so no two jobs will ever touch the same slot
+		std::atomic<uint32_t> updated(0);
+		JobSystem::ParallelFor((uint32_t)_chunkEnds.size(), 1, [this, &updated](uint32_t start, uint32_t end) {
+			uint32_t localUpdated = 0;
+			for (uint32_t ix = start == 0 ? 0 : _chunkEnds[start - 1]; ix < _chunkEnds[end - 1]; ix++) {
+				uint32_t index = _order[ix];
+				if (_NeedsUpdate(index)) {
+					_Recalculate(index);
+					localUpdated++;
+				}
+			}
+			updated += localUpdated;
+		});
+		_updatedCount = updated;
+	}
+
+	void TransformSystem::SaveState() {
+		// With each field in its own array, saving the state is just a few straight copies
+		_previousPositions = _positions;
+		_previousRotations = _rotations;
+		_previousScales    = _scales;
+		_interpolationFlags.resize(_positions.size(), 0);
+		for (uint8_t& flags : _interpolationFlags) {
+			flags |= HAS_PREVIOUS_STATE;
+		}
+	}
+
+	void TransformSystem::Interpolate(float alpha) {
+		if (_isOrderDirty) {
+			_RebuildOrder();
+		}
+
+		const size_t slotCount = _positions.size();
+		_interpolationFlags.resize(slotCount, 0);
+		_renderTransforms.resize(slotCount);
+		_inverseRenderTransforms.resize(slotCount);
+		_renderVersions.resize(slotCount, 0);
+
+		// Same chunks as Update, so parents are always blended before their children
+		JobSystem::ParallelFor((uint32_t)_chunkEnds.size(), 1, [this, alpha](uint32_t start, uint32_t end) {
+			glm::mat4 blended, inverseBlended;
+			for (uint32_t ix = start == 0 ? 0 : _chunkEnds[start - 1]; ix < _chunkEnds[end - 1]; ix++) {
+				uint32_t index = _order[ix];
+				const glm::mat4* local = &_localTransforms[index];
+				const glm::mat4* inverseLocal = &_inverseLocalTransforms[index];
+
+				// Most objects don't move, and can use the local transform that we already have. Objects that
+				// are new since the last tick have nothing to blend from, so they just use their current state
+				bool hasPrevious = _interpolationFlags[index] & HAS_PREVIOUS_STATE;
+				bool isMoving = hasPrevious && (_previousPositions[index] != _positions[index] ||
+					_previousRotations[index] != _rotations[index] || _previousScales[index] != _scales[index]);
+				if (isMoving) {
+					ComposeTransform(
+						glm::mix(_previousPositions[index], _positions[index], alpha),
+						glm::slerp(_previousRotations[index], _rotations[index], alpha),
+						glm::mix(_previousScales[index], _scales[index], alpha),
+						blended, inverseBlended);
+					local = &blended;
+					inverseLocal = &inverseBlended;
+				} else if (_flags[index] & LOCAL_DIRTY) {
+					ComposeTransform(_positions[index], _rotations[index], _scales[index], blended, inverseBlended);
+					local = &blended;
+					inverseLocal = &inverseBlended;
+				}
+
+				uint32_t parent = _parents[index];
+				if (parent != NO_PARENT) {
+					AffineMultiply(_renderTransforms[parent], *local, _renderTransforms[index]);
+					AffineMultiply(*inverseLocal, _inverseRenderTransforms[parent], _inverseRenderTransforms[index]);
+				} else {
+					_renderTransforms[index] = *local;
+					_inverseRenderTransforms[index] = *inverseLocal;
+				}
+
+				// An object that just stopped moving still differs from the blend it was drawn with last frame. Parents
+				// come first in the order, so their flag is already up to date for this call
+				uint8_t flags = _interpolationFlags[index];
+				bool changed = isMoving || (flags & WAS_BLENDED) || !(flags & HAS_RENDER_TRANSFORM) || (_flags[index] & LOCAL_DIRTY) ||
+					(parent != NO_PARENT && (_interpolationFlags[parent] & RENDER_CHANGED));
+				if (changed) {
+					_renderVersions[index]++;
+				}
+				flags &= ~(WAS_BLENDED | RENDER_CHANGED);
+				flags |= HAS_RENDER_TRANSFORM | (isMoving ? WAS_BLENDED : 0) | (changed ? RENDER_CHANGED : 0);
+				_interpolationFlags[index] = flags;
+			}
+		});
+	}
+
+	const glm::mat4& TransformSystem::GetRenderTransform(uint32_t index) {
+		if (index < _interpolationFlags.size() && (_interpolationFlags[index] & HAS_RENDER_TRANSFORM)) {
+			return _renderTransforms[index];
+		}
+		return GetWorldTransform(index);
+	}
+
+	const glm::mat4& TransformSystem::GetInverseRenderTransform(uint32_t index) {
+		if (index < _interpolationFlags.size() && (_interpolationFlags[index] & HAS_RENDER_TRANSFORM)) {
+			return _inverseRenderTransforms[index];
+		}
+		return GetInverseWorldTransform(index);
+	}
+
+	uint32_t TransformSystem::GetRenderVersion(uint32_t index) const {
+		// Both counters only ever go up, so their sum changes whenever either of them does
+		uint32_t renderVersion = index < _renderVersions.size() ? _renderVersions[index] : 0;
+		return _worldVersions[index] + renderVersion;
+	}
+
+	size_t TransformSystem::GetCount() const {
+		return _positions.size() - _freeSlots.size();
+	}
+
+	uint32_t TransformSystem::GetUpdatedCount() const {
+		return _updatedCount;
+	}
+
+	bool TransformSystem::_NeedsUpdate(uint32_t index) const {
+		uint32_t parent = _parents[index];
+		return _flags[index] != 0 || (parent != NO_PARENT && _parentVersions[index] != _worldVersions[parent]);
+	}
+
+	void TransformSystem::_RecalculateLocal(uint32_t index) {
+		ComposeTransform(_positions[index], _rotations[index], _scales[index], _localTransforms[index], _inverseLocalTransforms[index]);
+		_flags[index] = WORLD_DIRTY;
+	}
+
+	void TransformSystem::_Recalculate(uint32_t index) {
+		if (_flags[index] & LOCAL_DIRTY) {
+			_RecalculateLocal(index);
+		}
+
+		uint32_t parent = _parents[index];
+		if (parent != NO_PARENT) {
+			// inverse(P * L) is inverse(L) * inverse(P), both of which we already have
+			AffineMultiply(_worldTransforms[parent], _localTransforms[index], _worldTransforms[index]);
+			AffineMultiply(_inverseLocalTransforms[index], _inverseWorldTransforms[parent], _inverseWorldTransforms[index]);
+			_parentVersions[index] = _worldVersions[parent];
+		} else {
+			_worldTransforms[index] = _localTransforms[index];
+			_inverseWorldTransforms[index] = _inverseLocalTransforms[index];
+		}
+		_worldVersions[index]++;
+		_flags[index] = 0;
+	}
+
+	void TransformSystem::_Resolve(uint32_t index) {
+		// Collect the slot and its ancestors, so they can be brought up to date from the top down. The
+		// scratch space is per thread, so that components updating in parallel can read world transforms
+		static thread_local std::vector<uint32_t> resolveStack;
+		resolveStack.clear();
+		for (uint32_t current = index; current != NO_PARENT; current = _parents[current]) {
+			resolveStack.push_back(current);
+		}
+		for (auto it = resolveStack.rbegin(); it != resolveStack.rend(); it++) {
+			if (_NeedsUpdate(*it)) {
+				_Recalculate(*it);
+			}
+		}
+	}
+
+	void TransformSystem::_RebuildOrder() {
+		const uint32_t slotCount = (uint32_t)_positions.size();
+
+		// Lay the children of every slot out contiguously, so we can walk the hierarchy without any per object lists
+		std::vector<uint32_t> childStart(slotCount + 1, 0);
+		for (uint32_t ix = 0; ix < slotCount; ix++) {
+			if (_inUse[ix] && _parents[ix] != NO_PARENT) {
+				childStart[_parents[ix] + 1]++;
+			}
+		}
+		for (uint32_t ix = 0; ix < slotCount; ix++) {
+			childStart[ix + 1] += childStart[ix];
+		}
+		std::vector<uint32_t> children(childStart[slotCount]);
+		std::vector<uint32_t> childFill(childStart.begin(), childStart.end() - 1);
+		for (uint32_t ix = 0; ix < slotCount; ix++) {
+			if (_inUse[ix] && _parents[ix] != NO_PARENT) {
+				children[childFill[_parents[ix]]++] = ix;
+			}
+		}
+
+		// Walk each root's subtree depth first, so every root is followed by all of its descendants
+		_order.clear();
+		_chunkEnds.clear();
+		std::vector<uint32_t> stack;
+		uint32_t chunkStart = 0;
+		for (uint32_t root = 0; root < slotCount; root++) {
+			if (!_inUse[root] || _parents[root] != NO_PARENT) continue;
+
+			stack.push_back(root);
+			while (!stack.empty()) {
+				uint32_t index = stack.back();
+				stack.pop_back();
+				_order.push_back(index);
+				for (uint32_t child = childStart[index]; child < childStart[index + 1]; child++) {
+					stack.push_back(children[child]);
+				}
+			}
+
+			if (_order.size() - chunkStart >= CHUNK_SIZE) {
+				chunkStart = (uint32_t)_order.size();
+				_chunkEnds.push_back(chunkStart);
+			}
+		}
+		if (_order.size() > chunkStart) {
+			_chunkEnds.push_back((uint32_t)_order.size());
+		}
+
+		_isOrderDirty = false;
+	}
+}
@@ -0,0 +1,191 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <GLM/glm.hpp>
+#include <GLM/gtc/quaternion.hpp>
+
+#include "Utils/Macros.h"
+
+namespace Gameplay {
+	/// <summary>
+	/// Stores the transforms of all the objects in a scene, as one array per field rather than
+	/// one struct per object
+	///
+	/// Each object owns a slot, which holds its local position, rotation and scale, and the local
+	/// and world matrices (and their inverses) that are derived from them. Update recalculates
+	/// every transform that has changed in one pass over the slots, in an order where parents
+	/// always come before their children, and spreads independent root objects across the job
+	/// system. Transforms can still be queried between updates, in which case just the object and
+	/// its ancestors are brought up to date.
+	///
+	/// Rather than pushing dirty flags down to children, each slot remembers which version of its
+	/// parent's world transform it was calculated from, so changing an object never has to touch
+	/// its subtree
+	/// </summary>
+	class TransformSystem final {
+	public:
+		MAKE_PTRS(TransformSystem);
+		NO_COPY(TransformSystem);
+		NO_MOVE(TransformSystem);
+
+		// The parent of slots that are not attached to anything
+		static const uint32_t NO_PARENT = UINT32_MAX;
+
+		TransformSystem();
+		~TransformSystem() = default;
+
+		/// <summary>
+		/// Reserves a slot for a new root transform at the origin, with no rotation and a scale of 1
+		/// </summary>
+		/// <returns>The index of the new slot</returns>
+		uint32_t Allocate();
+		/// <summary>
+		/// Releases a slot so it can be reused, the slot should have no children
+		/// </summary>
+		/// <param name="index">The slot to release</param>
+		void Free(uint32_t index);
+
+		/// <summary>
+		/// Attaches a slot to a parent, so that it's world transform is relative to the parent's
+		/// </summary>
+		/// <param name="index">The slot to attach</param>
+		/// <param name="parent">The new parent, or NO_PARENT to detach the slot</param>
+		void SetParent(uint32_t index, uint32_t parent);
+		uint32_t GetParent(uint32_t index) const;
+
+		void SetPosition(uint32_t index, const glm::vec3& value);
+		void SetRotation(uint32_t index, const glm::quat& value);
+		void SetScale(uint32_t index, const glm::vec3& value);
+		const glm::vec3& GetPosition(uint32_t index) const;
+		const glm::quat& GetRotation(uint32_t index) const;
+		const glm::vec3& GetScale(uint32_t index) const;
+
+		/// <summary>
+		/// Gets the transform of a slot relative to its parent, recalculating it if needed
+		/// </summary>
+		const glm::mat4& GetLocalTransform(uint32_t index);
+		const glm::mat4& GetInverseLocalTransform(uint32_t index);
+		/// <summary>
+		/// Gets the world transform of a slot, recalculating it and any of its ancestors if needed. Safe to
+		/// call from several threads at once as long as nothing needs recalculating
+		/// </summary>
+		const glm::mat4& GetWorldTransform(uint32_t index);
+		const glm::mat4& GetInverseWorldTransform(uint32_t index);
+
+		/// <summary>
+		/// Recalculates every transform that has changed since the last update. Afterwards, reading
+		/// transforms is safe from any thread until one of them is modified again
+		/// </summary>
+		void Update();
+
+		/// <summary>
+		/// Remembers the position, rotation and scale of every slot as the state to interpolate from,
+		/// should be called at the start of each fixed simulation tick
+		/// </summary>
+		void SaveState();
+		/// <summary>
+		/// Calculates the transforms to render with, by blending each slot between the state saved by
+		/// SaveState and its current state. Slots created since the last SaveState use their current state
+		/// </summary>
+		/// <param name="alpha">How far to blend from the saved state to the current state, from 0 to 1</param>
+		void Interpolate(float alpha);
+		/// <summary>
+		/// Gets the transform to render a slot with. This is the interpolated transform if Interpolate
+		/// has been called since the slot was created, and the world transform otherwise
+		/// </summary>
+		const glm::mat4& GetRenderTransform(uint32_t index);
+		const glm::mat4& GetInverseRenderTransform(uint32_t index);
+		/// <summary>
+		/// Gets a number that changes whenever the slot's render transform does, so that systems caching
+		/// data built from it (ex: the GPU culler) can tell when to rebuild it. Call after GetRenderTransform,
+		/// since that may bring the transform up to date
+		/// </summary>
+		uint32_t GetRenderVersion(uint32_t index) const;
+
+		/// <summary>
+		/// Gets the number of slots that are in use
+		/// </summary>
+		size_t GetCount() const;
+		/// <summary>
+		/// Gets the number of world transforms that were recalculated by the last call to Update
+		/// </summary>
+		uint32_t GetUpdatedCount() const;
+
+	protected:
+		// Bits in _flags
+		static const uint8_t LOCAL_DIRTY = 0b01;
+		static const uint8_t WORLD_DIRTY = 0b10;
+
+		// Bits in _interpolationFlags
+		static const uint8_t HAS_PREVIOUS_STATE   = 0b0001;
+		static const uint8_t HAS_RENDER_TRANSFORM = 0b0010;
+		// Set if the slot was blended between two states by the last call to Interpolate
+		static const uint8_t WAS_BLENDED          = 0b0100;
+		// Set if the slot's render transform changed in the last call to Interpolate, so children know to update
+		static const uint8_t RENDER_CHANGED       = 0b1000;
+
+		// Roots are grouped into chunks of about this many slots, each chunk is one job
+		static const uint32_t CHUNK_SIZE = 256;
+
+		std::vector<glm::vec3> _positions;
+		std::vector<glm::quat> _rotations;
+		std::vector<glm::vec3> _scales;
+		std::vector<uint32_t>  _parents;
+		std::vector<uint8_t>   _flags;
+		std::vector<uint8_t>   _inUse;
+
+		std::vector<glm::mat4> _localTransforms;
+		std::vector<glm::mat4> _inverseLocalTransforms;
+		std::vector<glm::mat4> _worldTransforms;
+		std::vector<glm::mat4> _inverseWorldTransforms;
+
+		// Bumped every time a slot's world transform is recalculated, slots are never reset so that
+		// a reused slot can't be mistaken for the object that had it before
+		std::vector<uint32_t> _worldVersions;
+		// The version of the parent's world transform that each slot was last calculated from
+		std::vector<uint32_t> _parentVersions;
+
+		std::vector<uint32_t> _freeSlots;
+
+		// The state of each slot when SaveState was last called, and the transforms blended from it. These
+		// are only allocated once interpolation is used, so they may be shorter than the other arrays
+		std::vector<glm::vec3> _previousPositions;
+		std::vector<glm::quat> _previousRotations;
+		std::vector<glm::vec3> _previousScales;
+		std::vector<uint8_t>   _interpolationFlags;
+		std::vector<glm::mat4> _renderTransforms;
+		std::vector<glm::mat4> _inverseRenderTransforms;
+		// Bumped whenever Interpolate changes a slot's render transform, never reset for the same reason
+		// as _worldVersions
+		std::vector<uint32_t>  _renderVersions;
+
+		// Every slot in use, with each root followed by all of its descendants
+		std::vector<uint32_t> _order;
+		// The end of each chunk of roots in _order, chunks never split a root's subtree
+		std::vector<uint32_t> _chunkEnds;
+		bool _isOrderDirty;
+
+		uint32_t _updatedCount;
+
+		/// <summary>
+		/// Returns true if the slot's world transform is out of date, assuming its parent is up to date
+		/// </summary>
+		bool _NeedsUpdate(uint32_t index) const;
+		/// <summary>
+		/// Recalculates a slot's local matrices from its position, rotation and scale
+		/// </summary>
+		void _RecalculateLocal(uint32_t index);
+		/// <summary>
+		/// Recalculates all of a slot's matrices, the slot's parent must already be up to date
+		/// </summary>
+		void _Recalculate(uint32_t index);
+		/// <summary>
+		/// Brings a single slot's world transform up to date, along with any of its ancestors
+		/// </summary>
+		void _Resolve(uint32_t index);
+		/// <summary>
+		/// Rebuilds _order and _chunkEnds after the hierarchy has changed
+		/// </summary>
+		void _RebuildOrder();
+	};
+}
@@ -0,0 +1,188 @@
+#include "Graphics/Buffers/BufferPool.h"
+#include <algorithm>
+#include "Logging.h"
+
+BufferPool::BufferPool(int buffersPerPage, size_t pageSize, size_t budget, size_t alignment) :
+	_buffersPerPage(buffersPerPage),
+	_pageSize(pageSize),
+	_budget(budget),
+	_alignment(std::max(alignment, (size_t)1)),
+	_chargedBytes(0),
+	_pages(std::vector<Page>())
+{
+	LOG_ASSERT(buffersPerPage > 0 && buffersPerPage <= MAX_BUFFERS_PER_PAGE, "Buffers per page must be between 1 and {}", MAX_BUFFERS_PER_PAGE);
+}
+
+BufferPool::~BufferPool()
+{
+	for (int ix = 0; ix < (int)_pages.size(); ix++) {
+		_ReleasePage(ix);
+	}
+}
+
+bool BufferPool::Allocate(size_t size, Allocation& result)
+{
+	size = ((size + _alignment - 1) / _alignment) * _alignment;
+	if (size == 0) return false;
+
+	// First fit in the existing pages
+	for (int ix = 0; ix < (int)_pages.size(); ix++) {
+		if (_AllocateFromPage(ix, size, result)) {
+			return true;
+		}
+	}
+
+	// Need a new page, this is where the budget kicks in
+	size_t pageSize = std::max(size, _pageSize);
+	if (GetReservedBytes() + pageSize * _buffersPerPage > _budget) {
+		// A smaller page might still fit in what's left
+		pageSize = size;
+		if (GetReservedBytes() + pageSize * _buffersPerPage > _budget) {
+			return false;
+		}
+	}
+
+	int pageIx = _CreatePage(pageSize);
+	return _AllocateFromPage(pageIx, size, result);
+}
+
+bool BufferPool::_AllocateFromPage(int pageIx, size_t size, Allocation& result)
+{
+	Page& page = _pages[pageIx];
+	for (auto it = page.FreeRanges.begin(); it != page.FreeRanges.end(); it++) {
+		if (it->Size < size) continue;
+
+		result.Page   = pageIx;
+		result.Offset = it->Offset;
+		result.Size   = size;
+		for (int ix = 0; ix < MAX_BUFFERS_PER_PAGE; ix++) {
+			result.Buffers[ix] = page.Buffers[ix];
+		}
+
+		it->Offset += size;
+		it->Size   -= size;
+		if (it->Size == 0) {
+			page.FreeRanges.erase(it);
+		}
+		page.Used += size;
+		return true;
+	}
+	return false;
+}
+
+void BufferPool::Free(Allocation& allocation)
+{
+	if (!allocation.IsValid()) return;
+	LOG_ASSERT(allocation.Page < (int)_pages.size() && _pages[allocation.Page].Size > 0, "Allocation does not belong to this pool");
+
+	Page& page = _pages[allocation.Page];
+	Range range = { allocation.Offset, allocation.Size };
+
+	// Insert in offset order, merging with our neighbours where they touch
+	auto it = std::lower_bound(page.FreeRanges.begin(), page.FreeRanges.end(), range, [](const Range& a, const Range& b) {
+		return a.Offset < b.Offset;
+	});
+	it = page.FreeRanges.insert(it, range);
+	if (it + 1 != page.FreeRanges.end() && it->Offset + it->Size == (it + 1)->Offset) {
+		it->Size += (it + 1)->Size;
+		page.FreeRanges.erase(it + 1);
+	}
+	if (it != page.FreeRanges.begin() && (it - 1)->Offset + (it - 1)->Size == it->Offset) {
+		(it - 1)->Size += it->Size;
+		page.FreeRanges.erase(it);
+	}
+
+	page.Used -= allocation.Size;
+	if (page.Used == 0) {
+		_ReleasePage(allocation.Page);
+	}
+
+	allocation = Allocation();
+}
+
+bool BufferPool::Charge(size_t size)
+{
+	if (GetReservedBytes() + size > _budget) {
+		return false;
+	}
+	_chargedBytes += size;
+	return true;
+}
+
+void BufferPool::Uncharge(size_t size)
+{
+	LOG_ASSERT(size <= _chargedBytes, "Uncharging more bytes than were charged");
+	_chargedBytes -= size;
+}
+
+int BufferPool::_CreatePage(size_t size)
+{
+	// Reuse an empty slot if there is one
+	int pageIx = -1;
+	for (int ix = 0; ix < (int)_pages.size(); ix++) {
+		if (_pages[ix].Size == 0) {
+			pageIx = ix;
+			break;
+		}
+	}
+	if (pageIx == -1) {
+		pageIx = (int)_pages.size();
+		_pages.push_back(Page());
+	}
+
+	Page& page = _pages[pageIx];
+	glCreateBuffers(_buffersPerPage, page.Buffers);
+	for (int ix = 0; ix < _buffersPerPage; ix++) {
+		glNamedBufferData(page.Buffers[ix], size, nullptr, GL_DYNAMIC_DRAW);
+	}
+	page.Size = size;
+	page.Used = 0;
+	page.FreeRanges = { { 0, size } };
+
+	LOG_INFO("Created buffer pool page {} ({} KB x {})", pageIx, size / 1024, _buffersPerPage);
+	return pageIx;
+}
+
+void BufferPool::_ReleasePage(int pageIx)
+{
+	Page& page = _pages[pageIx];
+	if (page.Size == 0) return;
+
+	glDeleteBuffers(_buffersPerPage, page.Buffers);
+	_pages[pageIx] = Page();
+}
+
+void BufferPool::SetBudget(size_t budget) {
+	_budget = budget;
+}
+
+size_t BufferPool::GetBudget() const {
+	return _budget;
+}
+
+size_t BufferPool::GetReservedBytes() const
+{
+	size_t result = 0;
+	for (const Page& page : _pages) {
+		result += page.Size;
+	}
+	return result * _buffersPerPage + _chargedBytes;
+}
+
+size_t BufferPool::GetUsedBytes() const
+{
+	size_t result = 0;
+	for (const Page& page : _pages) {
+		result += page.Used;
+	}
+	return result * _buffersPerPage + _chargedBytes;
+}
+
+int BufferPool::GetPageCount() const
+{
+	int result = 0;
+	for (const Page& page : _pages) {
+		result += page.Size > 0 ? 1 : 0;
+	}
+	return result;
+}
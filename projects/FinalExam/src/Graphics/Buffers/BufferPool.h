@@ -0,0 +1,113 @@
+#pragma once
+#include <vector>
+#include <glad/glad.h>
+
+#include "Utils/Macros.h"
+
+/**
+ * Hands out ranges of a few large OpenGL buffers, so that many small users (ex: particle systems)
+ * can share allocations instead of each creating their own buffers
+ *
+ * Memory is reserved in pages, with every page holding the same number of buffers (ex: 2 for
+ * ping-ponging). An allocation gets the same range in each of its page's buffers. Pages are only
+ * created while the pool is under its memory budget, and are released once nothing uses them
+ */
+class BufferPool final {
+public:
+	MAKE_PTRS(BufferPool);
+	NO_COPY(BufferPool);
+	NO_MOVE(BufferPool);
+
+	static const int MAX_BUFFERS_PER_PAGE = 2;
+
+	/**
+	 * A range within one of the pool's pages
+	 */
+	struct Allocation {
+		GLuint Buffers[MAX_BUFFERS_PER_PAGE] = { 0 };
+		size_t Offset = 0;
+		size_t Size   = 0;
+		int    Page   = -1;
+
+		bool IsValid() const { return Page >= 0; }
+	};
+
+	/**
+	 * Creates a new buffer pool, no GL resources are created until the first allocation
+	 * @param buffersPerPage The number of buffers that each allocation gets a range in
+	 * @param pageSize The default size of a page, in bytes. Larger allocations get a page to themselves
+	 * @param budget The maximum number of bytes to reserve across all pages and buffers
+	 * @param alignment The alignment of allocation offsets, in bytes
+	 */
+	BufferPool(int buffersPerPage, size_t pageSize, size_t budget, size_t alignment = 256);
+	~BufferPool();
+
+	/**
+	 * Reserves a range in the pool
+	 * @param size The size of the range, in bytes
+	 * @param result Receives the allocation
+	 * @returns True if the allocation succeeded, false if it would put the pool over budget
+	 */
+	bool Allocate(size_t size, Allocation& result);
+	/**
+	 * Releases a range back to the pool, and resets the allocation
+	 */
+	void Free(Allocation& allocation);
+
+	/**
+	 * Counts memory that was allocated outside of the pool against its budget, for users that need
+	 * buffers the pool can't give them (ex: storage buffers with a different layout)
+	 * @param size The number of bytes to count
+	 * @returns True if the bytes fit in the budget, false if nothing was counted
+	 */
+	bool Charge(size_t size);
+	/**
+	 * Stops counting bytes that were added with Charge
+	 */
+	void Uncharge(size_t size);
+
+	/**
+	 * Sets the maximum number of bytes the pool can reserve. Shrinking the budget does not
+	 * release any existing pages, but no new ones will be created until usage drops
+	 */
+	void SetBudget(size_t budget);
+	size_t GetBudget() const;
+
+	/**
+	 * Gets the number of bytes reserved in GPU memory, including all buffers in every page and any charged bytes
+	 */
+	size_t GetReservedBytes() const;
+	/**
+	 * Gets the number of bytes handed out to allocations, including all buffers in every page and any charged bytes
+	 */
+	size_t GetUsedBytes() const;
+	int GetPageCount() const;
+
+protected:
+	struct Range {
+		size_t Offset;
+		size_t Size;
+	};
+
+	struct Page {
+		GLuint Buffers[MAX_BUFFERS_PER_PAGE] = { 0 };
+		size_t Size = 0;
+		size_t Used = 0;
+		// Sorted by offset, neighbouring ranges are always merged
+		std::vector<Range> FreeRanges;
+	};
+
+	int    _buffersPerPage;
+	size_t _pageSize;
+	size_t _budget;
+	size_t _alignment;
+	// Bytes allocated outside the pool that count against the budget, see Charge
+	size_t _chargedBytes;
+
+	// Released pages are left as empty slots so that page indices stay valid
+	std::vector<Page> _pages;
+
+	bool _AllocateFromPage(int pageIx, size_t size, Allocation& result);
+	int  _CreatePage(size_t size);
+	void _ReleasePage(int pageIx);
+};
@@ -152,8 +152,6 @@ void Font::Bake() {
 	current.num_chars = prevCodePoint - current.first_unicode_codepoint_in_range + 1;
 	ranges.push_back(current);
 
-	_CrtCheckMemory();
-
 	// Create a texture to store the atlas
 	Texture2DDescription desc;
 	desc.Width = _atlasWidth;
@@ -171,8 +169,6 @@ void Font::Bake() {
 		delete[] atlasData;
 		return;
 	}
-	_CrtCheckMemory();
-
 	stbtt_PackSetOversampling(&context, OVERSAMPLE_X, OVERSAMPLE_Y);
 	for (auto& range : ranges) {
 		if (!stbtt_PackFontRange(&context, rawFontData, 0, range.font_size, range.first_unicode_codepoint_in_range, range.num_chars, range.chardata_for_range)) {
@@ -180,12 +176,9 @@ void Font::Bake() {
 			delete[] atlasData;
 			return;
 		}
-		_CrtCheckMemory();
 	}
 	stbtt_PackEnd(&context);
 
-	_CrtCheckMemory();
-
 	// Upload data into the image
 	_atlas->LoadData(desc.Width, desc.Height, PixelFormat::Red, PixelType::UByte, atlasData);
 	delete[] atlasData;
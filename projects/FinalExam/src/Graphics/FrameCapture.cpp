@@ -0,0 +1,372 @@
+#include "Graphics/FrameCapture.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <stb_image_write.h>
+
+#include "Logging.h"
+
+FrameCapture::FrameCapture() :
+	_slots(),
+	_firstSlot(0),
+	_slotsInUse(0),
+	_isRecording(false),
+	_directory(""),
+	_format(CaptureFormat::PngSequence),
+	_captureDepth(false),
+	_frameRate(60),
+	_nextFrameNumber(0),
+	_stats(Stats()),
+	_writer(),
+	_mutex(),
+	_hasWork(),
+	_queue(std::deque<PendingFrame>()),
+	_stopWriter(false),
+	_framesWritten(0),
+	_videoStream(),
+	_videoSize(glm::ivec2(0))
+{ }
+
+FrameCapture::~FrameCapture()
+{
+	Stop();
+	for (ReadbackSlot& slot : _slots) {
+		glDeleteBuffers(1, &slot.ColorBuffer);
+		glDeleteBuffers(1, &slot.DepthBuffer);
+	}
+}
+
+bool FrameCapture::Start(const std::string& directory, CaptureFormat format, bool captureDepth, int frameRate)
+{
+	Stop();
+
+	std::error_code error;
+	std::filesystem::create_directories(directory, error);
+	if (!std::filesystem::is_directory(directory)) {
+		LOG_ERROR("Failed to create capture directory \"{}\"", directory);
+		return false;
+	}
+
+	_directory       = directory;
+	_format          = format;
+	_captureDepth    = captureDepth;
+	_frameRate       = std::max(frameRate, 1);
+	_nextFrameNumber = 0;
+	_stats           = Stats();
+	_framesWritten   = 0;
+	_stopWriter      = false;
+	_isRecording     = true;
+	_writer = std::thread(&FrameCapture::_WriterLoop, this);
+
+	LOG_INFO("Started capturing to \"{}\" ({})", directory, ~format);
+	return true;
+}
+
+void FrameCapture::Stop()
+{
+	if (!_isRecording) return;
+
+	// Stopping is allowed to wait, so make sure that everything we've captured makes it to disk
+	while (_slotsInUse > 0) {
+		ReadbackSlot& slot = _slots[_firstSlot];
+		glClientWaitSync(slot.Fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+		_ResolveSlot(slot);
+		_firstSlot = (_firstSlot + 1) % READBACK_SLOTS;
+		_slotsInUse--;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stopWriter = true;
+	}
+	_hasWork.notify_one();
+	_writer.join();
+
+	_isRecording = false;
+	LOG_INFO("Stopped capturing, {} frames written, {} dropped", _framesWritten.load(), _stats.FramesDropped);
+}
+
+bool FrameCapture::IsRecording() const {
+	return _isRecording;
+}
+
+void FrameCapture::Capture(GLuint colorFramebuffer, const glm::ivec4& colorRegion, GLuint depthFramebuffer, int frameNumber,
+	const std::optional<glm::ivec2>& depthOrigin)
+{
+	if (!_isRecording) return;
+
+	Poll();
+
+	// Every slot is still waiting on the GPU, we'd rather lose a frame than wait for one
+	if (_slotsInUse == READBACK_SLOTS) {
+		_stats.FramesDropped++;
+		return;
+	}
+
+	ReadbackSlot& slot = _slots[(_firstSlot + _slotsInUse) % READBACK_SLOTS];
+	slot.Size        = glm::ivec2(colorRegion.z, colorRegion.w);
+	slot.FrameNumber = frameNumber >= 0 ? frameNumber : _nextFrameNumber;
+	slot.HasDepth    = _captureDepth && depthFramebuffer != 0;
+	_nextFrameNumber = slot.FrameNumber + 1;
+
+	// Buffers only ever grow, so resizing the window back and forth doesn't reallocate every time
+	size_t colorSize = (size_t)slot.Size.x * slot.Size.y * 4;
+	if (slot.ColorBuffer == 0) {
+		glCreateBuffers(1, &slot.ColorBuffer);
+	}
+	if (colorSize > slot.ColorCapacity) {
+		glNamedBufferData(slot.ColorBuffer, colorSize, nullptr, GL_STREAM_READ);
+		slot.ColorCapacity = colorSize;
+	}
+
+	GLint previousRead = 0;
+	glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &previousRead);
+
+	// With a pack buffer bound, glReadPixels queues a copy instead of waiting for the frame to finish
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, colorFramebuffer);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.ColorBuffer);
+	glReadPixels(colorRegion.x, colorRegion.y, slot.Size.x, slot.Size.y, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+	if (slot.HasDepth) {
+		size_t depthSize = (size_t)slot.Size.x * slot.Size.y * sizeof(float);
+		if (slot.DepthBuffer == 0) {
+			glCreateBuffers(1, &slot.DepthBuffer);
+		}
+		if (depthSize > slot.DepthCapacity) {
+			glNamedBufferData(slot.DepthBuffer, depthSize, nullptr, GL_STREAM_READ);
+			slot.DepthCapacity = depthSize;
+		}
+
+		// Depth has to come from the same part of the image as color, or the two captures won't line up
+		glm::ivec2 origin = depthOrigin.value_or(glm::ivec2(colorRegion.x, colorRegion.y));
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, depthFramebuffer);
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.DepthBuffer);
+		glReadPixels(origin.x, origin.y, slot.Size.x, slot.Size.y, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+	}
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, previousRead);
+
+	slot.Fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	_slotsInUse++;
+	_stats.FramesCaptured++;
+}
+
+void FrameCapture::Poll()
+{
+	// Slots are resolved in order, so that video frames are never written out of order
+	while (_slotsInUse > 0) {
+		ReadbackSlot& slot = _slots[_firstSlot];
+		GLenum status = glClientWaitSync(slot.Fence, 0, 0);
+		if (status == GL_TIMEOUT_EXPIRED) {
+			break;
+		}
+
+		_ResolveSlot(slot);
+		_firstSlot = (_firstSlot + 1) % READBACK_SLOTS;
+		_slotsInUse--;
+	}
+}
+
+void FrameCapture::_ResolveSlot(ReadbackSlot& slot)
+{
+	glDeleteSync(slot.Fence);
+	slot.Fence = nullptr;
+
+	// If the writer has fallen behind, don't bother mapping the buffers
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		if (_queue.size() >= MAX_QUEUED_FRAMES) {
+			_stats.FramesDropped++;
+			return;
+		}
+	}
+
+	PendingFrame frame;
+	frame.FrameNumber = slot.FrameNumber;
+	frame.Size = slot.Size;
+
+	size_t pixelCount = (size_t)slot.Size.x * slot.Size.y;
+	frame.Color.resize(pixelCount * 4);
+	const void* color = glMapNamedBufferRange(slot.ColorBuffer, 0, frame.Color.size(), GL_MAP_READ_BIT);
+	if (color != nullptr) {
+		memcpy(frame.Color.data(), color, frame.Color.size());
+	}
+	glUnmapNamedBuffer(slot.ColorBuffer);
+
+	if (slot.HasDepth) {
+		frame.Depth.resize(pixelCount);
+		const void* depth = glMapNamedBufferRange(slot.DepthBuffer, 0, frame.Depth.size() * sizeof(float), GL_MAP_READ_BIT);
+		if (depth != nullptr) {
+			memcpy(frame.Depth.data(), depth, frame.Depth.size() * sizeof(float));
+		}
+		glUnmapNamedBuffer(slot.DepthBuffer);
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_queue.push_back(std::move(frame));
+	}
+	_hasWork.notify_one();
+}
+
+void FrameCapture::_WriterLoop()
+{
+	while (true) {
+		PendingFrame frame;
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_hasWork.wait(lock, [this]() { return _stopWriter || !_queue.empty(); });
+
+			// We only stop once everything has been written
+			if (_queue.empty()) break;
+
+			frame = std::move(_queue.front());
+			_queue.pop_front();
+		}
+
+		_WriteFrame(frame);
+		_framesWritten++;
+	}
+
+	if (_videoStream.is_open()) {
+		_videoStream.close();
+	}
+	_videoSize = glm::ivec2(0);
+}
+
+void FrameCapture::_WriteFrame(const PendingFrame& frame)
+{
+	switch (_format) {
+		case CaptureFormat::PngSequence:
+			_WritePng(frame);
+			break;
+		case CaptureFormat::Y4M:
+			_WriteY4mFrame(frame);
+			break;
+		default:
+			break;
+	}
+
+	if (!frame.Depth.empty()) {
+		_WriteDepth(frame);
+	}
+}
+
+void FrameCapture::_WritePng(const PendingFrame& frame)
+{
+	const int width = frame.Size.x;
+	const int height = frame.Size.y;
+	const size_t stride = (size_t)width * 4;
+
+	// OpenGL's origin is the bottom left, but images are stored top to bottom. We flip it ourselves
+	// instead of using stbi_flip_vertically_on_write, since that flag is shared with the main thread
+	std::vector<uint8_t> flipped(frame.Color.size());
+	for (int y = 0; y < height; y++) {
+		memcpy(flipped.data() + y * stride, frame.Color.data() + (height - 1 - y) * stride, stride);
+	}
+
+	char fileName[64];
+	snprintf(fileName, 64, "frame_%05d.png", frame.FrameNumber);
+	std::filesystem::path path = std::filesystem::path(_directory) / fileName;
+	if (!stbi_write_png(path.string().c_str(), width, height, 4, flipped.data(), (int)stride)) {
+		LOG_ERROR("Failed to write capture to \"{}\"", path.string());
+	}
+}
+
+void FrameCapture::_WriteY4mFrame(const PendingFrame& frame)
+{
+	const int width = frame.Size.x;
+	const int height = frame.Size.y;
+
+	if (!_videoStream.is_open()) {
+		std::filesystem::path path = std::filesystem::path(_directory) / "capture.y4m";
+		_videoStream.open(path, std::ios::binary);
+		if (!_videoStream.good()) {
+			LOG_ERROR("Failed to open \"{}\" for writing", path.string());
+			return;
+		}
+
+		// C420jpeg is full range BT.601, which matches the conversion below
+		char header[128];
+		snprintf(header, 128, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", width, height, _frameRate);
+		_videoStream << header;
+		_videoSize = frame.Size;
+	}
+
+	// Y4M can't change resolution part way through
+	if (frame.Size != _videoSize) {
+		LOG_WARN("Skipping capture frame {}, size changed from {}x{} to {}x{}", frame.FrameNumber, _videoSize.x, _videoSize.y, width, height);
+		return;
+	}
+
+	const int chromaWidth  = (width + 1) / 2;
+	const int chromaHeight = (height + 1) / 2;
+	std::vector<uint8_t> planes((size_t)width * height + (size_t)chromaWidth * chromaHeight * 2);
+	uint8_t* lumaPlane = planes.data();
+	uint8_t* cbPlane   = lumaPlane + (size_t)width * height;
+	uint8_t* crPlane   = cbPlane + (size_t)chromaWidth * chromaHeight;
+
+	// Rows are flipped as we go, since GL's origin is the bottom left
+	auto pixel = [&](int x, int y) {
+		return frame.Color.data() + ((size_t)(height - 1 - y) * width + x) * 4;
+	};
+
+	for (int y = 0; y < height; y++) {
+		for (int x = 0; x < width; x++) {
+			const uint8_t* rgb = pixel(x, y);
+			lumaPlane[(size_t)y * width + x] = (uint8_t)glm::clamp(0.299f * rgb[0] + 0.587f * rgb[1] + 0.114f * rgb[2] + 0.5f, 0.0f, 255.0f);
+		}
+	}
+
+	// Chroma is the average of each 2x2 block
+	for (int y = 0; y < chromaHeight; y++) {
+		for (int x = 0; x < chromaWidth; x++) {
+			glm::vec3 sum = glm::vec3(0.0f);
+			int count = 0;
+			for (int dy = 0; dy < 2; dy++) {
+				for (int dx = 0; dx < 2; dx++) {
+					int px = x * 2 + dx, py = y * 2 + dy;
+					if (px >= width || py >= height) continue;
+					const uint8_t* rgb = pixel(px, py);
+					sum += glm::vec3(rgb[0], rgb[1], rgb[2]);
+					count++;
+				}
+			}
+			glm::vec3 rgb = sum / (float)count;
+			cbPlane[(size_t)y * chromaWidth + x] = (uint8_t)glm::clamp(128.0f - 0.168736f * rgb.r - 0.331264f * rgb.g + 0.5f * rgb.b + 0.5f, 0.0f, 255.0f);
+			crPlane[(size_t)y * chromaWidth + x] = (uint8_t)glm::clamp(128.0f + 0.5f * rgb.r - 0.418688f * rgb.g - 0.081312f * rgb.b + 0.5f, 0.0f, 255.0f);
+		}
+	}
+
+	_videoStream << "FRAME\n";
+	_videoStream.write(reinterpret_cast<const char*>(planes.data()), planes.size());
+}
+
+void FrameCapture::_WriteDepth(const PendingFrame& frame)
+{
+	char fileName[64];
+	snprintf(fileName, 64, "depth_%05d.pfm", frame.FrameNumber);
+	std::filesystem::path path = std::filesystem::path(_directory) / fileName;
+
+	std::ofstream stream(path, std::ios::binary);
+	if (!stream.good()) {
+		LOG_ERROR("Failed to write depth capture to \"{}\"", path.string());
+		return;
+	}
+
+	// PFM stores rows bottom to top like OpenGL does, and a negative scale means little endian
+	stream << "Pf\n" << frame.Size.x << " " << frame.Size.y << "\n-1.0\n";
+	stream.write(reinterpret_cast<const char*>(frame.Depth.data()), frame.Depth.size() * sizeof(float));
+}
+
+FrameCapture::Stats FrameCapture::GetStats() const
+{
+	Stats result = _stats;
+	result.FramesWritten = _framesWritten.load();
+	return result;
+}
+
+const std::string& FrameCapture::GetDirectory() const {
+	return _directory;
+}
@@ -0,0 +1,147 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+#include <EnumToString.h>
+#include <GLM/glm.hpp>
+#include <glad/glad.h>
+
+#include "Utils/Macros.h"
+
+/**
+ * The file formats that a FrameCapture can record to
+ */
+ENUM(CaptureFormat, int,
+	PngSequence = 0, // One PNG per frame
+	Y4M         = 1  // A single uncompressed YUV 4:2:0 video, readable by ffmpeg and most video tools
+);
+
+/**
+ * Records frames from a framebuffer to disk without stalling the render thread
+ *
+ * Each captured frame is read into one of a ring of pixel pack buffers, and a fence is placed
+ * behind the read. The buffers are only mapped once their fence has signaled (usually a couple
+ * of frames later), and the pixels are handed to a worker thread for encoding and writing. If the
+ * GPU or the disk can't keep up, frames are dropped rather than making the frame wait
+ *
+ * Depth can optionally be recorded as well, and is written as one PFM (portable float map) per frame
+ */
+class FrameCapture final {
+public:
+	MAKE_PTRS(FrameCapture);
+	NO_COPY(FrameCapture);
+	NO_MOVE(FrameCapture);
+
+	/**
+	 * Statistics about the current recording, for debugging
+	 */
+	struct Stats {
+		int FramesCaptured = 0;
+		int FramesWritten  = 0;
+		// Frames skipped because the readback ring or the writer was full
+		int FramesDropped  = 0;
+	};
+
+	FrameCapture();
+	~FrameCapture();
+
+	/**
+	 * Starts recording into the given directory, stopping any current recording first
+	 * @param directory The directory to write frames to, will be created if it does not exist
+	 * @param format The format to encode color frames in
+	 * @param captureDepth True to record depth as well as color
+	 * @param frameRate The frame rate to store in video formats
+	 * @returns True if the recording was started
+	 */
+	bool Start(const std::string& directory, CaptureFormat format = CaptureFormat::PngSequence, bool captureDepth = false, int frameRate = 60);
+	/**
+	 * Stops the current recording. This waits for all in flight frames to be read back and written,
+	 * so it should not be called in the middle of something we're timing
+	 */
+	void Stop();
+	bool IsRecording() const;
+
+	/**
+	 * Queues a readback of the given framebuffers, should be called after everything we want
+	 * to see has been drawn. Does nothing if we aren't recording
+	 * @param colorFramebuffer The framebuffer to read color from, or 0 for the default framebuffer
+	 * @param colorRegion The region of the color framebuffer to read, as x, y, width, height
+	 * @param depthFramebuffer The framebuffer to read depth from, or 0 to skip depth
+	 * @param frameNumber The number to name the frame's files with, or -1 to number them sequentially
+	 * @param depthOrigin Where the region starts in the depth framebuffer, defaults to the same origin as the
+	 *                    color region. Only needed when the two framebuffers are laid out differently
+	 *                    (ex: color from a viewport on screen, depth from the offscreen scene it shows)
+	 */
+	void Capture(GLuint colorFramebuffer, const glm::ivec4& colorRegion, GLuint depthFramebuffer = 0, int frameNumber = -1,
+		const std::optional<glm::ivec2>& depthOrigin = std::nullopt);
+	/**
+	 * Hands any readbacks that the GPU has finished off to the writer, never waits on the GPU.
+	 * Should be called once per frame, Capture calls this as well
+	 */
+	void Poll();
+
+	Stats GetStats() const;
+	const std::string& GetDirectory() const;
+
+protected:
+	// How many frames can be in flight on the GPU at once
+	static const int READBACK_SLOTS = 4;
+	// How many frames can be waiting for the writer before we start dropping them
+	static const int MAX_QUEUED_FRAMES = 8;
+
+	struct ReadbackSlot {
+		GLuint     ColorBuffer   = 0;
+		GLuint     DepthBuffer   = 0;
+		size_t     ColorCapacity = 0;
+		size_t     DepthCapacity = 0;
+		GLsync     Fence         = nullptr;
+		glm::ivec2 Size          = glm::ivec2(0);
+		int        FrameNumber   = 0;
+		bool       HasDepth      = false;
+	};
+
+	// A frame that has been read back, waiting to be written to disk
+	struct PendingFrame {
+		int                  FrameNumber;
+		glm::ivec2           Size;
+		std::vector<uint8_t> Color;
+		std::vector<float>   Depth;
+	};
+
+	ReadbackSlot _slots[READBACK_SLOTS];
+	// The oldest slot that may be in flight, and the number in flight
+	int          _firstSlot;
+	int          _slotsInUse;
+
+	bool          _isRecording;
+	std::string   _directory;
+	CaptureFormat _format;
+	bool          _captureDepth;
+	int           _frameRate;
+	int           _nextFrameNumber;
+	Stats         _stats;
+
+	// Writer thread state, everything below is shared with the writer
+	std::thread                 _writer;
+	std::mutex                  _mutex;
+	std::condition_variable     _hasWork;
+	std::deque<PendingFrame>    _queue;
+	bool                        _stopWriter;
+	std::atomic<int>            _framesWritten;
+	// Only touched by the writer thread
+	std::ofstream               _videoStream;
+	glm::ivec2                  _videoSize;
+
+	void _ResolveSlot(ReadbackSlot& slot);
+	void _WriterLoop();
+	void _WriteFrame(const PendingFrame& frame);
+	void _WritePng(const PendingFrame& frame);
+	void _WriteY4mFrame(const PendingFrame& frame);
+	void _WriteDepth(const PendingFrame& frame);
+};
@@ -1,6 +1,6 @@
 #include "Graphics/Framebuffer.h"
 
-#include "Graphics/RenderBuffer.h"
+#include "Graphics/Renderbuffer.h"
 #include "Utils/JsonGlmHelpers.h"
 
 
@@ -253,7 +253,7 @@ void Framebuffer::SetDebugName(const std::string& name) {
 	// We'll also update the name for all our children
 	for (const auto& attachment : _targets) {
 		static char buffer[256];
-		sprintf_s(buffer, 256, "%s_%s", name.c_str(), (~attachment.first).c_str());
+		snprintf(buffer, 256, "%s_%s", name.c_str(), (~attachment.first).c_str());
 		attachment.second.Resource->SetDebugName(buffer);
 	}
 }
@@ -7,7 +7,7 @@
 #include <EnumToString.h>
 #include <glad/glad.h>
 #include <Logging.h>
-#include <glm/glm.hpp>
+#include <GLM/glm.hpp>
 
 // We can use an enum to make our code more readable and restrict
 // values to only ones we want to accept
@@ -17,6 +17,7 @@ ENUM(ShaderPartType, GLint,
 	 TessControl  = GL_TESS_CONTROL_SHADER,
 	 TessEval     = GL_TESS_EVALUATION_SHADER,
 	 Geometry     = GL_GEOMETRY_SHADER,
+	 Compute      = GL_COMPUTE_SHADER,
 	 Unknown      = GL_NONE // Usually good practice to have an "unknown" or "none" state for enums
 )
 
@@ -142,7 +143,7 @@ constexpr InternalFormat GetInternalFormatForChannels8(int numChannels) {
 		case 4:
 			return InternalFormat::RGBA8;
 		default:
-			LOG_WARN(false, "Unsupported texture format with {0} channels", numChannels);
+			LOG_WARN("Unsupported texture format with {0} channels", numChannels);
 			return InternalFormat::Unknown;
 	}
 }
@@ -157,7 +158,7 @@ constexpr PixelFormat GetPixelFormatForChannels(int numChannels) {
 		case 4:
 			return PixelFormat::RGBA;
 		default:
-			LOG_WARN(false, "Unsupported texture format with {0} channels", numChannels);
+			LOG_WARN("Unsupported texture format with {0} channels", numChannels);
 			return PixelFormat::Unknown;
 	}
 }
@@ -546,7 +547,7 @@ constexpr uint32_t ShaderDataTypeComponentCount(ShaderDataType type)
 		case ShaderDataTypecode::Texture:
 			return 1;
 		default:
-			LOG_WARN(false, "Unknown ShaderDataType! {}", type);
+			LOG_WARN("Unknown ShaderDataType! {}", type);
 			return 1;
 	}
 }
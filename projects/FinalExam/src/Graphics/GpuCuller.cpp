@@ -0,0 +1,285 @@
+#include "Graphics/GpuCuller.h"
+#include <algorithm>
+#include <cstring>
+
+// Shader storage bindings, these match the layouts in compute_shaders/gpu_cull.glsl
+static const GLuint CULL_OBJECT_BINDING = 10;
+static const GLuint COMMAND_BINDING     = 12;
+
+// Thread group sizes of the culling and downsampling shaders
+static const GLuint CULL_GROUP_SIZE = 64;
+static const GLuint HIZ_GROUP_SIZE  = 8;
+
+static ShaderProgram::Sptr LoadComputeShader(const char* path, bool& isValid) {
+	ShaderProgram::Sptr result = ShaderProgram::Create();
+	isValid &= result->LoadShaderPartFromFile(path, ShaderPartType::Compute);
+	isValid &= result->Link();
+	return result;
+}
+
+GpuCuller::GpuCuller(size_t drawDataStride) :
+	_cullObjectBuffer(0),
+	_drawDataBuffer(0),
+	_visibleBuffer(0),
+	_commandBuffer(0),
+	_objectCapacity(0),
+	_drawDataCapacity(0),
+	_visibleCapacity(0),
+	_commandCapacity(0),
+	_drawDataStride(drawDataStride),
+	_cullObjects(std::vector<CullObject>()),
+	_drawData(std::vector<uint8_t>()),
+	_freeSlots(std::vector<uint32_t>()),
+	_dirtyCullObjects(std::vector<uint32_t>()),
+	_dirtyDrawData(std::vector<uint32_t>()),
+	_hiZTexture(0),
+	_hiZAllocatedSize(glm::ivec2(0)),
+	_hiZSize(glm::ivec2(0)),
+	_hiZLevels(0),
+	_hiZValid(false),
+	_hiZViewProjection(glm::mat4(1.0f)),
+	_cullShader(nullptr),
+	_hiZShader(nullptr),
+	_isValid(true),
+	_stats(Stats())
+{
+	_cullShader = LoadComputeShader("shaders/compute_shaders/gpu_cull.glsl", _isValid);
+	_cullShader->SetDebugName("GPU Cull");
+	_hiZShader  = LoadComputeShader("shaders/compute_shaders/hiz_downsample.glsl", _isValid);
+	_hiZShader->SetDebugName("Hi-Z Downsample");
+
+	if (!_isValid) {
+		LOG_WARN("Failed to compile GPU culling shaders, falling back to CPU culling");
+	}
+}
+
+GpuCuller::~GpuCuller()
+{
+	GLuint buffers[4] = { _cullObjectBuffer, _drawDataBuffer, _visibleBuffer, _commandBuffer };
+	glDeleteBuffers(4, buffers);
+	if (_hiZTexture != 0) {
+		glDeleteTextures(1, &_hiZTexture);
+	}
+}
+
+bool GpuCuller::IsValid() const
+{
+	return _isValid;
+}
+
+uint32_t GpuCuller::AllocateSlot()
+{
+	uint32_t slot;
+	if (!_freeSlots.empty()) {
+		slot = _freeSlots.back();
+		_freeSlots.pop_back();
+	} else {
+		slot = (uint32_t)_cullObjects.size();
+		_cullObjects.emplace_back();
+		_drawData.resize(_drawData.size() + _drawDataStride);
+	}
+
+	// Keep the slot empty until the caller fills it in
+	_cullObjects[slot] = CullObject{ glm::vec4(0.0f), glm::vec4(0.0f), glm::uvec4(0, 0, 0, 1) };
+	_dirtyCullObjects.push_back(slot);
+	return slot;
+}
+
+void GpuCuller::FreeSlot(uint32_t slot)
+{
+	_cullObjects[slot].Batch.w = 1;
+	_dirtyCullObjects.push_back(slot);
+	_freeSlots.push_back(slot);
+}
+
+void GpuCuller::Clear()
+{
+	_cullObjects.clear();
+	_drawData.clear();
+	_freeSlots.clear();
+	_dirtyCullObjects.clear();
+	_dirtyDrawData.clear();
+	_stats.Objects = 0;
+}
+
+void GpuCuller::SetCullObject(uint32_t slot, const CullObject& object)
+{
+	_cullObjects[slot] = object;
+	_dirtyCullObjects.push_back(slot);
+}
+
+void GpuCuller::SetDrawData(uint32_t slot, const void* drawData)
+{
+	memcpy(&_drawData[slot * _drawDataStride], drawData, _drawDataStride);
+	_dirtyDrawData.push_back(slot);
+}
+
+void GpuCuller::Upload()
+{
+	if (!_isValid) {
+		return;
+	}
+
+	size_t uploaded = 0;
+	uploaded += _UploadSlots(_cullObjectBuffer, _objectCapacity, reinterpret_cast<const uint8_t*>(_cullObjects.data()), _cullObjects.size(), sizeof(CullObject), _dirtyCullObjects);
+	uploaded += _UploadSlots(_drawDataBuffer, _drawDataCapacity, _drawData.data(), _cullObjects.size(), _drawDataStride, _dirtyDrawData);
+
+	_stats.Objects       = (int)(_cullObjects.size() - _freeSlots.size());
+	_stats.UploadedBytes = (int)uploaded;
+}
+
+void GpuCuller::SetCommands(const std::vector<DrawCommand>& commands, size_t visibleCount)
+{
+	if (!_isValid) {
+		return;
+	}
+
+	// Every object in a batch could pass, so each batch's range needs room for all of them
+	size_t visibleSize = std::max(visibleCount, (size_t)1) * sizeof(GLuint);
+	if (visibleSize > _visibleCapacity) {
+		glDeleteBuffers(1, &_visibleBuffer);
+		glCreateBuffers(1, &_visibleBuffer);
+		_visibleCapacity = std::max(visibleSize, _visibleCapacity * 2);
+		glNamedBufferStorage(_visibleBuffer, _visibleCapacity, nullptr, 0);
+	}
+
+	// Orphan the old commands rather than waiting for last frame's draws to finish with them
+	size_t size = std::max(commands.size(), (size_t)1) * sizeof(DrawCommand);
+	if (_commandBuffer == 0) {
+		glCreateBuffers(1, &_commandBuffer);
+	}
+	_commandCapacity = std::max(_commandCapacity, size);
+	glNamedBufferData(_commandBuffer, _commandCapacity, nullptr, GL_STREAM_DRAW);
+	if (!commands.empty()) {
+		glNamedBufferSubData(_commandBuffer, 0, commands.size() * sizeof(DrawCommand), commands.data());
+	}
+
+	_stats.Batches = (int)commands.size();
+}
+
+void GpuCuller::Cull(const glm::mat4& viewProjection)
+{
+	if (!_isValid || _stats.Objects == 0) {
+		return;
+	}
+
+	_cullShader->Bind();
+	_cullShader->SetUniformMatrix("u_ViewProjection", viewProjection);
+	_cullShader->SetUniformMatrix("u_HiZViewProjection", _hiZViewProjection);
+	_cullShader->SetUniform("u_HiZSize", _hiZSize);
+	_cullShader->SetUniform("u_HiZLevels", _hiZLevels);
+	_cullShader->SetUniform("u_UseHiZ", _hiZValid ? 1 : 0);
+	// Free slots are skipped by the shader, so we dispatch over every slot rather than just the live ones
+	uint32_t slotCount = (uint32_t)_cullObjects.size();
+	_cullShader->SetUniform("u_ObjectCount", slotCount);
+
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, CULL_OBJECT_BINDING, _cullObjectBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, VISIBLE_BINDING, _visibleBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, COMMAND_BINDING, _commandBuffer);
+	if (_hiZValid) {
+		glBindTextureUnit(0, _hiZTexture);
+	}
+
+	glDispatchCompute((slotCount + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE, 1, 1);
+	// Draws read the instance counts as commands, and the visible list from the vertex shader
+	glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+}
+
+void GpuCuller::BuildHiZ(GLuint depthTexture, const glm::ivec2& size, const glm::mat4& viewProjection)
+{
+	if (!_isValid || depthTexture == 0) {
+		return;
+	}
+
+	// The first level is half the size of the depth buffer, the full size would be a copy of the depth buffer
+	glm::ivec2 levelSize = glm::max(size / 2, glm::ivec2(1));
+	if (levelSize.x > _hiZAllocatedSize.x || levelSize.y > _hiZAllocatedSize.y) {
+		if (_hiZTexture != 0) {
+			glDeleteTextures(1, &_hiZTexture);
+		}
+		_hiZAllocatedSize = glm::max(levelSize, _hiZAllocatedSize);
+		int levels = (int)glm::floor(glm::log2((float)glm::max(_hiZAllocatedSize.x, _hiZAllocatedSize.y))) + 1;
+		glCreateTextures(GL_TEXTURE_2D, 1, &_hiZTexture);
+		glTextureStorage2D(_hiZTexture, levels, GL_R32F, _hiZAllocatedSize.x, _hiZAllocatedSize.y);
+		glTextureParameteri(_hiZTexture, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+		glTextureParameteri(_hiZTexture, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTextureParameteri(_hiZTexture, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTextureParameteri(_hiZTexture, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	}
+	_hiZLevels = (int)glm::floor(glm::log2((float)glm::max(levelSize.x, levelSize.y))) + 1;
+
+	_hiZShader->Bind();
+	glm::ivec2 sourceSize = size;
+	for (int level = 0; level < _hiZLevels; level++) {
+		// The first level reads from the depth buffer, the rest from the level above them
+		glBindTextureUnit(0, level == 0 ? depthTexture : _hiZTexture);
+		_hiZShader->SetUniform("u_SourceLevel", level == 0 ? 0 : level - 1);
+		_hiZShader->SetUniform("u_SourceSize", sourceSize);
+		_hiZShader->SetUniform("u_DestSize", levelSize);
+		glBindImageTexture(0, _hiZTexture, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+
+		glDispatchCompute((levelSize.x + HIZ_GROUP_SIZE - 1) / HIZ_GROUP_SIZE, (levelSize.y + HIZ_GROUP_SIZE - 1) / HIZ_GROUP_SIZE, 1);
+		glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+
+		sourceSize = levelSize;
+		levelSize  = glm::max(levelSize / 2, glm::ivec2(1));
+	}
+	glBindImageTexture(0, 0, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+
+	_hiZSize           = glm::max(size / 2, glm::ivec2(1));
+	_hiZViewProjection = viewProjection;
+	_hiZValid          = true;
+}
+
+void GpuCuller::InvalidateHiZ()
+{
+	_hiZValid = false;
+}
+
+void GpuCuller::BindForDrawing(int drawDataBinding) const
+{
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, drawDataBinding, _drawDataBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, VISIBLE_BINDING, _visibleBuffer);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, _commandBuffer);
+}
+
+const GpuCuller::Stats& GpuCuller::GetStats() const
+{
+	return _stats;
+}
+
+size_t GpuCuller::_UploadSlots(GLuint& buffer, size_t& capacity, const uint8_t* data, size_t count, size_t stride, std::vector<uint32_t>& dirty)
+{
+	size_t size = count * stride;
+
+	// Grow by doubling, so that a scene that keeps adding objects doesn't reallocate every frame
+	if (size > capacity || buffer == 0) {
+		glDeleteBuffers(1, &buffer);
+		glCreateBuffers(1, &buffer);
+		capacity = std::max(std::max(size, capacity * 2), stride);
+		glNamedBufferStorage(buffer, capacity, nullptr, GL_DYNAMIC_STORAGE_BIT);
+		if (size > 0) {
+			glNamedBufferSubData(buffer, 0, size, data);
+		}
+		dirty.clear();
+		return size;
+	}
+
+	// Merge neighbouring slots into a single upload, most frames only a few objects will have changed
+	std::sort(dirty.begin(), dirty.end());
+	dirty.erase(std::unique(dirty.begin(), dirty.end()), dirty.end());
+	size_t uploaded = 0;
+	for (size_t ix = 0; ix < dirty.size();) {
+		uint32_t rangeStart = dirty[ix];
+		uint32_t rangeEnd   = rangeStart + 1;
+		while (++ix < dirty.size() && dirty[ix] == rangeEnd) {
+			rangeEnd++;
+		}
+		size_t offset = rangeStart * stride;
+		size_t rangeSize = (rangeEnd - rangeStart) * stride;
+		glNamedBufferSubData(buffer, offset, rangeSize, data + offset);
+		uploaded += rangeSize;
+	}
+	dirty.clear();
+	return uploaded;
+}
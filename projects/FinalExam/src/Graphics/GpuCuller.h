@@ -0,0 +1,173 @@
+#pragma once
+#include <vector>
+#include <GLM/glm.hpp>
+#include <glad/glad.h>
+
+#include "Graphics/ShaderProgram.h"
+#include "Utils/Macros.h"
+
+/**
+ * Culls objects on the GPU, and writes the survivors straight into indirect draw arguments
+ *
+ * Objects live in persistent slots, which callers keep for as long as the object exists and only
+ * rewrite when something about the object changes, so only changed slots are ever uploaded. Each
+ * object belongs to a batch, which is a single indirect draw command, and has a range of the
+ * visible list reserved for it. Every frame a compute pass tests each object against the view
+ * frustum and a Hi-Z pyramid built from the previous frame's depth buffer, and appends the ones that
+ * pass to their batch's range, bumping the command's instance count as it goes. The CPU never sees
+ * the results, it just issues one indirect draw per batch
+ *
+ * Vertex shaders should look up their object with VisibleObjects[u_BaseInstance + gl_InstanceID],
+ * where u_BaseInstance is the first slot of the batch's range, see vertex_shaders/basic_gpu_culled.glsl
+ *
+ * Needs compute shaders and indirect draws, which our 4.6 context always has
+ */
+class GpuCuller final {
+public:
+	MAKE_PTRS(GpuCuller);
+	NO_COPY(GpuCuller);
+	NO_MOVE(GpuCuller);
+
+	// The shader storage binding that the visible list is bound to for drawing
+	static const int VISIBLE_BINDING = 11;
+
+	/**
+	 * An object's bounds and batch, matches CullObject in compute_shaders/gpu_cull.glsl
+	 */
+	struct CullObject {
+		// World space center of the object's bounding box
+		glm::vec4  Center;
+		// Half size of the bounding box along each world axis
+		glm::vec4  Extents;
+		// x is the index of the object's batch, y is the first slot in the visible list for that
+		// batch, z is 1 if the object has no bounds and should never be culled, and w is 1 if the
+		// slot is free and should be skipped
+		glm::uvec4 Batch;
+	};
+
+	/**
+	 * Matches DrawElementsIndirectCommand. Meshes without an index buffer read the first four values
+	 * as a DrawArraysIndirectCommand, so BaseVertex holds their base instance instead
+	 */
+	struct DrawCommand {
+		uint32_t Count;
+		uint32_t InstanceCount;
+		uint32_t First;
+		uint32_t BaseVertex;
+		uint32_t BaseInstance;
+	};
+
+	/**
+	 * Statistics about the current frame, for debugging
+	 */
+	struct Stats {
+		int Objects       = 0;
+		int Batches       = 0;
+		// How much object data had to be uploaded this frame
+		int UploadedBytes = 0;
+	};
+
+	/**
+	 * @param drawDataStride The size of the per object data that the vertex shader reads, see SetDrawData
+	 */
+	GpuCuller(size_t drawDataStride);
+	~GpuCuller();
+
+	/**
+	 * Returns true if all of the culling shaders compiled, the CPU path should be used if not
+	 */
+	bool IsValid() const;
+
+	/**
+	 * Reserves a slot for an object, the slot is skipped by culling until SetCullObject is called
+	 * @returns The index of the slot
+	 */
+	uint32_t AllocateSlot();
+	/**
+	 * Releases a slot so that it can be reused, the object in it will no longer be drawn
+	 */
+	void FreeSlot(uint32_t slot);
+	/**
+	 * Releases every slot (ex: when the scene changes)
+	 */
+	void Clear();
+	/**
+	 * Sets the bounds and batch of the object in a slot, sent to the GPU by the next call to Upload
+	 */
+	void SetCullObject(uint32_t slot, const CullObject& object);
+	/**
+	 * Sets the data that the vertex shader reads for the object in a slot, sent to the GPU by the next call to Upload
+	 * @param drawData The object's data, drawDataStride bytes long
+	 */
+	void SetDrawData(uint32_t slot, const void* drawData);
+	/**
+	 * Uploads the slots that have changed since the last upload
+	 */
+	void Upload();
+	/**
+	 * Sets the draw commands for this frame, instance counts will be filled in by Cull
+	 * @param visibleCount The size of the visible list, every batch's range has to fit inside it
+	 */
+	void SetCommands(const std::vector<DrawCommand>& commands, size_t visibleCount);
+
+	/**
+	 * Tests every object and builds the visible list and draw commands for the given camera
+	 * @param viewProjection The view projection matrix of the camera we are drawing for
+	 */
+	void Cull(const glm::mat4& viewProjection);
+	/**
+	 * Builds the Hi-Z pyramid that the next call to Cull will test against
+	 * @param depthTexture The depth texture to build the pyramid from
+	 * @param size The size of the region of the depth texture that holds this frame's depth
+	 * @param viewProjection The view projection that the depth was rendered with
+	 */
+	void BuildHiZ(GLuint depthTexture, const glm::ivec2& size, const glm::mat4& viewProjection);
+	/**
+	 * Stops occlusion culling until the next call to BuildHiZ, should be used whenever the last
+	 * frame's depth can't be trusted (ex: after a resize or a scene change)
+	 */
+	void InvalidateHiZ();
+
+	/**
+	 * Binds the per object draw data to the given shader storage binding, the visible list to
+	 * VISIBLE_BINDING, and the draw commands as the indirect buffer
+	 */
+	void BindForDrawing(int drawDataBinding) const;
+	const Stats& GetStats() const;
+
+protected:
+	GLuint _cullObjectBuffer;
+	GLuint _drawDataBuffer;
+	GLuint _visibleBuffer;
+	GLuint _commandBuffer;
+	size_t _objectCapacity;
+	size_t _drawDataCapacity;
+	size_t _visibleCapacity;
+	size_t _commandCapacity;
+	size_t _drawDataStride;
+	// Copies of every slot, so that a buffer can be refilled when it grows
+	std::vector<CullObject> _cullObjects;
+	std::vector<uint8_t>    _drawData;
+	std::vector<uint32_t>   _freeSlots;
+	// The slots that have changed since the last upload, may hold duplicates
+	std::vector<uint32_t>   _dirtyCullObjects;
+	std::vector<uint32_t>   _dirtyDrawData;
+
+	GLuint     _hiZTexture;
+	glm::ivec2 _hiZAllocatedSize;
+	glm::ivec2 _hiZSize;
+	int        _hiZLevels;
+	bool       _hiZValid;
+	glm::mat4  _hiZViewProjection;
+
+	ShaderProgram::Sptr _cullShader;
+	ShaderProgram::Sptr _hiZShader;
+	bool  _isValid;
+	Stats _stats;
+
+	/**
+	 * Uploads the dirty slots, or every slot if the buffer had to grow, and clears the dirty list
+	 * @returns The number of bytes that were uploaded
+	 */
+	static size_t _UploadSlots(GLuint& buffer, size_t& capacity, const uint8_t* data, size_t count, size_t stride, std::vector<uint32_t>& dirty);
+};
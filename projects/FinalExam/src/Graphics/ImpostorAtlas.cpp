@@ -0,0 +1,121 @@
+#include "Graphics/ImpostorAtlas.h"
+#include <GLM/gtc/matrix_transform.hpp>
+
+ImpostorAtlas::ImpostorAtlas(uint32_t frameSize, uint32_t framesPerSide, uint32_t slotsPerSide) :
+	_frameSize(frameSize),
+	_framesPerSide(framesPerSide),
+	_slotsPerSide(slotsPerSide),
+	_usedSlots(0),
+	_framebuffer(nullptr)
+{
+	LOG_ASSERT(frameSize > 0 && framesPerSide > 0 && slotsPerSide > 0, "Impostor atlas dimensions must all be > 0");
+
+	FramebufferDescriptor descriptor;
+	descriptor.Width  = frameSize * framesPerSide * slotsPerSide;
+	descriptor.Height = descriptor.Width;
+	descriptor.RenderTargets[RenderTargetAttachment::Depth]  = RenderTargetDescriptor(RenderTargetType::Depth32);
+	descriptor.RenderTargets[RenderTargetAttachment::Color0] = RenderTargetDescriptor(RenderTargetType::ColorRgba8); // Albedo, coverage
+	descriptor.RenderTargets[RenderTargetAttachment::Color1] = RenderTargetDescriptor(RenderTargetType::ColorRgba8); // Normals, metallic
+	descriptor.RenderTargets[RenderTargetAttachment::Color2] = RenderTargetDescriptor(RenderTargetType::ColorRgba8); // Emissive
+	_framebuffer = std::make_shared<Framebuffer>(descriptor);
+}
+
+int ImpostorAtlas::Allocate()
+{
+	if (IsFull()) {
+		return -1;
+	}
+	int slot = _usedSlots++;
+
+	// Clear the whole slot, so that frames start out with no coverage
+	uint32_t slotSize = _frameSize * _framesPerSide;
+	glm::ivec2 origin = glm::ivec2(slot % _slotsPerSide, slot / _slotsPerSide) * (int)slotSize;
+	const float clearColor[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	const float clearNormal[4] = { 0.5f, 0.5f, 1.0f, 0.0f };
+	const float clearDepth = 1.0f;
+	glClearTexSubImage(_framebuffer->GetTextureAttachment(RenderTargetAttachment::Color0)->GetHandle(), 0, origin.x, origin.y, 0, slotSize, slotSize, 1, GL_RGBA, GL_FLOAT, clearColor);
+	glClearTexSubImage(_framebuffer->GetTextureAttachment(RenderTargetAttachment::Color1)->GetHandle(), 0, origin.x, origin.y, 0, slotSize, slotSize, 1, GL_RGBA, GL_FLOAT, clearNormal);
+	glClearTexSubImage(_framebuffer->GetTextureAttachment(RenderTargetAttachment::Color2)->GetHandle(), 0, origin.x, origin.y, 0, slotSize, slotSize, 1, GL_RGBA, GL_FLOAT, clearColor);
+	glClearTexSubImage(_framebuffer->GetTextureAttachment(RenderTargetAttachment::Depth)->GetHandle(),  0, origin.x, origin.y, 0, slotSize, slotSize, 1, GL_DEPTH_COMPONENT, GL_FLOAT, &clearDepth);
+
+	return slot;
+}
+
+bool ImpostorAtlas::IsFull() const
+{
+	return _usedSlots >= GetSlotCount();
+}
+
+int ImpostorAtlas::GetSlotCount() const
+{
+	return (int)(_slotsPerSide * _slotsPerSide);
+}
+
+uint32_t ImpostorAtlas::GetFrameSize() const
+{
+	return _frameSize;
+}
+
+uint32_t ImpostorAtlas::GetFramesPerSide() const
+{
+	return _framesPerSide;
+}
+
+uint32_t ImpostorAtlas::GetSlotsPerSide() const
+{
+	return _slotsPerSide;
+}
+
+const Framebuffer::Sptr& ImpostorAtlas::GetFramebuffer() const
+{
+	return _framebuffer;
+}
+
+glm::ivec4 ImpostorAtlas::GetFrameViewport(int slot, uint32_t frameX, uint32_t frameY) const
+{
+	uint32_t slotSize = _frameSize * _framesPerSide;
+	return glm::ivec4(
+		(slot % _slotsPerSide) * slotSize + frameX * _frameSize,
+		(slot / _slotsPerSide) * slotSize + frameY * _frameSize,
+		_frameSize,
+		_frameSize
+	);
+}
+
+glm::vec3 ImpostorAtlas::GetFrameDirection(uint32_t frameX, uint32_t frameY) const
+{
+	return OctahedralDecode((glm::vec2(frameX, frameY) + 0.5f) / (float)_framesPerSide);
+}
+
+glm::mat4 ImpostorAtlas::GetFrameView(const glm::vec3& direction, const glm::vec3& center, float radius)
+{
+	// Looking straight up or down would make the up vector degenerate
+	glm::vec3 up = glm::abs(direction.y) > 0.999f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+	return glm::lookAt(center + direction * radius * 2.0f, center, up);
+}
+
+glm::mat4 ImpostorAtlas::GetFrameProjection(float radius)
+{
+	// The eye sits 2 radii from the center, so the sphere is between 1 and 3 radii away
+	return glm::ortho(-radius, radius, -radius, radius, radius * 0.5f, radius * 3.5f);
+}
+
+glm::vec2 ImpostorAtlas::OctahedralEncode(const glm::vec3& direction)
+{
+	glm::vec3 n = direction / (glm::abs(direction.x) + glm::abs(direction.y) + glm::abs(direction.z));
+	glm::vec2 result = glm::vec2(n.x, n.y);
+	if (n.z < 0.0f) {
+		result = (1.0f - glm::abs(glm::vec2(n.y, n.x))) * glm::vec2(n.x >= 0.0f ? 1.0f : -1.0f, n.y >= 0.0f ? 1.0f : -1.0f);
+	}
+	return result * 0.5f + 0.5f;
+}
+
+glm::vec3 ImpostorAtlas::OctahedralDecode(const glm::vec2& uv)
+{
+	glm::vec2 f = uv * 2.0f - 1.0f;
+	glm::vec3 n = glm::vec3(f.x, f.y, 1.0f - glm::abs(f.x) - glm::abs(f.y));
+	float t = glm::clamp(-n.z, 0.0f, 1.0f);
+	n.x += n.x >= 0.0f ? -t : t;
+	n.y += n.y >= 0.0f ? -t : t;
+	return glm::normalize(n);
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include <vector>
+#include <GLM/glm.hpp>
+
+#include "Graphics/Framebuffer.h"
+#include "Utils/Macros.h"
+
+/**
+ * Stores octahedral impostors, which are pictures of a mesh taken from many directions around it
+ *
+ * The atlas is split into square slots, with one impostor per slot. Each slot is a grid of frames,
+ * and the frame at grid position (x, y) looks at the mesh from the direction found by decoding the
+ * center of that cell as an octahedral map. Frames hold the mesh's G-buffer data, so impostors can
+ * go through the same lighting as everything else:
+ *   Color0 - albedo, with coverage in alpha
+ *   Color1 - normals in the frame's view space, with metallic in alpha
+ *   Color2 - emissive
+ *
+ * Baking is done by the render layer, since the material shaders need its uniform buffers
+ */
+class ImpostorAtlas final {
+public:
+	MAKE_PTRS(ImpostorAtlas);
+	NO_COPY(ImpostorAtlas);
+	NO_MOVE(ImpostorAtlas);
+
+	/**
+	 * Creates a new atlas
+	 * @param frameSize The width and height of a single frame in pixels
+	 * @param framesPerSide The number of frames along each side of an impostor's grid
+	 * @param slotsPerSide The number of impostors along each side of the atlas
+	 */
+	ImpostorAtlas(uint32_t frameSize = 64, uint32_t framesPerSide = 8, uint32_t slotsPerSide = 4);
+	~ImpostorAtlas() = default;
+
+	/**
+	 * Reserves a slot in the atlas and clears it
+	 * @returns The slot index, or -1 if the atlas is full
+	 */
+	int Allocate();
+	bool IsFull() const;
+	int GetSlotCount() const;
+
+	uint32_t GetFrameSize() const;
+	uint32_t GetFramesPerSide() const;
+	uint32_t GetSlotsPerSide() const;
+	const Framebuffer::Sptr& GetFramebuffer() const;
+
+	/**
+	 * Gets the viewport of a single frame in the atlas, as x, y, width, height in pixels
+	 */
+	glm::ivec4 GetFrameViewport(int slot, uint32_t frameX, uint32_t frameY) const;
+	/**
+	 * Gets the direction from the mesh towards the camera for the frame at the given grid position
+	 */
+	glm::vec3 GetFrameDirection(uint32_t frameX, uint32_t frameY) const;
+
+	/**
+	 * Gets the view matrix to bake a frame with, looking at a bounding sphere from the given direction.
+	 * The view's right and up axes match the basis in shaders/fragments/impostor_common.glsl
+	 */
+	static glm::mat4 GetFrameView(const glm::vec3& direction, const glm::vec3& center, float radius);
+	/**
+	 * Gets the projection matrix to bake frames with, which fits a bounding sphere exactly
+	 */
+	static glm::mat4 GetFrameProjection(float radius);
+
+	/**
+	 * Maps a unit direction to [0, 1] texture coordinates on an octahedron, and back again
+	 */
+	static glm::vec2 OctahedralEncode(const glm::vec3& direction);
+	static glm::vec3 OctahedralDecode(const glm::vec2& uv);
+
+protected:
+	uint32_t          _frameSize;
+	uint32_t          _framesPerSide;
+	uint32_t          _slotsPerSide;
+	int               _usedSlots;
+	Framebuffer::Sptr _framebuffer;
+};
@@ -0,0 +1,238 @@
+#include "Graphics/OcclusionCuller.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <xmmintrin.h>
+
+// Anything closer than this to the eye is treated as crossing the near plane
+static const float MIN_W = 1e-4f;
+
+OcclusionCuller::OcclusionCuller(int width, int height) :
+	_width(0),
+	_height(0),
+	_tilesX(0),
+	_tilesY(0),
+	_viewProjection(glm::mat4(1.0f)),
+	_depth(std::vector<float>()),
+	_tileDepth(std::vector<float>()),
+	_stats(Stats())
+{
+	Resize(width, height);
+}
+
+void OcclusionCuller::Resize(int width, int height)
+{
+	_tilesX = std::max(1, (width  + TILE_SIZE - 1) / TILE_SIZE);
+	_tilesY = std::max(1, (height + TILE_SIZE - 1) / TILE_SIZE);
+	_width  = _tilesX * TILE_SIZE;
+	_height = _tilesY * TILE_SIZE;
+	_depth.assign(_width * _height, 0.0f);
+	_tileDepth.assign(_tilesX * _tilesY, 0.0f);
+}
+
+glm::ivec2 OcclusionCuller::GetSize() const
+{
+	return glm::ivec2(_width, _height);
+}
+
+void OcclusionCuller::BeginFrame(const glm::mat4& viewProjection)
+{
+	_viewProjection = viewProjection;
+	std::fill(_depth.begin(), _depth.end(), 0.0f);
+	std::fill(_tileDepth.begin(), _tileDepth.end(), 0.0f);
+	_stats = Stats();
+}
+
+void OcclusionCuller::RenderOccluder(const glm::mat4& model, const std::vector<glm::vec3>& triangles)
+{
+	glm::mat4 mvp = _viewProjection * model;
+	for (size_t ix = 0; ix + 2 < triangles.size(); ix += 3) {
+		_RasterizeTriangle(
+			mvp * glm::vec4(triangles[ix], 1.0f),
+			mvp * glm::vec4(triangles[ix + 1], 1.0f),
+			mvp * glm::vec4(triangles[ix + 2], 1.0f)
+		);
+	}
+	_stats.OccludersRendered++;
+}
+
+void OcclusionCuller::_RasterizeTriangle(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c)
+{
+	// Clipping is more trouble than it's worth here, dropping the triangle just means we cull less
+	if (a.w < MIN_W || b.w < MIN_W || c.w < MIN_W ||
+		a.z < -a.w  || b.z < -b.w  || c.z < -c.w) {
+		return;
+	}
+
+	// Project into pixel space, keeping 1/w as our depth
+	glm::vec3 v[3];
+	const glm::vec4* clip[3] = { &a, &b, &c };
+	for (int ix = 0; ix < 3; ix++) {
+		float invW = 1.0f / clip[ix]->w;
+		v[ix] = glm::vec3(
+			(clip[ix]->x * invW * 0.5f + 0.5f) * _width,
+			(clip[ix]->y * invW * 0.5f + 0.5f) * _height,
+			invW
+		);
+	}
+
+	// We don't care about facing, so make every triangle counter clockwise
+	float area = (v[1].x - v[0].x) * (v[2].y - v[0].y) - (v[1].y - v[0].y) * (v[2].x - v[0].x);
+	if (std::abs(area) < 1e-8f) return;
+	if (area < 0.0f) {
+		std::swap(v[1], v[2]);
+		area = -area;
+	}
+
+	int minX = std::max((int)std::floor(std::min({ v[0].x, v[1].x, v[2].x })), 0);
+	int maxX = std::min((int)std::ceil (std::max({ v[0].x, v[1].x, v[2].x })), _width - 1);
+	int minY = std::max((int)std::floor(std::min({ v[0].y, v[1].y, v[2].y })), 0);
+	int maxY = std::min((int)std::ceil (std::max({ v[0].y, v[1].y, v[2].y })), _height - 1);
+	if (minX > maxX || minY > maxY) return;
+
+	// Edge functions in the form E(x, y) = A*x + B*y + C, positive on the inside of the edge.
+	// Edge ix is opposite vertex ix, so E / area is the barycentric weight of that vertex
+	float edgeA[3], edgeB[3], edgeC[3];
+	for (int ix = 0; ix < 3; ix++) {
+		const glm::vec3& p0 = v[(ix + 1) % 3];
+		const glm::vec3& p1 = v[(ix + 2) % 3];
+		edgeA[ix] = p0.y - p1.y;
+		edgeB[ix] = p1.x - p0.x;
+		edgeC[ix] = p0.x * p1.y - p0.y * p1.x;
+	}
+
+	// Depth is linear in screen space, so it's just another plane equation
+	float invArea = 1.0f / area;
+	float depthA = (v[0].z * edgeA[0] + v[1].z * edgeA[1] + v[2].z * edgeA[2]) * invArea;
+	float depthB = (v[0].z * edgeB[0] + v[1].z * edgeB[1] + v[2].z * edgeB[2]) * invArea;
+	float depthC = (v[0].z * edgeC[0] + v[1].z * edgeC[1] + v[2].z * edgeC[2]) * invArea;
+
+	const __m128 laneOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+	const __m128 zero = _mm_setzero_ps();
+
+	// Our width is a multiple of the tile size, so 4 pixel groups never run off the end of a row
+	int startX = minX & ~3;
+	for (int y = minY; y <= maxY; y++) {
+		float py = y + 0.5f;
+		__m128 row0  = _mm_set1_ps(edgeB[0] * py + edgeC[0]);
+		__m128 row1  = _mm_set1_ps(edgeB[1] * py + edgeC[1]);
+		__m128 row2  = _mm_set1_ps(edgeB[2] * py + edgeC[2]);
+		__m128 rowZ  = _mm_set1_ps(depthB * py + depthC);
+		float* depthRow = _depth.data() + y * _width;
+
+		for (int x = startX; x <= maxX; x += 4) {
+			__m128 px = _mm_add_ps(_mm_set1_ps((float)x), laneOffsets);
+
+			__m128 e0 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(edgeA[0]), px), row0);
+			__m128 e1 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(edgeA[1]), px), row1);
+			__m128 e2 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(edgeA[2]), px), row2);
+			__m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_cmpge_ps(e1, zero)), _mm_cmpge_ps(e2, zero));
+			if (_mm_movemask_ps(inside) == 0) continue;
+
+			// Depths are always positive, so masked out lanes become 0 and lose to whatever is in the buffer
+			__m128 depth = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(depthA), px), rowZ);
+			depth = _mm_and_ps(inside, depth);
+			_mm_storeu_ps(depthRow + x, _mm_max_ps(_mm_loadu_ps(depthRow + x), depth));
+		}
+	}
+
+	_stats.TrianglesRasterized++;
+}
+
+void OcclusionCuller::EndFrame()
+{
+	for (int ty = 0; ty < _tilesY; ty++) {
+		for (int tx = 0; tx < _tilesX; tx++) {
+			const float* tile = _depth.data() + (ty * TILE_SIZE) * _width + tx * TILE_SIZE;
+			__m128 farthest = _mm_loadu_ps(tile);
+			for (int y = 0; y < TILE_SIZE; y++) {
+				const float* row = tile + y * _width;
+				farthest = _mm_min_ps(farthest, _mm_min_ps(_mm_loadu_ps(row), _mm_loadu_ps(row + 4)));
+			}
+			// Reduce the 4 lanes down to one
+			farthest = _mm_min_ps(farthest, _mm_shuffle_ps(farthest, farthest, _MM_SHUFFLE(1, 0, 3, 2)));
+			farthest = _mm_min_ps(farthest, _mm_shuffle_ps(farthest, farthest, _MM_SHUFFLE(2, 3, 0, 1)));
+			_tileDepth[ty * _tilesX + tx] = _mm_cvtss_f32(farthest);
+		}
+	}
+}
+
+bool OcclusionCuller::IsVisible(const glm::vec3& center, const glm::vec3& extents) const
+{
+	// Project the corners of the box, building each one from the projected center and axes
+	glm::vec4 clipCenter = _viewProjection * glm::vec4(center, 1.0f);
+	glm::vec4 axes[3] = {
+		_viewProjection[0] * extents.x,
+		_viewProjection[1] * extents.y,
+		_viewProjection[2] * extents.z
+	};
+
+	glm::vec2 screenMin = glm::vec2( FLT_MAX);
+	glm::vec2 screenMax = glm::vec2(-FLT_MAX);
+	float nearest = 0.0f;
+	for (int ix = 0; ix < 8; ix++) {
+		glm::vec4 corner = clipCenter +
+			((ix & 1) ? axes[0] : -axes[0]) +
+			((ix & 2) ? axes[1] : -axes[1]) +
+			((ix & 4) ? axes[2] : -axes[2]);
+
+		// Boxes that cross the near plane could be covering the whole screen
+		if (corner.w < MIN_W || corner.z < -corner.w) {
+			return true;
+		}
+
+		float invW = 1.0f / corner.w;
+		glm::vec2 screen = (glm::vec2(corner) * invW * 0.5f + 0.5f) * glm::vec2(_width, _height);
+		screenMin = glm::min(screenMin, screen);
+		screenMax = glm::max(screenMax, screen);
+		nearest = std::max(nearest, invW);
+	}
+
+	int minX = std::max((int)std::floor(screenMin.x), 0);
+	int maxX = std::min((int)std::floor(screenMax.x), _width - 1);
+	int minY = std::max((int)std::floor(screenMin.y), 0);
+	int maxY = std::min((int)std::floor(screenMax.y), _height - 1);
+	// Off screen boxes are left for frustum culling to deal with
+	if (minX > maxX || minY > maxY) return true;
+
+	const __m128 laneOffsets = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+	const __m128 boxDepth = _mm_set1_ps(nearest);
+
+	for (int ty = minY / TILE_SIZE; ty <= maxY / TILE_SIZE; ty++) {
+		for (int tx = minX / TILE_SIZE; tx <= maxX / TILE_SIZE; tx++) {
+			// Everything in this tile is in front of the box, no need to look at individual pixels
+			if (_tileDepth[ty * _tilesX + tx] > nearest) continue;
+
+			int x0 = std::max(minX, tx * TILE_SIZE);
+			int x1 = std::min(maxX, tx * TILE_SIZE + TILE_SIZE - 1);
+			int y0 = std::max(minY, ty * TILE_SIZE);
+			int y1 = std::min(maxY, ty * TILE_SIZE + TILE_SIZE - 1);
+			__m128 laneMin = _mm_set1_ps((float)x0);
+			__m128 laneMax = _mm_set1_ps((float)x1);
+
+			for (int y = y0; y <= y1; y++) {
+				const float* depthRow = _depth.data() + y * _width;
+				for (int x = x0 & ~3; x <= x1; x += 4) {
+					__m128 px = _mm_add_ps(_mm_set1_ps((float)x), laneOffsets);
+					__m128 inRange = _mm_and_ps(_mm_cmpge_ps(px, laneMin), _mm_cmple_ps(px, laneMax));
+					__m128 visible = _mm_and_ps(inRange, _mm_cmple_ps(_mm_loadu_ps(depthRow + x), boxDepth));
+					if (_mm_movemask_ps(visible) != 0) {
+						return true;
+					}
+				}
+			}
+		}
+	}
+
+	return false;
+}
+
+const std::vector<float>& OcclusionCuller::GetDepth() const
+{
+	return _depth;
+}
+
+const OcclusionCuller::Stats& OcclusionCuller::GetStats() const
+{
+	return _stats;
+}
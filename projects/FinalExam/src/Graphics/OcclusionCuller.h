@@ -0,0 +1,91 @@
+#pragma once
+#include <vector>
+#include <GLM/glm.hpp>
+
+#include "Utils/Macros.h"
+
+/**
+ * A software occlusion culler that runs entirely on the CPU
+ *
+ * Occluder triangles are rasterized into a low resolution depth buffer with SSE, 4 pixels at a
+ * time. Each 8x8 tile of the buffer also stores its farthest depth, so that bounding boxes can
+ * usually be rejected by looking at a handful of tiles instead of every pixel that they cover.
+ *
+ * Depths are stored as 1/w (so 0 is infinitely far away), since 1/w can be interpolated linearly
+ * in screen space. Occluders that cross the near plane are skipped, and boxes that cross it are
+ * always visible, so the culler only ever errs on the side of drawing something
+ */
+class OcclusionCuller final {
+public:
+	MAKE_PTRS(OcclusionCuller);
+	NO_COPY(OcclusionCuller);
+	NO_MOVE(OcclusionCuller);
+
+	static const int TILE_SIZE = 8;
+
+	/**
+	 * Statistics about the current frame, for debugging
+	 */
+	struct Stats {
+		int OccludersRendered   = 0;
+		int TrianglesRasterized = 0;
+	};
+
+	/**
+	 * Creates a new occlusion culler, the dimensions are rounded up to a multiple of the tile size
+	 * @param width The width of the depth buffer in pixels
+	 * @param height The height of the depth buffer in pixels
+	 */
+	OcclusionCuller(int width = 256, int height = 128);
+	~OcclusionCuller() = default;
+
+	/**
+	 * Resizes the depth buffer, the dimensions are rounded up to a multiple of the tile size
+	 */
+	void Resize(int width, int height);
+	glm::ivec2 GetSize() const;
+
+	/**
+	 * Clears the depth buffer and sets the view projection that occluders and tests will use
+	 */
+	void BeginFrame(const glm::mat4& viewProjection);
+	/**
+	 * Rasterizes an occluder into the depth buffer
+	 * @param model The model matrix of the occluder
+	 * @param triangles The model space triangles of the occluder, 3 vertices per triangle
+	 */
+	void RenderOccluder(const glm::mat4& model, const std::vector<glm::vec3>& triangles);
+	/**
+	 * Updates the per tile depths, must be called after all occluders have been rendered and before testing
+	 */
+	void EndFrame();
+
+	/**
+	 * Tests a world space bounding box against the depth buffer. This does not modify the culler,
+	 * so many tests can run in parallel once EndFrame has been called
+	 * @param center The center of the box in world space
+	 * @param extents The half size of the box along each world axis
+	 * @returns False if the box is completely hidden behind occluders
+	 */
+	bool IsVisible(const glm::vec3& center, const glm::vec3& extents) const;
+
+	/**
+	 * Gets the depth buffer (as 1/w), row by row starting from the bottom of the screen
+	 */
+	const std::vector<float>& GetDepth() const;
+	const Stats& GetStats() const;
+
+protected:
+	int                _width;
+	int                _height;
+	int                _tilesX;
+	int                _tilesY;
+	glm::mat4          _viewProjection;
+	// Nearest occluder depth for each pixel
+	std::vector<float> _depth;
+	// Farthest occluder depth in each tile
+	std::vector<float> _tileDepth;
+	Stats              _stats;
+
+	void _RasterizeTriangle(const glm::vec4& a, const glm::vec4& b, const glm::vec4& c);
+};
@@ -0,0 +1,324 @@
+#include "Graphics/RenderGraph.h"
+#include <algorithm>
+#include "Logging.h"
+
+RenderGraph::RenderGraph() :
+	_baseSize(glm::ivec2(0)),
+	_resources(std::vector<Resource>()),
+	_passes(std::vector<Pass>()),
+	_pool(std::vector<PooledTarget>()),
+	_output(InvalidResource),
+	_outputViewport(glm::uvec4(0)),
+	_presentOutput(true),
+	_stats(Stats()),
+	_currentGroup(""),
+	_queryFrameIndex(0),
+	_groupTimings(std::unordered_map<std::string, double>())
+{ }
+
+RenderGraph::~RenderGraph() {
+	for (auto& frame : _queryFrames) {
+		if (!frame.Queries.empty()) {
+			glDeleteQueries((GLsizei)frame.Queries.size(), frame.Queries.data());
+		}
+	}
+}
+
+void RenderGraph::Reset(const glm::ivec2& baseSize)
+{
+	// Anything still held from last frame (ex: a non-presented output) goes back into the pool
+	for (auto& resource : _resources) {
+		_Release(resource);
+	}
+
+	_baseSize = baseSize;
+	_resources.clear();
+	_passes.clear();
+	_output = InvalidResource;
+	_currentGroup = "";
+
+	for (auto& target : _pool) {
+		target.UsedThisFrame = false;
+	}
+}
+
+RenderGraph::ResourceHandle RenderGraph::Import(const std::string& name, const Framebuffer::Sptr& framebuffer)
+{
+	LOG_ASSERT(framebuffer != nullptr, "Cannot import a null framebuffer into the render graph");
+
+	Resource resource;
+	resource.Name         = name;
+	resource.Size         = framebuffer->GetSize();
+	resource.Target       = framebuffer;
+	resource.IsImported   = true;
+	resource.IsBackbuffer = false;
+	resource.LastRead     = -1;
+	resource.IsNeeded     = false;
+	_resources.push_back(resource);
+
+	return static_cast<ResourceHandle>(_resources.size() - 1);
+}
+
+RenderGraph::ResourceHandle RenderGraph::CreateTexture(const std::string& name, const TextureDescriptor& descriptor)
+{
+	Resource resource;
+	resource.Name         = name;
+	resource.Descriptor   = descriptor;
+	resource.Size         = glm::max(glm::ivec2(glm::vec2(_baseSize) * descriptor.Scale), glm::ivec2(1));
+	resource.Target       = nullptr;
+	resource.IsImported   = false;
+	resource.IsBackbuffer = false;
+	resource.LastRead     = -1;
+	resource.IsNeeded     = false;
+	_resources.push_back(resource);
+
+	return static_cast<ResourceHandle>(_resources.size() - 1);
+}
+
+void RenderGraph::SetGroup(const std::string& group)
+{
+	_currentGroup = group;
+}
+
+void RenderGraph::AddPass(const std::string& name, const std::vector<PassInput>& inputs, ResourceHandle output, const std::function<void()>& execute)
+{
+	LOG_ASSERT(output >= 0 && output < (int)_resources.size(), "Invalid output resource for pass \"{}\"", name);
+	LOG_ASSERT(!_resources[output].IsImported, "Pass \"{}\" cannot write to an imported resource", name);
+
+	Pass pass;
+	pass.Name    = name;
+	pass.Group   = _currentGroup.empty() ? name : _currentGroup;
+	pass.Inputs  = inputs;
+	pass.Output  = output;
+	pass.Execute = execute;
+	pass.IsLive  = false;
+	_passes.push_back(pass);
+}
+
+void RenderGraph::SetOutput(ResourceHandle resource, const glm::uvec4& viewport, bool present)
+{
+	_output         = resource;
+	_outputViewport = viewport;
+	_presentOutput  = present;
+}
+
+void RenderGraph::_Compile()
+{
+	// Walk backwards from the output, a pass is only live if something downstream needs its result
+	_resources[_output].IsNeeded = true;
+	for (int ix = (int)_passes.size() - 1; ix >= 0; ix--) {
+		Pass& pass = _passes[ix];
+		pass.IsLive = _resources[pass.Output].IsNeeded;
+		if (pass.IsLive) {
+			for (const auto& input : pass.Inputs) {
+				_resources[input.Resource].IsNeeded = true;
+			}
+		} else {
+			_stats.PassesCulled++;
+		}
+	}
+
+	// Determine the last live pass that reads from each resource, so we know when its target can be reused
+	for (int ix = 0; ix < (int)_passes.size(); ix++) {
+		if (_passes[ix].IsLive) {
+			for (const auto& input : _passes[ix].Inputs) {
+				_resources[input.Resource].LastRead = ix;
+			}
+		}
+	}
+
+	// If the output is a full size transient that no pass reads from, the last pass can render straight
+	// to the screen instead of needing a blit
+	Resource& output = _resources[_output];
+	output.IsBackbuffer =
+		_presentOutput && !output.IsImported && output.LastRead == -1 &&
+		output.Size == glm::ivec2(_outputViewport.z, _outputViewport.w);
+	_stats.OutputFolded = output.IsBackbuffer;
+}
+
+void RenderGraph::Execute()
+{
+	_stats = Stats();
+
+	if (_output == InvalidResource) {
+		LOG_WARN("Render graph has no output, skipping execution");
+		return;
+	}
+
+	_Compile();
+
+	// Grab the timings from the last time we used this set of queries before we overwrite them
+	QueryFrame& queries = _queryFrames[_queryFrameIndex];
+	_ResolveQueries(queries);
+	if (EnableProfiling) {
+		size_t required = (_passes.size() - _stats.PassesCulled) * 2;
+		if (queries.Queries.size() < required) {
+			size_t existing = queries.Queries.size();
+			queries.Queries.resize(required);
+			glCreateQueries(GL_TIMESTAMP, (GLsizei)(required - existing), queries.Queries.data() + existing);
+		}
+		queries.Groups.clear();
+		queries.Count = 0;
+	}
+
+	for (int ix = 0; ix < (int)_passes.size(); ix++) {
+		Pass& pass = _passes[ix];
+		if (!pass.IsLive) continue;
+
+		Resource& output = _resources[pass.Output];
+		if (output.IsBackbuffer) {
+			glBindFramebuffer(GL_FRAMEBUFFER, 0);
+			glViewport(_outputViewport.x, _outputViewport.y, _outputViewport.z, _outputViewport.w);
+		} else {
+			_Acquire(output);
+			output.Target->Bind();
+			glViewport(0, 0, output.Size.x, output.Size.y);
+		}
+
+		for (const auto& input : pass.Inputs) {
+			_resources[input.Resource].Target->BindAttachment(input.Attachment, input.Slot);
+		}
+
+		if (EnableProfiling) {
+			glQueryCounter(queries.Queries[queries.Count * 2], GL_TIMESTAMP);
+		}
+
+		pass.Execute();
+
+		if (EnableProfiling) {
+			glQueryCounter(queries.Queries[queries.Count * 2 + 1], GL_TIMESTAMP);
+			queries.Groups.push_back(pass.Group);
+			queries.Count++;
+		}
+
+		if (output.Target != nullptr) {
+			output.Target->Unbind();
+		}
+
+		// Any inputs that are no longer needed can be handed to later passes
+		for (const auto& input : pass.Inputs) {
+			Resource& resource = _resources[input.Resource];
+			if (resource.LastRead == ix) {
+				_Release(resource);
+			}
+		}
+
+		_stats.PassesExecuted++;
+	}
+
+	// If we couldn't fold the output into the last pass, we need to copy it to the screen
+	Resource& output = _resources[_output];
+	if (_presentOutput && !output.IsBackbuffer) {
+		glBlitNamedFramebuffer(
+			output.Target->GetHandle(), 0,
+			0, 0, output.Size.x, output.Size.y,
+			_outputViewport.x, _outputViewport.y, _outputViewport.x + _outputViewport.z, _outputViewport.y + _outputViewport.w,
+			GL_COLOR_BUFFER_BIT, GL_LINEAR
+		);
+		_Release(output);
+	}
+
+	if (EnableProfiling) {
+		queries.Pending = true;
+		_queryFrameIndex = (_queryFrameIndex + 1) % QUERY_FRAMES;
+	}
+
+	_TrimPool();
+	_stats.PooledTargets = (int)_pool.size();
+}
+
+const Framebuffer::Sptr& RenderGraph::GetFramebuffer(ResourceHandle resource) const
+{
+	return _resources[resource].Target;
+}
+
+glm::ivec2 RenderGraph::GetSize(ResourceHandle resource) const
+{
+	return _resources[resource].Size;
+}
+
+void RenderGraph::ClearPool()
+{
+	_pool.clear();
+}
+
+const RenderGraph::Stats& RenderGraph::GetStats() const
+{
+	return _stats;
+}
+
+const std::unordered_map<std::string, double>& RenderGraph::GetGroupTimings() const
+{
+	return _groupTimings;
+}
+
+void RenderGraph::_Acquire(Resource& resource)
+{
+	if (resource.IsImported || resource.Target != nullptr) return;
+
+	// Look for a free target with a matching size and format
+	for (auto& target : _pool) {
+		if (!target.InUse && target.Format == resource.Descriptor.Format && target.Target->GetSize() == resource.Size) {
+			target.InUse         = true;
+			target.UsedThisFrame = true;
+			resource.Target      = target.Target;
+			return;
+		}
+	}
+
+	// Nothing available, we need to make a new target
+	FramebufferDescriptor fboDescriptor;
+	fboDescriptor.Width  = resource.Size.x;
+	fboDescriptor.Height = resource.Size.y;
+	fboDescriptor.RenderTargets[RenderTargetAttachment::Color0] = RenderTargetDescriptor(resource.Descriptor.Format);
+
+	PooledTarget target;
+	target.Target        = std::make_shared<Framebuffer>(fboDescriptor);
+	target.Format        = resource.Descriptor.Format;
+	target.InUse         = true;
+	target.UsedThisFrame = true;
+	_pool.push_back(target);
+
+	resource.Target = target.Target;
+}
+
+void RenderGraph::_Release(Resource& resource)
+{
+	if (resource.IsImported || resource.Target == nullptr) return;
+
+	for (auto& target : _pool) {
+		if (target.Target == resource.Target) {
+			target.InUse = false;
+			break;
+		}
+	}
+	resource.Target = nullptr;
+}
+
+void RenderGraph::_TrimPool()
+{
+	// Targets that weren't touched this frame are stale (ex: the window was resized, or an effect was disabled)
+	_pool.erase(std::remove_if(_pool.begin(), _pool.end(), [](const PooledTarget& target) {
+		return !target.UsedThisFrame && !target.InUse;
+	}), _pool.end());
+}
+
+void RenderGraph::_ResolveQueries(QueryFrame& frame)
+{
+	if (!frame.Pending) return;
+	frame.Pending = false;
+	if (frame.Count == 0) return;
+
+	// These are a few frames old, but if the GPU is still behind we'd rather skip them than stall
+	GLint available = 0;
+	glGetQueryObjectiv(frame.Queries[frame.Count * 2 - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+	if (!available) return;
+
+	_groupTimings.clear();
+	for (int ix = 0; ix < frame.Count; ix++) {
+		GLuint64 start = 0, end = 0;
+		glGetQueryObjectui64v(frame.Queries[ix * 2], GL_QUERY_RESULT, &start);
+		glGetQueryObjectui64v(frame.Queries[ix * 2 + 1], GL_QUERY_RESULT, &end);
+		_groupTimings[frame.Groups[ix]] += (end - start) / 1000000.0;
+	}
+}
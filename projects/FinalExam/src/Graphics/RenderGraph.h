@@ -0,0 +1,204 @@
+#pragma once
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <GLM/glm.hpp>
+
+#include "Utils/Macros.h"
+#include "Graphics/Framebuffer.h"
+#include "Graphics/GlEnums.h"
+
+/**
+ * A small render graph for chains of fullscreen passes (ex: post processing)
+ *
+ * Every frame, passes are declared along with the resources they read and the single
+ * resource that they write to. When the graph is executed, passes that do not contribute
+ * to the output are culled, and transient render targets whose lifetimes do not overlap
+ * will share the same framebuffer. Framebuffers are pooled between frames, and targets
+ * that were not used during a frame are released
+ *
+ * If the graph's output is a transient target that matches the size of the viewport, the
+ * final pass will render directly into the default framebuffer instead of blitting
+ */
+class RenderGraph final {
+public:
+	MAKE_PTRS(RenderGraph);
+	NO_COPY(RenderGraph);
+	NO_MOVE(RenderGraph);
+
+	typedef int ResourceHandle;
+	static const ResourceHandle InvalidResource = -1;
+
+	/**
+	 * Describes a transient render target that is owned by the graph
+	 */
+	struct TextureDescriptor {
+		// The scaling between the target and the graph's base size
+		glm::vec2        Scale  = glm::vec2(1.0f);
+		// The format of the target's color attachment
+		RenderTargetType Format = RenderTargetType::ColorRgba8;
+	};
+
+	/**
+	 * Describes an attachment that a pass will read from, and the texture slot it
+	 * will be bound to before the pass is executed
+	 */
+	struct PassInput {
+		ResourceHandle         Resource;
+		RenderTargetAttachment Attachment;
+		int                    Slot;
+	};
+
+	/**
+	 * Statistics about the last execution of the graph, for debugging
+	 */
+	struct Stats {
+		int  PassesExecuted = 0;
+		int  PassesCulled   = 0;
+		int  PooledTargets  = 0;
+		bool OutputFolded   = false;
+	};
+
+	// True if the graph should record GPU timings for each pass group, see GetGroupTimings
+	bool EnableProfiling = false;
+
+	RenderGraph();
+	~RenderGraph();
+
+	/**
+	 * Clears all the passes and resources from the previous frame, pooled framebuffers are kept
+	 * @param baseSize The size that transient target scales are relative to (usually the viewport size)
+	 */
+	void Reset(const glm::ivec2& baseSize);
+
+	/**
+	 * Adds an existing framebuffer to the graph, imported framebuffers are never aliased
+	 * @param name The name of the resource, for debugging
+	 * @param framebuffer The framebuffer to import
+	 */
+	ResourceHandle Import(const std::string& name, const Framebuffer::Sptr& framebuffer);
+	/**
+	 * Declares a transient render target, the graph will only allocate it if a live pass writes to it
+	 * @param name The name of the resource, for debugging
+	 * @param descriptor The scale and format for the render target
+	 */
+	ResourceHandle CreateTexture(const std::string& name, const TextureDescriptor& descriptor);
+
+	/**
+	 * Sets the group that passes added after this call belong to, timings are recorded per group
+	 * @param group The name of the group (ex: the name of a post processing effect)
+	 */
+	void SetGroup(const std::string& group);
+
+	/**
+	 * Adds a new pass to the end of the graph. Before the callback is invoked, the output will be bound
+	 * with a viewport covering the entire target, and all inputs will be bound to their texture slots
+	 * @param name The name of the pass, for debugging
+	 * @param inputs The attachments that this pass will read from
+	 * @param output The resource that this pass will write to, each resource should only be written once
+	 * @param execute The callback that will perform the pass's rendering
+	 */
+	void AddPass(const std::string& name, const std::vector<PassInput>& inputs, ResourceHandle output, const std::function<void()>& execute);
+
+	/**
+	 * Sets the resource that the graph will produce
+	 * @param resource The resource to output
+	 * @param viewport The region of the default framebuffer that the output should fill
+	 * @param present True if the output should be written to the default framebuffer, false to keep it
+	 *                in an offscreen target that can be retrieved via GetFramebuffer after execution
+	 */
+	void SetOutput(ResourceHandle resource, const glm::uvec4& viewport, bool present = true);
+
+	/**
+	 * Culls unused passes, assigns framebuffers to transient resources and executes all live passes
+	 */
+	void Execute();
+
+	/**
+	 * Gets the framebuffer backing a resource. For transient resources, this is only valid during
+	 * execution, or afterwards for the graph's output if it is not presented
+	 */
+	const Framebuffer::Sptr& GetFramebuffer(ResourceHandle resource) const;
+	/**
+	 * Gets the size in pixels of a resource
+	 */
+	glm::ivec2 GetSize(ResourceHandle resource) const;
+
+	/**
+	 * Releases all pooled framebuffers
+	 */
+	void ClearPool();
+
+	/**
+	 * Gets statistics from the last time the graph was executed
+	 */
+	const Stats& GetStats() const;
+	/**
+	 * Gets the GPU time in milliseconds spent on each pass group. Results lag a few frames
+	 * behind, and are only available when EnableProfiling is set
+	 */
+	const std::unordered_map<std::string, double>& GetGroupTimings() const;
+
+protected:
+	struct Resource {
+		std::string        Name;
+		TextureDescriptor  Descriptor;
+		glm::ivec2         Size;
+		// The framebuffer backing this resource, either imported or assigned from the pool
+		Framebuffer::Sptr  Target;
+		bool               IsImported;
+		// True if this resource will be rendered directly into the default framebuffer
+		bool               IsBackbuffer;
+		// Index of the last live pass that reads this resource
+		int                LastRead;
+		bool               IsNeeded;
+	};
+
+	struct Pass {
+		std::string            Name;
+		std::string            Group;
+		std::vector<PassInput> Inputs;
+		ResourceHandle         Output;
+		std::function<void()>  Execute;
+		bool                   IsLive;
+	};
+
+	struct PooledTarget {
+		Framebuffer::Sptr Target;
+		RenderTargetType  Format;
+		bool              InUse;
+		bool              UsedThisFrame;
+	};
+
+	// Timestamp queries for a single frame, we keep a few in flight so that reading them back won't stall
+	struct QueryFrame {
+		std::vector<GLuint>      Queries;
+		std::vector<std::string> Groups;
+		int                      Count   = 0;
+		bool                     Pending = false;
+	};
+	static const int QUERY_FRAMES = 3;
+
+	glm::ivec2            _baseSize;
+	std::vector<Resource> _resources;
+	std::vector<Pass>     _passes;
+	std::vector<PooledTarget> _pool;
+
+	ResourceHandle _output;
+	glm::uvec4     _outputViewport;
+	bool           _presentOutput;
+
+	Stats _stats;
+
+	std::string _currentGroup;
+	QueryFrame  _queryFrames[QUERY_FRAMES];
+	int         _queryFrameIndex;
+	std::unordered_map<std::string, double> _groupTimings;
+
+	void _Compile();
+	void _Acquire(Resource& resource);
+	void _Release(Resource& resource);
+	void _TrimPool();
+	void _ResolveQueries(QueryFrame& frame);
+};
@@ -511,7 +511,7 @@ void ShaderProgram::_IntrospectUnifromBlocks() {
 
 void ShaderProgram::BindUniformBlockToSlot(const std::string& name, int uboSlot)
 {
-	auto& it = _uniformBlocks.find(name);
+	auto it = _uniformBlocks.find(name);
 	if (it != _uniformBlocks.end()) {
 		UniformBlockInfo& block = it->second;
 		glUniformBlockBinding(_rendererId, block.BlockIndex, uboSlot);
@@ -5,7 +5,7 @@
 #include <GLM/glm.hpp>
 #include "Utils/ResourceManager/IResource.h"
 #include "Graphics/IGraphicsResource.h"
-#include "Graphics/GLenums.h"
+#include "Graphics/GlEnums.h"
 
 /// <summary>
 /// The abstract base class for all our textures that we'll be implementing
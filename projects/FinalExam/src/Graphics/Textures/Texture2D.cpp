@@ -4,6 +4,7 @@
 #include "GLM/glm.hpp"
 #include "Utils/JsonGlmHelpers.h"
 #include "Utils/Base64.h"
+#include "Utils/JobSystem.h"
 
 /// <summary>
 /// Get the number of mipmap levels required for a texture of the given size
@@ -150,53 +151,63 @@ void Texture2D::_LoadDataFromFile() {
 	LOG_ASSERT(_description.Width + _description.Height == 0, "This texture has already been configured with a size! Cannot re-allocate memory!");
 
 	if (!_description.Filename.empty()) {
-		// Variables that will store properties about our image
 		int width, height, numChannels;
-		const int targetChannels = GetTexelComponentCount(_description.FormatHint);
+		uint8_t* data = _DecodeFile(_description.Filename, _description.FormatHint, width, height, numChannels);
+		_UploadDecodedData(data, width, height, numChannels);
+	}
+	
+	SetDebugName(_description.Filename);
+}
 
-		// Use STBI to load the image
-		stbi_set_flip_vertically_on_load(true);
-		uint8_t* data = stbi_load(_description.Filename.c_str(), &width, &height, &numChannels, targetChannels);
+uint8_t* Texture2D::_DecodeFile(const std::string& filename, PixelFormat formatHint, int& width, int& height, int& numChannels) {
+	const int targetChannels = GetTexelComponentCount(formatHint);
 
-		// If we could not load any data, warn and return null
-		if (data == nullptr) {
-			LOG_WARN("STBI Failed to load image from \"{}\"", _description.Filename);
-			return ;
-		}
+	// Use STBI to load the image
+	stbi_set_flip_vertically_on_load(true);
+	uint8_t* data = stbi_load(filename.c_str(), &width, &height, &numChannels, targetChannels);
 
-		// We should estimate a good format for our data
+	// If we could not load any data, warn and return null
+	if (data == nullptr) {
+		LOG_WARN("STBI Failed to load image from \"{}\"", filename);
+		return nullptr;
+	}
 
-		// numChannels will store the number of channels in the image on disk, if we overrode that we should use the override value
-		if (targetChannels != 0)
-			numChannels = targetChannels;
+	// numChannels will store the number of channels in the image on disk, if we overrode that we should use the override value
+	if (targetChannels != 0)
+		numChannels = targetChannels;
 
-		// We'll determine a recommended format for the image based on number of channels
-		// We hinted that we wanted a certain number of channels, but we're not guaranteed
-		// that all those channels exist (ex: loading an RGB image but requesting RGBA)
-		InternalFormat internal_format = GetInternalFormatForChannels8(numChannels);
-		PixelFormat    image_format = GetPixelFormatForChannels(numChannels);
+	return data;
+}
 
-		// This is one of those poorly documented things in OpenGL
-		if ((numChannels * width) % 4 != 0) {
-			LOG_WARN("The alignment of a horizontal line is not a multiple of 4, this will require a call to glPixelStorei(GL_PACK_ALIGNMENT)");
-		}
+void Texture2D::_UploadDecodedData(uint8_t* data, int width, int height, int numChannels) {
+	if (data == nullptr) {
+		return;
+	}
 
-		// Update our description to match what we loaded
-		_description.Format = internal_format;
-		_description.Width = width;
-		_description.Height = height;
+	// We'll determine a recommended format for the image based on number of channels
+	// We hinted that we wanted a certain number of channels, but we're not guaranteed
+	// that all those channels exist (ex: loading an RGB image but requesting RGBA)
+	InternalFormat internal_format = GetInternalFormatForChannels8(numChannels);
+	PixelFormat    image_format = GetPixelFormatForChannels(numChannels);
 
-		// Allocates our memory
-		_SetTextureParams();
+	// This is one of those poorly documented things in OpenGL
+	if ((numChannels * width) % 4 != 0) {
+		LOG_WARN("The alignment of a horizontal line is not a multiple of 4, this will require a call to glPixelStorei(GL_PACK_ALIGNMENT)");
+	}
 
-		// Upload data to our texture
-		LoadData(width, height, image_format, PixelType::UByte, data);
+	// Update our description to match what we loaded
+	_description.Format = internal_format;
+	_description.Width = width;
+	_description.Height = height;
 
-		// We now have data in the image, we can clear the STBI data
-		stbi_image_free(data);
-	}
-	
-	SetDebugName(_description.Filename);
+	// Allocates our memory
+	_SetTextureParams();
+
+	// Upload data to our texture
+	LoadData(width, height, image_format, PixelType::UByte, data);
+
+	// We now have data in the image, we can clear the STBI data
+	stbi_image_free(data);
 }
 
 void Texture2D::_SetTextureParams() {
@@ -253,4 +264,42 @@ Texture2D::Sptr Texture2D::LoadFromFile(const std::string& path, const Texture2D
 	Texture2D::Sptr result = std::make_shared<Texture2D>(desc);
 
 	return result;
-}
\ No newline at end of file
+}
+
+std::vector<Texture2D::Sptr> Texture2D::LoadFromFiles(const std::vector<std::string>& paths, const Texture2DDescription& description) {
+	std::vector<Texture2D::Sptr> result;
+	result.reserve(paths.size());
+
+	// Decoding the images is the slow part and can happen on any thread, but the upload needs OpenGL,
+	// so each upload runs on the main thread as soon as its own image has been decoded
+	JobCounter::Sptr uploaded = std::make_shared<JobCounter>();
+	for (const std::string& path : paths) {
+		// Create the texture without a filename or size, so that the constructor doesn't load or allocate it for us
+		Texture2DDescription desc = description;
+		desc.Filename.clear();
+		desc.Width = desc.Height = 0;
+		Texture2D::Sptr texture = std::make_shared<Texture2D>(desc);
+		texture->_description.Filename = path;
+		texture->SetDebugName(path);
+		result.push_back(texture);
+
+		struct DecodedImage {
+			uint8_t* Data = nullptr;
+			int      Width = 0, Height = 0, Channels = 0;
+		};
+		std::shared_ptr<DecodedImage> image = std::make_shared<DecodedImage>();
+		JobCounter::Sptr decoded = std::make_shared<JobCounter>();
+
+		PixelFormat formatHint = desc.FormatHint;
+		JobSystem::Run([image, path, formatHint]() {
+			image->Data = _DecodeFile(path, formatHint, image->Width, image->Height, image->Channels);
+		}, decoded);
+		JobSystem::RunOnMainThread([texture, image]() {
+			texture->_UploadDecodedData(image->Data, image->Width, image->Height, image->Channels);
+		}, uploaded, decoded);
+	}
+
+	// Waiting from the main thread runs the uploads as they become ready
+	JobSystem::Wait(uploaded);
+	return result;
+}
@@ -157,10 +157,27 @@ protected:
 	/// </summary>
 	void _LoadDataFromFile();
 	/// <summary>
+	/// Decodes an image file into memory, this does not touch OpenGL and is safe to call from any thread.
+	/// The result should be passed to _UploadDecodedData, which will free it
+	/// </summary>
+	/// <returns>The decoded pixels, or nullptr if the file could not be loaded</returns>
+	static uint8_t* _DecodeFile(const std::string& filename, PixelFormat formatHint, int& width, int& height, int& numChannels);
+	/// <summary>
+	/// Allocates this texture to fit an image from _DecodeFile, and uploads and frees the image's pixels
+	/// </summary>
+	void _UploadDecodedData(uint8_t* data, int width, int height, int numChannels);
+	/// <summary>
 	/// Allocates our texture's memory and sets sampling / filtering parameters
 	/// </summary>
 	void _SetTextureParams();
 
 public:
 	static Texture2D::Sptr LoadFromFile(const std::string& path, const Texture2DDescription& description = Texture2DDescription(), bool forceRgba = true);
+	/// <summary>
+	/// Loads a batch of textures, decoding the files in parallel on the job system. Should be called from the main thread
+	/// </summary>
+	/// <param name="paths">The paths of the image files to load</param>
+	/// <param name="description">The sampler settings to use for every texture, the filename and size are ignored</param>
+	/// <returns>The textures, in the same order as paths</returns>
+	static std::vector<Texture2D::Sptr> LoadFromFiles(const std::vector<std::string>& paths, const Texture2DDescription& description = Texture2DDescription());
 };
@@ -1,4 +1,5 @@
 #include "Texture2DArray.h"
+#include "Texture2D.h"
 #include <stb_image.h>
 #include <Logging.h>
 #include "GLM/glm.hpp"
@@ -149,6 +150,63 @@ void Texture2DArray::LoadData(uint32_t width, uint32_t height, uint32_t layers,
 	}
 }
 
+bool Texture2DArray::CopyLayerFrom(uint32_t layer, const Texture2D::Sptr& source) {
+	if (source == nullptr || layer >= (uint32_t)GetLevels()) {
+		return false;
+	}
+	if (source->GetWidth() != GetLayerWidth() || source->GetHeight() != GetLayerHeight() || source->GetFormat() != _description.Format) {
+		LOG_WARN("Cannot copy texture \"{}\" into array, size or format does not match", source->GetDebugName());
+		return false;
+	}
+
+	glCopyImageSubData(
+		source->GetHandle(), GL_TEXTURE_2D, 0, 0, 0, 0,
+		_rendererId, GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer,
+		GetLayerWidth(), GetLayerHeight(), 1
+	);
+	return true;
+}
+
+void Texture2DArray::UpdateMipmaps() {
+	if (_description.GenerateMipMaps) {
+		glGenerateTextureMipmap(_rendererId);
+	}
+}
+
+bool Texture2DArray::GrowLayers(uint32_t layers) {
+	uint32_t oldLayers = (uint32_t)GetLevels();
+	if (layers <= oldLayers || _description.YDivisions != 1) {
+		return false;
+	}
+
+	uint32_t layerWidth  = GetLayerWidth();
+	uint32_t layerHeight = GetLayerHeight();
+	int mipLevels = _description.GenerateMipMaps ? CalcRequiredMipLevels(layerWidth, layerHeight) : 1;
+
+	// Storage is immutable, so we need a new texture that we can copy the old layers into
+	GLuint oldHandle = _rendererId;
+	glCreateTextures(GL_TEXTURE_2D_ARRAY, 1, &_rendererId);
+
+	_description.Width      = layerWidth * layers;
+	_description.XDivisions = layers;
+	_SetTextureParams();
+
+	for (int level = 0; level < mipLevels; level++) {
+		glCopyImageSubData(
+			oldHandle, GL_TEXTURE_2D_ARRAY, level, 0, 0, 0,
+			_rendererId, GL_TEXTURE_2D_ARRAY, level, 0, 0, 0,
+			glm::max(layerWidth >> level, 1u), glm::max(layerHeight >> level, 1u), oldLayers
+		);
+	}
+	glDeleteTextures(1, &oldHandle);
+
+	// The debug label belongs to the old handle
+	if (!_debugName.empty()) {
+		SetDebugName(_debugName);
+	}
+	return true;
+}
+
 void Texture2DArray::_LoadDataFromFile() {
 	LOG_ASSERT(_description.Width + _description.Height == 0, "This texture has already been configured with a size! Cannot re-allocate memory!");
 
@@ -236,8 +294,6 @@ void Texture2DArray::_LoadDataFromFile() {
 			}
 		}
 
-		_CrtCheckMemory();
-
 		// Upload data to our texture
 		LoadData(xSize, ySize, layers, image_format, PixelType::UByte, repack);
 
@@ -276,6 +332,18 @@ void Texture2DArray::_SetTextureParams() {
 	}
 }
 
+Texture2DArray::Sptr Texture2DArray::CreateEmpty(uint32_t layerWidth, uint32_t layerHeight, uint32_t layers, const Texture2DArrayDescription& description) {
+	// Layers are stored as if they were slices of a single image laid out horizontally
+	Texture2DArrayDescription desc = description;
+	desc.Filename   = "";
+	desc.Width      = layerWidth * layers;
+	desc.Height     = layerHeight;
+	desc.XDivisions = layers;
+	desc.YDivisions = 1;
+
+	return std::make_shared<Texture2DArray>(desc);
+}
+
 Texture2DArray::Sptr Texture2DArray::LoadFromFile(const std::string& path, const Texture2DArrayDescription& description, bool forceRgba) {
 	// Create a copy of the description and change filename to the path
 	Texture2DArrayDescription desc = description;
@@ -1,6 +1,8 @@
 #pragma once
 #include "ITexture.h"
 
+class Texture2D;
+
 /// <summary>
 /// Describes all parameters we can manipulate with our 2D Textures
 /// </summary>
@@ -141,6 +143,37 @@ public:
 	/// <param name="offsetY">The y edge of the destination rectangle in the texture, bottom->top</param>
 	void LoadData(uint32_t width, uint32_t height, uint32_t layers, PixelFormat format, PixelType type, void* data, uint32_t offsetX = 0, uint32_t offsetY = 0, uint32_t offsetZ = 0);
 
+	/// <summary>
+	/// Gets the width of a single layer in pixels
+	/// </summary>
+	uint32_t GetLayerWidth() const { return _description.Width / _description.XDivisions; }
+	/// <summary>
+	/// Gets the height of a single layer in pixels
+	/// </summary>
+	uint32_t GetLayerHeight() const { return _description.Height / _description.YDivisions; }
+
+	/// <summary>
+	/// Copies the top level of a 2D texture into one of our layers on the GPU. The texture must
+	/// match our layer size and internal format. Mip maps are not updated, call UpdateMipmaps once
+	/// all the layers have been copied
+	/// </summary>
+	/// <param name="layer">The index of the layer to overwrite</param>
+	/// <param name="source">The texture to copy from</param>
+	/// <returns>True if the texture was copied</returns>
+	bool CopyLayerFrom(uint32_t layer, const std::shared_ptr<Texture2D>& source);
+	/// <summary>
+	/// Regenerates the mip maps for all layers, if this texture has mip maps enabled
+	/// </summary>
+	void UpdateMipmaps();
+	/// <summary>
+	/// Reallocates this array with more layers, copying the existing layers and their mip maps over. The
+	/// OpenGL handle changes, but anything holding on to this texture keeps working. Only supported for
+	/// arrays made with CreateEmpty
+	/// </summary>
+	/// <param name="layers">The new number of layers, must be greater than the current count</param>
+	/// <returns>True if the texture was resized</returns>
+	bool GrowLayers(uint32_t layers);
+
 	/// <summary>
 	/// Gets this texture's description, which contains basic information about the
 	/// texture's dimensions and creation parameters
@@ -165,5 +198,15 @@ protected:
 	void _SetTextureParams();
 
 public:
+	/// <summary>
+	/// Creates an empty texture array with the given layer size and number of layers, to be filled
+	/// with LoadData or CopyLayerFrom
+	/// </summary>
+	/// <param name="layerWidth">The width of each layer in pixels</param>
+	/// <param name="layerHeight">The height of each layer in pixels</param>
+	/// <param name="layers">The number of layers to allocate</param>
+	/// <param name="description">The format and sampler settings to use, the size and divisions are overwritten</param>
+	static Texture2DArray::Sptr CreateEmpty(uint32_t layerWidth, uint32_t layerHeight, uint32_t layers, const Texture2DArrayDescription& description);
+
 	static Texture2DArray::Sptr LoadFromFile(const std::string& path, const Texture2DArrayDescription& description = Texture2DArrayDescription(), bool forceRgba = true);
 };
@@ -0,0 +1,127 @@
+#include "TextureArrayPacker.h"
+#include "Logging.h"
+
+TextureArrayPacker::TextureArrayPacker(uint32_t layersPerPage) :
+	_layersPerPage(glm::max(layersPerPage, 1u)),
+	_pages(std::vector<Texture2DArray::Sptr>()),
+	_pageInfo(std::vector<PageInfo>()),
+	_packed(std::unordered_map<Guid, PackedTexture>())
+{ }
+
+TextureArrayPacker::~TextureArrayPacker() = default;
+
+bool TextureArrayPacker::PageFormat::operator==(const PageFormat& other) const
+{
+	return
+		Width == other.Width && Height == other.Height && Format == other.Format &&
+		WrapS == other.WrapS && WrapT == other.WrapT &&
+		Minification == other.Minification && Magnification == other.Magnification &&
+		Mipmaps == other.Mipmaps;
+}
+
+TextureArrayPacker::PackedTexture TextureArrayPacker::Pack(const Texture2D::Sptr& texture)
+{
+	if (texture == nullptr) return PackedTexture();
+
+	auto it = _packed.find(texture->GetGUID());
+	if (it != _packed.end()) {
+		return it->second;
+	}
+
+	const Texture2DDescription& desc = texture->GetDescription();
+	if (desc.Width * desc.Height == 0 || desc.Format == InternalFormat::Unknown || desc.MultisampleCount > 1 || desc.EnableShadowSampling) {
+		return PackedTexture();
+	}
+
+	PageFormat format;
+	format.Width         = desc.Width;
+	format.Height        = desc.Height;
+	format.Format        = desc.Format;
+	format.WrapS         = desc.HorizontalWrap;
+	format.WrapT         = desc.VerticalWrap;
+	format.Minification  = desc.MinificationFilter;
+	format.Magnification = desc.MagnificationFilter;
+	format.Mipmaps       = desc.GenerateMipMaps;
+
+	int pageIx = _FindOrCreatePage(format, texture);
+	PageInfo& info = _pageInfo[pageIx];
+
+	PackedTexture result;
+	result.Page  = _pages[pageIx];
+	result.Layer = (int)info.UsedLayers;
+	if (!result.Page->CopyLayerFrom(info.UsedLayers, texture)) {
+		return PackedTexture();
+	}
+
+	info.UsedLayers++;
+	info.Dirty = true;
+	_packed[texture->GetGUID()] = result;
+	return result;
+}
+
+int TextureArrayPacker::_FindOrCreatePage(const PageFormat& format, const Texture2D::Sptr& texture)
+{
+	// Make sure we don't ask for more layers than the GPU can give us
+	GLint maxLayers = 0;
+	glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+	uint32_t pageLimit = glm::min(_layersPerPage, (uint32_t)glm::max(maxLayers, 1));
+
+	for (int ix = 0; ix < (int)_pages.size(); ix++) {
+		if (!(_pageInfo[ix].Format == format)) continue;
+
+		uint32_t allocated = (uint32_t)_pages[ix]->GetLevels();
+		if (_pageInfo[ix].UsedLayers < allocated) {
+			return ix;
+		}
+		// Pages start small and double when they fill up, so groups with only a few textures don't
+		// pay for a full page of layers and mip maps
+		if (allocated < pageLimit && _pages[ix]->GrowLayers(glm::min(allocated * 2, pageLimit))) {
+			LOG_INFO("Grew texture array page {}x{} to {} layers", format.Width, format.Height, _pages[ix]->GetLevels());
+			return ix;
+		}
+	}
+
+	uint32_t layers = glm::min(INITIAL_PAGE_LAYERS, pageLimit);
+
+	Texture2DArrayDescription desc;
+	desc.Format              = format.Format;
+	desc.HorizontalWrap      = format.WrapS;
+	desc.VerticalWrap        = format.WrapT;
+	desc.MinificationFilter  = format.Minification;
+	desc.MagnificationFilter = format.Magnification;
+	desc.MaxAnisotropic      = texture->GetAnisoLevel();
+	desc.GenerateMipMaps     = format.Mipmaps;
+
+	Texture2DArray::Sptr page = Texture2DArray::CreateEmpty(format.Width, format.Height, layers, desc);
+	page->SetDebugName("Texture Page " + std::to_string(_pages.size()) + " (" + std::to_string(format.Width) + "x" + std::to_string(format.Height) + ")");
+	_pages.push_back(page);
+	_pageInfo.push_back({ format, 0, false });
+
+	LOG_INFO("Created texture array page {}x{} x {} layers", format.Width, format.Height, layers);
+	return (int)_pages.size() - 1;
+}
+
+void TextureArrayPacker::Flush()
+{
+	for (int ix = 0; ix < (int)_pages.size(); ix++) {
+		if (_pageInfo[ix].Dirty) {
+			_pages[ix]->UpdateMipmaps();
+			_pageInfo[ix].Dirty = false;
+		}
+	}
+}
+
+void TextureArrayPacker::Clear()
+{
+	_pages.clear();
+	_pageInfo.clear();
+	_packed.clear();
+}
+
+const std::vector<Texture2DArray::Sptr>& TextureArrayPacker::GetPages() const {
+	return _pages;
+}
+
+size_t TextureArrayPacker::GetPackedCount() const {
+	return _packed.size();
+}
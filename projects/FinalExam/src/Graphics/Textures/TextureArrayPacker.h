@@ -0,0 +1,90 @@
+#pragma once
+#include <unordered_map>
+#include <vector>
+#include "Texture2D.h"
+#include "Texture2DArray.h"
+#include "Utils/GUID.hpp"
+#include "Utils/Macros.h"
+
+/// <summary>
+/// Packs 2D textures into shared texture array pages, so that materials using different textures can
+/// be drawn together by referencing their textures as layers in the same array
+///
+/// Textures are grouped by size, format and sampler settings, since every layer in an array shares
+/// these. Each group gets as many pages as it needs, and a texture is only ever packed once. Pages are
+/// allocated small and grown as textures are added, up to the page size given to the constructor
+/// </summary>
+class TextureArrayPacker {
+public:
+	MAKE_PTRS(TextureArrayPacker);
+	NO_COPY(TextureArrayPacker);
+	NO_MOVE(TextureArrayPacker);
+
+	/// <summary>
+	/// Where a texture ended up after packing
+	/// </summary>
+	struct PackedTexture {
+		Texture2DArray::Sptr Page  = nullptr;
+		int                  Layer = -1;
+
+		bool IsValid() const { return Page != nullptr; }
+	};
+
+	/// <summary>
+	/// Creates a new packer
+	/// </summary>
+	/// <param name="layersPerPage">The most layers a page can grow to, will be clamped to what the GPU supports</param>
+	TextureArrayPacker(uint32_t layersPerPage = 32);
+	~TextureArrayPacker();
+
+	/// <summary>
+	/// Packs a texture into a page, or returns where it was already packed. Textures without any data,
+	/// or that are multisampled or used for shadow sampling can't be packed
+	/// </summary>
+	/// <param name="texture">The texture to pack</param>
+	/// <returns>The page and layer the texture was packed into, or an invalid result if it could not be packed</returns>
+	PackedTexture Pack(const Texture2D::Sptr& texture);
+	/// <summary>
+	/// Regenerates mip maps for any pages that have been packed into since the last flush, should be
+	/// called before the pages are sampled
+	/// </summary>
+	void Flush();
+	/// <summary>
+	/// Releases all pages, textures that have already been handed out keep their pages alive
+	/// </summary>
+	void Clear();
+
+	const std::vector<Texture2DArray::Sptr>& GetPages() const;
+	size_t GetPackedCount() const;
+
+protected:
+	// Everything that has to match between textures for them to share a page
+	struct PageFormat {
+		uint32_t       Width;
+		uint32_t       Height;
+		InternalFormat Format;
+		WrapMode       WrapS;
+		WrapMode       WrapT;
+		MinFilter      Minification;
+		MagFilter      Magnification;
+		bool           Mipmaps;
+
+		bool operator ==(const PageFormat& other) const;
+	};
+
+	struct PageInfo {
+		PageFormat Format;
+		uint32_t   UsedLayers;
+		bool       Dirty;
+	};
+
+	// The number of layers a new page starts with, pages double in size as they fill up
+	static constexpr uint32_t INITIAL_PAGE_LAYERS = 4;
+
+	uint32_t                                  _layersPerPage;
+	std::vector<Texture2DArray::Sptr>         _pages;
+	std::vector<PageInfo>                     _pageInfo;
+	std::unordered_map<Guid, PackedTexture>   _packed;
+
+	int _FindOrCreatePage(const PageFormat& format, const Texture2D::Sptr& texture);
+};
@@ -72,7 +72,7 @@ VertexArrayObject::VertexBufferBinding* VertexArrayObject::AddVertexBuffer(const
 void VertexArrayObject::ReplaceVertexBuffer(VertexBufferBinding* binding, const VertexBuffer::Sptr& buffer)
 {
 	// Search for the BufferAttribute with the matching usage
-	auto& it = std::find_if(_vertexBuffers.begin(), _vertexBuffers.end(), [&](const VertexBufferBinding* buffer) {
+	auto it = std::find_if(_vertexBuffers.begin(), _vertexBuffers.end(), [&](const VertexBufferBinding* buffer) {
 		return buffer == binding;
 	});
 
@@ -128,6 +128,26 @@ void VertexArrayObject::DrawInstanced(uint32_t instanceCount, DrawMode mode /*=
 	
 }
 
+void VertexArrayObject::DrawIndirect(GLintptr offset, DrawMode mode /*= DrawMode::TriangleList*/)
+{
+	Bind();
+	if (_indexBuffer == nullptr) {
+		glDrawArraysIndirect((GLenum)mode, reinterpret_cast<const void*>(offset));
+	}
+	else {
+		glDrawElementsIndirect((GLenum)mode, (GLenum)_indexBuffer->GetElementType(), reinterpret_cast<const void*>(offset));
+	}
+	Unbind();
+}
+
+uint32_t VertexArrayObject::GetDrawCount() const
+{
+	if (_elementCount != 0) {
+		return _elementCount;
+	}
+	return _indexBuffer == nullptr ? _vertexBuffers[0]->Buffer->GetElementCount() : _indexBuffer->GetElementCount();
+}
+
 void VertexArrayObject::Bind() {
 	glBindVertexArray(_handle);
 }
@@ -151,7 +171,7 @@ GlResourceType VertexArrayObject::GetResourceClass() const {
 VertexArrayObject::VertexBufferBinding* VertexArrayObject::GetBufferBinding(AttribUsage usage) {
 	for (auto& binding : _vertexBuffers) {
 		// Search for the BufferAttribute with the matching usage
-		auto& it = std::find_if(binding->Attributes.begin(), binding->Attributes.end(), [&](const BufferAttribute& attrib) {
+		auto it = std::find_if(binding->Attributes.begin(), binding->Attributes.end(), [&](const BufferAttribute& attrib) {
 			return attrib.Usage == usage;
 		});
 
@@ -134,6 +134,20 @@ public:
 	/// <param name="mode">The primitive mode for rendering the mesh</param>
 	void DrawInstanced(uint32_t instanceCount, DrawMode mode = DrawMode::TriangleList);
 
+	/// <summary>
+	/// Renders this VAO using the command at the given offset in the bound GL_DRAW_INDIRECT_BUFFER.
+	/// Internally this will call glDrawArraysIndirect or glDrawElementsIndirect, so the command's
+	/// layout depends on whether this VAO has an index buffer
+	/// </summary>
+	/// <param name="offset">The offset of the command in the indirect buffer, in bytes</param>
+	/// <param name="mode">The primitive mode for rendering the mesh</param>
+	void DrawIndirect(GLintptr offset, DrawMode mode = DrawMode::TriangleList);
+
+	/// <summary>
+	/// Gets the number of vertices or indices that a call to Draw will render
+	/// </summary>
+	uint32_t GetDrawCount() const;
+
 	/// <summary>
 	/// Binds this VAO as the source of data for draw operations
 	/// </summary>
@@ -0,0 +1,195 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "Utils/GUID.hpp"
+
+/// <summary>
+/// Builds up a block of binary data in memory, for writing binary files in a single write
+///
+/// Values are copied in as their raw bytes, so files are only readable on machines with the
+/// same endianness (which is every machine we build for)
+/// </summary>
+class BinaryWriter {
+public:
+	BinaryWriter() :
+		_data(std::vector<char>())
+	{ }
+
+	/// <summary>
+	/// Appends the raw bytes of a value, the type must be trivially copyable (ex: numbers, glm types)
+	/// </summary>
+	template <typename T>
+	void Write(const T& value) {
+		static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be written as raw bytes");
+		WriteBytes(&value, sizeof(T));
+	}
+
+	/// <summary>
+	/// Appends a block of bytes
+	/// </summary>
+	void WriteBytes(const void* data, size_t size) {
+		const char* bytes = static_cast<const char*>(data);
+		_data.insert(_data.end(), bytes, bytes + size);
+	}
+
+	/// <summary>
+	/// Appends a string as its length followed by its characters
+	/// </summary>
+	void WriteString(const std::string& value) {
+		Write((uint32_t)value.size());
+		WriteBytes(value.data(), value.size());
+	}
+
+	/// <summary>
+	/// Appends the 16 bytes of a GUID
+	/// </summary>
+	void WriteGuid(const Guid& value) {
+		WriteBytes(value.bytes(), 16);
+	}
+
+	/// <summary>
+	/// Overwrites a value that has already been written, for filling in sizes once the data
+	/// that they describe has been written
+	/// </summary>
+	/// <param name="offset">The offset of the value from the start of the data, see Size</param>
+	/// <param name="value">The new value</param>
+	template <typename T>
+	void Patch(size_t offset, const T& value) {
+		static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be written as raw bytes");
+		std::memcpy(_data.data() + offset, &value, sizeof(T));
+	}
+
+	/// <summary>
+	/// Gets the number of bytes that have been written
+	/// </summary>
+	size_t Size() const { return _data.size(); }
+	/// <summary>
+	/// Gets the bytes that have been written
+	/// </summary>
+	const char* Data() const { return _data.data(); }
+
+private:
+	std::vector<char> _data;
+};
+
+/// <summary>
+/// Reads values back out of a block of binary data written by a BinaryWriter
+///
+/// The reader does not own the data. Reading past the end of the data never reads out of bounds,
+/// instead the value is left zeroed and the reader is marked as failed, so loaders can read a whole
+/// block and check HasFailed once at the end
+/// </summary>
+class BinaryReader {
+public:
+	/// <param name="data">The data to read from, must outlive the reader</param>
+	/// <param name="size">The number of bytes in data</param>
+	BinaryReader(const char* data, size_t size) :
+		_data(data),
+		_size(size),
+		_offset(0),
+		_hasFailed(false)
+	{ }
+
+	/// <summary>
+	/// Reads the raw bytes of a value, the type must be trivially copyable
+	/// </summary>
+	template <typename T>
+	T Read() {
+		static_assert(std::is_trivially_copyable<T>::value, "Only trivially copyable types can be read as raw bytes");
+		T result;
+		if (ReadBytes(&result, sizeof(T))) {
+			return result;
+		}
+		std::memset(&result, 0, sizeof(T));
+		return result;
+	}
+
+	/// <summary>
+	/// Copies a block of bytes into the given buffer, returning false if there are not enough bytes left
+	/// </summary>
+	bool ReadBytes(void* result, size_t size) {
+		if (!_Reserve(size)) return false;
+		std::memcpy(result, _data + _offset, size);
+		_offset += size;
+		return true;
+	}
+
+	/// <summary>
+	/// Reads a string written by BinaryWriter::WriteString
+	/// </summary>
+	std::string ReadString() {
+		uint32_t length = Read<uint32_t>();
+		if (!_Reserve(length)) return std::string();
+		std::string result(_data + _offset, length);
+		_offset += length;
+		return result;
+	}
+
+	/// <summary>
+	/// Reads a GUID written by BinaryWriter::WriteGuid
+	/// </summary>
+	Guid ReadGuid() {
+		unsigned char bytes[16] = { 0 };
+		ReadBytes(bytes, 16);
+		return Guid::FromBytes(bytes);
+	}
+
+	/// <summary>
+	/// Skips over a number of bytes, returning false if there are not enough bytes left
+	/// </summary>
+	bool Skip(size_t size) {
+		if (!_Reserve(size)) return false;
+		_offset += size;
+		return true;
+	}
+
+	/// <summary>
+	/// Moves the reader to the given offset from the start of the data
+	/// </summary>
+	void Seek(size_t offset) {
+		if (offset > _size) {
+			_hasFailed = true;
+			offset = _size;
+		}
+		_offset = offset;
+	}
+
+	/// <summary>
+	/// Gets a pointer to the next unread byte
+	/// </summary>
+	const char* Current() const { return _data + _offset; }
+	/// <summary>
+	/// Gets the offset of the next unread byte from the start of the data
+	/// </summary>
+	size_t Offset() const { return _offset; }
+	/// <summary>
+	/// Gets the number of bytes left to read
+	/// </summary>
+	size_t Remaining() const { return _size - _offset; }
+	/// <summary>
+	/// Returns true if anything has tried to read past the end of the data, or the reader was marked as failed
+	/// </summary>
+	bool HasFailed() const { return _hasFailed; }
+	/// <summary>
+	/// Marks the reader as failed, for loaders that find data they can't make sense of
+	/// </summary>
+	void MarkFailed() { _hasFailed = true; }
+
+private:
+	const char* _data;
+	size_t      _size;
+	size_t      _offset;
+	bool        _hasFailed;
+
+	bool _Reserve(size_t size) {
+		if (size > Remaining()) {
+			_hasFailed = true;
+			return false;
+		}
+		return true;
+	}
+};
@@ -98,6 +98,6 @@ std::string FileHelpers::ReadResolveIncludes(const std::string& filename, std::v
 }
 
 void FileHelpers::WriteContentsToFile(const std::string& filename, const std::string& contents, bool append /*= false*/) {
-	std::ofstream output(filename, std::ios::out | (append ? std::ios::app : 0));
+	std::ofstream output(filename, std::ios::out | (append ? std::ios::app : std::ios::openmode()));
 	output << contents;
 }
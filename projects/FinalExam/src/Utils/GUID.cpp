@@ -22,8 +22,12 @@
 */
 
 #include <cstring>
-#include "Utils/guid.hpp"
+#include "Utils/GUID.hpp"
+#ifdef _WIN32
 #include <combaseapi.h>
+#else
+#include <random>
+#endif
 
 // converts a single hex char to a number (0 - 15)
 unsigned char hexDigitToChar(char ch) {
@@ -142,7 +146,16 @@ void Guid::Clear() {
 Guid Guid::New() {
 	try {
 		Guid result;
+		#ifdef _WIN32
 		CoCreateGuid((GUID*)result._bytes);
+		#else
+		// Random (version 4) UUID, each thread gets its own generator so we don't need to lock
+		thread_local std::mt19937_64 generator(std::random_device{}());
+		uint64_t halves[2] = { generator(), generator() };
+		memcpy(result._bytes, halves, 16);
+		result._bytes[6] = (result._bytes[6] & 0x0F) | 0x40;
+		result._bytes[8] = (result._bytes[8] & 0x3F) | 0x80;
+		#endif
 		return result;
 	} catch (...) {
 		return Guid();
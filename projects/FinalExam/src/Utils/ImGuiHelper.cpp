@@ -143,7 +143,8 @@ void ImGuiHelper::ResourceDragSource(const IResource* resource, const std::strin
 {
 	if (ImGui::BeginDragDropSource(ImGuiDragDropFlags_SourceAllowNullID)) {
 		std::string typeName = StringTools::SanitizeClassName(typeid(*resource).name());
-		ImGui::SetDragDropPayload(typeName.c_str(), &resource->GetGUID(), sizeof(Guid));
+		Guid guid = resource->GetGUID();
+		ImGui::SetDragDropPayload(typeName.c_str(), &guid, sizeof(Guid));
 		ImGui::Text(name.c_str());
 		ImGui::EndDragDropSource();
 	}
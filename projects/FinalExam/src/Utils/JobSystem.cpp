@@ -0,0 +1,259 @@
+#include "JobSystem.h"
+#include <algorithm>
+#include "Logging.h"
+
+std::vector<std::unique_ptr<JobSystem::WorkQueue>> JobSystem::_queues;
+std::vector<std::thread>          JobSystem::_workers;
+std::atomic<int>                  JobSystem::_queuedJobs(0);
+std::mutex                        JobSystem::_sleepMutex;
+std::condition_variable           JobSystem::_sleepSignal;
+std::atomic<bool>                 JobSystem::_isRunning(false);
+std::thread::id                   JobSystem::_mainThread;
+std::mutex                        JobSystem::_mainQueueMutex;
+std::vector<JobSystem::Job>       JobSystem::_mainQueue;
+thread_local uint32_t             JobSystem::_queueIndex = 0;
+
+JobCounter::JobCounter() :
+	_pending(0),
+	_continuationMutex(),
+	_continuations(std::vector<Continuation>())
+{ }
+
+bool JobCounter::IsDone() const {
+	return _pending.load() == 0;
+}
+
+void JobSystem::Init(int threadCount) {
+	if (_isRunning) return;
+
+	if (threadCount <= 0) {
+		threadCount = std::max(1, (int)std::thread::hardware_concurrency() - 1);
+	}
+
+	_mainThread = std::this_thread::get_id();
+	_queues.clear();
+	for (int ix = 0; ix <= threadCount; ix++) {
+		_queues.push_back(std::make_unique<WorkQueue>());
+	}
+
+	_isRunning = true;
+	for (int ix = 0; ix < threadCount; ix++) {
+		_workers.emplace_back(&JobSystem::_WorkerMain, (uint32_t)ix + 1);
+	}
+	LOG_INFO("Started job system with {} workers", threadCount);
+}
+
+void JobSystem::Shutdown() {
+	if (!_isRunning) return;
+
+	{
+		std::lock_guard<std::mutex> lock(_sleepMutex);
+		_isRunning = false;
+	}
+	_sleepSignal.notify_all();
+
+	// Workers empty the queues before they exit
+	for (auto& worker : _workers) {
+		worker.join();
+	}
+	_workers.clear();
+
+	// Anything left for the main thread can run now, there's nobody else left to run it
+	PumpMainThread();
+	_queues.clear();
+}
+
+int JobSystem::GetWorkerCount() {
+	return (int)_workers.size();
+}
+
+bool JobSystem::IsMainThread() {
+	return std::this_thread::get_id() == _mainThread;
+}
+
+void JobSystem::Run(std::function<void()> func, const JobCounter::Sptr& counter, const JobCounter::Sptr& dependency) {
+	_Submit(std::move(func), counter, dependency, false);
+}
+
+void JobSystem::RunOnMainThread(std::function<void()> func, const JobCounter::Sptr& counter, const JobCounter::Sptr& dependency) {
+	_Submit(std::move(func), counter, dependency, true);
+}
+
+void JobSystem::Wait(const JobCounter::Sptr& counter, bool pumpMainThread) {
+	if (counter == nullptr) return;
+
+	pumpMainThread = pumpMainThread && IsMainThread();
+	while (!counter->IsDone()) {
+		if (pumpMainThread) {
+			PumpMainThread();
+		}
+
+		// Help out instead of sitting idle
+		Job job;
+		if (_isRunning && _TryPop(job)) {
+			_Execute(job);
+		} else {
+			std::this_thread::yield();
+		}
+	}
+}
+
+void JobSystem::PumpMainThread() {
+	LOG_ASSERT(_mainThread == std::thread::id() || IsMainThread(), "Main thread jobs can only be run from the main thread");
+
+	// Jobs queued while we're running these will wait for the next pump, so that a job that
+	// re-queues itself can't trap us here
+	std::vector<Job> jobs;
+	{
+		std::lock_guard<std::mutex> lock(_mainQueueMutex);
+		jobs.swap(_mainQueue);
+	}
+	for (Job& job : jobs) {
+		_Execute(job);
+	}
+}
+
+void JobSystem::ParallelFor(uint32_t count, uint32_t batchSize, const std::function<void(uint32_t start, uint32_t end)>& func) {
+	if (count == 0) return;
+	batchSize = std::max(batchSize, 1u);
+	uint32_t batches = (count + batchSize - 1) / batchSize;
+
+	// Not worth waking anyone up for a single batch
+	if (!_isRunning || batches == 1) {
+		func(0, count);
+		return;
+	}
+
+	// Rather than a job per batch, we submit a few jobs that pull batches until there are none left.
+	// Idle workers steal them from our queue, and if they're all busy we just end up doing the work ourselves
+	std::atomic<uint32_t> nextBatch(0);
+	auto runBatches = [&]() {
+		uint32_t batch;
+		while ((batch = nextBatch.fetch_add(1)) < batches) {
+			uint32_t start = batch * batchSize;
+			func(start, std::min(start + batchSize, count));
+		}
+	};
+
+	JobCounter::Sptr counter = std::make_shared<JobCounter>();
+	uint32_t helpers = std::min(batches - 1, (uint32_t)_workers.size());
+	for (uint32_t ix = 0; ix < helpers; ix++) {
+		Run(runBatches, counter);
+	}
+	runBatches();
+
+	// The helpers reference our stack, so they all have to finish (even the ones that found no work) before we return.
+	// Callers are part way through their own work (transforms, update phases, render prep), so main thread jobs
+	// can't be allowed to run in the middle of it
+	Wait(counter, false);
+}
+
+void JobSystem::_Submit(std::function<void()>&& func, const JobCounter::Sptr& counter, const JobCounter::Sptr& dependency, bool mainThread) {
+	// Count the job now rather than when it's scheduled, so that waiting on the counter covers jobs
+	// that are still waiting on their dependency
+	if (counter != nullptr) {
+		counter->_pending++;
+	}
+
+	if (dependency != nullptr && !dependency->IsDone()) {
+		std::lock_guard<std::mutex> lock(dependency->_continuationMutex);
+		// The dependency may have finished while we were taking the lock, _Finish takes the same lock
+		// before it looks at the continuations, so if it's still pending here it will see ours
+		if (!dependency->IsDone()) {
+			dependency->_continuations.push_back({ std::move(func), counter, mainThread });
+			return;
+		}
+	}
+
+	_Schedule({ std::move(func), counter }, mainThread);
+}
+
+void JobSystem::_Schedule(Job&& job, bool mainThread) {
+	// With no workers, everything runs right away on whoever submitted it
+	if (!_isRunning) {
+		_Execute(job);
+		return;
+	}
+
+	if (mainThread) {
+		std::lock_guard<std::mutex> lock(_mainQueueMutex);
+		_mainQueue.push_back(std::move(job));
+		return;
+	}
+
+	{
+		WorkQueue& queue = *_queues[_queueIndex];
+		std::lock_guard<std::mutex> lock(queue.Mutex);
+		queue.Jobs.push_back(std::move(job));
+	}
+	_queuedJobs++;
+
+	// Taking the lock means a worker can't miss the signal between checking _queuedJobs and going to sleep
+	{
+		std::lock_guard<std::mutex> lock(_sleepMutex);
+	}
+	_sleepSignal.notify_one();
+}
+
+bool JobSystem::_TryPop(Job& job) {
+	// Our own newest job first
+	{
+		WorkQueue& queue = *_queues[_queueIndex];
+		std::lock_guard<std::mutex> lock(queue.Mutex);
+		if (!queue.Jobs.empty()) {
+			job = std::move(queue.Jobs.back());
+			queue.Jobs.pop_back();
+			_queuedJobs--;
+			return true;
+		}
+	}
+
+	// Then the oldest job from anyone else, starting with our neighbour so that thieves spread out
+	uint32_t queueCount = (uint32_t)_queues.size();
+	for (uint32_t offset = 1; offset < queueCount; offset++) {
+		WorkQueue& queue = *_queues[(_queueIndex + offset) % queueCount];
+		std::lock_guard<std::mutex> lock(queue.Mutex);
+		if (!queue.Jobs.empty()) {
+			job = std::move(queue.Jobs.front());
+			queue.Jobs.pop_front();
+			_queuedJobs--;
+			return true;
+		}
+	}
+	return false;
+}
+
+void JobSystem::_Execute(Job& job) {
+	job.Func();
+	_Finish(job.Counter);
+}
+
+void JobSystem::_Finish(const JobCounter::Sptr& counter) {
+	if (counter == nullptr || counter->_pending.fetch_sub(1) != 1) return;
+
+	std::vector<JobCounter::Continuation> ready;
+	{
+		std::lock_guard<std::mutex> lock(counter->_continuationMutex);
+		ready.swap(counter->_continuations);
+	}
+	for (JobCounter::Continuation& continuation : ready) {
+		_Schedule({ std::move(continuation.Func), continuation.Counter }, continuation.MainThread);
+	}
+}
+
+void JobSystem::_WorkerMain(uint32_t queueIndex) {
+	_queueIndex = queueIndex;
+	while (true) {
+		Job job;
+		if (_TryPop(job)) {
+			_Execute(job);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(_sleepMutex);
+		_sleepSignal.wait(lock, []() { return !_isRunning || _queuedJobs.load() > 0; });
+		if (!_isRunning && _queuedJobs.load() == 0) {
+			return;
+		}
+	}
+}
@@ -0,0 +1,160 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Utils/Macros.h"
+
+/// <summary>
+/// Tracks a set of jobs, letting other jobs wait for them to finish
+///
+/// Every job submitted with a counter bumps it, and the counter is done once all of those jobs
+/// have finished. Jobs can also be submitted to run after a counter is done, see JobSystem::Run
+/// </summary>
+class JobCounter final {
+public:
+	MAKE_PTRS(JobCounter);
+	NO_COPY(JobCounter);
+	NO_MOVE(JobCounter);
+
+	JobCounter();
+	~JobCounter() = default;
+
+	/// <summary>
+	/// Returns true if every job that was submitted with this counter has finished
+	/// </summary>
+	bool IsDone() const;
+
+protected:
+	friend class JobSystem;
+
+	// A job waiting on this counter, which gets scheduled once the counter is done
+	struct Continuation {
+		std::function<void()> Func;
+		JobCounter::Sptr      Counter;
+		bool                  MainThread;
+	};
+
+	std::atomic<int>          _pending;
+	std::mutex                _continuationMutex;
+	std::vector<Continuation> _continuations;
+};
+
+/// <summary>
+/// A pool of worker threads for splitting CPU work (ex: preparing render data, loading files) across cores
+///
+/// Every worker has its own queue of jobs. Workers take their newest job first, which keeps nested
+/// work hot in the cache, and when they run dry they steal the oldest job from someone else's queue.
+/// Threads that aren't workers (ex: the main thread) submit to a shared queue, which workers steal from
+/// in the same way. Waiting on jobs never blocks outright, the waiting thread runs jobs until the ones
+/// it cares about are done, so jobs can safely submit and wait on other jobs
+///
+/// Jobs must not touch OpenGL, since the context is only current on the main thread. Work that needs
+/// OpenGL should be submitted with RunOnMainThread, and will run the next time the main thread calls
+/// PumpMainThread (once a frame, and during explicit waits on jobs)
+/// </summary>
+class JobSystem {
+public:
+	/// <summary>
+	/// Starts the worker threads, should be called once from the main thread before any jobs are submitted
+	/// </summary>
+	/// <param name="threadCount">The number of workers to start, or 0 to use one less than the number of hardware threads</param>
+	static void Init(int threadCount = 0);
+	/// <summary>
+	/// Waits for any outstanding jobs, and stops all the worker threads
+	/// </summary>
+	static void Shutdown();
+
+	/// <summary>
+	/// Gets the number of worker threads, not including the main thread
+	/// </summary>
+	static int GetWorkerCount();
+	/// <summary>
+	/// Returns true if called from the thread that called Init
+	/// </summary>
+	static bool IsMainThread();
+
+	/// <summary>
+	/// Submits a job to run on any thread. If the job system is not running, the job runs immediately
+	/// </summary>
+	/// <param name="func">The job to run</param>
+	/// <param name="counter">An optional counter to track the job with</param>
+	/// <param name="dependency">An optional counter that must be done before the job can start</param>
+	static void Run(std::function<void()> func, const JobCounter::Sptr& counter = nullptr, const JobCounter::Sptr& dependency = nullptr);
+	/// <summary>
+	/// Submits a job to run on the main thread, for work that needs OpenGL (ex: uploading a texture
+	/// once a job has loaded it). The job runs during PumpMainThread
+	/// </summary>
+	/// <param name="func">The job to run</param>
+	/// <param name="counter">An optional counter to track the job with</param>
+	/// <param name="dependency">An optional counter that must be done before the job can start</param>
+	static void RunOnMainThread(std::function<void()> func, const JobCounter::Sptr& counter = nullptr, const JobCounter::Sptr& dependency = nullptr);
+	/// <summary>
+	/// Runs jobs until the counter is done. On the main thread this also runs any main thread jobs
+	/// that are ready, so it is safe to wait on work that ends with a main thread continuation
+	/// </summary>
+	/// <param name="counter">The counter to wait on</param>
+	/// <param name="pumpMainThread">False to only run worker jobs, for waits in the middle of work that main thread jobs must not interrupt</param>
+	static void Wait(const JobCounter::Sptr& counter, bool pumpMainThread = true);
+	/// <summary>
+	/// Runs all of the main thread jobs that are ready, should only be called from the main thread
+	/// </summary>
+	static void PumpMainThread();
+
+	/// <summary>
+	/// Splits the range [0, count) into batches, and invokes the function for each batch across
+	/// the worker threads. The calling thread will help with the work, and this will only return
+	/// once all batches have completed. If the job system is not running, the work is done inline.
+	/// Main thread jobs are never run while waiting for the batches
+	/// </summary>
+	/// <param name="count">The number of items to process</param>
+	/// <param name="batchSize">The number of items per batch (the grain size), larger batches have less overhead</param>
+	/// <param name="func">The function to invoke with the start (inclusive) and end (exclusive) of each batch</param>
+	static void ParallelFor(uint32_t count, uint32_t batchSize, const std::function<void(uint32_t start, uint32_t end)>& func);
+
+protected:
+	JobSystem() = default;
+
+	struct Job {
+		std::function<void()> Func;
+		JobCounter::Sptr      Counter;
+	};
+
+	// A deque of jobs, the owner pushes and pops at the back and thieves take from the front
+	struct WorkQueue {
+		std::mutex      Mutex;
+		std::deque<Job> Jobs;
+	};
+
+	// Index 0 is shared by every thread that isn't a worker, worker N owns index N + 1
+	static std::vector<std::unique_ptr<WorkQueue>> _queues;
+	static std::vector<std::thread> _workers;
+	// The number of jobs sitting in any of the queues, workers sleep while this is 0
+	static std::atomic<int>         _queuedJobs;
+	static std::mutex               _sleepMutex;
+	static std::condition_variable  _sleepSignal;
+	static std::atomic<bool>        _isRunning;
+	static std::thread::id          _mainThread;
+
+	static std::mutex               _mainQueueMutex;
+	static std::vector<Job>         _mainQueue;
+
+	// The queue owned by the current thread, 0 for threads that aren't workers
+	static thread_local uint32_t    _queueIndex;
+
+	static void _WorkerMain(uint32_t queueIndex);
+	// Queues a job that is ready to run, on the main thread queue if mainThread is true
+	static void _Schedule(Job&& job, bool mainThread);
+	// Takes a job from our own queue, or steals one from another
+	static bool _TryPop(Job& job);
+	static void _Execute(Job& job);
+	// Marks one of a counter's jobs as finished, scheduling its continuations if it was the last one
+	static void _Finish(const JobCounter::Sptr& counter);
+	static void _Submit(std::function<void()>&& func, const JobCounter::Sptr& counter, const JobCounter::Sptr& dependency, bool mainThread);
+};
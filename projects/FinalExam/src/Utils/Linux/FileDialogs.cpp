@@ -0,0 +1,80 @@
+#include "Utils/Windows/FileDialogs.h"
+
+#include <cstdio>
+#include <cstring>
+#include <optional>
+#include "Logging.h"
+
+// There's no native file dialog on linux, so we go through zenity if it's installed
+
+// Converts a win32 style filter ("Name\0*.a;*.b\0\0") into zenity's --file-filter arguments
+static std::string ToZenityFilters(const char* filter)
+{
+	std::string result;
+	while (filter != nullptr && *filter != '\0') {
+		const char* name = filter;
+		const char* patterns = name + strlen(name) + 1;
+		if (*patterns == '\0') break;
+
+		std::string pattern = patterns;
+		for (char& c : pattern) {
+			if (c == ';') c = ' ';
+		}
+		result += " --file-filter=\"" + std::string(name) + " | " + pattern + "\"";
+
+		filter = patterns + strlen(patterns) + 1;
+	}
+	return result;
+}
+
+// Runs zenity with the given arguments, returning the selected path if the user picked one
+static std::optional<std::string> RunZenity(const std::string& args)
+{
+	std::string command = "zenity --file-selection" + args + " 2>/dev/null";
+	FILE* pipe = popen(command.c_str(), "r");
+	if (pipe == nullptr) {
+		LOG_WARN("File dialogs need zenity to be installed");
+		return std::nullopt;
+	}
+
+	char buffer[4096] = { 0 };
+	std::string result;
+	while (fgets(buffer, sizeof(buffer), pipe) != nullptr) {
+		result += buffer;
+	}
+	int status = pclose(pipe);
+
+	// Strip the trailing newline
+	while (!result.empty() && (result.back() == '\n' || result.back() == '\r')) {
+		result.pop_back();
+	}
+
+	if (status != 0 || result.empty())
+		return std::nullopt;
+	return result;
+}
+
+std::optional<std::string> FileDialogs::OpenFile(const char* filter)
+{
+	return RunZenity(ToZenityFilters(filter));
+}
+
+std::optional<std::string> FileDialogs::SaveFile(const char* filter)
+{
+	std::optional<std::string> result = RunZenity(" --save --confirm-overwrite" + ToZenityFilters(filter));
+
+	// Add the default extension from the filter if the user didn't type one, same as the windows version
+	if (result.has_value() && result.value().find('.', result.value().find_last_of('/') + 1) == std::string::npos) {
+		const char* pattern = strchr(filter, '\0') + 1;
+		const char* extension = strchr(pattern, '.');
+		if (extension != nullptr && extension[1] != '*') {
+			result.value() += std::string(extension, strcspn(extension, ";"));
+		}
+	}
+	return result;
+}
+
+std::optional<std::string> FileDialogs::SelectFolder(const char* filter)
+{
+	return RunZenity(" --directory");
+}
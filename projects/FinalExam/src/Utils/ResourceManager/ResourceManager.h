@@ -27,10 +27,20 @@ public:
 	/// <typeparam name="...TArgs">The types for the arguments to forward to the constructor</typeparam>
 	/// <param name="...args">The arguments to forward to the constructor</param>
 	/// <returns>The GUID of the newly created asset</returns>
-	template <typename T, typename ... TArgs, typename = std::enable_if<is_valid_resource<T>()>::type>
+	template <typename T, typename ... TArgs, typename = typename std::enable_if<is_valid_resource<T>()>::type>
 	static std::shared_ptr<T> CreateAsset(TArgs&&... args) {
-		// Create and store the asset
-		std::shared_ptr<T> asset = std::make_shared<T>(std::forward<TArgs>(args)...);
+		return AddAsset<T>(std::make_shared<T>(std::forward<TArgs>(args)...));
+	}
+
+	/// <summary>
+	/// Adds an asset that was created elsewhere (ex: by a batch loader) to the resource manager
+	/// </summary>
+	/// <typeparam name="T">The type of asset to add</typeparam>
+	/// <param name="asset">The asset to add</param>
+	/// <returns>The asset, for chaining</returns>
+	template <typename T, typename = typename std::enable_if<is_valid_resource<T>()>::type>
+	static std::shared_ptr<T> AddAsset(const std::shared_ptr<T>& asset) {
+		// Store the asset
 		_resources[std::type_index(typeid(T))][asset->IResource::GetGUID()] = asset;
 
 		// Get the JSON representation of the asset so we can store it in the manifest
@@ -51,7 +61,7 @@ public:
 	/// <typeparam name="T">The type of resource to retreive</typeparam>
 	/// <param name="id">The ID of the resource to retrieve</param>
 	/// <returns>The resource with the given GUID, or nullptr if none exists</returns>
-	template<typename T, typename = std::enable_if<is_valid_resource<T>()>::type>
+	template<typename T, typename = typename std::enable_if<is_valid_resource<T>()>::type>
 	static std::shared_ptr<T> Get(Guid id) {
 		// Try and grab the asset from the resource pool
 		std::shared_ptr<T> result =  std::dynamic_pointer_cast<T>(_resources[std::type_index(typeid(T))][id]);
@@ -81,7 +91,7 @@ public:
 	/// </summary>
 	/// <typeparam name="T">The type to register, must satisfy the is_valid_resource constraint</typeparam>
 	/// <typeparam name=""></typeparam>
-	template <typename T, typename = std::enable_if<is_valid_resource<T>()>::type>
+	template <typename T, typename = typename std::enable_if<is_valid_resource<T>()>::type>
 	static void RegisterType() {
 		// Extract the type name from a sanitized version of they typeid name
 		std::string typeName = StringTools::SanitizeClassName(typeid(T).name());
@@ -89,7 +99,7 @@ public:
 		// Create the type loader for the type
 		_typeLoaders[typeName] = [](const nlohmann::json& data) {
 			IResource::Sptr res = T::FromJson(data);
-			res->OverrideGUID(Guid(data["guid"]));
+			res->OverrideGUID(Guid(data["guid"].get<std::string>()));
 			_resources[std::type_index(typeid(T))][res->GetGUID()] = res;
 			return res->GetGUID();
 		};
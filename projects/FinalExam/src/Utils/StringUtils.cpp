@@ -1,7 +1,25 @@
 #include "Utils/StringUtils.h"
+#include <cstring>
+
+#ifndef _MSC_VER
+#include <cxxabi.h>
+#include <cstdlib>
+#endif
 
 std::string StringTools::SanitizeClassName(const std::string& name)
 {
+	#ifndef _MSC_VER
+	// Other compilers give us mangled names, demangling them gives us the same names as MSVC without the
+	// class or struct tag, so resources and components are named the same no matter where the files were made
+	int status = 0;
+	char* demangled = abi::__cxa_demangle(name.c_str(), nullptr, nullptr, &status);
+	if (status == 0 && demangled != nullptr) {
+		std::string result = demangled;
+		free(demangled);
+		return result;
+	}
+	#endif
+
 	const std::string classTag = "class ";
 	const std::string structTag = "struct ";
 	if (strncmp(name.c_str(), classTag.c_str(), classTag.size()) == 0) {
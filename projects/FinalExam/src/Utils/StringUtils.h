@@ -17,6 +17,7 @@ public:
 	/// Takes a class or structure name returned from typeid().name() and
 	/// removes the type specifier
 	/// ex: "class StringTools" --> "StringTools"
+	/// Mangled names from other compilers are demangled into the same format
 	/// </summary>
 	/// <param name="name">The unsanitized name of the type</param>
 	static std::string SanitizeClassName(const std::string& name);
@@ -1,16 +1,17 @@
 #define GLM_SWIZZLE 
 #include "Application/Application.h"
 
+#ifdef _WIN32
 extern "C" {
 	__declspec(dllexport) unsigned long NvOptimusEnablement = 0x01;
 	__declspec(dllexport) int AmdPowerXpressRequestHighPerformance = 0x01;
 }
+#endif
 
 int main(int argc, char** args) { 
 	Logger::Init();
 
-	// TODO: parse arguments?
-
+	// Arguments are handled in Application::_ParseArguments (ex: --headless --scene <path>)
 	Application::Start(argc, args);
 
 	Logger::Uninitialize();